@@ -0,0 +1,234 @@
+#include "FakeDevices.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+
+namespace {
+    constexpr double DEGREES_PER_RADIAN {180.0 / M_PI};
+}
+
+void FakeRadio::attach(FakeDevices &devices)
+{
+    mDevices.push_back(&devices);
+    add(devices, devices.channel());
+}
+
+void FakeRadio::detach(FakeDevices &devices)
+{
+    mDevices.erase(std::remove(mDevices.begin(), mDevices.end(), &devices), mDevices.end());
+    remove(devices, devices.channel());
+}
+
+void FakeRadio::retune(FakeDevices &devices, int from, int to)
+{
+    remove(devices, from);
+    add(devices, to);
+}
+
+void FakeRadio::send(const FakeDevices &sender, int channel, const std::string &data)
+{
+    if (mTap)
+    {
+        mTap(sender, channel, data);
+    }
+    if (channel == -1)
+    {
+        for (FakeDevices *devices : mDevices)
+        {
+            if (devices != &sender)
+            {
+                devices->deliver(data);
+            }
+        }
+        return;
+    }
+    for (int listening : {channel, -1})
+    {
+        auto listeners{mListeners.find(listening)};
+        if (listeners == mListeners.end())
+        {
+            continue;
+        }
+        for (FakeDevices *devices : listeners->second)
+        {
+            if (devices != &sender)
+            {
+                devices->deliver(data);
+            }
+        }
+    }
+}
+
+void FakeRadio::tap(std::function<void(const FakeDevices&, int, const std::string&)> listener)
+{
+    mTap = std::move(listener);
+}
+
+void FakeRadio::add(FakeDevices &devices, int channel)
+{
+    mListeners[channel].push_back(&devices);
+}
+
+void FakeRadio::remove(FakeDevices &devices, int channel)
+{
+    std::vector<FakeDevices *> &listeners{mListeners[channel]};
+    listeners.erase(std::remove(listeners.begin(), listeners.end(), &devices), listeners.end());
+}
+
+FakeDevices::FakeDevices(const std::string &name, FakeRadio &radio, double x, double z, double heading)
+    : mName(name),
+      mRadio(radio),
+      mTime(0),
+      mX(x),
+      mZ(z),
+      mHeading(heading),
+      mLeftVelocity(0),
+      mRightVelocity(0),
+      mChannel(0),
+      mStopped(false),
+      mMotorCalls(0)
+{
+    mRadio.attach(*this);
+}
+
+FakeDevices::~FakeDevices()
+{
+    mRadio.detach(*this);
+}
+
+void FakeDevices::enable(int) {}
+
+int FakeDevices::step(int timeStep)
+{
+    if (mStopped)
+    {
+        return -1;
+    }
+    double dt{timeStep / 1000.0};
+    double left{std::clamp(mLeftVelocity, -MAX_VELOCITY, MAX_VELOCITY) * WHEEL_RADIUS};
+    double right{std::clamp(mRightVelocity, -MAX_VELOCITY, MAX_VELOCITY) * WHEEL_RADIUS};
+
+    // Turning left (right wheel faster) turns anticlockwise, which lowers the compass bearing
+    mHeading = std::fmod(mHeading - (right - left) / AXLE_LENGTH * dt * DEGREES_PER_RADIAN + 360.0, 360.0);
+    double direction{(mHeading - 180.0) / DEGREES_PER_RADIAN};
+    mX += (left + right) / 2 * std::cos(direction) * dt;
+    mZ += (left + right) / 2 * std::sin(direction) * dt;
+    mTime += dt;
+
+    mInbox.insert(mInbox.end(), mArriving.begin(), mArriving.end());
+    mArriving.clear();
+    return 0;
+}
+
+double FakeDevices::time() const
+{
+    return mTime;
+}
+
+std::string FakeDevices::name() const
+{
+    return mName;
+}
+
+int FakeDevices::key()
+{
+    if (mKeys.empty())
+    {
+        return EOF;
+    }
+    int key{mKeys.front()};
+    mKeys.pop_front();
+    return key;
+}
+
+void FakeDevices::send(int channel, const std::string &data)
+{
+    mRadio.send(*this, channel, data);
+}
+
+bool FakeDevices::receive(std::string &data)
+{
+    if (mInbox.empty())
+    {
+        return false;
+    }
+    data = std::move(mInbox.front());
+    mInbox.pop_front();
+    return true;
+}
+
+void FakeDevices::listen(int channel)
+{
+    mRadio.retune(*this, mChannel, channel);
+    mChannel = channel;
+}
+
+std::array<double, 3> FakeDevices::position() const
+{
+    return {mX, 0, mZ};
+}
+
+std::array<double, 3> FakeDevices::north() const
+{
+    // Inverse of BaseRobot::updateHeading
+    double rad{mHeading / DEGREES_PER_RADIAN + M_PI / 2};
+    return {std::cos(rad), 0, std::sin(rad)};
+}
+
+double FakeDevices::maxMotorVelocity() const
+{
+    return MAX_VELOCITY;
+}
+
+void FakeDevices::velocityControl(Wheel)
+{
+    mMotorCalls++;
+}
+
+void FakeDevices::setMotorVelocity(Wheel wheel, double velocity)
+{
+    (wheel == Wheel::LEFT ? mLeftVelocity : mRightVelocity) = velocity;
+    mMotorCalls++;
+}
+
+void FakeDevices::pressKey(int key)
+{
+    mKeys.push_back(key);
+}
+
+void FakeDevices::deliver(const std::string &data)
+{
+    mArriving.push_back(data);
+}
+
+int FakeDevices::channel() const
+{
+    return mChannel;
+}
+
+double FakeDevices::heading() const
+{
+    return mHeading;
+}
+
+double FakeDevices::leftVelocity() const
+{
+    return mLeftVelocity;
+}
+
+double FakeDevices::rightVelocity() const
+{
+    return mRightVelocity;
+}
+
+long FakeDevices::motorCalls() const
+{
+    return mMotorCalls;
+}
+
+void FakeDevices::stop()
+{
+    mStopped = true;
+}
@@ -0,0 +1,101 @@
+// File:          FakeDevices.hpp
+// Description:   RobotDevices without Webots, for running the robot core on a plain Linux box.
+//                Robots drive on a flat floor with ideal differential drive kinematics, and
+//                messages travel over a shared FakeRadio, arriving on the receiver's next step
+//                as they do in Webots.
+
+#pragma once
+
+#include <array>
+#include <deque>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "z5363966Devices.hpp"
+
+class FakeDevices;
+
+// Every robot on the same radio hears messages sent on its channel, or broadcast on -1. Listeners
+// are indexed by channel, so sending to one robot costs the same however many share the radio.
+class FakeRadio {
+    public:
+        void attach(FakeDevices&);
+        void detach(FakeDevices&);
+        void retune(FakeDevices&, int, int);
+        void send(const FakeDevices&, int, const std::string&);
+
+        // Test hook, called with the sender, channel and message of everything sent
+        void tap(std::function<void(const FakeDevices&, int, const std::string&)>);
+
+    private:
+        void add(FakeDevices&, int);
+        void remove(FakeDevices&, int);
+
+        std::vector<FakeDevices *> mDevices;
+        std::unordered_map<int, std::vector<FakeDevices *>> mListeners;
+        std::function<void(const FakeDevices&, int, const std::string&)> mTap;
+};
+
+class FakeDevices : public RobotDevices {
+    public:
+        /**
+         * @brief Places a robot on the floor
+         *
+         * @param name e.g. Customer1, which gives the robot its ID
+         * @param radio shared with the other robots
+         * @param x, z position [m]
+         * @param heading compass bearing [deg], as BaseRobot::updateHeading reports it
+         */
+        FakeDevices(const std::string&, FakeRadio&, double, double, double);
+        ~FakeDevices() override;
+
+        void enable(int) override;
+        int step(int) override;
+        double time() const override;
+        std::string name() const override;
+        int key() override;
+        void send(int, const std::string&) override;
+        bool receive(std::string&) override;
+        void listen(int) override;
+        std::array<double, 3> position() const override;
+        std::array<double, 3> north() const override;
+        double maxMotorVelocity() const override;
+        void velocityControl(Wheel) override;
+        void setMotorVelocity(Wheel, double) override;
+
+        // Test hooks
+        void pressKey(int);
+        void deliver(const std::string&);
+        int channel() const;
+        double heading() const;
+        double leftVelocity() const;
+        double rightVelocity() const;
+        long motorCalls() const;
+
+        // Stops the controller on the next step, as Webots does when the simulation ends
+        void stop();
+
+    private:
+        std::string mName;
+        FakeRadio &mRadio;
+        double mTime;
+        double mX;
+        double mZ;
+        double mHeading;
+        double mLeftVelocity;
+        double mRightVelocity;
+        int mChannel;
+        bool mStopped;
+        long mMotorCalls;
+
+        std::deque<int> mKeys;
+        std::deque<std::string> mArriving;   // sent during the current step
+        std::deque<std::string> mInbox;      // readable by the controller
+
+        // e-puck wheel motors
+        static constexpr double MAX_VELOCITY {6.28};
+        static constexpr double WHEEL_RADIUS {0.025};
+        static constexpr double AXLE_LENGTH {0.045};
+};
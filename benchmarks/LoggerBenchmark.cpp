@@ -0,0 +1,94 @@
+// File:          LoggerBenchmark.cpp
+// Description:   Checks the lines the asynchronous logger writes, then times a LOG_INFO call on the
+//                control loop for the shapes of line the controllers log. Lines are logged in bursts
+//                of BURST, well inside the ring buffer, and the writer thread is flushed between
+//                bursts outside the timing, so a call never waits for a full buffer. The writer
+//                formats into a string stream instead of the terminal.
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "z5363966Logger.hpp"
+
+static constexpr int BURST {256};
+static constexpr int BURSTS {2000};
+
+// Target cost of a call to the control loop
+static constexpr double TARGET_NS {100};
+
+static int failures {0};
+
+#define CHECK(condition)                                                        \
+    do                                                                          \
+    {                                                                           \
+        if (!(condition))                                                       \
+        {                                                                       \
+            std::printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition);  \
+            failures++;                                                         \
+        }                                                                       \
+    } while (false)
+
+// Mean time of a call, over BURSTS bursts of BURST calls [ns]
+template <typename Log>
+static double nsPerCall(Log log)
+{
+    double total{0};
+    for (int burst = 0; burst < BURSTS; burst++)
+    {
+        auto start{std::chrono::steady_clock::now()};
+        for (int i = 0; i < BURST; i++)
+        {
+            log(i);
+        }
+        total += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        Logger::instance().flush();
+    }
+    return total / (static_cast<double>(BURST) * BURSTS);
+}
+
+int main()
+{
+    std::ostringstream sink;
+    std::streambuf *terminal{std::cout.rdbuf(sink.rdbuf())};
+
+    std::string name{"Customer12"};
+    std::string item{"Picolo Latte"};
+    // Longer than the spare bytes of a slot, so its text goes to the heap
+    std::string chunk(300, 'x');
+
+    // Strings are copied at the call, so changing them afterwards does not change the line
+    LOG_INFO(name, ": Hi Staff, I would like to order ", item, " x", 2);
+    LOG_WARN(name, ": balance ", LogFixed{4.5, 2});
+    LOG_ERROR("chunk ", chunk, " of ", chunk.size());
+    LOG_INFO(std::string{}, "|", std::to_string(7));
+    name = "Changed";
+    chunk.assign(300, 'y');
+    Logger::instance().flush();
+    CHECK(sink.str() == "Customer12: Hi Staff, I would like to order Picolo Latte x2\n"
+                        "[WARN] Customer12: balance 4.50\n"
+                        "[ERROR] chunk " + std::string(300, 'x') + " of 300\n"
+                        "|7\n");
+    name = "Customer12";
+
+    struct Shape {
+        const char *name;
+        double ns;
+    };
+    Shape shapes[] {
+        {"literals and an int", nsPerCall([](int i) { LOG_INFO("Customer ", i, ": I am heading to order counter"); })},
+        {"two strings", nsPerCall([&](int) { LOG_INFO(name, ": Hi Staff, I would like to order ", item); })},
+        {"string and fixed point", nsPerCall([&](int i) { LOG_INFO(name, ": My current balance is ", LogFixed{i * 0.01, 2}); })},
+        {"string on the heap", nsPerCall([&](int) { LOG_WARN(name, ": malformed message: ", chunk); })}};
+    std::cout.rdbuf(terminal);
+
+    std::printf("%-24s %12s\n", "line", "per call");
+    for (const Shape &shape : shapes)
+    {
+        std::printf("%-24s %9.1f ns%s\n", shape.name, shape.ns, shape.ns > TARGET_NS ? "  over target" : "");
+    }
+    std::printf("logger checks:          %s\n", failures == 0 ? "passed" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
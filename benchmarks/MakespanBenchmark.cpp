@@ -0,0 +1,604 @@
+// File:          MakespanBenchmark.cpp
+// Description:   End to end makespan suite. Runs the director, staff and customer controllers together
+//                on fake devices, stepped in lockstep as Webots steps them, through a fixed catalogue of
+//                scenarios: the shipped Order.csv, heavily skewed items, only invalid items, customers
+//                who cannot pay, 1k orders, 100 customers, a radio that drops and reorders 10% of
+//                the dialogue's frames each, admission control holding a p99 latency target against
+//                more orders than the kitchen can make, and pre-orders while ingredients run out. For each scenario it records the simulated
+//                makespan of auto mode, the mean and p99 order latency (dispatch to "Order Complete", as
+//                the director measures it) and the wall clock time, then compares them against
+//                MakespanBaseline.json. Simulated results are deterministic, so any that regress beyond
+//                the baseline's threshold fail the run. Wall clock time depends on the machine and is
+//                only flagged. A scenario whose robots' final balances do not reconcile with the staff's
+//                ledger fails too. Pass --update-baseline to rewrite the baseline from this run.
+//                Results are cached by a hash of the scenario's input files, the constants below and
+//                this binary (see ResultCache.hpp), so a scenario nothing it depends on has changed
+//                for is not run again. Pass --no-cache to run every scenario and refresh its entry,
+//                and --cache-limit-mb=<size> to bound the cache, 256 MB by default.
+//                Run from benchmarks/build so ../../ is the project root.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "z5363966CustomerRobot.hpp"
+#include "z5363966StaffRobot.hpp"
+#include "z5363966DirectorRobot.hpp"
+#include "FakeDevices.hpp"
+#include "ResultCache.hpp"
+
+namespace fs = std::filesystem;
+
+static constexpr int TIME_STEP {64};
+
+// A scenario that has not finished by then is stuck
+static constexpr double MAX_SIMULATED_SECONDS {1000000};
+
+// Used when the baseline does not give its own thresholds
+static constexpr double DEFAULT_THRESHOLD {0.02};
+static constexpr double DEFAULT_WALL_THRESHOLD {0.5};
+
+// Starting poses of the four customers in worlds/MTRN2500.wbt, and of the staff behind the counter
+static constexpr double CUSTOMER_START_X {-1.375};
+static constexpr double CUSTOMER_START_Z {0.875};
+static constexpr double CUSTOMER_SPACING {0.5};
+static constexpr double STAFF_X {1.375};
+static constexpr double STAFF_Z {0.875};
+
+// Files of a scenario's project root its results depend on, and the ones its run leaves behind
+static const std::vector<std::string> INPUTS {"Menu.csv", "Order.csv", "Stock.csv", "Settings.csv", "Starting.csv"};
+static const std::vector<std::string> OUTPUTS {"Account.csv", "Ledger.csv", "Trace.csv"};
+
+static constexpr std::uintmax_t DEFAULT_CACHE_LIMIT_MB {256};
+
+struct Scenario {
+    std::string name;
+    int customers;
+    double balance;     // starting cash of every customer, negative keeps the shipped Starting.csv
+    std::vector<std::pair<std::string, std::string>> settings;   // on top of the shipped Settings.csv
+};
+
+struct Result {
+    std::size_t orders {0};
+    double makespan {0};
+    double meanLatency {0};
+    double p99Latency {0};
+    double wall {0};
+    bool finished {false};
+};
+
+// Generated orders arrive about once a second per customer, so the cafeteria is always saturated,
+// except where a scenario sets its own workload_rate
+static const std::vector<std::pair<std::string, std::string>> SATURATED {
+    {"order_source", "generator"},
+    {"workload_rate", "3600"},
+    {"workload_invalid_fraction", "0"},
+    {"workload_over_budget_fraction", "0"},
+    {"max_outstanding_orders", "4"}};
+
+static std::vector<Scenario> catalogue()
+{
+    auto with = [](std::vector<std::pair<std::string, std::string>> settings) {
+        std::vector<std::pair<std::string, std::string>> all{SATURATED};
+        all.insert(all.end(), settings.begin(), settings.end());
+        return all;
+    };
+    return {
+        {"shipped", 4, -1, {}},
+        {"preorder", 4, -1, {{"preorder", "1"}}},
+        {"heavy_skew", 4, 1000, with({{"workload_orders", "200"}, {"workload_item_weights", "Picolo Latte:100"}})},
+        {"all_invalid", 4, 1000, with({{"workload_orders", "200"}, {"workload_invalid_fraction", "1"}})},
+        {"all_broke", 4, 0, with({{"workload_orders", "200"}})},
+        {"orders_1k", 4, 1000, with({{"workload_orders", "1000"}, {"workload_invalid_fraction", "0.05"}})},
+        {"customers_100", 100, 1000, with({{"workload_orders", "300"}, {"max_outstanding_orders", "100"}})},
+        {"lossy", 4, 1000, with({{"workload_orders", "200"}, {"message_drop_percent", "10"}, {"message_reorder_percent", "10"}})},
+        {"admission", 4, 1000, with({{"workload_orders", "200"}, {"workload_rate", "8"}, {"target_p99_latency", "400"},
+                                      {"shed_after_seconds", "1200"}})},
+        {"stockout", 4, 1000, with({{"workload_orders", "200"}, {"stock_scale", "0.02"}, {"restock_interval", "1800"}})},
+        {"pre_stockout", 4, 1000, with({{"workload_orders", "200"}, {"preorder", "1"}, {"stock_scale", "0.02"},
+                                        {"restock_interval", "1800"}})},
+        {"counters_1", 20, 1000, with({{"workload_orders", "200"}, {"max_outstanding_orders", "20"}, {"counters", "0.375:-0.375"}})},
+        {"counters_2", 20, 1000, with({{"workload_orders", "200"}, {"max_outstanding_orders", "20"}, {"counters", "0.25:-0.25;0.75:-0.75"}})},
+        {"counters_4", 20, 1000, with({{"workload_orders", "200"}, {"max_outstanding_orders", "20"},
+                                       {"counters", "0.125:-0.125;0.375:-0.375;0.625:-0.625;0.875:-0.875"}})}};
+}
+
+// Customer IDs skip the staff's
+static std::vector<int> customerIds(int customers, int staffId)
+{
+    std::vector<int> ids;
+    for (int id = 1; static_cast<int>(ids.size()) < customers; id++)
+    {
+        if (id != staffId)
+        {
+            ids.push_back(id);
+        }
+    }
+    return ids;
+}
+
+static void copyFile(const fs::path &from, const fs::path &to)
+{
+    fs::copy_file(from, to, fs::copy_options::overwrite_existing);
+}
+
+/**
+ * @brief Lays out a project root for the scenario, with the controllers' working directory inside it
+ *
+ * @return fs::path, the working directory
+ */
+static fs::path prepare(const Scenario &scenario, const fs::path &projectRoot, const fs::path &scenariosDir)
+{
+    fs::path root{scenariosDir / scenario.name};
+    fs::remove_all(root);
+    fs::path workingDir{root / "controllers" / "headless"};
+    fs::create_directories(workingDir);
+
+    copyFile(projectRoot / "Menu.csv", root / "Menu.csv");
+    copyFile(projectRoot / "Order.csv", root / "Order.csv");
+    copyFile(projectRoot / "Stock.csv", root / "Stock.csv");
+
+    std::ifstream shippedSettings{projectRoot / "Settings.csv"};
+    std::ofstream settings{root / "Settings.csv"};
+    settings << shippedSettings.rdbuf();
+    for (const auto &setting : scenario.settings)
+    {
+        settings << '\n' << setting.first << ',' << setting.second;
+    }
+    settings << '\n';
+    settings.close();
+
+    if (scenario.balance < 0)
+    {
+        copyFile(projectRoot / "Starting.csv", root / "Starting.csv");
+    }
+    else
+    {
+        int staffId{Settings{(root / "Settings.csv").string()}.getInt("staff_id", 5)};
+        std::ofstream starting{root / "Starting.csv"};
+        starting << "Robot,Starting Cash ($)\n";
+        for (int id : customerIds(scenario.customers, staffId))
+        {
+            starting << id << ',' << scenario.balance << '\n';
+        }
+        starting << staffId << ",5\n";
+    }
+    return workingDir;
+}
+
+// Nearest rank, as the director's admission control takes it
+static double p99(std::vector<double> samples)
+{
+    if (samples.empty())
+    {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    std::size_t rank{static_cast<std::size_t>(std::ceil(0.99 * samples.size()))};
+    return samples[std::max<std::size_t>(rank, 1) - 1];
+}
+
+static Result run(const Scenario &scenario, const fs::path &workingDir)
+{
+    fs::current_path(workingDir);
+    auto start{std::chrono::steady_clock::now()};
+
+    // Watches the director's dispatches and the customers' completions on the radio, from the first
+    // time each frame is sent
+    FakeRadio radio;
+    double autoStart{-1};
+    double autoEnd{-1};
+    std::unordered_map<int, double> dispatched;
+    std::vector<double> latencies;
+    std::ofstream trace{"../../Trace.csv"};
+    trace << "Time (s),Robot,Event,Channel\n";
+    std::set<std::tuple<std::string, int, std::uint32_t, std::uint32_t>> framesSent;
+    const std::string complete{"Order Complete"};
+    radio.tap([&](const FakeDevices &sender, int channel, const std::string &sent) {
+        Link::Frame frame;
+        std::string data{sent};
+        if (Link::parse(sent, frame))
+        {
+            if (frame.acknowledgement || !framesSent.emplace(sender.name(), channel, frame.session, frame.sequence).second)
+            {
+                return;
+            }
+            data = frame.message;
+        }
+        if (sender.name() == "Director")
+        {
+            if (channel == -1 && data == "4")
+            {
+                autoStart = sender.time();
+                trace << sender.time() << ",Director,auto_start," << channel << '\n';
+            }
+            else if (channel == -1 && data == "~")
+            {
+                autoEnd = sender.time();
+                trace << sender.time() << ",Director,auto_end," << channel << '\n';
+            }
+            else if (channel > 0 && !data.empty() && !std::isdigit(static_cast<unsigned char>(data[0])))
+            {
+                dispatched[channel] = sender.time();
+                trace << sender.time() << ",Director,dispatch," << channel << '\n';
+            }
+        }
+        else if (channel == Roster::DIRECTOR_CHANNEL && data.compare(0, complete.size(), complete) == 0)
+        {
+            auto order{dispatched.find(std::atoi(data.c_str() + complete.size()))};
+            if (order != dispatched.end())
+            {
+                latencies.push_back(sender.time() - order->second);
+                trace << sender.time() << ',' << sender.name() << ",complete," << order->first << '\n';
+                dispatched.erase(order);
+            }
+        }
+    });
+
+    // Every controller steps its devices and then runs its time step, as its run loop does
+    struct Controller {
+        FakeDevices *devices;
+        std::function<bool()> update;
+        bool running;
+    };
+    std::vector<Controller> controllers;
+
+    int staffId{Settings{"../../Settings.csv"}.getInt("staff_id", 5)};
+    auto staffDevices{std::make_unique<FakeDevices>("Staff", radio, STAFF_X, STAFF_Z, 0)};
+    FakeDevices *staffFake{staffDevices.get()};
+    StaffRobot staff{std::move(staffDevices)};
+    staff.start();
+    controllers.push_back({staffFake, [&staff] { return staff.update(); }, true});
+
+    std::vector<int> ids{customerIds(scenario.customers, staffId)};
+    std::vector<std::unique_ptr<CustomerRobot>> customers;
+    int columns{static_cast<int>(std::ceil(std::sqrt(ids.size())))};
+    for (std::size_t i = 0; i < ids.size(); i++)
+    {
+        // The world's four customers stand in a line, larger crowds in a grid on the same side of the floor
+        double x{CUSTOMER_START_X};
+        double z{CUSTOMER_START_Z - CUSTOMER_SPACING * i};
+        if (ids.size() > 4)
+        {
+            x = CUSTOMER_START_X + 0.1 * static_cast<double>(i % columns);
+            z = CUSTOMER_START_Z - 1.75 * static_cast<double>(i / columns) / columns;
+        }
+        auto devices{std::make_unique<FakeDevices>("Customer" + std::to_string(ids[i]), radio, x, z, 0)};
+        FakeDevices *fake{devices.get()};
+        customers.push_back(std::make_unique<CustomerRobot>(std::move(devices)));
+        CustomerRobot *customer{customers.back().get()};
+        customer->start();
+        controllers.push_back({fake, [customer] { return customer->update(); }, true});
+    }
+
+    auto directorDevices{std::make_unique<FakeDevices>("Director", radio, 0, 0, 0)};
+    FakeDevices *directorFake{directorDevices.get()};
+    DirectorRobot director{std::move(directorDevices)};
+    director.start();
+    controllers.push_back({directorFake, [&director] { return director.update(); }, true});
+
+    // Auto mode, as if A was pressed as the simulation started
+    directorFake->pressKey('a');
+
+    std::size_t running{controllers.size()};
+    while (running > 0 && directorFake->time() < MAX_SIMULATED_SECONDS)
+    {
+        for (Controller &controller : controllers)
+        {
+            if (controller.running)
+            {
+                controller.devices->step(TIME_STEP);
+            }
+        }
+        for (Controller &controller : controllers)
+        {
+            if (controller.running && !controller.update())
+            {
+                controller.running = false;
+                running--;
+            }
+        }
+    }
+
+    Result result;
+    result.finished = running == 0 && autoStart >= 0 && autoEnd >= 0;
+    result.orders = latencies.size();
+    result.makespan = autoEnd - autoStart;
+    for (double latency : latencies)
+    {
+        result.meanLatency += latency / latencies.size();
+    }
+    result.p99Latency = p99(latencies);
+    result.wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// Everything the benchmark itself fixes about a scenario's run, the controllers' constants are in the binary
+static std::string constants(const Scenario &scenario)
+{
+    char text[256];
+    std::snprintf(text, sizeof(text),
+                  "time_step=%d;max_simulated=%.17g;customer_start=%.17g:%.17g:%.17g;staff=%.17g:%.17g;customers=%d",
+                  TIME_STEP, MAX_SIMULATED_SECONDS, CUSTOMER_START_X, CUSTOMER_START_Z, CUSTOMER_SPACING, STAFF_X, STAFF_Z,
+                  scenario.customers);
+    return text;
+}
+
+// Value of a robot's unlabelled metric from the Prometheus file it left, false if it never set it
+static bool readMetric(const fs::path &path, const std::string &name, double &value)
+{
+    std::ifstream metrics{path};
+    const std::string series{name + "{"};
+    std::string line;
+    while (std::getline(metrics, line))
+    {
+        if (line.compare(0, series.size(), series) == 0)
+        {
+            value = std::atof(line.c_str() + line.rfind(' ') + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Whether the staff found every robot's final balance matched its ledger
+static bool ledgerReconciled(const fs::path &root)
+{
+    double conserved{0};
+    return readMetric(root / "Metrics_Staff.prom", "cafe_ledger_conserved", conserved) && conserved == 1;
+}
+
+// With target_p99_latency set, whether the director held the p99 latency within it, engaging
+// backpressure and reporting the orders it shed. Describes what it found in detail.
+static bool admissionHeld(const Scenario &scenario, const fs::path &root, const Result &result, std::string &detail)
+{
+    auto target{std::find_if(scenario.settings.begin(), scenario.settings.end(),
+                             [](const auto &setting) { return setting.first == "target_p99_latency"; })};
+    if (target == scenario.settings.end())
+    {
+        return true;
+    }
+    double engagements{0};
+    double shed{0};
+    bool reported{readMetric(root / "Metrics_Director.prom", "cafe_backpressure_engaged_total", engagements) &&
+                  readMetric(root / "Metrics_Director.prom", "cafe_orders_shed_total", shed)};
+    double limit{std::atof(target->second.c_str())};
+    char text[96];
+    std::snprintf(text, sizeof(text), "  backpressure %.0fx, %.0f shed", engagements, shed);
+    detail = text;
+    return reported && engagements > 0 && shed > 0 && result.p99Latency <= limit;
+}
+
+// The run's files, with a metrics file for every robot that ran
+static std::vector<std::string> outputs(const fs::path &root)
+{
+    std::vector<std::string> files{OUTPUTS};
+    for (const fs::directory_entry &file : fs::directory_iterator(root))
+    {
+        if (file.path().filename().string().compare(0, 8, "Metrics_") == 0)
+        {
+            files.push_back(file.path().filename().string());
+        }
+    }
+    return files;
+}
+
+static std::string encodeResult(const Result &result)
+{
+    char text[160];
+    std::snprintf(text, sizeof(text), "%zu %.17g %.17g %.17g %.17g", result.orders, result.makespan, result.meanLatency,
+                  result.p99Latency, result.wall);
+    return text;
+}
+
+static bool decodeResult(const std::string &text, Result &result)
+{
+    result.finished = std::sscanf(text.c_str(), "%zu %lg %lg %lg %lg", &result.orders, &result.makespan,
+                                  &result.meanLatency, &result.p99Latency, &result.wall) == 5;
+    return result.finished;
+}
+
+// Reads "key": number from the given part of the baseline, which MakespanBenchmark writes
+static bool readNumber(const std::string &text, const std::string &key, double &value)
+{
+    std::size_t found{text.find("\"" + key + "\":")};
+    if (found == std::string::npos)
+    {
+        return false;
+    }
+    value = std::strtod(text.c_str() + found + key.size() + 3, nullptr);
+    return true;
+}
+
+static bool readScenario(const std::string &baseline, const std::string &name, Result &result)
+{
+    std::size_t start{baseline.find("\"" + name + "\": {")};
+    if (start == std::string::npos)
+    {
+        return false;
+    }
+    std::string entry{baseline.substr(start, baseline.find('}', start) - start)};
+    double orders{0};
+    bool complete{readNumber(entry, "orders", orders) && readNumber(entry, "makespan_seconds", result.makespan) &&
+                  readNumber(entry, "mean_latency_seconds", result.meanLatency) &&
+                  readNumber(entry, "p99_latency_seconds", result.p99Latency) &&
+                  readNumber(entry, "wall_seconds", result.wall)};
+    result.orders = static_cast<std::size_t>(orders);
+    return complete;
+}
+
+static void writeResults(const fs::path &path, const std::vector<Scenario> &scenarios, const std::vector<Result> &results,
+                         double threshold, double wallThreshold)
+{
+    std::ofstream file{path};
+    file << "{\n";
+    file << "    \"threshold\": " << threshold << ",\n";
+    file << "    \"wall_threshold\": " << wallThreshold << ",\n";
+    file << "    \"scenarios\": {\n";
+    for (std::size_t i = 0; i < scenarios.size(); i++)
+    {
+        char entry[256];
+        std::snprintf(entry, sizeof(entry),
+                      "        \"%s\": {\"orders\": %zu, \"makespan_seconds\": %.3f, \"mean_latency_seconds\": %.3f, "
+                      "\"p99_latency_seconds\": %.3f, \"wall_seconds\": %.3f}%s\n",
+                      scenarios[i].name.c_str(), results[i].orders, results[i].makespan, results[i].meanLatency,
+                      results[i].p99Latency, results[i].wall, (i + 1 < scenarios.size()) ? "," : "");
+        file << entry;
+    }
+    file << "    }\n";
+    file << "}\n";
+}
+
+// Relative change against the baseline, flagged beyond the threshold
+static std::string compare(double current, double baseline, double threshold, bool &regressed)
+{
+    double change{(baseline > 0) ? current / baseline - 1 : (current > 0 ? 1.0 : 0.0)};
+    char text[32];
+    std::snprintf(text, sizeof(text), "%+.1f%%", 100 * change);
+    if (change > threshold)
+    {
+        regressed = true;
+        return std::string(text) + "!";
+    }
+    return text;
+}
+
+int main(int argc, char **argv)
+{
+    bool updateBaseline{false};
+    bool useCache{true};
+    std::uintmax_t cacheLimitMb{DEFAULT_CACHE_LIMIT_MB};
+    for (int arg = 1; arg < argc; arg++)
+    {
+        std::string option{argv[arg]};
+        if (option == "--update-baseline")
+        {
+            // A baseline is only ever taken from fresh runs
+            updateBaseline = true;
+            useCache = false;
+        }
+        else if (option == "--no-cache")
+        {
+            useCache = false;
+        }
+        else if (option.compare(0, 17, "--cache-limit-mb=") == 0)
+        {
+            cacheLimitMb = std::strtoull(option.c_str() + 17, nullptr, 10);
+        }
+    }
+    fs::path buildDir{fs::current_path()};
+    fs::path projectRoot{fs::canonical(buildDir / ".." / "..")};
+    fs::path baselinePath{projectRoot / "benchmarks" / "MakespanBaseline.json"};
+
+    std::ifstream baselineFile{baselinePath};
+    std::stringstream baselineText;
+    baselineText << baselineFile.rdbuf();
+    std::string baseline{baselineText.str()};
+    double threshold{DEFAULT_THRESHOLD};
+    double wallThreshold{DEFAULT_WALL_THRESHOLD};
+    readNumber(baseline.substr(0, baseline.find("\"scenarios\"")), "threshold", threshold);
+    readNumber(baseline.substr(0, baseline.find("\"scenarios\"")), "wall_threshold", wallThreshold);
+
+    ResultCache cache{buildDir / "cache", cacheLimitMb * 1024 * 1024};
+    std::uint64_t binary{ResultCache::hashFile("/proc/self/exe")};
+    if (binary == ResultCache::FNV_OFFSET)
+    {
+        binary = ResultCache::hashFile(argv[0]);
+    }
+
+    std::vector<Scenario> scenarios{catalogue()};
+    std::vector<Result> results;
+    int failures{0};
+    std::printf("%-14s %7s %13s %13s %13s %9s  %s\n", "scenario", "orders", "makespan [s]", "mean lat [s]",
+                "p99 lat [s]", "wall [s]", "vs baseline (makespan mean p99 wall)");
+    for (const Scenario &scenario : scenarios)
+    {
+        fs::path workingDir{prepare(scenario, projectRoot, buildDir / "scenarios")};
+        fs::path root{buildDir / "scenarios" / scenario.name};
+        std::string key{ResultCache::key(root, INPUTS, constants(scenario), binary)};
+        std::string summary;
+        Result result;
+        bool cached{useCache && cache.fetch(key, root, summary) && decodeResult(summary, result)};
+        if (!cached)
+        {
+            result = run(scenario, workingDir);
+            fs::current_path(buildDir);
+            // The robots' own lines come first, so they do not break up the table
+            Logger::instance().flush();
+            if (result.finished)
+            {
+                cache.store(key, root, outputs(root), encodeResult(result));
+            }
+        }
+        results.push_back(result);
+
+        std::string verdict;
+        std::string admission;
+        Result expected;
+        if (!result.finished)
+        {
+            verdict = "DID NOT FINISH";
+            failures++;
+        }
+        else if (!ledgerReconciled(root))
+        {
+            verdict = "LEDGER NOT RECONCILED";
+            failures++;
+        }
+        else if (!admissionHeld(scenario, root, result, admission))
+        {
+            verdict = "TARGET NOT HELD";
+            failures++;
+        }
+        else if (updateBaseline)
+        {
+            verdict = "baseline updated";
+        }
+        else if (!readScenario(baseline, scenario.name, expected))
+        {
+            verdict = "no baseline";
+        }
+        else
+        {
+            bool regressed{false};
+            bool slower{false};
+            verdict = compare(result.makespan, expected.makespan, threshold, regressed) + " " +
+                      compare(result.meanLatency, expected.meanLatency, threshold, regressed) + " " +
+                      compare(result.p99Latency, expected.p99Latency, threshold, regressed) + " " +
+                      compare(result.wall, expected.wall, wallThreshold, slower);
+            if (result.orders != expected.orders)
+            {
+                verdict += " orders changed from " + std::to_string(expected.orders);
+                regressed = true;
+            }
+            verdict += regressed ? "  REGRESSED" : (slower ? "  slower wall clock" : "  ok");
+            failures += regressed ? 1 : 0;
+        }
+        verdict += admission + (cached ? "  (cached)" : "");
+        std::printf("%-14s %7zu %13.1f %13.1f %13.1f %9.2f  %s\n", scenario.name.c_str(), result.orders, result.makespan,
+                    result.meanLatency, result.p99Latency, result.wall, verdict.c_str());
+        std::fflush(stdout);
+    }
+
+    writeResults(buildDir / "MakespanResults.json", scenarios, results, threshold, wallThreshold);
+    if (updateBaseline && failures == 0)
+    {
+        writeResults(baselinePath, scenarios, results, threshold, wallThreshold);
+    }
+    std::printf("result cache:           %ld hits, %ld misses\n", cache.hits(), cache.misses());
+    std::printf("makespan suite:         %s\n", failures == 0 ? "passed" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
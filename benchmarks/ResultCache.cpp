@@ -0,0 +1,162 @@
+#include "ResultCache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+    constexpr const char *SUMMARY {"Summary.txt"};
+
+    std::uint64_t hashBytes(std::uint64_t hash, const char *data, std::size_t size)
+    {
+        for (std::size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * ResultCache::FNV_PRIME;
+        }
+        return hash;
+    }
+
+    // Names and contents are separated, so moving bytes from one to the next changes the key
+    std::uint64_t hashText(std::uint64_t hash, const std::string &text)
+    {
+        return hashBytes(hash, text.c_str(), text.size() + 1);
+    }
+
+    std::uintmax_t entrySize(const fs::path &entry)
+    {
+        std::uintmax_t size{0};
+        for (const fs::directory_entry &file : fs::directory_iterator(entry))
+        {
+            if (file.is_regular_file())
+            {
+                size += file.file_size();
+            }
+        }
+        return size;
+    }
+}
+
+ResultCache::ResultCache(const fs::path &directory, std::uintmax_t limitBytes)
+    : mDirectory(directory),
+      mLimitBytes(limitBytes),
+      mHits(0),
+      mMisses(0)
+{
+    fs::create_directories(mDirectory);
+}
+
+std::string ResultCache::key(const fs::path &root, const std::vector<std::string> &inputs, const std::string &constants,
+                             std::uint64_t binary)
+{
+    std::uint64_t hash{FNV_OFFSET};
+    for (const std::string &input : inputs)
+    {
+        hash = hashText(hash, input);
+        hash = hashText(hashFile(root / input, hash), "");
+    }
+    hash = hashText(hash, constants);
+    hash = hashBytes(hash, reinterpret_cast<const char *>(&binary), sizeof(binary));
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(hash));
+    return text;
+}
+
+std::uint64_t ResultCache::hashFile(const fs::path &path, std::uint64_t seed)
+{
+    std::ifstream file{path, std::ios::binary};
+    std::array<char, 65536> buffer;
+    std::uint64_t hash{seed};
+    while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0)
+    {
+        hash = hashBytes(hash, buffer.data(), static_cast<std::size_t>(file.gcount()));
+    }
+    return hash;
+}
+
+bool ResultCache::fetch(const std::string &key, const fs::path &into, std::string &summary)
+{
+    fs::path entry{mDirectory / key};
+    std::ifstream summaryFile{entry / SUMMARY};
+    if (!std::getline(summaryFile, summary))
+    {
+        mMisses++;
+        return false;
+    }
+    for (const fs::directory_entry &file : fs::directory_iterator(entry))
+    {
+        if (file.is_regular_file() && file.path().filename() != SUMMARY)
+        {
+            fs::copy_file(file.path(), into / file.path().filename(), fs::copy_options::overwrite_existing);
+        }
+    }
+    fs::last_write_time(entry, fs::file_time_type::clock::now());
+    mHits++;
+    return true;
+}
+
+void ResultCache::store(const std::string &key, const fs::path &from, const std::vector<std::string> &outputs,
+                        const std::string &summary)
+{
+    // Written aside and renamed into place, so an interrupted store never leaves half an entry
+    fs::path entry{mDirectory / key};
+    fs::path staging{mDirectory / (key + ".tmp")};
+    fs::remove_all(staging);
+    fs::create_directories(staging);
+    for (const std::string &output : outputs)
+    {
+        if (fs::is_regular_file(from / output))
+        {
+            fs::copy_file(from / output, staging / output, fs::copy_options::overwrite_existing);
+        }
+    }
+    std::ofstream{staging / SUMMARY} << summary << '\n';
+    fs::remove_all(entry);
+    fs::rename(staging, entry);
+    fs::last_write_time(entry, fs::file_time_type::clock::now());
+    evict(entry);
+}
+
+long ResultCache::hits() const
+{
+    return mHits;
+}
+
+long ResultCache::misses() const
+{
+    return mMisses;
+}
+
+void ResultCache::evict(const fs::path &keep)
+{
+    struct Entry {
+        fs::path path;
+        fs::file_time_type used;
+        std::uintmax_t size;
+    };
+    std::vector<Entry> entries;
+    std::uintmax_t total{0};
+    for (const fs::directory_entry &entry : fs::directory_iterator(mDirectory))
+    {
+        if (entry.is_directory())
+        {
+            entries.push_back({entry.path(), entry.last_write_time(), entrySize(entry.path())});
+            total += entries.back().size;
+        }
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.used < b.used; });
+    for (const Entry &entry : entries)
+    {
+        if (total <= mLimitBytes)
+        {
+            break;
+        }
+        if (entry.path != keep)
+        {
+            fs::remove_all(entry.path);
+            total -= entry.size;
+        }
+    }
+}
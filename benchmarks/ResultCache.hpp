@@ -0,0 +1,80 @@
+// File:          ResultCache.hpp
+// Description:   Content-addressed cache of makespan scenario results. A scenario's key hashes every
+//                input file of its project root, the constants that place and step the robots and
+//                the benchmark binary, which has the controllers compiled in, so any change to what
+//                the run depends on misses. An entry holds the results and the files the run left
+//                behind (Account.csv, Ledger.csv, Trace.csv and the metrics). The cache is kept
+//                under a size limit by evicting the least recently used entries.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+class ResultCache {
+    public:
+        /**
+         * @brief Opens the cache in a directory, creating it if needed
+         *
+         * @param directory e.g. benchmarks/build/cache
+         * @param limitBytes total size the entries are evicted down to
+         */
+        ResultCache(const std::filesystem::path&, std::uintmax_t);
+
+        /**
+         * @brief Key of a run: the inputs' names and contents, the constants and the binary's hash
+         *
+         * @param root project root the inputs are read from
+         * @param inputs file names under root
+         * @param constants text of every constant the run depends on that is not an input
+         * @param binary hash of the benchmark binary, from hashFile
+         * @return std::string, 16 hex digits
+         */
+        static std::string key(const std::filesystem::path&, const std::vector<std::string>&, const std::string&,
+                               std::uint64_t);
+
+        /**
+         * @brief FNV-1a of a file's contents, seeded so files can be chained
+         *
+         * @param path
+         * @param seed
+         * @return std::uint64_t, seed unchanged if the file cannot be read
+         */
+        static std::uint64_t hashFile(const std::filesystem::path&, std::uint64_t seed = FNV_OFFSET);
+
+        /**
+         * @brief Copies a cached run's files into a directory and marks it used
+         *
+         * @param key
+         * @param into project root of the scenario
+         * @param summary set to the results stored with the entry
+         * @return boolean, false on a miss
+         */
+        bool fetch(const std::string&, const std::filesystem::path&, std::string&);
+
+        /**
+         * @brief Stores a run's files and results, then evicts least recently used entries over the limit
+         *
+         * @param key
+         * @param from project root of the scenario
+         * @param outputs file names under from, missing ones skipped
+         * @param summary results, one line
+         */
+        void store(const std::string&, const std::filesystem::path&, const std::vector<std::string>&, const std::string&);
+
+        long hits() const;
+        long misses() const;
+
+        static constexpr std::uint64_t FNV_OFFSET {14695981039346656037ull};
+        static constexpr std::uint64_t FNV_PRIME {1099511628211ull};
+
+    private:
+        void evict(const std::filesystem::path&);
+
+        std::filesystem::path mDirectory;
+        std::uintmax_t mLimitBytes;
+        long mHits;
+        long mMisses;
+};
@@ -0,0 +1,1114 @@
+// File:          RobotCoreBenchmark.cpp
+// Description:   Unit checks and benchmarks of the robot core (libRobotCore) on fake devices, so
+//                BaseRobot's movement, change-only motor commands, messaging and its reliable link,
+//                registration, menu and menu replica, delivery routes, snapshots, teleop and pose
+//                recording run without Webots. A session of every controller checks the coroutine
+//                frame pool. Run from benchmarks/build so ../../Settings.csv and ../../Starting.csv
+//                are found.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <tuple>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "z5363966BaseRobot.hpp"
+#include "z5363966Admission.hpp"
+#include "z5363966Ledger.hpp"
+#include "z5363966CustomerRobot.hpp"
+#include "z5363966StaffRobot.hpp"
+#include "z5363966DirectorRobot.hpp"
+#include "z5363966Route.hpp"
+#include "FakeDevices.hpp"
+
+static constexpr long CONTROL_STEPS {2000000};
+static constexpr long MESSAGES {1000000};
+static constexpr int SNAPSHOTS {100000};
+static constexpr long MENU_LOOKUPS {10000000};
+static constexpr int FLEET_SIZES[] {10, 100, 500};
+static constexpr int FLEET_ROUTING_STEPS {200};
+
+// A session of the shipped world that has not finished by then is stuck [s]
+static constexpr double SESSION_SECONDS {20000};
+
+static int failures {0};
+
+#define CHECK(condition)                                                        \
+    do                                                                          \
+    {                                                                           \
+        if (!(condition))                                                       \
+        {                                                                       \
+            std::printf("FAILED %s:%d: %s\n", __FILE__, __LINE__, #condition);  \
+            failures++;                                                         \
+        }                                                                       \
+    } while (false)
+
+// BaseRobot with no behaviour of its own, driven step by step by the checks
+class CoreRobot : public BaseRobot {
+    public:
+        explicit CoreRobot(std::unique_ptr<RobotDevices> devices)
+            : BaseRobot(std::move(devices)) {}
+
+        void processData() override {}
+        void run() override {}
+        void remoteControl() override {}
+        void autoMode() override {}
+
+        /**
+         * @brief Steps until the move to x, z, angle finishes, as ArriveAt does in a workflow
+         *
+         * @return long, steps taken or -1 if the move did not finish
+         */
+        long driveTo(double x, double z, double angle, long maxSteps)
+        {
+            for (long steps = 1; steps <= maxSteps && step(TIME_STEP) != -1; steps++)
+            {
+                currentHeading = updateHeading();
+                updatePosition();
+                if (moveFinished())
+                {
+                    return steps;
+                }
+                move(x, z, angle);
+            }
+            return -1;
+        }
+
+        int id() const { return robotID; }
+        double balance() const { return mBalance; }
+        std::size_t mailbox() const { return mMailbox.size(); }
+};
+
+struct Fixture {
+    FakeRadio radio;
+    FakeDevices *devices;
+    std::unique_ptr<CoreRobot> robot;
+
+    explicit Fixture(const std::string &name, double heading = 200)
+    {
+        auto fake{std::make_unique<FakeDevices>(name, radio, 0, 0, heading)};
+        devices = fake.get();
+        robot = std::make_unique<CoreRobot>(std::move(fake));
+    }
+};
+
+static void checkIdentity()
+{
+    Fixture customer{"Customer2"};
+    CHECK(customer.robot->id() == 2);
+    CHECK(customer.devices->channel() == 2);
+    // Starting.csv gives Customer2 a balance
+    CHECK(customer.robot->balance() > 0);
+
+    Fixture staff{"Staff"};
+    CHECK(staff.robot->id() == 5);
+}
+
+static void checkMotors()
+{
+    Fixture customer{"Customer1"};
+    customer.robot->moveForward(2);
+    customer.robot->setMotorSpeed();
+    CHECK(customer.devices->leftVelocity() == 2 && customer.devices->rightVelocity() == 2);
+    customer.robot->turnLeft(1);
+    customer.robot->setMotorSpeed();
+    CHECK(customer.devices->leftVelocity() == -1 && customer.devices->rightVelocity() == 1);
+    customer.robot->halt();
+    customer.robot->setMotorSpeed();
+    CHECK(customer.devices->leftVelocity() == 0 && customer.devices->rightVelocity() == 0);
+
+    // Only changes reach the motors
+    long calls{customer.devices->motorCalls()};
+    customer.robot->setMotorPosition();
+    customer.robot->setMotorPosition();
+    customer.robot->setMotorSpeed();
+    CHECK(customer.devices->motorCalls() == calls + 2);
+
+    // Small changes wait for the refresh interval, stopping does not
+    {
+        std::ofstream settings{"ActuatorSettings.csv", std::ios::out | std::ios::trunc};
+        settings << "Setting,Value\nmotor_dead_band,0.05\nmotor_refresh_interval,0.5\n";
+    }
+    FakeRadio radio;
+    FakeDevices devices{"Customer1", radio, 0, 0, 0};
+    Actuators actuators{devices, Settings{"ActuatorSettings.csv"}};
+    actuators.setVelocity(2, 2);
+    actuators.setVelocity(2.03, 1.98);
+    CHECK(devices.leftVelocity() == 2 && devices.rightVelocity() == 2);
+    actuators.setVelocity(2.2, 2);
+    CHECK(devices.leftVelocity() == 2.2);
+    for (int step = 0; step < 8; step++)
+    {
+        devices.step(64);
+    }
+    actuators.setVelocity(2.23, 2);
+    CHECK(devices.leftVelocity() == 2.23);
+    actuators.setVelocity(0, 2);
+    CHECK(devices.leftVelocity() == 0);
+    CHECK(actuators.sent() == 5 && actuators.avoided() == 5 && devices.motorCalls() == 5);
+}
+
+static void checkSensors()
+{
+    Fixture customer{"Customer1", 123.5};
+    CHECK(std::abs(customer.robot->updateHeading() - 123.5) < 1e-3);
+}
+
+static void checkMove()
+{
+    // A move starts by turning on the spot to face its target
+    Fixture customer{"Customer1"};
+    CHECK(customer.robot->driveTo(0.3, 0.2, 0, 3) == -1);
+    CHECK(customer.devices->leftVelocity() != 0);
+    CHECK(customer.devices->leftVelocity() == -customer.devices->rightVelocity());
+    CHECK(customer.devices->heading() != 200);
+
+    // and finishes inside the tolerances, facing the bearing asked for from its start heading
+    CHECK(customer.robot->driveTo(0.3, 0.2, -M_PI / 2, 2000) > 0);
+    std::array<double, 3> position{customer.devices->position()};
+    CHECK(std::abs(position[0] - 0.3) < 0.01 && std::abs(position[2] - 0.2) < 0.01);
+    CHECK(std::abs(customer.devices->heading() - 110) < 0.1);
+}
+
+static void checkMessages()
+{
+    FakeRadio radio;
+    auto fake{std::make_unique<FakeDevices>("Customer3", radio, 0, 0, 0)};
+    FakeDevices *devices{fake.get()};
+    CoreRobot customer{std::move(fake)};
+    FakeDevices staff{"Staff", radio, 0, 0, 0};
+    staff.listen(5);
+
+    customer.sendMessage("Coffee3", 5);
+    std::string received;
+    CHECK(!staff.receive(received));
+    staff.step(64);
+    Link::Frame frame;
+    CHECK(staff.receive(received) && Link::parse(received, frame));
+    CHECK(!frame.acknowledgement && frame.channel == 3 && frame.sequence == 1 && frame.message == "Coffee3");
+
+    staff.send(3, "+");
+    staff.send(4, "not for customer 3");
+    customer.step(64);
+    CHECK(customer.receiveMessage() == "+");
+    CHECK(customer.receiveMessage().empty());
+
+    devices->stop();
+    CHECK(customer.step(64) == -1);
+}
+
+// Two links over a radio that drops and reorders frames: every message arrives once and in order
+static void checkLink()
+{
+    {
+        std::ofstream settings{"LinkSettings.csv", std::ios::out | std::ios::trunc};
+        settings << "Setting,Value\nmessage_drop_percent,30\nmessage_reorder_percent,30\n"
+                 << "message_timeout,0.2\nmessage_max_attempts,100\n";
+    }
+    Settings settings{"LinkSettings.csv"};
+    Metrics metrics{"LinkCheck", settings};
+    FakeRadio radio;
+    FakeDevices customerDevices{"Customer1", radio, 0, 0, 0};
+    FakeDevices staffDevices{"Staff", radio, 0, 0, 0};
+    Link customer{customerDevices, settings, metrics};
+    Link staff{staffDevices, settings, metrics};
+    customer.listen(1);
+    staff.listen(5);
+
+    constexpr int MESSAGES_EACH_WAY {200};
+    std::vector<std::string> toStaff;
+    std::vector<std::string> toCustomer;
+    std::string data;
+    for (int step = 0; step < 10000 && (toStaff.size() < MESSAGES_EACH_WAY || toCustomer.size() < MESSAGES_EACH_WAY); step++)
+    {
+        if (step < MESSAGES_EACH_WAY)
+        {
+            customer.send(5, "order" + std::to_string(step));
+            staff.send(1, "reply" + std::to_string(step));
+        }
+        customerDevices.step(64);
+        staffDevices.step(64);
+        customer.update();
+        staff.update();
+        while (staff.receive(data))
+        {
+            toStaff.push_back(data);
+        }
+        while (customer.receive(data))
+        {
+            toCustomer.push_back(data);
+        }
+    }
+    bool inOrder{toStaff.size() == MESSAGES_EACH_WAY && toCustomer.size() == MESSAGES_EACH_WAY};
+    for (std::size_t i = 0; inOrder && i < MESSAGES_EACH_WAY; i++)
+    {
+        inOrder = toStaff[i] == "order" + std::to_string(i) && toCustomer[i] == "reply" + std::to_string(i);
+    }
+    CHECK(inOrder);
+    CHECK(metrics.value("cafe_messages_dropped_total", "") > 0 && metrics.value("cafe_messages_resent_total", "") > 0);
+    // and the last acknowledgements get through in the end
+    for (int step = 0; step < 1000; step++)
+    {
+        customerDevices.step(64);
+        staffDevices.step(64);
+        customer.update();
+        staff.update();
+        customer.receive(data);
+        staff.receive(data);
+    }
+    CHECK(customer.unacknowledged() == 0 && staff.unacknowledged() == 0);
+
+    // A frame received again is acknowledged and suppressed, and anything else passes through
+    Settings clean{"../../Settings.csv"};
+    FakeDevices receiverDevices{"Customer2", radio, 0, 0, 0};
+    Link receiver{receiverDevices, clean, metrics};
+    receiver.listen(2);
+    for (const char *sent : {"&5:1:1:+", "&5:1:1:+", "=4.5"})
+    {
+        receiverDevices.deliver(sent);
+    }
+    receiverDevices.step(64);
+    CHECK(receiver.receive(data) && data == "+");
+    CHECK(receiver.receive(data) && data == "=4.5");
+    CHECK(!receiver.receive(data));
+
+    // A restored link starts a new session, which its receivers count from the start again, and
+    // frames from the old session are stale
+    FakeDevices senderDevices{"Customer3", radio, 0, 0, 0};
+    Link original{senderDevices, clean, metrics};
+    original.listen(3);
+    original.send(2, "before");
+    receiverDevices.step(64);
+    CHECK(receiver.receive(data) && data == "before");
+    SnapshotWriter writer;
+    original.save(writer);
+    Link restored{senderDevices, clean, metrics};
+    restored.listen(3);
+    SnapshotReader reader{writer.bytes()};
+    restored.restore(reader)();
+    CHECK(reader.ok() && restored.unacknowledged() == 1);
+    restored.update();
+    receiverDevices.deliver("&3:1:1:before");
+    receiverDevices.step(64);
+    CHECK(receiver.receive(data) && data == "before");
+    CHECK(!receiver.receive(data));
+
+    // A frame given up on is skipped, rather than holding back every later frame from its sender
+    {
+        std::ofstream settings{"LinkSettings.csv", std::ios::out | std::ios::trunc};
+        settings << "Setting,Value\nmessage_timeout,0.1\nmessage_max_attempts,2\n";
+    }
+    Settings impatient{"LinkSettings.csv"};
+    FakeDevices quitterDevices{"Customer4", radio, 0, 0, 0};
+    FakeDevices listenerDevices{"Customer6", radio, 0, 0, 0};
+    Link quitter{quitterDevices, impatient, metrics};
+    Link listener{listenerDevices, impatient, metrics};
+    quitter.listen(4);
+    // The listener is tuned away, so "lost" is dropped every time it is sent
+    listener.listen(9);
+    quitter.send(6, "lost");
+    for (int step = 0; step < 10; step++)
+    {
+        quitterDevices.step(64);
+        quitter.update();
+    }
+    CHECK(quitter.unacknowledged() == 0 && metrics.value("cafe_messages_abandoned_total", "") > 0);
+    listener.listen(6);
+    double skipped{metrics.value("cafe_messages_skipped_total", "")};
+    std::vector<std::string> after;
+    for (int step = 0; step < 20; step++)
+    {
+        if (step < 2)
+        {
+            quitter.send(6, "after" + std::to_string(step));
+        }
+        quitterDevices.step(64);
+        listenerDevices.step(64);
+        quitter.update();
+        listener.update();
+        while (listener.receive(data))
+        {
+            after.push_back(data);
+        }
+        quitter.receive(data);
+    }
+    CHECK((after == std::vector<std::string>{"after0", "after1"}));
+    CHECK(quitter.unacknowledged() == 0 && metrics.value("cafe_messages_skipped_total", "") == skipped + 1);
+
+    // Held back frames below a floor are handed on, the missing ones before them skipped
+    FakeDevices gapDevices{"Customer7", radio, 0, 0, 0};
+    Link gap{gapDevices, clean, metrics};
+    gap.listen(7);
+    for (const char *sent : {"&8:1:3/2:third", "&8:1:5/2:fifth"})
+    {
+        gapDevices.deliver(sent);
+    }
+    gapDevices.step(64);
+    CHECK(!gap.receive(data));
+    gapDevices.deliver("&8:1:6/4:sixth");
+    gapDevices.deliver("&8:1:4:fourth");
+    gapDevices.step(64);
+    std::vector<std::string> gapped;
+    while (gap.receive(data))
+    {
+        gapped.push_back(data);
+    }
+    CHECK((gapped == std::vector<std::string>{"third", "fourth", "fifth", "sixth"}));
+
+    Link::Frame frame;
+    CHECK(Link::parse("&1:2:1:before", frame) && frame.session == 2 && frame.message == "before");
+    CHECK(Link::parse("&1:2:9/3:later", frame) && frame.sequence == 9 && frame.floor == 3 && frame.message == "later");
+    CHECK(!Link::parse("&1:2:3/9:early", frame));
+    CHECK(Link::parse("&5:2:7", frame) && frame.acknowledgement && frame.sequence == 7);
+    CHECK(!Link::parse("&5:x", frame) && !Link::parse("+", frame));
+}
+
+static void checkRegistration()
+{
+    // Names ask for multi-digit IDs, and a robot whose ID is taken gets another
+    CHECK(Roster::requestedId("Customer12", 5) == 12);
+    CHECK(Roster::requestedId("Staff", 5) == 5);
+    Roster roster{5};
+    CHECK(roster.enrol("Staff") == 5);
+    CHECK(roster.enrol("Customer12") == 12);
+    CHECK(roster.enrol("Customer12") == 12);
+    int reassigned{roster.enrol("Customer5")};
+    CHECK(reassigned != 5 && reassigned != 12 && roster.registered(reassigned));
+    CHECK(roster.size() == 3);
+    CHECK(roster.takeAssignments().size() == 1);
+    CHECK(roster.takeAssignments().empty());
+
+    // A robot takes the ID and channel the director answers with
+    Fixture customer{"Customer12"};
+    CHECK(customer.robot->id() == 12 && customer.devices->channel() == 12);
+    FakeDevices director{"Director", customer.radio, 0, 0, 0};
+    director.listen(Roster::DIRECTOR_CHANNEL);
+    customer.robot->updateRegistration();
+    director.step(64);
+    std::string request;
+    CHECK(director.receive(request) && request == "@Customer12");
+    director.send(-1, "@Customer1=1:1;Customer12=40:41");
+    customer.robot->step(64);
+    CHECK(customer.robot->receiveMessage().empty());
+    CHECK(customer.robot->registered() && customer.robot->id() == 40 && customer.devices->channel() == 41);
+}
+
+static void checkMenu()
+{
+    // Items are interned in Menu.csv order and names must match exactly
+    Menu menu{"../../Menu.csv"};
+    CHECK(menu.size() > 0);
+    CHECK(menu.find("Latte") == 0 && menu.name(0) == "Latte");
+    CHECK(menu.prepSeconds(0) == 120 && menu.price(0) == 4 && menu.priceText(0) == "4");
+    CHECK(menu.recipe(0) == "espresso:1;milk:220");
+    CHECK(menu.find("Lattea") == Menu::NO_ITEM);
+    CHECK(menu.decode(Menu::encode(1)) == 1 && menu.decode("Cappuccino") == 1);
+    CHECK(menu.decode("%65534") == Menu::NO_ITEM);
+    CHECK(menu.label("%1") == "Cappuccino" && menu.label("Lattea") == "Lattea");
+}
+
+// The staff's menu replicated to a customer: a chunked snapshot, then deltas in order, stale ones
+// ignored and a lost one detected
+static void checkMenuReplica()
+{
+    Menu menu{"../../Menu.csv"};
+    MenuReplica staff;
+    staff.load(menu);
+    MenuReplica customer;
+    CHECK(customer.check(0, 100) == MenuVerdict::UNSYNCED);
+
+    std::vector<std::string> chunks{staff.snapshot()};
+    CHECK(chunks.size() == (menu.size() + MenuReplica::ITEMS_PER_MESSAGE - 1) / MenuReplica::ITEMS_PER_MESSAGE);
+    for (const std::string &chunk : chunks)
+    {
+        CHECK(customer.apply(chunk));
+    }
+    CHECK(customer.synced() && customer.version() == 1);
+    CHECK(customer.check(0, 4) == MenuVerdict::ORDERABLE && customer.check(0, 3.99) == MenuVerdict::UNAFFORDABLE);
+    CHECK(customer.check(Menu::NO_ITEM, 100) == MenuVerdict::UNKNOWN_ITEM);
+
+    std::string sold{staff.setAvailable(1, false)};
+    CHECK(staff.setAvailable(1, false).empty());
+    CHECK(customer.apply(sold) && customer.version() == 2);
+    CHECK(customer.check(1, 100) == MenuVerdict::UNAVAILABLE && !staff.available(1));
+    CHECK(customer.apply(sold) && customer.version() == 2);
+
+    // A delta that skips a version leaves the replica waiting for a snapshot
+    staff.setAvailable(1, true);
+    CHECK(!customer.apply(staff.setAvailable(2, false)));
+    CHECK(!customer.synced() && customer.check(2, 100) == MenuVerdict::UNSYNCED);
+    for (const std::string &chunk : staff.snapshot())
+    {
+        customer.apply(chunk);
+    }
+    CHECK(customer.synced() && customer.version() == 4);
+    CHECK(customer.check(1, 100) == MenuVerdict::ORDERABLE && customer.check(2, 100) == MenuVerdict::UNAVAILABLE);
+    CHECK(MenuReplica::request(3) == "^?3");
+}
+
+// Route::plan against every ordering of the stops, and its fallback for long routes
+static void checkRoute()
+{
+    RoutePoint kitchen{1.375, -0.375};
+    RoutePoint counter{0.875, 0.375};
+    CHECK(Route::plan(kitchen, {}, counter).empty());
+
+    std::vector<RoutePoint> stops{{0.875, -0.0625}, {0.875, -0.9375}, {0.875, -0.375}, {0.2, 0.6},
+                                  {-0.4, -0.8}, {1.2, 0.9}, {-1.1, 0.1}};
+    std::vector<std::size_t> order{Route::plan(kitchen, stops, counter)};
+    std::vector<std::size_t> sorted{order};
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<std::size_t> every(stops.size());
+    for (std::size_t stop = 0; stop < stops.size(); stop++)
+    {
+        every[stop] = stop;
+    }
+    CHECK(sorted == every);
+    double shortest{Route::length(kitchen, stops, every, counter)};
+    do
+    {
+        shortest = std::min(shortest, Route::length(kitchen, stops, every, counter));
+    } while (std::next_permutation(every.begin(), every.end()));
+    CHECK(std::abs(Route::length(kitchen, stops, order, counter) - shortest) < 1e-9);
+    CHECK(Route::length(kitchen, stops, order, counter) <= Route::roundTrips(kitchen, stops, counter));
+    CHECK(std::abs(Route::roundTrips(kitchen, {stops[3]}, counter) - Route::length(kitchen, {stops[3]}, {0}, counter)) < 1e-9);
+
+    // Slots along a counter are swept from one end to the other
+    std::vector<RoutePoint> slots{{0.875, -0.375}, {0.875, -0.0625}, {0.875, -0.625}};
+    CHECK((Route::plan(kitchen, slots, counter) == std::vector<std::size_t>{2, 0, 1}));
+
+    std::vector<RoutePoint> many(Route::MAX_EXACT_STOPS + 2);
+    for (std::size_t stop = 0; stop < many.size(); stop++)
+    {
+        many[stop] = {0.1 * static_cast<double>(stop), 0};
+    }
+    std::vector<std::size_t> sweep{Route::plan({-0.1, 0}, many, {2, 0})};
+    CHECK(sweep.size() == many.size() && std::is_sorted(sweep.begin(), sweep.end()));
+}
+
+// Counters from the settings, and customers routed by queue and walk
+static void checkCounters()
+{
+    Counters shipped{Settings{"../../Settings.csv"}};
+    CHECK(shipped.size() == 1 && shipped.orderPad(0).x == 0.375 && shipped.orderPad(0).z == 0.375);
+    CHECK(shipped.pickupPad(0).z == -0.375 && shipped.staffPost(0).x == 0.875);
+    CHECK(shipped.choose({-1.375, 0.875}, {5}) == 0);
+
+    {
+        std::ofstream settings{"CounterSettings.csv", std::ios::out | std::ios::trunc};
+        settings << "Setting,Value\ncounters,0.25:-0.25;0.75:-0.75\ncounter_service_seconds,10\n";
+    }
+    Counters two{Settings{"CounterSettings.csv"}};
+    CHECK(two.size() == 2 && two.orderPad(1).z == 0.75 && two.pickupPad(1).z == -0.75);
+
+    // Counter 0 is the shorter walk, until its queue outweighs the difference
+    RoutePoint start{-1.375, 0.875};
+    CHECK(two.choose(start, {}) == 0);
+    double difference{two.expectedWait(1, start, 0) - two.expectedWait(0, start, 0)};
+    CHECK(difference > 0 && difference < 10);
+    CHECK(two.choose(start, {1, 0}) == 1 && two.choose(start, {2, 1}) == 1 && two.choose(start, {1, 1}) == 0);
+
+    std::vector<int> queues;
+    Counters::decodeQueues(Counters::encodeQueues({3, 0, 12}), queues);
+    CHECK((queues == std::vector<int>{3, 0, 12}));
+}
+
+static void checkSnapshot()
+{
+    Fixture original{"Customer4"};
+    original.robot->postMessage({'$', 5, "2.50"});
+    SnapshotWriter writer;
+    original.robot->saveState(writer);
+
+    // Nothing changes until the snapshot read back is applied
+    Fixture restored{"Customer4"};
+    SnapshotReader reader{writer.bytes()};
+    SnapshotCommit commit{restored.robot->restoreState(reader)};
+    CHECK(reader.ok() && restored.robot->mailbox() == 0);
+    commit();
+    CHECK(restored.robot->mailbox() == 1);
+    BaseRobot::Receive price{restored.robot->receive("$", 5)};
+    CHECK(price.poll() && price.await_resume().body == "2.50");
+
+    // A snapshot cut short is read no further than its end and leaves the robot as it was
+    Fixture truncated{"Customer4"};
+    truncated.robot->postMessage({'*', 5, "kept"});
+    double balance{truncated.robot->balance()};
+    std::string bytes{writer.bytes()};
+    SnapshotReader shortened{bytes.substr(0, bytes.size() - 3)};
+    truncated.robot->restoreState(shortened);
+    CHECK(!shortened.ok());
+    CHECK(truncated.robot->mailbox() == 1 && truncated.robot->balance() == balance);
+    BaseRobot::Receive kept{truncated.robot->receive("*", 5)};
+    CHECK(kept.poll() && kept.await_resume().body == "kept");
+}
+
+// Ledger transfers and their rejections, then the end of run reconciliation against the balances
+// the robots report
+static void checkLedger()
+{
+    {
+        std::ofstream starting{"LedgerStarting.csv", std::ios::trunc};
+        starting << "Robot,Starting Cash ($)\n1,5\n2,8\n5,5\n";
+    }
+    Menu menu{"../../Menu.csv"};
+    Ledger ledger{"LedgerStarting.csv", "LedgerAccount.csv", "LedgerCheckpoint.csv", 5, 10, menu};
+    ledger.start();
+    CHECK(ledger.accounts() == 3 && ledger.openingTotal() == 1800);
+
+    CHECK(ledger.transfer(1, 1, 5, 400, 0) == Ledger::Result::APPLIED);
+    CHECK(ledger.balance(1) == 100 && ledger.balance(5) == 900 && ledger.transfers() == 1);
+    CHECK(ledger.transfer(1, 1, 5, 400, 0) == Ledger::Result::DUPLICATE);
+    CHECK(ledger.transfer(1, 2, 5, 101, 0) == Ledger::Result::INSUFFICIENT_FUNDS);
+    CHECK(ledger.transfer(3, 1, 5, 100, 0) == Ledger::Result::UNKNOWN_ACCOUNT);
+    CHECK(ledger.transfer(1, 2, 9, 100, 0) == Ledger::Result::UNKNOWN_ACCOUNT);
+    CHECK(ledger.balance(1) == 100 && ledger.balance(5) == 900 && ledger.transfers() == 1);
+
+    // A rejected payment does not use up its ID
+    CHECK(ledger.transfer(1, 2, 5, 100, 0) == Ledger::Result::APPLIED && ledger.balance(1) == 0);
+
+    Ledger::Reconciliation agreed{ledger.reconcile({{1, 0}, {2, 800}, {5, 1000}})};
+    CHECK(agreed.conserved && agreed.mismatched.empty() && agreed.unreported.empty() && agreed.total == 1800);
+
+    // A customer that kept money the ledger took, one that never reported, and one with no account
+    Ledger::Reconciliation kept{ledger.reconcile({{1, 400}, {5, 1000}, {7, 100}})};
+    CHECK(!kept.conserved && kept.mismatched == std::vector<int>({1, 7}));
+    CHECK(kept.unreported == std::vector<int>({2}) && kept.total == 2300);
+
+    // Money moved between customers outside the ledger is caught, though the total still adds up
+    Ledger::Reconciliation swapped{ledger.reconcile({{1, 100}, {2, 700}, {5, 1000}})};
+    CHECK(!swapped.conserved && swapped.mismatched == std::vector<int>({1, 2}) && swapped.total == 1800);
+}
+
+// Admission control's latency estimate from the staff's status and recent orders, and backpressure
+// engaging and releasing as the estimate crosses the target
+static void checkAdmission()
+{
+    {
+        std::ofstream settings{"AdmissionSettings.csv", std::ios::trunc};
+        settings << "Setting,Value\n";
+    }
+    AdmissionControl off{Settings{"AdmissionSettings.csv"}};
+    off.updateStatus(4, 1000, 0);
+    CHECK(!off.enabled() && off.admit(0, 0) && !off.shed(1e9) && off.engagements() == 0);
+
+    {
+        std::ofstream settings{"AdmissionSettings.csv", std::ios::trunc};
+        settings << "Setting,Value\ntarget_p99_latency,10\nshed_after_seconds,30\n";
+    }
+    AdmissionControl admission{Settings{"AdmissionSettings.csv"}};
+    CHECK(admission.enabled() && admission.predictedLatency(0, 0) == 0);
+
+    // The drain time counts down from the status until the next one, and the order's own prep time adds to it
+    admission.updateStatus(2, 4, 100);
+    CHECK(admission.queueDepth() == 2 && admission.predictedLatency(100, 0) == 4 && admission.predictedLatency(101, 0) == 3);
+    CHECK(admission.predictedLatency(110, 0) == 0 && admission.predictedLatency(100, 2) == 6);
+
+    // An order outstanding counts its prep time as work ahead until the drain time covers it, and one
+    // dispatched with 4 s ahead that took 6 s to prepare and 12 s in all leaves 2 s for the rest of its service
+    admission.dispatched(1, 100, 6);
+    CHECK(admission.predictedLatency(100, 0) == 6 && admission.predictedLatency(110, 0) == 6);
+    admission.completed(1, 12);
+    CHECK(admission.latencyP99() == 12 && admission.predictedLatency(100, 0) == 6);
+    CHECK(admission.admit(100, 3) && !admission.engaged());
+
+    // Over target engages once however long it lasts, and releases once the kitchen drains
+    admission.updateStatus(3, 8, 110);
+    CHECK(admission.predictedLatency(110, 2) == 12);
+    CHECK(!admission.admit(110, 2) && admission.engaged() && admission.engagements() == 1);
+    CHECK(!admission.admit(111, 2) && admission.engagements() == 1);
+    CHECK(admission.admit(112, 2) && !admission.engaged() && admission.engagements() == 1);
+    admission.updateStatus(1, 9, 120);
+    CHECK(!admission.admit(120, 2) && admission.engagements() == 2);
+
+    // With no work ahead holding an order gains nothing, so it is admitted even over target
+    admission.updateStatus(0, 0, 130);
+    CHECK(admission.predictedLatency(130, 20) == 22 && admission.admit(130, 20) && !admission.engaged());
+    admission.dispatched(3, 130, 20);
+    CHECK(!admission.admit(130, 1) && admission.engagements() == 3);
+
+    // A completion with no dispatch on record updates the latency but not the service time
+    admission.completed(7, 50);
+    CHECK(admission.latencyP99() == 50 && admission.predictedLatency(130, 0) == 22);
+
+    CHECK(!admission.shed(30) && admission.shed(30.5));
+
+    // The p99 is the nearest rank over the last 100 orders
+    for (int i = 1; i <= 100; i++)
+    {
+        admission.dispatched(2, 200, 0);
+        admission.completed(2, i);
+    }
+    CHECK(admission.latencyP99() == 99);
+    admission.completed(2, 1000);
+    CHECK(admission.latencyP99() == 100);
+}
+
+// A live teleop session over a Unix socket, recorded, then replayed: the replay applies the same
+// quantised commands on the same steps
+static void checkTeleop()
+{
+    {
+        std::ofstream settings{"TeleopSettings.csv", std::ios::out | std::ios::trunc};
+        settings << "Setting,Value\nteleop_address,unix:TeleopCheck\nteleop_record,TeleopSession\n";
+    }
+    using Applied = std::tuple<int, float, float>;
+    std::vector<Applied> live;
+    {
+        Teleop teleop{"Customer1", Settings{"TeleopSettings.csv"}};
+        TeleopCommand command;
+        CHECK(teleop.enabled() && !teleop.poll(1, command));
+
+        int client{socket(AF_UNIX, SOCK_DGRAM, 0)};
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::string("TeleopCheck_Customer1").copy(address.sun_path, sizeof(address.sun_path) - 1);
+        auto send = [&](std::uint32_t sequence, float left, float right) {
+            auto now{std::chrono::system_clock::now().time_since_epoch()};
+            TeleopCommand sent{sequence, std::chrono::duration_cast<std::chrono::nanoseconds>(now).count(), left, right};
+            sendto(client, &sent, sizeof(sent), 0, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+        };
+        for (int step = 1; step < 300; step++)
+        {
+            if (step == 3 || step == 200)
+            {
+                send(step, 1.23456f, -2.5f);
+            }
+            if (step == 40)
+            {
+                // Only the latest of a burst is applied
+                send(step, 6.0f, 6.0f);
+                send(step + 1, 0.5f, 0.25f);
+            }
+            if (teleop.poll(1, command))
+            {
+                live.push_back({step, command.left, command.right});
+                CHECK(teleop.lastLatency() > 0 && teleop.lastLatency() < 1);
+                CHECK(teleop.superseded() == ((step == 40) ? 1u : 0u));
+            }
+        }
+        close(client);
+    }
+    CHECK(live.size() == 3);
+    CHECK(!live.empty() && std::get<1>(live[0]) == Teleop::quantise(1.23456f));
+
+    // Magic, then 1 + 4 bytes a command while commands are under 128 steps apart, 2 + 4 after
+    CHECK(std::ifstream("TeleopSession_Customer1.tlp", std::ios::binary | std::ios::ate).tellg() == 4 + 5 + 5 + 6);
+
+    {
+        std::ofstream settings{"TeleopSettings.csv", std::ios::out | std::ios::trunc};
+        settings << "Setting,Value\nteleop_replay,TeleopSession\n";
+    }
+    std::vector<Applied> replayed;
+    Teleop teleop{"Customer1", Settings{"TeleopSettings.csv"}};
+    TeleopCommand command;
+    CHECK(!teleop.poll(1, command));
+    for (int step = 1; step < 300; step++)
+    {
+        if (teleop.poll(1, command))
+        {
+            replayed.push_back({step, command.left, command.right});
+        }
+    }
+    CHECK(replayed == live);
+}
+
+// A customer's trajectory through waits and moves, recorded and read back whole, by window and
+// without its index
+static double checkPoses()
+{
+    Fixture customer{"Customer3", 355};
+    std::vector<PoseSample> truth;
+    std::vector<PoseEvent> arrivals;
+    std::size_t csvBytes{std::string("Time (s),X (m),Z (m),Heading (deg)\n").size()};
+    {
+        PoseRecorder recorder{"PoseCheck_Customer3.pose", 256};
+        auto sample = [&] {
+            std::array<double, 3> position{customer.devices->position()};
+            PoseSample pose{customer.devices->time(), position[0], position[2], customer.devices->heading()};
+            recorder.record(pose.time, pose.x, pose.z, pose.heading);
+            truth.push_back(pose);
+            char line[96];
+            csvBytes += std::snprintf(line, sizeof(line), "%.3f,%.4f,%.4f,%.3f\n", pose.time, pose.x, pose.z, pose.heading);
+        };
+        const double legs[][3]{{0.5, 0.3, 0}, {-0.4, 0.6, M_PI / 2}, {0, 0, -M_PI / 2}};
+        for (int round = 0; round < 3; round++)
+        {
+            for (const auto &leg : legs)
+            {
+                // Waits at the counter, then moves
+                for (int wait = 0; wait < 300; wait++)
+                {
+                    customer.robot->step(64);
+                    sample();
+                }
+                for (int step = 0; step < 2000 && customer.robot->driveTo(leg[0], leg[1], leg[2], 1) == -1; step++)
+                {
+                    sample();
+                }
+                sample();
+                recorder.event(customer.devices->time(), 7);
+                arrivals.push_back({customer.devices->time(), 7});
+            }
+        }
+        CHECK(recorder.samples() == truth.size());
+    }
+
+    // Everything back within half a quantum
+    PoseReader reader{"PoseCheck_Customer3.pose"};
+    std::vector<PoseSample> samples;
+    std::vector<PoseEvent> events;
+    CHECK(reader.ok() && reader.chunks() == (truth.size() + 255) / 256);
+    CHECK(reader.read(0, 1e9, samples, events) && reader.decoded() == reader.chunks());
+    CHECK(samples.size() == truth.size() && events.size() == arrivals.size());
+    bool exact{samples.size() == truth.size()};
+    for (std::size_t i = 0; exact && i < samples.size(); i++)
+    {
+        double turn{std::abs(samples[i].heading - truth[i].heading)};
+        exact = std::abs(samples[i].time - truth[i].time) < 1e-6 && std::abs(samples[i].x - truth[i].x) <= 0.5e-4 + 1e-9 &&
+                std::abs(samples[i].z - truth[i].z) <= 0.5e-4 + 1e-9 && std::min(turn, 360 - turn) <= 0.5e-3 + 1e-9;
+    }
+    CHECK(exact);
+    for (std::size_t i = 0; i < events.size() && i < arrivals.size(); i++)
+    {
+        CHECK(std::abs(events[i].time - arrivals[i].time) < 1e-6 && events[i].code == arrivals[i].code);
+    }
+
+    // A window decodes only the chunks it overlaps
+    std::size_t decoded{reader.decoded()};
+    CHECK(truth.size() > 1200 && reader.read(truth[1000].time, truth[1100].time, samples, events));
+    CHECK(samples.size() == 101 && std::abs(samples.front().time - truth[1000].time) < 1e-6);
+    CHECK(reader.decoded() - decoded <= 2);
+
+    // Cut short by a crash: the index is lost and then half of the last chunk, the chunks before still read
+    std::uintmax_t size{std::filesystem::file_size("PoseCheck_Customer3.pose")};
+    std::filesystem::copy_file("PoseCheck_Customer3.pose", "PoseCheck_Crashed.pose", std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::resize_file("PoseCheck_Crashed.pose", size - reader.chunks() * 24 - 8);
+    PoseReader unindexed{"PoseCheck_Crashed.pose"};
+    CHECK(unindexed.ok() && unindexed.chunks() == reader.chunks());
+    CHECK(unindexed.read(truth[1000].time, truth[1100].time, samples, events) && samples.size() == 101);
+    std::filesystem::resize_file("PoseCheck_Crashed.pose", size - reader.chunks() * 24 - 20);
+    CHECK(PoseReader{"PoseCheck_Crashed.pose"}.chunks() == reader.chunks() - 1);
+
+    double compression{static_cast<double>(csvBytes) / size};
+    CHECK(compression > 10);
+    return compression;
+}
+
+/**
+ * @brief Runs the shipped world end to end, the director, staff and four customers with pre-orders
+ * on, so every kind of workflow is spawned, and checks that the frame pool served every frame. The
+ * world is laid out in FrameSession so the run leaves the project's files alone, and the dialogue
+ * goes to a string instead of the terminal.
+ *
+ * @return std::size_t, the largest frame [bytes]
+ */
+static std::size_t checkFrames()
+{
+    namespace fs = std::filesystem;
+    fs::path root{fs::current_path() / "FrameSession"};
+    fs::path workingDir{root / "controllers" / "headless"};
+    fs::create_directories(workingDir);
+    for (const char *file : {"Menu.csv", "Order.csv", "Stock.csv", "Starting.csv"})
+    {
+        fs::copy_file(fs::path{"../.."} / file, root / file, fs::copy_options::overwrite_existing);
+    }
+    {
+        std::ifstream shipped{"../../Settings.csv"};
+        std::ofstream settings{root / "Settings.csv", std::ios::trunc};
+        settings << shipped.rdbuf() << "\npreorder,1\n";
+    }
+    fs::path buildDir{fs::current_path()};
+    fs::current_path(workingDir);
+
+    std::ostringstream sink;
+    std::streambuf *terminal{std::cout.rdbuf(sink.rdbuf())};
+    bool finished{false};
+    {
+        FakeRadio radio;
+        std::vector<std::pair<FakeDevices *, std::function<bool()>>> controllers;
+
+        auto staffDevices{std::make_unique<FakeDevices>("Staff", radio, 1.375, 0.875, 0)};
+        FakeDevices *staffFake{staffDevices.get()};
+        StaffRobot staff{std::move(staffDevices)};
+        staff.start();
+        controllers.push_back({staffFake, [&staff] { return staff.update(); }});
+
+        std::vector<std::unique_ptr<CustomerRobot>> customers;
+        for (int id = 1; id <= 4; id++)
+        {
+            auto devices{std::make_unique<FakeDevices>("Customer" + std::to_string(id), radio, -1.375, 0.875 - 0.5 * (id - 1), 0)};
+            FakeDevices *fake{devices.get()};
+            customers.push_back(std::make_unique<CustomerRobot>(std::move(devices)));
+            CustomerRobot *customer{customers.back().get()};
+            customer->start();
+            controllers.push_back({fake, [customer] { return customer->update(); }});
+        }
+
+        auto directorDevices{std::make_unique<FakeDevices>("Director", radio, 0, 0, 0)};
+        FakeDevices *directorFake{directorDevices.get()};
+        DirectorRobot director{std::move(directorDevices)};
+        director.start();
+        controllers.push_back({directorFake, [&director] { return director.update(); }});
+        directorFake->pressKey('a');
+
+        std::vector<bool> running(controllers.size(), true);
+        std::size_t stopped{0};
+        while (stopped < controllers.size() && directorFake->time() < SESSION_SECONDS)
+        {
+            for (std::size_t i = 0; i < controllers.size(); i++)
+            {
+                if (running[i])
+                {
+                    controllers[i].first->step(64);
+                }
+            }
+            for (std::size_t i = 0; i < controllers.size(); i++)
+            {
+                if (running[i] && !controllers[i].second())
+                {
+                    running[i] = false;
+                    stopped++;
+                }
+            }
+        }
+        finished = stopped == controllers.size();
+    }
+    Logger::instance().flush();
+    std::cout.rdbuf(terminal);
+    fs::current_path(buildDir);
+
+    CHECK(finished);
+    CHECK(FramePool::heapFallbacks() == 0);
+    CHECK(FramePool::largestFrame() > 0 && FramePool::largestFrame() <= FramePool::BLOCK_SIZE);
+    return FramePool::largestFrame();
+}
+
+template <typename Body>
+static double nsPer(long count, Body body)
+{
+    auto start{std::chrono::steady_clock::now()};
+    body();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+}
+
+struct FleetResult {
+    double startupUs;       // construction and registration, per robot
+    long registrationSteps;
+    double routingNs;       // per order and reply
+};
+
+/**
+ * @brief Starts a fleet of customers that register with a director, then each order from the staff
+ * once per step
+ *
+ * @return FleetResult
+ */
+static FleetResult runFleet(int size)
+{
+    FakeRadio radio;
+    FakeDevices director{"Director", radio, 0, 0, 0};
+    director.listen(Roster::DIRECTOR_CHANNEL);
+    FakeDevices staff{"Staff", radio, 0, 0, 0};
+    Settings settings{"../../Settings.csv"};
+    Metrics staffMetrics{"Staff", settings};
+    Link staffLink{staff, settings, staffMetrics};
+    staffLink.listen(Roster::channelOf(5));
+    Roster roster{5};
+    std::vector<std::unique_ptr<CoreRobot>> fleet;
+    std::string data;
+
+    FleetResult result{0, 0, 0};
+    int registered{0};
+    result.startupUs = nsPer(size, [&] {
+        for (int i = 1; i <= size; i++)
+        {
+            fleet.push_back(std::make_unique<CoreRobot>(std::make_unique<FakeDevices>("Customer" + std::to_string(i), radio, 0, 0, 0)));
+        }
+        while (registered < size && result.registrationSteps < 100)
+        {
+            result.registrationSteps++;
+            registered = 0;
+            for (auto &robot : fleet)
+            {
+                robot->step(64);
+                robot->updateRegistration();
+                robot->receiveMessage();
+                registered += robot->registered() ? 1 : 0;
+            }
+            director.step(64);
+            while (director.receive(data))
+            {
+                roster.enrol(data.substr(1));
+            }
+            for (const std::string &assignments : roster.takeAssignments())
+            {
+                director.send(-1, assignments);
+            }
+        }
+    }) / 1000;
+    CHECK(registered == size && static_cast<int>(roster.size()) == size);
+
+    std::vector<std::string> orders;
+    for (auto &robot : fleet)
+    {
+        orders.push_back("Coffee" + std::to_string(robot->id()));
+    }
+    long replies{0};
+    result.routingNs = nsPer(static_cast<long>(size) * FLEET_ROUTING_STEPS, [&] {
+        for (int step = 0; step < FLEET_ROUTING_STEPS; step++)
+        {
+            for (std::size_t i = 0; i < fleet.size(); i++)
+            {
+                fleet[i]->sendMessage(orders[i], Roster::channelOf(5));
+            }
+            staff.step(64);
+            staffLink.update();
+            while (staffLink.receive(data))
+            {
+                staffLink.send(Roster::channelOf(std::atoi(data.c_str() + 6)), "+");
+            }
+            for (auto &robot : fleet)
+            {
+                robot->step(64);
+                replies += robot->receiveMessage().empty() ? 0 : 1;
+            }
+        }
+    });
+    CHECK(replies == static_cast<long>(size) * FLEET_ROUTING_STEPS);
+    return result;
+}
+
+int main()
+{
+    checkIdentity();
+    checkMotors();
+    checkSensors();
+    checkMove();
+    checkMessages();
+    checkLink();
+    checkRegistration();
+    checkMenu();
+    checkMenuReplica();
+    checkRoute();
+    checkCounters();
+    checkSnapshot();
+    checkLedger();
+    checkAdmission();
+    checkTeleop();
+    double poseCompression{checkPoses()};
+    std::size_t largestFrame{checkFrames()};
+    std::printf("robot core checks:      %s\n", failures == 0 ? "passed" : "FAILED");
+
+    // Control steps of a robot moving between two points, including the fake physics
+    Fixture driver{"Customer1"};
+    long driven{0};
+    double stepNs{nsPer(CONTROL_STEPS, [&] {
+        bool out{true};
+        while (driven < CONTROL_STEPS)
+        {
+            long steps{driver.robot->driveTo(out ? 0.3 : 0, out ? 0.2 : 0, 0, CONTROL_STEPS - driven)};
+            driven += (steps > 0) ? steps : CONTROL_STEPS - driven;
+            out = !out;
+        }
+    })};
+
+    // Message round trips between a customer and the staff, each acknowledged
+    FakeRadio radio;
+    CoreRobot customer{std::make_unique<FakeDevices>("Customer1", radio, 0, 0, 0)};
+    FakeDevices staff{"Staff", radio, 0, 0, 0};
+    Settings settings{"../../Settings.csv"};
+    Metrics staffMetrics{"Staff", settings};
+    Link staffLink{staff, settings, staffMetrics};
+    staffLink.listen(5);
+    long replies{0};
+    double messageNs{nsPer(MESSAGES, [&] {
+        std::string order;
+        for (long i = 0; i < MESSAGES; i++)
+        {
+            customer.sendMessage("Coffee1", 5);
+            staff.step(64);
+            staffLink.update();
+            while (staffLink.receive(order))
+            {
+                staffLink.send(1, "+");
+            }
+            customer.step(64);
+            replies += customer.receiveMessage().empty() ? 0 : 1;
+        }
+    })};
+    CHECK(replies == MESSAGES);
+
+    // Snapshot of a robot with a few messages waiting
+    for (int i = 0; i < 4; i++)
+    {
+        driver.robot->postMessage({'*', 5, ""});
+    }
+    std::size_t snapshotBytes{0};
+    double snapshotNs{nsPer(SNAPSHOTS, [&] {
+        for (int i = 0; i < SNAPSHOTS; i++)
+        {
+            SnapshotWriter writer;
+            driver.robot->saveState(writer);
+            SnapshotReader reader{writer.bytes()};
+            driver.robot->restoreState(reader)();
+            snapshotBytes = writer.bytes().size();
+        }
+    })};
+
+    // Prep time and price of an order, looked up by item name as before and by interned ID
+    Menu menu{"../../Menu.csv"};
+    std::vector<std::string> names;
+    for (ItemId id = 0; id < menu.size(); id++)
+    {
+        names.push_back(menu.name(id));
+    }
+    double lookedUp{0};
+    double byNameNs{nsPer(MENU_LOOKUPS, [&] {
+        for (long i = 0; i < MENU_LOOKUPS; i++)
+        {
+            ItemId id{menu.find(names[i % names.size()])};
+            lookedUp += menu.prepSeconds(id) + menu.price(id);
+        }
+    })};
+    double byIdNs{nsPer(MENU_LOOKUPS, [&] {
+        for (long i = 0; i < MENU_LOOKUPS; i++)
+        {
+            ItemId id{static_cast<ItemId>(i % menu.size())};
+            lookedUp += menu.prepSeconds(id) + menu.price(id);
+        }
+    })};
+    CHECK(lookedUp > 0);
+
+    // Startup and routing of fleets of customers, which should cost the same per robot at any size
+    std::vector<std::pair<int, FleetResult>> fleets;
+    for (int size : FLEET_SIZES)
+    {
+        fleets.push_back({size, runFleet(size)});
+    }
+
+    std::printf("control step:           %.1f ns/step\n", stepNs);
+    std::printf("message round trip:     %.1f ns/message\n", messageNs);
+    std::printf("snapshot save+restore:  %.1f ns (%zu bytes)\n", snapshotNs, snapshotBytes);
+    std::printf("menu lookup:            %.1f ns by name, %.1f ns by item ID\n", byNameNs, byIdNs);
+    std::printf("pose recording:         %.1fx smaller than CSV\n", poseCompression);
+    std::printf("workflow frames:        largest %zu of %zu bytes, %zu from the heap\n", largestFrame,
+                FramePool::BLOCK_SIZE, FramePool::heapFallbacks());
+    for (const auto &fleet : fleets)
+    {
+        std::printf("fleet of %3d robots:    startup %.1f us/robot (registered in %ld steps), routing %.1f ns/message\n",
+                    fleet.first, fleet.second.startupUs, fleet.second.registrationSteps, fleet.second.routingNs);
+    }
+    return failures == 0 ? 0 : 1;
+}
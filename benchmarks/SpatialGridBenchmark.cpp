@@ -0,0 +1,199 @@
+// File:          SpatialGridBenchmark.cpp
+// Description:   Checks the spatial grid's radius and k-nearest queries against a scan of every robot,
+//                then times per-step updates and queries for fleets of 100, 1k and 10k robots driving
+//                at e-puck speed. Floors grow with the fleet so robots stay as crowded as 100 robots on
+//                the cafeteria floor. Run from benchmarks/build so ../../worlds is found.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "z5363966SpatialGrid.hpp"
+
+static constexpr int FLEET_SIZES[] {100, 1000, 10000};
+static constexpr long ROBOT_STEPS {1000000};
+static constexpr double CELL_SIZE {0.1};
+static constexpr double NEIGHBOUR_RADIUS {0.15};
+static constexpr std::size_t NEAREST {4};
+static constexpr int CHECK_QUERIES {200};
+
+// Distance an e-puck covers in a 64 ms step at full speed
+static constexpr double STEP_DISTANCE {6.28 * 0.025 * 0.064};
+
+static int failures {0};
+
+struct Robot {
+    double x;
+    double z;
+    double heading;
+};
+
+struct Fleet {
+    double width;
+    double depth;
+    std::vector<Robot> robots;
+    std::mt19937_64 random;
+
+    Fleet(int size, double width, double depth)
+        : width(width),
+          depth(depth),
+          random(static_cast<std::uint64_t>(size))
+    {
+        std::uniform_real_distribution<double> uniform(0, 1);
+        for (int i = 0; i < size; i++)
+        {
+            robots.push_back({(uniform(random) - 0.5) * width, (uniform(random) - 0.5) * depth, uniform(random) * 2 * M_PI});
+        }
+    }
+
+    // Every robot drives forward, turning a little at random and back off the floor's edges
+    void step()
+    {
+        std::uniform_real_distribution<double> turn(-0.3, 0.3);
+        for (Robot &robot : robots)
+        {
+            robot.heading += turn(random);
+            robot.x += STEP_DISTANCE * std::cos(robot.heading);
+            robot.z += STEP_DISTANCE * std::sin(robot.heading);
+            if (std::abs(robot.x) > width / 2 || std::abs(robot.z) > depth / 2)
+            {
+                robot.heading += M_PI;
+                robot.x = std::clamp(robot.x, -width / 2, width / 2);
+                robot.z = std::clamp(robot.z, -depth / 2, depth / 2);
+            }
+        }
+    }
+
+    double distanceSquared(int id, double x, double z) const
+    {
+        double dx{robots[id].x - x};
+        double dz{robots[id].z - z};
+        return dx * dx + dz * dz;
+    }
+
+    // The O(N) scan the grid replaces
+    void withinRadius(double x, double z, double radius, std::vector<int> &result, int exclude) const
+    {
+        result.clear();
+        for (int id = 0; id < static_cast<int>(robots.size()); id++)
+        {
+            if (id != exclude && distanceSquared(id, x, z) <= radius * radius)
+            {
+                result.push_back(id);
+            }
+        }
+    }
+};
+
+static void check(const Fleet &fleet, const SpatialGrid &grid)
+{
+    std::vector<int> expected;
+    std::vector<int> found;
+    for (int query = 0; query < CHECK_QUERIES; query++)
+    {
+        int id{static_cast<int>(query * fleet.robots.size() / CHECK_QUERIES)};
+        const Robot &robot{fleet.robots[id]};
+
+        fleet.withinRadius(robot.x, robot.z, NEIGHBOUR_RADIUS, expected, id);
+        grid.withinRadius(robot.x, robot.z, NEIGHBOUR_RADIUS, found, id);
+        std::sort(expected.begin(), expected.end());
+        std::sort(found.begin(), found.end());
+        failures += (found != expected) ? 1 : 0;
+
+        // Ties may come in any order, so the distances are compared
+        std::vector<double> expectedDistances;
+        for (int other = 0; other < static_cast<int>(fleet.robots.size()); other++)
+        {
+            if (other != id)
+            {
+                expectedDistances.push_back(fleet.distanceSquared(other, robot.x, robot.z));
+            }
+        }
+        std::sort(expectedDistances.begin(), expectedDistances.end());
+        expectedDistances.resize(std::min(NEAREST, expectedDistances.size()));
+        grid.nearest(robot.x, robot.z, NEAREST, found, id);
+        std::vector<double> foundDistances;
+        for (int other : found)
+        {
+            foundDistances.push_back(fleet.distanceSquared(other, robot.x, robot.z));
+        }
+        failures += (foundDistances != expectedDistances) ? 1 : 0;
+    }
+}
+
+int main()
+{
+    // The world's arena, with every robot placed and removed again
+    SpatialGrid arena{SpatialGrid::forArena("../../worlds/MTRN2500.wbt", CELL_SIZE)};
+    Fleet cafe{100, 3, 2};
+    for (int id = 0; id < static_cast<int>(cafe.robots.size()); id++)
+    {
+        arena.update(id, cafe.robots[id].x, cafe.robots[id].z);
+    }
+    check(cafe, arena);
+    failures += (arena.size() == cafe.robots.size()) ? 0 : 1;
+    for (int id = 0; id < static_cast<int>(cafe.robots.size()); id += 2)
+    {
+        arena.remove(id);
+    }
+    failures += (arena.size() == cafe.robots.size() / 2 && !arena.contains(0) && arena.contains(1)) ? 0 : 1;
+
+    std::printf("%6s %14s %14s %14s %14s %10s\n", "robots", "update/robot", "radius query", "4-nearest", "scan query", "neighbours");
+    for (int size : FLEET_SIZES)
+    {
+        // Floors grow with the fleet, keeping 100 robots per 3 m by 2 m
+        double scale{std::sqrt(size / 100.0)};
+        Fleet fleet{size, 3 * scale, 2 * scale};
+        SpatialGrid grid{-fleet.width / 2, -fleet.depth / 2, fleet.width, fleet.depth, CELL_SIZE};
+        long steps{ROBOT_STEPS / size};
+
+        std::vector<int> neighbours;
+        double updateNs{0};
+        double radiusNs{0};
+        double nearestNs{0};
+        long found{0};
+        for (long step = 0; step < steps; step++)
+        {
+            fleet.step();
+            auto start{std::chrono::steady_clock::now()};
+            for (int id = 0; id < size; id++)
+            {
+                grid.update(id, fleet.robots[id].x, fleet.robots[id].z);
+            }
+            auto updated{std::chrono::steady_clock::now()};
+            for (int id = 0; id < size; id++)
+            {
+                grid.withinRadius(fleet.robots[id].x, fleet.robots[id].z, NEIGHBOUR_RADIUS, neighbours, id);
+                found += static_cast<long>(neighbours.size());
+            }
+            auto queried{std::chrono::steady_clock::now()};
+            for (int id = 0; id < size; id++)
+            {
+                grid.nearest(fleet.robots[id].x, fleet.robots[id].z, NEAREST, neighbours, id);
+            }
+            auto nearest{std::chrono::steady_clock::now()};
+            updateNs += std::chrono::duration<double, std::nano>(updated - start).count();
+            radiusNs += std::chrono::duration<double, std::nano>(queried - updated).count();
+            nearestNs += std::chrono::duration<double, std::nano>(nearest - queried).count();
+        }
+        check(fleet, grid);
+
+        // One step of scanning, which is O(N^2) for the fleet
+        auto start{std::chrono::steady_clock::now()};
+        for (int id = 0; id < size; id++)
+        {
+            fleet.withinRadius(fleet.robots[id].x, fleet.robots[id].z, NEIGHBOUR_RADIUS, neighbours, id);
+        }
+        double scanNs{std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / size};
+
+        double queries{static_cast<double>(steps) * size};
+        std::printf("%6d %11.1f ns %11.1f ns %11.1f ns %11.1f ns %10.2f\n", size, updateNs / queries, radiusNs / queries,
+                    nearestNs / queries, scanNs, found / queries);
+    }
+
+    std::printf("spatial grid checks:    %s\n", failures == 0 ? "passed" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+// File:          StateMachineBenchmark.cpp
+// Description:   Compares the dispatch cost of the table driven StateMachine against the
+//                hand-written switch over int constants that the robots used before.
+
+#include <chrono>
+#include <cstdio>
+
+#include "z5363966StateMachine.hpp"
+
+#define NO_INLINE __attribute__((noinline))
+
+static constexpr long STEPS {50000000};
+static constexpr int REPEATS {5};
+
+// Same shape as the staff auto machine: eight states visited in a ring
+class SwitchRobot {
+    public:
+        void step()
+        {
+            switch (autoState)
+            {
+            case AUTO_IDLE:
+                idle();
+                break;
+            case AUTO_MOVE_ORDER_COUNTER:
+                moveOrderCounter();
+                break;
+            case AUTO_STAFF_CHECK_ORDER:
+                checkOrder();
+                break;
+            case AUTO_STAFF_PLACE_ORDER:
+                placeOrder();
+                break;
+            case AUTO_MOVE_STARTING_POSITION:
+                moveStartingPosition();
+                break;
+            case AUTO_STAFF_ORDER_PREP:
+                orderPrep();
+                break;
+            case AUTO_MOVE_PICKUP_COUNTER:
+                movePickupCounter();
+                break;
+            case AUTO_STAFF_ORDER_READY:
+                orderReady();
+                break;
+            }
+        }
+
+        long work {0};
+
+    private:
+        NO_INLINE void idle() { advance(AUTO_MOVE_ORDER_COUNTER); }
+        NO_INLINE void moveOrderCounter() { advance(AUTO_STAFF_CHECK_ORDER); }
+        NO_INLINE void checkOrder() { advance(AUTO_STAFF_PLACE_ORDER); }
+        NO_INLINE void placeOrder() { advance(AUTO_MOVE_STARTING_POSITION); }
+        NO_INLINE void moveStartingPosition() { advance(AUTO_STAFF_ORDER_PREP); }
+        NO_INLINE void orderPrep() { advance(AUTO_MOVE_PICKUP_COUNTER); }
+        NO_INLINE void movePickupCounter() { advance(AUTO_STAFF_ORDER_READY); }
+        NO_INLINE void orderReady() { advance(AUTO_IDLE); }
+
+        void advance(int next)
+        {
+            if ((++work & 3) == 0)
+            {
+                autoState = next;
+            }
+        }
+
+        int autoState {AUTO_IDLE};
+
+        static constexpr int AUTO_IDLE {10};
+        static constexpr int AUTO_MOVE_ORDER_COUNTER {20};
+        static constexpr int AUTO_STAFF_CHECK_ORDER {11};
+        static constexpr int AUTO_STAFF_PLACE_ORDER {12};
+        static constexpr int AUTO_MOVE_STARTING_POSITION {40};
+        static constexpr int AUTO_STAFF_ORDER_PREP {13};
+        static constexpr int AUTO_MOVE_PICKUP_COUNTER {30};
+        static constexpr int AUTO_STAFF_ORDER_READY {14};
+};
+
+enum class BenchState : unsigned char { S0, S1, S2, S3, S4, S5, S6, S7, COUNT };
+
+class MachineRobot {
+    public:
+        MachineRobot() : mMachine(*this, BenchState::S0) {}
+
+        void step()
+        {
+            mMachine.step();
+        }
+
+        long work {0};
+
+    private:
+        template <BenchState From, BenchState To>
+        void advance()
+        {
+            if ((++work & 3) == 0)
+            {
+                mMachine.transition<From, To>();
+            }
+        }
+
+        NO_INLINE void s0() { advance<BenchState::S0, BenchState::S1>(); }
+        NO_INLINE void s1() { advance<BenchState::S1, BenchState::S2>(); }
+        NO_INLINE void s2() { advance<BenchState::S2, BenchState::S3>(); }
+        NO_INLINE void s3() { advance<BenchState::S3, BenchState::S4>(); }
+        NO_INLINE void s4() { advance<BenchState::S4, BenchState::S5>(); }
+        NO_INLINE void s5() { advance<BenchState::S5, BenchState::S6>(); }
+        NO_INLINE void s6() { advance<BenchState::S6, BenchState::S7>(); }
+        NO_INLINE void s7() { advance<BenchState::S7, BenchState::S0>(); }
+
+        using Machine = StateMachine<MachineRobot, BenchState,
+            TransitionTable<BenchState,
+                StateEdge<BenchState, BenchState::S0, BenchState::S1>,
+                StateEdge<BenchState, BenchState::S1, BenchState::S2>,
+                StateEdge<BenchState, BenchState::S2, BenchState::S3>,
+                StateEdge<BenchState, BenchState::S3, BenchState::S4>,
+                StateEdge<BenchState, BenchState::S4, BenchState::S5>,
+                StateEdge<BenchState, BenchState::S5, BenchState::S6>,
+                StateEdge<BenchState, BenchState::S6, BenchState::S7>,
+                StateEdge<BenchState, BenchState::S7, BenchState::S0>>,
+            BehaviourTable<MachineRobot, BenchState,
+                StateBehaviour<MachineRobot, BenchState, BenchState::S0, &MachineRobot::s0>,
+                StateBehaviour<MachineRobot, BenchState, BenchState::S1, &MachineRobot::s1>,
+                StateBehaviour<MachineRobot, BenchState, BenchState::S2, &MachineRobot::s2>,
+                StateBehaviour<MachineRobot, BenchState, BenchState::S3, &MachineRobot::s3>,
+                StateBehaviour<MachineRobot, BenchState, BenchState::S4, &MachineRobot::s4>,
+                StateBehaviour<MachineRobot, BenchState, BenchState::S5, &MachineRobot::s5>,
+                StateBehaviour<MachineRobot, BenchState, BenchState::S6, &MachineRobot::s6>,
+                StateBehaviour<MachineRobot, BenchState, BenchState::S7, &MachineRobot::s7>>>;
+
+        Machine mMachine;
+};
+
+template <typename Robot>
+double bestNsPerStep()
+{
+    double best{1e9};
+    for (int repeat = 0; repeat < REPEATS; repeat++)
+    {
+        Robot robot;
+        auto start{std::chrono::steady_clock::now()};
+        for (long i = 0; i < STEPS; i++)
+        {
+            robot.step();
+        }
+        auto elapsed{std::chrono::steady_clock::now() - start};
+        if (robot.work != STEPS)
+        {
+            std::printf("Benchmark: work mismatch\n");
+        }
+        double ns{std::chrono::duration<double, std::nano>(elapsed).count() / STEPS};
+        best = (ns < best) ? ns : best;
+    }
+    return best;
+}
+
+int main()
+{
+    double switchNs{bestNsPerStep<SwitchRobot>()};
+    double machineNs{bestNsPerStep<MachineRobot>()};
+    std::printf("switch dispatch:        %.3f ns/step\n", switchNs);
+    std::printf("StateMachine dispatch:  %.3f ns/step\n", machineNs);
+    std::printf("ratio (machine/switch): %.3f\n", machineNs / switchNs);
+    return 0;
+}
@@ -7,7 +7,7 @@
 // You may need to add webots include files such as
 // <webots/DistanceSensor.hpp>, <webots/Motor.hpp>, etc.
 // and/or to add some other includes
-// #include <webots/Robot.hpp>
+#include <webots/Robot.hpp>
 #include <z5363966BaseRobot.hpp>
 
 // All the webots classes are defined in the "webots" namespace
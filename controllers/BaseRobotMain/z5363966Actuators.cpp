@@ -0,0 +1,86 @@
+#include "z5363966Actuators.hpp"
+
+#include <cmath>
+
+Actuators::Actuators(RobotDevices &devices, const Settings &settings)
+    : mDevices(devices),
+      mDeadBand(settings.getDouble("motor_dead_band", 0)),
+      mRefreshInterval(settings.getDouble("motor_refresh_interval", 0.5)),
+      mMotors{},
+      mSent{},
+      mAvoided{},
+      mReportedSent{},
+      mReportedAvoided{}
+{
+}
+
+void Actuators::velocityControl()
+{
+    for (std::size_t wheel = 0; wheel < mMotors.size(); wheel++)
+    {
+        if (mMotors[wheel].velocityControl)
+        {
+            mAvoided[SET_POSITION]++;
+            continue;
+        }
+        mDevices.velocityControl(static_cast<Wheel>(wheel));
+        mMotors[wheel].velocityControl = true;
+        mSent[SET_POSITION]++;
+    }
+}
+
+void Actuators::setVelocity(double left, double right)
+{
+    command(Wheel::LEFT, left);
+    command(Wheel::RIGHT, right);
+}
+
+void Actuators::report(Metrics &metrics)
+{
+    static const char *const LABELS[CALLS] {"call=\"set_position\"", "call=\"set_velocity\""};
+    for (std::size_t call = 0; call < CALLS; call++)
+    {
+        if (mSent[call] != mReportedSent[call])
+        {
+            metrics.increment("cafe_motor_calls_total", LABELS[call], static_cast<double>(mSent[call] - mReportedSent[call]));
+            mReportedSent[call] = mSent[call];
+        }
+        if (mAvoided[call] != mReportedAvoided[call])
+        {
+            metrics.increment("cafe_motor_calls_avoided_total", LABELS[call],
+                              static_cast<double>(mAvoided[call] - mReportedAvoided[call]));
+            mReportedAvoided[call] = mAvoided[call];
+        }
+    }
+}
+
+std::uint64_t Actuators::sent() const
+{
+    return mSent[SET_POSITION] + mSent[SET_VELOCITY];
+}
+
+std::uint64_t Actuators::avoided() const
+{
+    return mAvoided[SET_POSITION] + mAvoided[SET_VELOCITY];
+}
+
+void Actuators::command(Wheel wheel, double velocity)
+{
+    Motor &motor{mMotors[static_cast<std::size_t>(wheel)]};
+    double now{mDevices.time()};
+    if (motor.commanded)
+    {
+        // Small corrections wait for the refresh, but stopping and starting never do
+        bool unchanged{velocity == motor.velocity};
+        bool small{std::abs(velocity - motor.velocity) <= mDeadBand && velocity != 0 && motor.velocity != 0 &&
+                   now - motor.sentTime < mRefreshInterval};
+        if (unchanged || small)
+        {
+            mAvoided[SET_VELOCITY]++;
+            return;
+        }
+    }
+    mDevices.setMotorVelocity(wheel, velocity);
+    motor = {motor.velocityControl, true, velocity, now};
+    mSent[SET_VELOCITY]++;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "z5363966Devices.hpp"
+#include "z5363966Settings.hpp"
+#include "z5363966Metrics.hpp"
+
+// Wheel motor commands of a robot, passed on to the devices only when they change. In Webots every
+// motor call is a request from the controller to the simulator, and a moving robot sets the same
+// mode and often the same velocities every step.
+//
+// The mode and the last velocity sent are cached per motor. Putting a motor into velocity control
+// is sent once, and a velocity is sent only if it differs from the last one sent. A change of at
+// most motor_dead_band rad/s is held back until motor_refresh_interval seconds after the last send,
+// so small corrections go out at that rate instead of every step. Stopping and starting are always
+// sent at once.
+
+class Actuators {
+    public:
+        /**
+         * @brief Constructs the actuators of a robot, with nothing sent to the motors yet
+         *
+         * @param devices
+         * @param settings dead band and refresh interval
+         */
+        Actuators(RobotDevices&, const Settings&);
+
+        /**
+         * @brief Puts both wheel motors into velocity control, unless they already are
+         *
+         */
+        void velocityControl();
+
+        /**
+         * @brief Commands the wheel velocities [rad/s], sending each only if it changed enough
+         *
+         * @param left, right
+         */
+        void setVelocity(double, double);
+
+        /**
+         * @brief Adds the motor calls sent and avoided since the last report to the metrics
+         *
+         */
+        void report(Metrics&);
+
+        std::uint64_t sent() const;
+        std::uint64_t avoided() const;
+
+    private:
+        struct Motor {
+            bool velocityControl;
+            bool commanded;         // false until a velocity is first sent
+            double velocity;        // last sent [rad/s]
+            double sentTime;        // [s]
+        };
+
+        void command(Wheel, double);
+
+        RobotDevices &mDevices;
+        double mDeadBand;
+        double mRefreshInterval;
+        std::array<Motor, static_cast<std::size_t>(Wheel::COUNT)> mMotors;
+
+        // Device calls sent and avoided by kind, and the totals last reported
+        enum Call : std::size_t { SET_POSITION, SET_VELOCITY, CALLS };
+        std::array<std::uint64_t, CALLS> mSent;
+        std::array<std::uint64_t, CALLS> mAvoided;
+        std::array<std::uint64_t, CALLS> mReportedSent;
+        std::array<std::uint64_t, CALLS> mReportedAvoided;
+};
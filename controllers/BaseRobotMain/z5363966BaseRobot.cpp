@@ -1,35 +1,71 @@
 #include "z5363966BaseRobot.hpp"
 
-BaseRobot::BaseRobot()
-    : Robot(),
-      emitter(getEmitter("emitter")),
-      receiver(getReceiver("receiver")),
-      mGPS(getGPS("gps")),
-      mCompass(getCompass("compass")),
-      mLeftMotor(*getMotor("left wheel motor")),
-      mRightMotor(*getMotor("right wheel motor")),
-      robotName(getName()),
-      state(IDLE),
-      maxMotorSpeed(mLeftMotor.getMaxVelocity()),
+#include <cstdlib>
+#include <limits>
+
+bool readNumber(const char *text, char separator, long &value)
+{
+    char *end{nullptr};
+    value = std::strtol(text, &end, 10);
+    return end != text && std::isdigit(static_cast<unsigned char>(*text)) && (*end == '\0' || *end == separator) &&
+           value <= std::numeric_limits<int>::max();
+}
+
+bool readAmount(const char *text, double &value)
+{
+    char *end{nullptr};
+    value = std::strtod(text, &end);
+    return end != text && *end == '\0' && std::isfinite(value) && value >= 0;
+}
+
+BaseRobot::BaseRobot(std::unique_ptr<RobotDevices> devices)
+    : mDevices(std::move(devices)),
+      robotName(mDevices->name()),
+      mSettings("../../Settings.csv"),
+      mMenu("../../Menu.csv"),
+      mMetrics(robotName, mSettings),
+      mSnapshots(robotName, mSettings),
+      mTeleop(robotName, mSettings),
+      mLink(*mDevices, mSettings, mMetrics),
+      mActuators(*mDevices, mSettings),
+      mPoses(robotName, mSettings),
+      mRecordedMove(MoveState::COUNT),
+      mRecordedControl(ControlState::COUNT),
+      maxMotorSpeed(mDevices->maxMotorVelocity()),
       defaultMotorSpeed(0.5 * maxMotorSpeed),
       defaultMotorSpeedStep(0.1 * maxMotorSpeed),
       leftMotorDir(1),
       rightMotorDir(1),
       leftAbsMotorSpeed(0),
       rightAbsMotorSpeed(0),
-      autoState(AUTO_IDLE),
-      moveState(INTERMEDIATE_MOVE_IDLE),
+      mBalance(0),
       currentData(""),
-      currentOrder(""),
-      currentOrderPrice(0),
-      purchaseConfirmation(false)
+      mRegistered(false),
+      mNextRegistration(0),
+      targetX(0),
+      targetZ(0),
+      targetAngle(0),
+      targetHeading(0),
+      mControl(*this, ControlState::IDLE),
+      mMove(*this, MoveState::IDLE)
 
 {
-    robotID = (std::isdigit(robotName.back())) ? robotName.back() - '0' : 5;
-    mKeyboard.enable(TIME_STEP);
-    receiver->enable(TIME_STEP);
-    mGPS->enable(TIME_STEP);
-    mCompass->enable(TIME_STEP);
+    // Provisional until the director answers the registration
+    mStaffId = mSettings.getInt("staff_id", 5);
+    mStaffChannel = Roster::channelOf(mStaffId);
+    robotID = Roster::requestedId(robotName, mStaffId);
+    mChannel = Roster::channelOf(robotID);
+    mMetrics.describe("cafe_motor_calls_total", "counter", "Wheel motor calls sent to the simulator by kind");
+    mMetrics.describe("cafe_motor_calls_avoided_total", "counter", "Wheel motor calls not sent as nothing had changed enough");
+    mMetrics.describe("cafe_coroutine_heap_frames", "gauge", "Workflow frames the frame pool could not serve, so came from the heap");
+    if (mTeleop.enabled())
+    {
+        mMetrics.describe("cafe_teleop_commands_total", "counter", "Teleop commands applied in remote mode");
+        mMetrics.describe("cafe_teleop_superseded_total", "counter", "Teleop commands replaced by a later one before the next step");
+        mMetrics.describe("cafe_teleop_latency_seconds", "histogram", "Time from a client sending a teleop command to it being applied");
+        mMetrics.describe("cafe_teleop_last_latency_seconds", "gauge", "Latency of the last teleop command applied");
+    }
+    mDevices->enable(TIME_STEP);
     assignBalance();
     setERChannels();
     step(TIME_STEP);
@@ -38,87 +74,131 @@ BaseRobot::BaseRobot()
     startXPos = currentX;
     startZPos = currentZ;
     // std::cout << "Robot " + std::to_string(robotID) + " has been created." << std::endl;
-    std::cout << "Robot " + std::to_string(robotID) + "'s start position is " + std::to_string(startXPos) + std::to_string(startZPos) << std::endl;
+    LOG_INFO("Robot ", robotID, "'s start position is ", LogFixed{startXPos, 6}, ", ", LogFixed{startZPos, 6});
     // std::cout << "Robot " + std::to_string(robotID) + "'s start heading is " + std::to_string(startHeading[0]) + " " + std::to_string(startHeading[1]) + " " + std::to_string(startHeading[2]) << std::endl;
 }
 
+int BaseRobot::step(int timeStep)
+{
+    return mDevices->step(timeStep);
+}
+
+double BaseRobot::getTime() const
+{
+    return mDevices->time();
+}
+
 void BaseRobot::move(double x, double y, double angle)
 {
-    double targetHeading = calculateHeadingToCoordinate(x, y);
-    switch (moveState)
+    targetX = x;
+    targetZ = y;
+    targetAngle = angle;
+    targetHeading = calculateHeadingToCoordinate(x, y);
+    mMove.step();
+}
+
+bool BaseRobot::moveFinished()
+{
+    if (!mMove.is(MoveState::FINISH))
     {
-    case INTERMEDIATE_MOVE_IDLE:
-        moveState = INTERMEDIATE_MOVE_FACE;
-        break;
-    case INTERMEDIATE_MOVE_FACE:
-        // if (checkPosition(x, y))
-        // {
-        //     moveState = INTERMEDIATE_MOVE_HEAD;
-        //     std::cout << "MOVED!" << std::endl;
-        //     return;
-        // }
-        // if (checkBearing(targetHeading))
-        // {
-        //     std::cout << "Moving forward!" << std::endl;
-        //     movePosition(x, y, targetHeading);
-        // }
-        // else
-        // {
-        //     std::cout << "Turning!" << std::endl;
-        //     moveHeading(targetHeading);
-        // }
-        if (!checkBearing(targetHeading))
-        {
-            moveHeading(targetHeading);
-        }
-        else
-        {
-            moveState = INTERMEDIATE_MOVE;
-        }
-        break;
-    case INTERMEDIATE_MOVE:
-        if (!checkPosition(x, y))
-        {
-            movePosition(x, y, targetHeading);
-        }
-        else
-        {
-            moveState = INTERMEDIATE_MOVE_HEAD;
-        }
-        break;
-    case INTERMEDIATE_MOVE_HEAD:
-        if (checkBearing(startHeading + angle * (180 / M_PI)))
-        {
-            moveState = INTERMEDIATE_MOVE_FINISH;
-            std::cout << "DONE!" << std::endl;
-            setMotorPosition();
-            halt();
-            setMotorSpeed();
-        }
-        else
-        {
-            moveHeading(startHeading + angle * (180 / M_PI));
-        }
-        break;
-    case INTERMEDIATE_MOVE_FINISH:
-        break;
+        return false;
+    }
+    mMove.transition<MoveState::FINISH, MoveState::IDLE>();
+    return true;
+}
+
+void BaseRobot::abandonMove()
+{
+    if (mMove.is(MoveState::DRIVE) || mMove.is(MoveState::HEAD))
+    {
+        mMove.transitionTo(MoveState::FACE);
+    }
+    else
+    {
+        moveFinished();
     }
 }
 
+void BaseRobot::moveIdle()
+{
+    mMove.transition<MoveState::IDLE, MoveState::FACE>();
+}
+
+void BaseRobot::moveFace()
+{
+    if (!checkBearing(targetHeading))
+    {
+        moveHeading(targetHeading);
+    }
+    else
+    {
+        mMove.transition<MoveState::FACE, MoveState::DRIVE>();
+    }
+}
+
+void BaseRobot::moveDrive()
+{
+    if (!checkPosition(targetX, targetZ))
+    {
+        movePosition(targetX, targetZ, targetHeading);
+    }
+    else
+    {
+        mMove.transition<MoveState::DRIVE, MoveState::HEAD>();
+    }
+}
+
+void BaseRobot::moveHead()
+{
+    if (checkBearing(startHeading + targetAngle * (180 / M_PI)))
+    {
+        mMove.transition<MoveState::HEAD, MoveState::FINISH>();
+    }
+    else
+    {
+        moveHeading(startHeading + targetAngle * (180 / M_PI));
+    }
+}
+
+void BaseRobot::moveFinish() {}
+
+void BaseRobot::onMoveFinish()
+{
+    LOG_DEBUG("DONE!");
+    setMotorPosition();
+    halt();
+    setMotorSpeed();
+}
+
 void BaseRobot::movePosition(double x, double z, double targetBearing)
 {
+    // Steers back onto the bearing to the target while driving, and slows over the last few steps
+    // so the robot stops inside the tolerance rather than driving through it
+    double error = bearingError(calculateHeadingToCoordinate(x, z));
+    double distance = std::hypot(x - currentX, z - currentZ);
+    double speed = std::min(maxMotorSpeed, distance / 2 / (WHEEL_RADIUS * TIME_STEP / 1000.0));
+    if (std::abs(error) > STEER_LIMIT)
+    {
+        // Overshot or knocked off course, so turns on the spot first
+        speed = 0;
+    }
+    double turn = std::clamp(linearAdjust(std::abs(error)), 0.0, maxMotorSpeed);
+    turn = (error > 0) ? turn : -turn;
     setMotorPosition();
-    moveForward(maxMotorSpeed);
+    leftMotorDir = (speed + turn >= 0) ? 1 : -1;
+    rightMotorDir = (speed - turn >= 0) ? 1 : -1;
+    leftAbsMotorSpeed = std::min(maxMotorSpeed, std::abs(speed + turn));
+    rightAbsMotorSpeed = std::min(maxMotorSpeed, std::abs(speed - turn));
     setMotorSpeed();
 }
 
 void BaseRobot::moveHeading(double bearing)
 {
-    double delta = abs(currentHeading - bearing);
-    // double speed = maxMotorSpeed * (delta * SPEED_MULTIPLIER + MINIMUM_MOTOR_SPEED);
-    double speed = (delta < 4) ? linearAdjust(delta / 180) : maxMotorSpeed;
+    // Turns the shorter way round, clockwise if the bearing is ahead of the current heading
+    double delta = bearingError(bearing);
+    double speed = std::min(maxMotorSpeed, linearAdjust(std::abs(delta)));
     setMotorPosition();
-    if (bearing >= 90 && bearing <= 270)
+    if (delta > 0)
         turnRight(speed);
     else
         turnLeft(speed);
@@ -127,39 +207,43 @@ void BaseRobot::moveHeading(double bearing)
 
 double BaseRobot::linearAdjust(double input)
 {
-    // return maxMotorSpeed * (input * SPEED_MULTIPLIER + MINIMUM_MOTOR_SPEED);
-    // return maxMotorSpeed * (input * SPEED_MULTIPLIER);
-    return 0.01 * maxMotorSpeed;
-    // return maxMotorSpeed * MINIMUM_MOTOR_SPEED;
+    // Wheel speed that turns the robot through half of input degrees in one time step, so the
+    // heading closes in on its target instead of stepping over the tolerance
+    return (input / 2) * (M_PI / 180) * AXLE_LENGTH / (2 * WHEEL_RADIUS * TIME_STEP / 1000.0);
 }
 
 double BaseRobot::calculateHeadingToCoordinate(double targetX, double targetZ)
 {
     double deltaX = targetX - currentX;
     double deltaZ = targetZ - currentZ;
-    double rad = abs(atan2(deltaZ, deltaX));
+    double rad = std::atan2(deltaZ, deltaX);
     rad = (rad * 180) / M_PI;
     double bearing = (rad >= 0.0) ? rad : rad + 360.0;
-    bearing += 180;
+    bearing = std::fmod(bearing + 180, 360.0);
     // std::cout << "Required heading is: " + std::to_string(bearing) << std::endl;
     // std::cout << "Current heading is: " + std::to_string(currentHeading) << std::endl;
     return bearing;
 }
 
+double BaseRobot::bearingError(double bearing) const
+{
+    return std::remainder(bearing - currentHeading, 360.0);
+}
+
 bool BaseRobot::checkPosition(double x, double z)
 {
     // std::cout << "Current position is " + std::to_string(currentX) + std::to_string(currentZ) << std::endl;
-    return abs(currentX - x) < POSITION_TOLERANCE && abs(currentZ - z) < POSITION_TOLERANCE;
+    return std::abs(currentX - x) < POSITION_TOLERANCE && std::abs(currentZ - z) < POSITION_TOLERANCE;
 }
 
 bool BaseRobot::checkBearing(double bearing)
 {
-    return abs(currentHeading - bearing) < BEARING_TOLERANCE;
+    return std::abs(bearingError(bearing)) < BEARING_TOLERANCE;
 }
 
 double BaseRobot::updateHeading()
 {
-    const double *north = mCompass->getValues();
+    std::array<double, 3> north{mDevices->north()};
     double rad = atan2(north[2], north[0]);
     double bearing = (rad - 1.5708) / M_PI * 180.0;
     // bearing = (bearing >= 0.0) ? bearing : bearing + 360.0;
@@ -170,30 +254,94 @@ double BaseRobot::updateHeading()
 
 void BaseRobot::updatePosition()
 {
-    const double *gpsValues{mGPS->getValues()};
+    std::array<double, 3> gpsValues{mDevices->position()};
     currentX = gpsValues[0];
     currentZ = gpsValues[2];
     // std::copy(gpsValues, gpsValues + 3, currentPosition.begin());
     // std::cout << "Position: " + std::to_string(currentPosition[0]) + std::to_string(currentPosition[1]) + std::to_string(currentPosition[2]) << std::endl;
 }
 
+void BaseRobot::recordPose()
+{
+    if (!mPoses.enabled())
+    {
+        return;
+    }
+    if (!mMove.is(mRecordedMove))
+    {
+        mRecordedMove = mMove.current();
+        mPoses.event(getTime(), MOVE_EVENT + static_cast<std::uint8_t>(mRecordedMove));
+    }
+    if (!mControl.is(mRecordedControl))
+    {
+        mRecordedControl = mControl.current();
+        mPoses.event(getTime(), CONTROL_EVENT + static_cast<std::uint8_t>(mRecordedControl));
+    }
+    mPoses.record(getTime(), currentX, currentZ, currentHeading);
+}
+
 void BaseRobot::sendMessage(const std::string &str, int id)
 {
-    emitter->setChannel(id);
-    emitter->send(str.data(), str.size() + 1);
+    mLink.send(id, str);
+}
+
+void BaseRobot::sendDatagram(const std::string &str, int id)
+{
+    mLink.sendDatagram(id, str);
 }
 
 std::string BaseRobot::receiveMessage()
 {
-    if (receiver->getQueueLength() != 0)
+    mLink.update();
+    std::string data;
+    while (mLink.receive(data))
     {
-        std::string data{(const char *)receiver->getData()};
-        receiver->nextPacket();
-        return data;
+        if (data[0] != '@')
+        {
+            return data;
+        }
+        handleAssignments(data);
     }
     return "";
 }
 
+void BaseRobot::updateRegistration()
+{
+    if (!mRegistered && getTime() >= mNextRegistration)
+    {
+        sendDatagram("@" + robotName, Roster::DIRECTOR_CHANNEL);
+        mNextRegistration = getTime() + REGISTRATION_RETRY;
+    }
+}
+
+bool BaseRobot::registered() const
+{
+    return mRegistered;
+}
+
+void BaseRobot::handleAssignments(const std::string &assignments)
+{
+    int id{0};
+    int channel{0};
+    if (mRegistered || !Roster::findAssignment(assignments, robotName, id, channel))
+    {
+        return;
+    }
+    mRegistered = true;
+    if (id != robotID)
+    {
+        LOG_WARN(robotName, ": ID ", robotID, " is taken, registered as ", id);
+        robotID = id;
+        assignBalance();
+    }
+    if (channel != mChannel)
+    {
+        mChannel = channel;
+        setERChannels();
+    }
+    LOG_DEBUG(robotName, ": registered as ", robotID, " on channel ", mChannel);
+}
+
 void BaseRobot::halt()
 {
     leftAbsMotorSpeed = rightAbsMotorSpeed = 0;
@@ -253,32 +401,50 @@ void BaseRobot::decreaseMotorSpeed()
 
 void BaseRobot::setMotorPosition()
 {
-    mLeftMotor.setPosition(INFINITY);
-    mRightMotor.setPosition(INFINITY);
+    mActuators.velocityControl();
 }
 
 void BaseRobot::setMotorSpeed()
 {
-    mLeftMotor.setVelocity(leftMotorDir * leftAbsMotorSpeed);
-    mRightMotor.setVelocity(rightMotorDir * rightAbsMotorSpeed);
+    mActuators.setVelocity(leftMotorDir * leftAbsMotorSpeed, rightMotorDir * rightAbsMotorSpeed);
+}
+
+void BaseRobot::applyTeleop(const TeleopCommand &command)
+{
+    leftMotorDir = (command.left < 0) ? -1 : 1;
+    rightMotorDir = (command.right < 0) ? -1 : 1;
+    leftAbsMotorSpeed = std::min(maxMotorSpeed, static_cast<double>(std::abs(command.left)));
+    rightAbsMotorSpeed = std::min(maxMotorSpeed, static_cast<double>(std::abs(command.right)));
+    setMotorPosition();
+    setMotorSpeed();
+
+    mMetrics.increment("cafe_teleop_commands_total", "");
+    mMetrics.increment("cafe_teleop_superseded_total", "", static_cast<double>(mTeleop.superseded()));
+    if (mTeleop.lastLatency() > 0)
+    {
+        mMetrics.observe("cafe_teleop_latency_seconds", "", mTeleop.lastLatency());
+        mMetrics.set("cafe_teleop_last_latency_seconds", "", mTeleop.lastLatency());
+    }
 }
 
 void BaseRobot::setERChannels()
 {
-    receiver->setChannel(robotID);
-    emitter->setChannel(5);
+    mLink.listen(mChannel);
 }
 
 void BaseRobot::assignBalance()
 {
     std::ifstream startingFile("../../Starting.csv", std::ifstream::in);
     std::string lineInput;
+    // Skips the header
+    std::getline(startingFile, lineInput);
     while (std::getline(startingFile, lineInput))
     {
-        if (lineInput[0] - '0' == robotID)
+        std::size_t comma{lineInput.find(',')};
+        if (comma != std::string::npos && std::atoi(lineInput.c_str()) == robotID)
         {
             // Assigns balance to the appropriate robot
-            mBalance = std::stod(lineInput.substr(2, lineInput.size() - 2));
+            mBalance = std::stod(lineInput.substr(comma + 1));
             // std::cout << "Customer " + std::to_string(robotID) + "'s balance is " + std::to_string(mBalance) << std::endl;
             break;
         }
@@ -287,7 +453,202 @@ void BaseRobot::assignBalance()
 
 void BaseRobot::printBalance()
 {
-    std::cout << robotName + ": My current balance is " << std::setprecision(2) << std::fixed << mBalance << std::endl;
+    LOG_INFO(robotName, ": My current balance is ", LogFixed{mBalance, 2});
+}
+
+void BaseRobot::setControlMode(int code)
+{
+    ControlState mode;
+    switch (code)
+    {
+    case REMOTE_MODE_CODE:
+        mode = ControlState::REMOTE;
+        break;
+    case AUTO_MODE_CODE:
+        mode = ControlState::AUTO;
+        break;
+    default:
+        LOG_WARN(robotName, ": unknown control mode ", code);
+        return;
+    }
+    if (!mControl.transitionTo(mode))
+    {
+        LOG_WARN(robotName, ": cannot change control mode to ", code);
+    }
+}
+
+BaseRobot::ArriveAt::ArriveAt(BaseRobot &robot, double x, double z, double angle)
+    : mRobot(robot),
+      mX(x),
+      mZ(z),
+      mAngle(angle) {}
+
+bool BaseRobot::ArriveAt::poll()
+{
+    if (mRobot.moveFinished())
+    {
+        return true;
+    }
+    mRobot.move(mX, mZ, mAngle);
+    return false;
+}
+
+BaseRobot::Receive::Receive(std::deque<Message> &mailbox, const std::string &types, int sender)
+    : mMailbox(mailbox),
+      mTypes(types),
+      mSender(sender),
+      mMessage{'\0', 0, ""} {}
+
+bool BaseRobot::Receive::poll()
+{
+    for (auto message = mMailbox.begin(); message != mMailbox.end(); ++message)
+    {
+        if (mTypes.find(message->type) != std::string::npos && (mSender < 0 || message->sender == mSender))
+        {
+            mMessage = std::move(*message);
+            mMailbox.erase(message);
+            return true;
+        }
+    }
+    return false;
+}
+
+Message BaseRobot::Receive::await_resume() const
+{
+    return mMessage;
+}
+
+BaseRobot::ArriveAt BaseRobot::arriveAt(double x, double z, double angle)
+{
+    return ArriveAt{*this, x, z, angle};
+}
+
+BaseRobot::Receive BaseRobot::receive(const std::string &types, int sender)
+{
+    return Receive{mMailbox, types, sender};
+}
+
+void BaseRobot::postMessage(const Message &message)
+{
+    mMailbox.push_back(message);
+}
+
+void BaseRobot::saveState(SnapshotWriter &state)
+{
+    state.put(mControl.current());
+    state.put(mMove.current());
+    state.put(targetX);
+    state.put(targetZ);
+    state.put(targetAngle);
+    state.put(targetHeading);
+    state.put(mBalance);
+    state.put(static_cast<std::uint32_t>(mMailbox.size()));
+    for (const Message &message : mMailbox)
+    {
+        state.put(message.type);
+        state.put(message.sender);
+        state.putString(message.body);
+    }
+    mLink.save(state);
+}
+
+SnapshotCommit BaseRobot::restoreState(SnapshotReader &state)
+{
+    ControlState control{state.get<ControlState>()};
+    // The robot may not be where it was, so an unfinished move starts again by facing its target
+    MoveState move{state.get<MoveState>()};
+    double x{state.get<double>()};
+    double z{state.get<double>()};
+    double angle{state.get<double>()};
+    double heading{state.get<double>()};
+    double balance{state.get<double>()};
+    std::deque<Message> mailbox;
+    std::uint32_t messages{state.get<std::uint32_t>()};
+    for (std::uint32_t i = 0; i < messages && state.ok(); i++)
+    {
+        char type{state.get<char>()};
+        int sender{state.get<int>()};
+        mailbox.push_back({type, sender, state.getString()});
+    }
+    SnapshotCommit link{mLink.restore(state)};
+
+    return [=, this, mailbox = std::move(mailbox), link = std::move(link)]() {
+        mControl.restore(control);
+        mMove.restore((move == MoveState::FINISH) ? MoveState::FINISH : MoveState::IDLE);
+        targetX = x;
+        targetZ = z;
+        targetAngle = angle;
+        targetHeading = heading;
+        mBalance = balance;
+        mMailbox = mailbox;
+        link();
+    };
+}
+
+void BaseRobot::updateSnapshot()
+{
+    if (mSnapshots.due(getTime()))
+    {
+        SnapshotWriter state;
+        saveState(state);
+        mSnapshots.save(state, getTime());
+    }
+}
+
+bool BaseRobot::restoreSnapshot()
+{
+    std::string bytes;
+    double snapshotTime{0};
+    if (!mSnapshots.load(bytes, snapshotTime))
+    {
+        return false;
+    }
+    auto start{std::chrono::steady_clock::now()};
+    SnapshotReader state{std::move(bytes)};
+    SnapshotCommit commit{restoreState(state)};
+    if (!state.ok())
+    {
+        LOG_ERROR(robotName, ": snapshot from ", LogFixed{snapshotTime, 3}, " s is incomplete");
+        return false;
+    }
+    commit();
+    [[maybe_unused]] double restoreMs{std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()};
+    LOG_INFO(robotName, ": restored snapshot from ", LogFixed{snapshotTime, 3}, " s in ", LogFixed{restoreMs, 3}, " ms");
+    return true;
+}
+
+void BaseRobot::controlIdle() {}
+
+void BaseRobot::controlRemote()
+{
+    remoteControl();
+
+    // A teleop command overrides the keyboard for this step
+    TeleopCommand command;
+    if (mTeleop.poll(robotID, command))
+    {
+        applyTeleop(command);
+    }
+}
+
+void BaseRobot::controlAuto()
+{
+    autoMode();
+}
+
+void BaseRobot::controlEnd() {}
+
+void BaseRobot::onControlEnd()
+{
+    mActuators.report(mMetrics);
+    std::size_t heapFrames{FramePool::heapFallbacks()};
+    mMetrics.set("cafe_coroutine_heap_frames", "", static_cast<double>(heapFrames));
+    if (heapFrames > 0)
+    {
+        LOG_WARN(robotName, ": ", heapFrames, " workflow frames did not fit the frame pool and came from the heap");
+    }
+    mMetrics.writeSummary(getTime());
+    mPoses.close();
 }
 
 BaseRobot::~BaseRobot() {}
@@ -1,29 +1,91 @@
+#pragma once
+
 #include <iostream>
 #include <array>
 #include <fstream>
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <deque>
+#include <chrono>
+#include <memory>
 
 // Math
 #define _USE_MATH_DEFINES
 #include <cmath>
 
-#include <webots/Robot.hpp>
-#include <webots/Keyboard.hpp>
-#include <webots/Emitter.hpp>
-#include <webots/Receiver.hpp>
-#include <webots/Motor.hpp>
-#include <webots/GPS.hpp>
-#include <webots/Compass.hpp>
+#include "z5363966Devices.hpp"
+#include "z5363966Settings.hpp"
+#include "z5363966Metrics.hpp"
+#include "z5363966Logger.hpp"
+#include "z5363966StateMachine.hpp"
+#include "z5363966Coroutine.hpp"
+#include "z5363966Snapshot.hpp"
+#include "z5363966Roster.hpp"
+#include "z5363966Menu.hpp"
+#include "z5363966MenuReplica.hpp"
+#include "z5363966Counters.hpp"
+#include "z5363966Teleop.hpp"
+#include "z5363966Link.hpp"
+#include "z5363966Actuators.hpp"
+#include "z5363966PoseRecorder.hpp"
+
+// Control modes of every customer and staff robot
+enum class ControlState : unsigned char { IDLE, REMOTE, AUTO, END, COUNT };
+
+// Steps of BaseRobot::move
+enum class MoveState : unsigned char { IDLE, FACE, DRIVE, HEAD, FINISH, COUNT };
+
+/**
+ * @brief A dialogue message waiting to be picked up by a workflow
+ * 
+ */
+struct Message {
+    char type;          // first character, e.g. '$' for a price
+    int sender;         // robot ID of the sender, 0 if the message does not carry one
+    std::string body;   // remainder of the message after the type and sender ID
+};
 
-class BaseRobot : public webots::Robot {
+/**
+ * @brief Reads the number a message field starts with, which must run to the end of the message or
+ * to the separator. Robot IDs and counters are never negative.
+ * 
+ * @param text, separator, value set to the number read
+ * @return true if the field is a whole number that fits an int
+ */
+bool readNumber(const char*, char, long&);
+
+/**
+ * @brief Reads an amount of money that makes up the rest of a message field. Prices and balances
+ * are never negative.
+ * 
+ * @param text, value set to the amount read [$]
+ * @return true if the field is a finite, non-negative number
+ */
+bool readAmount(const char*, double&);
+
+class BaseRobot {
     public:
         /**
-         * @brief Constructs a new base robot
+         * @brief Constructs a new base robot on the given devices, e.g. makeWebotsDevices()
+         * 
+         */
+        explicit BaseRobot(std::unique_ptr<RobotDevices>);
+
+        /**
+         * @brief Advances the simulation by the given time step
+         * 
+         * @param timeStep [ms]
+         * @return int, -1 once the simulation is stopping the controller
+         */
+        int step(int);
+
+        /**
+         * @brief Simulation time [s]
          * 
+         * @return double
          */
-        BaseRobot();
+        double getTime() const;
         
         /**
          * @brief Move to the input location. The inputs are x, y, heading in [meter, meter, radian]. The
@@ -33,6 +95,19 @@ class BaseRobot : public webots::Robot {
          */
         void move(double, double, double);
 
+        /**
+         * @brief Checks whether the current move has finished, and if so readies the robot for the next move
+         * 
+         * @return boolean
+         */
+        bool moveFinished();
+
+        /**
+         * @brief Gives up the current move part way, so the next move starts by facing its own target
+         * 
+         */
+        void abandonMove();
+
         /**
          * @brief Moves robot to target coordinates
          * 
@@ -49,14 +124,23 @@ class BaseRobot : public webots::Robot {
         void moveHeading(double);
 
         /**
-         * @brief Moves robot to target heading
+         * @brief Motor speed for the last few degrees of a turn, which turns half of them per step
          * 
-         * @param delta
+         * @param delta [deg]
          * 
          * @return double - linearised motor speed
         */
         double linearAdjust(double);
 
+        /**
+         * @brief Turn from the current heading to a bearing, clockwise positive
+         * 
+         * @param bearing [deg]
+         * 
+         * @return double - (-180, 180]
+        */
+        double bearingError(double) const;
+
         /**
          * @brief Calculates the heading required to face the target position
          * 
@@ -97,19 +181,48 @@ class BaseRobot : public webots::Robot {
         void updatePosition();
         
         /**
-         * @brief Send a message string to the robot. The inputs are message string and the robotID
+         * @brief Records the pose just updated, and the move and control states the step starts in
+         * when they change, if pose_record is set
+         * 
+         */
+        void recordPose();
+
+        /**
+         * @brief Send a message string to the robot. The inputs are message string and the robotID.
+         * Sent again until the robot acknowledges it, see z5363966Link.hpp.
          * 
          */
         void sendMessage(const std::string&, int);
 
+        /**
+         * @brief Sends a message string once, for messages repeated until answered anyway such as
+         * registration and status
+         * 
+         */
+        void sendDatagram(const std::string&, int);
+
         /**
          * @brief Receive the message from other robots and return the message. If no message received, return
-         * an empty string.
+         * an empty string. Registration answers from the director are handled here and not returned.
          * 
          * @return std::string 
          */
         std::string receiveMessage();
 
+        /**
+         * @brief Asks the director for the robot's ID and channel, again every REGISTRATION_RETRY
+         * seconds until it answers
+         * 
+         */
+        void updateRegistration();
+
+        /**
+         * @brief Whether the director has answered the robot's registration
+         * 
+         * @return boolean
+         */
+        bool registered() const;
+
         /**
          * @brief Stops all movement
          * 
@@ -153,17 +266,23 @@ class BaseRobot : public webots::Robot {
         void decreaseMotorSpeed();
 
         /**
-         * @brief Set the Motor Position 
+         * @brief Set the Motor Position, once until the motors are set otherwise
          * 
          */
         void setMotorPosition();
 
         /**
-         * @brief Set the Motor Speed 
+         * @brief Set the Motor Speed, if it changed
          * 
          */
         void setMotorSpeed();
 
+        /**
+         * @brief Drives the wheels at a teleop command's velocities, clamped to the motors' maximum
+         * 
+         */
+        void applyTeleop(const TeleopCommand&);
+
         /**
          * @brief Set the Emitter/Receiver Channels for all customer and staff robots
          * 
@@ -176,6 +295,13 @@ class BaseRobot : public webots::Robot {
          */
         virtual void processData() = 0;
 
+        /**
+         * @brief Changes control mode from a mode code sent by the director
+         * 
+         * @param code REMOTE_MODE_CODE or AUTO_MODE_CODE
+         */
+        void setControlMode(int);
+
         /**
          * @brief Prints the state of the robot in meters and radians.
          * The position and orientation of the robot should round to 3 decimal places.
@@ -188,12 +314,6 @@ class BaseRobot : public webots::Robot {
         virtual void remoteControl() = 0;
         virtual void autoMode() = 0;
 
-        /**
-         * @brief Resets all auto ordering fields
-         * 
-         */
-        virtual void resetOrdering() = 0;
-
         /**
          * @brief Assigns the robot its starting balance
          * 
@@ -206,24 +326,125 @@ class BaseRobot : public webots::Robot {
          */
         void printBalance();
 
+        /**
+         * @brief Waits until the robot has moved to x, z and turned angle radians relative to its
+         * starting heading. Only one workflow may be moving the robot at a time.
+         * 
+         */
+        class ArriveAt : public Waiter {
+            public:
+                ArriveAt(BaseRobot&, double, double, double);
+                bool poll() override;
+
+            private:
+                BaseRobot &mRobot;
+                double mX;
+                double mZ;
+                double mAngle;
+        };
+
+        /**
+         * @brief Waits for a message whose type is one of the given characters, optionally from one
+         * sender only, and removes it from the mailbox. co_await returns the message.
+         * 
+         */
+        class Receive : public Waiter {
+            public:
+                Receive(std::deque<Message>&, const std::string&, int);
+                bool poll() override;
+                Message await_resume() const;
+
+            private:
+                std::deque<Message> &mMailbox;
+                std::string mTypes;
+                int mSender;
+                Message mMessage;
+        };
+
+        /**
+         * @brief Returns a waiter for arriving at a pose, e.g. co_await arriveAt(x, z, angle)
+         * 
+         * @return ArriveAt
+         */
+        ArriveAt arriveAt(double, double, double);
+
+        /**
+         * @brief Returns a waiter for the next message of the given types, from any sender if sender is -1
+         * 
+         * @return Receive
+         */
+        Receive receive(const std::string&, int sender = -1);
+
+        /**
+         * @brief Hands a message to the workflows waiting on the mailbox
+         * 
+         */
+        void postMessage(const Message&);
+
+        /**
+         * @brief Writes the robot's behavioural state: control and move states, move target, balance
+         * and messages not yet picked up by a workflow. Overrides append their own state.
+         * 
+         */
+        virtual void saveState(SnapshotWriter&);
+
+        /**
+         * @brief Reads back the state written by saveState, in the same order, to be applied once
+         * the whole snapshot was read
+         * 
+         * @return SnapshotCommit
+         */
+        virtual SnapshotCommit restoreState(SnapshotReader&);
+
+        /**
+         * @brief Writes a snapshot if the snapshot interval has elapsed
+         * 
+         */
+        void updateSnapshot();
+
+        /**
+         * @brief Restores the latest consistent snapshot, if snapshot_restore is set
+         * 
+         * @return boolean, true if the robot was restored
+         */
+        bool restoreSnapshot();
+
         /**
          * @brief Destroy the Base Robot object
          * 
          */
-        ~BaseRobot();
+        virtual ~BaseRobot();
+
+        // Recorded pose event codes, the move or control state entered added to its base
+        static constexpr std::uint8_t MOVE_EVENT {0x00};
+        static constexpr std::uint8_t CONTROL_EVENT {0x10};
     protected:
-        webots::Emitter *emitter;
-        webots::Receiver *receiver;
-        webots::Keyboard mKeyboard;
-        webots::GPS *mGPS;
-        webots::Compass *mCompass;
-        webots::Motor& mLeftMotor;
-        webots::Motor& mRightMotor;
+        // Simulator access, declared first so it exists before every other member
+        std::unique_ptr<RobotDevices> mDevices;
 
         int robotID;
         std::string robotName;
 
-        int state;
+        // ID and channel of the staff, from the staff_id setting
+        int mStaffId;
+        int mStaffChannel;
+
+        // Simulation settings, menu and service metrics
+        Settings mSettings;
+        Menu mMenu;
+        Metrics mMetrics;
+        SnapshotStore mSnapshots;
+        Teleop mTeleop;
+        Link mLink;
+
+        // Wheel motor commands, sent only when they change
+        Actuators mActuators;
+
+        // Pose recording, and the states last recorded as events
+        PoseRecorder mPoses;
+        MoveState mRecordedMove;
+        ControlState mRecordedControl;
+
         int currentKey;
 
         // Motor control fields
@@ -241,12 +462,19 @@ class BaseRobot : public webots::Robot {
 
         // Auto fields
         double mBalance;
-        int autoState;
-        int moveState;
         std::string currentData;
-        std::string currentOrder;
-        double currentOrderPrice;
-        bool purchaseConfirmation;
+        std::deque<Message> mMailbox;
+
+        // Registration with the director
+        int mChannel;
+        bool mRegistered;
+        double mNextRegistration;
+
+        /**
+         * @brief Adopts the ID and channel given to the robot by an assignment broadcast
+         * 
+         */
+        void handleAssignments(const std::string&);
 
         // Movement fields
         // std::array<double, 3> currentPosition;
@@ -257,26 +485,73 @@ class BaseRobot : public webots::Robot {
         double currentZ;
         double currentHeading;
 
+        // Target of the current move
+        double targetX;
+        double targetZ;
+        double targetAngle;
+        double targetHeading;
+
+        // Control state behaviours
+        void controlIdle();
+        void controlRemote();
+        void controlAuto();
+        void controlEnd();
+        void onControlEnd();
+
+        // Movement state behaviours
+        void moveIdle();
+        void moveFace();
+        void moveDrive();
+        void moveHead();
+        void moveFinish();
+        void onMoveFinish();
+
+        using ControlMachine = StateMachine<BaseRobot, ControlState,
+            TransitionTable<ControlState,
+                StateEdge<ControlState, ControlState::IDLE, ControlState::REMOTE>,
+                StateEdge<ControlState, ControlState::IDLE, ControlState::AUTO>,
+                StateEdge<ControlState, ControlState::IDLE, ControlState::END>,
+                StateEdge<ControlState, ControlState::REMOTE, ControlState::END>,
+                StateEdge<ControlState, ControlState::AUTO, ControlState::END>>,
+            BehaviourTable<BaseRobot, ControlState,
+                StateBehaviour<BaseRobot, ControlState, ControlState::IDLE, &BaseRobot::controlIdle>,
+                StateBehaviour<BaseRobot, ControlState, ControlState::REMOTE, &BaseRobot::controlRemote>,
+                StateBehaviour<BaseRobot, ControlState, ControlState::AUTO, &BaseRobot::controlAuto>,
+                StateBehaviour<BaseRobot, ControlState, ControlState::END, &BaseRobot::controlEnd, &BaseRobot::onControlEnd>>>;
+
+        using MoveMachine = StateMachine<BaseRobot, MoveState,
+            TransitionTable<MoveState,
+                StateEdge<MoveState, MoveState::IDLE, MoveState::FACE>,
+                StateEdge<MoveState, MoveState::FACE, MoveState::DRIVE>,
+                StateEdge<MoveState, MoveState::DRIVE, MoveState::HEAD>,
+                StateEdge<MoveState, MoveState::DRIVE, MoveState::FACE>,
+                StateEdge<MoveState, MoveState::HEAD, MoveState::FINISH>,
+                StateEdge<MoveState, MoveState::HEAD, MoveState::FACE>,
+                StateEdge<MoveState, MoveState::FINISH, MoveState::IDLE>>,
+            BehaviourTable<BaseRobot, MoveState,
+                StateBehaviour<BaseRobot, MoveState, MoveState::IDLE, &BaseRobot::moveIdle>,
+                StateBehaviour<BaseRobot, MoveState, MoveState::FACE, &BaseRobot::moveFace>,
+                StateBehaviour<BaseRobot, MoveState, MoveState::DRIVE, &BaseRobot::moveDrive>,
+                StateBehaviour<BaseRobot, MoveState, MoveState::HEAD, &BaseRobot::moveHead>,
+                StateBehaviour<BaseRobot, MoveState, MoveState::FINISH, &BaseRobot::moveFinish, &BaseRobot::onMoveFinish>>>;
+
+        ControlMachine mControl;
+        MoveMachine mMove;
+
+        // Runs the auto mode workflows, declared last so unfinished workflows are destroyed first
+        Executor mExecutor;
+
         static constexpr int TIME_STEP {64};
 
-        // Control States
-        static constexpr int IDLE {0};
-        static constexpr int REMOTE {2};
-        static constexpr int AUTO {4};
-        static constexpr int END {6};
-
-        // Auto States
-        static constexpr int AUTO_IDLE {10};
-        static constexpr int AUTO_MOVE_ORDER_COUNTER {20};
-        static constexpr int AUTO_MOVE_PICKUP_COUNTER {30};
-        static constexpr int AUTO_MOVE_STARTING_POSITION {40};
-
-        // Movement states
-        static constexpr int INTERMEDIATE_MOVE_IDLE {50};
-        static constexpr int INTERMEDIATE_MOVE_FACE {60};
-        static constexpr int INTERMEDIATE_MOVE {70};
-        static constexpr int INTERMEDIATE_MOVE_HEAD {80};
-        static constexpr int INTERMEDIATE_MOVE_FINISH {0};
+        // Control mode codes sent by the director
+        static constexpr int REMOTE_MODE_CODE {2};
+        static constexpr int AUTO_MODE_CODE {4};
+
+        // Seconds between registration requests while the director has not answered
+        static constexpr double REGISTRATION_RETRY {1.0};
+
+        // Longest a robot told to quit stays on to settle final balances with the staff [s]
+        static constexpr double CLOSING_TIMEOUT {5.0};
 
         // Robot stats
         static constexpr double AXLE_LENGTH {0.045};
@@ -285,6 +560,9 @@ class BaseRobot : public webots::Robot {
         // Movement Control
         static constexpr double POSITION_TOLERANCE {0.01};
         static constexpr double BEARING_TOLERANCE {0.05};
+
+        // Bearing error [deg] beyond which the robot stops driving and turns on the spot
+        static constexpr double STEER_LIMIT {45};
         static constexpr double SPEED_MULTIPLIER {1.05};
         static constexpr double MINIMUM_MOTOR_SPEED {0.1};
 };
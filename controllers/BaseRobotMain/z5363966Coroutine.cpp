@@ -0,0 +1,180 @@
+#include "z5363966Coroutine.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <new>
+#include <utility>
+
+namespace {
+    struct FrameBlock {
+        alignas(std::max_align_t) unsigned char bytes[FramePool::BLOCK_SIZE];
+        FrameBlock *next;
+    };
+
+    struct FrameStorage {
+        FrameBlock blocks[FramePool::BLOCK_COUNT];
+        FrameBlock *freeList {nullptr};
+        std::size_t heapFallbacks {0};
+        std::size_t largestFrame {0};
+
+        FrameStorage()
+        {
+            for (std::size_t i = 0; i < FramePool::BLOCK_COUNT; i++)
+            {
+                blocks[i].next = freeList;
+                freeList = &blocks[i];
+            }
+        }
+
+        bool owns(const void *frame) const
+        {
+            std::less<const void *> before;
+            return !before(frame, &blocks[0]) && before(frame, &blocks[FramePool::BLOCK_COUNT]);
+        }
+    };
+
+    FrameStorage &frameStorage()
+    {
+        static FrameStorage storage;
+        return storage;
+    }
+}
+
+void *FramePool::allocate(std::size_t size)
+{
+    FrameStorage &storage{frameStorage()};
+    storage.largestFrame = std::max(storage.largestFrame, size);
+    if (size > BLOCK_SIZE || storage.freeList == nullptr)
+    {
+        storage.heapFallbacks++;
+        return ::operator new(size);
+    }
+    FrameBlock *block{storage.freeList};
+    storage.freeList = block->next;
+    return block->bytes;
+}
+
+void FramePool::release(void *frame, std::size_t size)
+{
+    FrameStorage &storage{frameStorage()};
+    if (!storage.owns(frame))
+    {
+        ::operator delete(frame, size);
+        return;
+    }
+    // bytes is the first member, so the frame address is the block address
+    FrameBlock *block{reinterpret_cast<FrameBlock *>(frame)};
+    block->next = storage.freeList;
+    storage.freeList = block;
+}
+
+std::size_t FramePool::heapFallbacks()
+{
+    return frameStorage().heapFallbacks;
+}
+
+std::size_t FramePool::largestFrame()
+{
+    return frameStorage().largestFrame;
+}
+
+Task::Task(std::coroutine_handle<promise_type> handle)
+    : mHandle(handle) {}
+
+Task::Task(Task &&other) noexcept
+    : mHandle(std::exchange(other.mHandle, nullptr)) {}
+
+Task::~Task()
+{
+    if (mHandle)
+    {
+        mHandle.destroy();
+    }
+}
+
+std::coroutine_handle<Task::promise_type> Task::release()
+{
+    return std::exchange(mHandle, nullptr);
+}
+
+Executor::Executor()
+    : mNow(0)
+{
+    // Each workflow waits on one waiter at a time, so this is room for as many workflows as the frame
+    // pool holds. Past that their frames come from the heap, and these grow with them.
+    mWaiting.reserve(FramePool::BLOCK_COUNT);
+    mPolling.reserve(FramePool::BLOCK_COUNT);
+}
+
+void Executor::spawn(Task task)
+{
+    std::coroutine_handle<Task::promise_type> handle{task.release()};
+    handle.promise().executor = this;
+    resume(handle);
+}
+
+void Executor::resume(std::coroutine_handle<> handle)
+{
+    handle.resume();
+    if (handle.done())
+    {
+        handle.destroy();
+    }
+}
+
+void Executor::step(double now)
+{
+    mNow = now;
+
+    // Workflows resumed below register their next waiter in mWaiting while it is being rebuilt
+    mPolling.swap(mWaiting);
+    for (const Waiting &waiting : mPolling)
+    {
+        if (waiting.waiter->poll())
+        {
+            resume(waiting.handle);
+        }
+        else
+        {
+            mWaiting.push_back(waiting);
+        }
+    }
+    mPolling.clear();
+}
+
+void Executor::wait(std::coroutine_handle<> handle, Waiter *waiter)
+{
+    mWaiting.push_back({handle, waiter});
+}
+
+double Executor::now() const
+{
+    return mNow;
+}
+
+std::size_t Executor::active() const
+{
+    return mWaiting.size();
+}
+
+Executor::~Executor()
+{
+    for (const Waiting &waiting : mWaiting)
+    {
+        waiting.handle.destroy();
+    }
+}
+
+Executor::Timer::Timer(const Executor &executor, double seconds)
+    : mExecutor(executor),
+      mDeadline(executor.now() + seconds) {}
+
+bool Executor::Timer::poll()
+{
+    return mExecutor.now() >= mDeadline;
+}
+
+Executor::Timer Executor::sleepFor(double seconds) const
+{
+    return Timer{*this, seconds};
+}
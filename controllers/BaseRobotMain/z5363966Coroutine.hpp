@@ -0,0 +1,286 @@
+#pragma once
+
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <vector>
+
+// Coroutine workflows driven by the robot's time step.
+//
+// A workflow is a Task coroutine spawned on an Executor. Every co_await suspends the workflow on a
+// Waiter, which the executor polls once per time step until it is satisfied, then resumes the
+// workflow. A robot can run any number of workflows side by side.
+
+/**
+ * @brief Fixed pool of coroutine frames, so spawning a workflow does not touch the heap
+ *
+ */
+class FramePool {
+    public:
+        /**
+         * @brief Returns a frame block, or falls back to the heap if the frame is too large or the
+         * pool is exhausted
+         *
+         * @return void*
+         */
+        static void* allocate(std::size_t);
+
+        /**
+         * @brief Returns a frame block to the pool
+         *
+         */
+        static void release(void*, std::size_t);
+
+        /**
+         * @brief Number of frames that could not be served from the pool
+         *
+         * @return std::size_t
+         */
+        static std::size_t heapFallbacks();
+
+        /**
+         * @brief Size of the largest frame asked for so far, which must fit BLOCK_SIZE for the pool
+         * to serve it
+         *
+         * @return std::size_t [bytes]
+         */
+        static std::size_t largestFrame();
+
+        static constexpr std::size_t BLOCK_SIZE {1024};
+        static constexpr std::size_t BLOCK_COUNT {64};
+};
+
+class Executor;
+
+/**
+ * @brief Something a workflow can wait on. poll() is called once per time step while waiting and
+ * returns true once the workflow may continue.
+ *
+ */
+class Waiter {
+    public:
+        virtual bool poll() = 0;
+
+        bool await_ready()
+        {
+            return poll();
+        }
+
+        template <typename Promise>
+        void await_suspend(std::coroutine_handle<Promise> handle);
+
+        void await_resume() {}
+
+    protected:
+        ~Waiter() = default;
+};
+
+/**
+ * @brief Coroutine type of a workflow. Starts suspended and is owned by the executor once spawned.
+ *
+ */
+class Task {
+    public:
+        struct promise_type {
+            Executor *executor {nullptr};
+
+            Task get_return_object()
+            {
+                return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+            std::suspend_always initial_suspend() noexcept
+            {
+                return {};
+            }
+            std::suspend_always final_suspend() noexcept
+            {
+                return {};
+            }
+            void return_void() {}
+            void unhandled_exception()
+            {
+                std::terminate();
+            }
+
+            static void* operator new(std::size_t size)
+            {
+                return FramePool::allocate(size);
+            }
+            static void operator delete(void *frame, std::size_t size)
+            {
+                FramePool::release(frame, size);
+            }
+        };
+
+        Task(Task &&other) noexcept;
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+        ~Task();
+
+        /**
+         * @brief Hands the coroutine over to the caller
+         *
+         * @return std::coroutine_handle<promise_type>
+         */
+        std::coroutine_handle<promise_type> release();
+
+    private:
+        explicit Task(std::coroutine_handle<promise_type>);
+
+        std::coroutine_handle<promise_type> mHandle;
+};
+
+class Executor {
+    public:
+        Executor();
+
+        /**
+         * @brief Starts a workflow and runs it until its first suspension
+         *
+         */
+        void spawn(Task);
+
+        /**
+         * @brief Polls every waiting workflow once and resumes those whose waiter is satisfied
+         *
+         * @param now simulated time [s]
+         */
+        void step(double);
+
+        /**
+         * @brief Registers a suspended workflow, called from Waiter::await_suspend
+         *
+         */
+        void wait(std::coroutine_handle<>, Waiter*);
+
+        /**
+         * @brief Simulated time of the current step [s]
+         *
+         * @return double
+         */
+        double now() const;
+
+        /**
+         * @brief Number of workflows that have not finished
+         *
+         * @return std::size_t
+         */
+        std::size_t active() const;
+
+        /**
+         * @brief Destroys every unfinished workflow
+         *
+         */
+        ~Executor();
+
+        /**
+         * @brief Waits until the given number of seconds of simulated time has passed
+         *
+         */
+        class Timer : public Waiter {
+            public:
+                Timer(const Executor&, double);
+                bool poll() override;
+
+            private:
+                const Executor &mExecutor;
+                double mDeadline;
+        };
+
+        /**
+         * @brief Returns a waiter that is satisfied after the given simulated seconds
+         *
+         * @return Timer
+         */
+        Timer sleepFor(double) const;
+
+    private:
+        struct Waiting {
+            std::coroutine_handle<> handle;
+            Waiter *waiter;
+        };
+
+        void resume(std::coroutine_handle<>);
+
+        std::vector<Waiting> mWaiting;
+        std::vector<Waiting> mPolling;
+        double mNow;
+};
+
+template <typename Promise>
+void Waiter::await_suspend(std::coroutine_handle<Promise> handle)
+{
+    handle.promise().executor->wait(handle, this);
+}
+
+/**
+ * @brief Waits until any of several waiters is satisfied. co_await returns the index of the first
+ * satisfied waiter; the others are left untouched.
+ *
+ */
+template <std::size_t N>
+class AnyOf : public Waiter {
+    public:
+        explicit AnyOf(const std::array<Waiter*, N> &waiters)
+            : mWaiters(waiters),
+              mIndex(N) {}
+
+        bool poll() override
+        {
+            for (std::size_t i = 0; i < N; i++)
+            {
+                if (mWaiters[i]->poll())
+                {
+                    mIndex = i;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::size_t await_resume() const
+        {
+            return mIndex;
+        }
+
+    private:
+        std::array<Waiter*, N> mWaiters;
+        std::size_t mIndex;
+};
+
+/**
+ * @brief Waits on several waiters declared by the caller, e.g. co_await anyOf(paid, cancelled)
+ *
+ * @return AnyOf<N>
+ */
+template <typename... Waiters>
+AnyOf<sizeof...(Waiters)> anyOf(Waiters&... waiters)
+{
+    return AnyOf<sizeof...(Waiters)>{{{&waiters...}}};
+}
+
+/**
+ * @brief Waits until a condition holds, e.g. co_await until([&] { return ready; })
+ *
+ */
+template <typename Condition>
+class Until : public Waiter {
+    public:
+        explicit Until(Condition condition)
+            : mCondition(condition) {}
+
+        bool poll() override
+        {
+            return mCondition();
+        }
+
+    private:
+        Condition mCondition;
+};
+
+template <typename Condition>
+Until<Condition> until(Condition condition)
+{
+    return Until<Condition>{condition};
+}
@@ -0,0 +1,89 @@
+#include "z5363966Counters.hpp"
+
+#include <cstdlib>
+#include <sstream>
+
+Counters::Counters(const Settings &settings)
+    : mServiceSeconds(settings.getDouble("counter_service_seconds", 10))
+{
+    std::stringstream counters{settings.getString("counters", "")};
+    std::string counter;
+    while (std::getline(counters, counter, ';'))
+    {
+        std::size_t colon{counter.find(':')};
+        if (colon != std::string::npos)
+        {
+            mOrderZ.push_back(std::atof(counter.c_str()));
+            mPickupZ.push_back(std::atof(counter.c_str() + colon + 1));
+        }
+    }
+    if (mOrderZ.empty())
+    {
+        mOrderZ.push_back(0.375);
+        mPickupZ.push_back(-0.375);
+    }
+}
+
+std::size_t Counters::size() const
+{
+    return mOrderZ.size();
+}
+
+RoutePoint Counters::orderPad(std::size_t counter) const
+{
+    return {CUSTOMER_X, mOrderZ[counter]};
+}
+
+RoutePoint Counters::pickupPad(std::size_t counter) const
+{
+    return {CUSTOMER_X, mPickupZ[counter]};
+}
+
+RoutePoint Counters::staffPost(std::size_t counter) const
+{
+    return {STAFF_X, mOrderZ[counter]};
+}
+
+double Counters::expectedWait(std::size_t counter, const RoutePoint &from, int queue) const
+{
+    double walk{Route::distance(from, orderPad(counter)) + Route::distance(orderPad(counter), pickupPad(counter)) +
+                Route::distance(pickupPad(counter), from)};
+    return queue * mServiceSeconds + walk / WALK_SPEED;
+}
+
+std::size_t Counters::choose(const RoutePoint &from, const std::vector<int> &queues) const
+{
+    std::size_t best{0};
+    double bestWait{0};
+    for (std::size_t counter = 0; counter < size(); counter++)
+    {
+        double wait{expectedWait(counter, from, (counter < queues.size()) ? queues[counter] : 0)};
+        if (counter == 0 || wait < bestWait)
+        {
+            best = counter;
+            bestWait = wait;
+        }
+    }
+    return best;
+}
+
+std::string Counters::encodeQueues(const std::vector<int> &queues)
+{
+    std::string message{MARK};
+    for (std::size_t counter = 0; counter < queues.size(); counter++)
+    {
+        message += ((counter > 0) ? "," : "") + std::to_string(queues[counter]);
+    }
+    return message;
+}
+
+void Counters::decodeQueues(const std::string &message, std::vector<int> &queues)
+{
+    queues.clear();
+    std::stringstream entries{message.substr(1)};
+    std::string queue;
+    while (std::getline(entries, queue, ','))
+    {
+        queues.push_back(std::atoi(queue.c_str()));
+    }
+}
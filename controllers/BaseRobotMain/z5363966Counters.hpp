@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "z5363966Route.hpp"
+#include "z5363966Settings.hpp"
+
+// Order and pickup pads along the counter that divides the customers' side of the cafeteria from
+// the staff's, Counter1 and Counter2 in the world.
+//
+// `counters` lists them as "<order z>:<pickup z>;...", one counter per entry, e.g. the shipped
+// "0.375:-0.375" is the Order and Pickup pads. A customer orders from the customers' side of its
+// counter's order pad and collects from its pickup pad, and the staff serves the order pad from the
+// other side.
+//
+// A customer goes to the counter with the lowest expected wait: the customers already queued at it,
+// counter_service_seconds each, plus the time to walk from its start to the order pad, on to the
+// pickup pad and back. It claims its counter from the staff with "|<counter>:<robot ID>" before it
+// orders, and the staff broadcasts how many customers have claimed each counter and not yet been
+// served, "|<queue>,<queue>,...", whenever that changes. With a single counter neither is sent.
+
+class Counters {
+    public:
+        /**
+         * @brief Reads the counters from the settings, the shipped pads if none are listed
+         *
+         * @param settings counters and counter_service_seconds
+         */
+        explicit Counters(const Settings&);
+
+        std::size_t size() const;
+
+        /**
+         * @brief Where a customer stands to order at a counter
+         *
+         * @return RoutePoint
+         */
+        RoutePoint orderPad(std::size_t) const;
+
+        /**
+         * @brief Where a customer stands to collect from a counter
+         *
+         * @return RoutePoint
+         */
+        RoutePoint pickupPad(std::size_t) const;
+
+        /**
+         * @brief Where the staff stands to serve a counter's order pad
+         *
+         * @return RoutePoint
+         */
+        RoutePoint staffPost(std::size_t) const;
+
+        /**
+         * @brief Expected time until a customer leaves a counter with its order, not counting the
+         * kitchen, which is shared [s]
+         *
+         * @param counter
+         * @param from the customer's start
+         * @param queue customers queued at the counter
+         * @return double
+         */
+        double expectedWait(std::size_t, const RoutePoint&, int) const;
+
+        /**
+         * @brief Counter with the lowest expected wait, the first of equals
+         *
+         * @param from the customer's start
+         * @param queues customers queued at each counter, missing ones taken as empty
+         * @return std::size_t
+         */
+        std::size_t choose(const RoutePoint&, const std::vector<int>&) const;
+
+        /**
+         * @brief Message broadcasting the queue at every counter
+         *
+         * @return std::string
+         */
+        static std::string encodeQueues(const std::vector<int>&);
+
+        /**
+         * @brief Reads the queues broadcast by the staff
+         *
+         * @param message "|<queue>,<queue>,..."
+         * @param queues set to the queues
+         */
+        static void decodeQueues(const std::string&, std::vector<int>&);
+
+        // Marks a counter claim or the queues
+        static constexpr char MARK {'|'};
+
+        // Sides of the counter the customers and staff stand at [m]
+        static constexpr double CUSTOMER_X {0.375};
+        static constexpr double STAFF_X {0.875};
+
+        // e-puck at full wheel speed, 6.28 rad/s on 0.025 m wheels [m/s]
+        static constexpr double WALK_SPEED {0.157};
+
+    private:
+        std::vector<double> mOrderZ;
+        std::vector<double> mPickupZ;
+        double mServiceSeconds;
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+
+// Wheel motors of a robot
+enum class Wheel : unsigned char { LEFT, RIGHT, COUNT };
+
+/**
+ * @brief Everything a robot controller needs from the simulator: the clock, keyboard, radio, GPS,
+ * compass and wheel motors.
+ *
+ * BaseRobot and the director only talk to the simulator through this interface, so they build without
+ * Webots. WebotsDevices (z5363966WebotsDevices.hpp) is the implementation used by the controllers,
+ * and the benchmarks link the core against fake devices instead.
+ *
+ */
+class RobotDevices {
+    public:
+        /**
+         * @brief Enables the keyboard, receiver and sensors with the given sampling period
+         *
+         * @param timeStep [ms]
+         */
+        virtual void enable(int) = 0;
+
+        /**
+         * @brief Advances the simulation by the given time step
+         *
+         * @param timeStep [ms]
+         * @return int, -1 once the simulation is stopping the controller
+         */
+        virtual int step(int) = 0;
+
+        /**
+         * @brief Simulation time [s]
+         *
+         * @return double
+         */
+        virtual double time() const = 0;
+
+        /**
+         * @brief Name of the robot node, e.g. Customer1
+         *
+         * @return std::string
+         */
+        virtual std::string name() const = 0;
+
+        /**
+         * @brief Next key pressed, EOF if none
+         *
+         * @return int
+         */
+        virtual int key() = 0;
+
+        /**
+         * @brief Sends a message on a channel, -1 to broadcast
+         *
+         */
+        virtual void send(int, const std::string&) = 0;
+
+        /**
+         * @brief Takes the next received message
+         *
+         * @return boolean, false if no message is waiting
+         */
+        virtual bool receive(std::string&) = 0;
+
+        /**
+         * @brief Sets the channel messages are received on
+         *
+         */
+        virtual void listen(int) = 0;
+
+        /**
+         * @brief GPS position x, y, z [m]
+         *
+         * @return std::array<double, 3>
+         */
+        virtual std::array<double, 3> position() const = 0;
+
+        /**
+         * @brief Compass reading, the direction of north in the robot's frame
+         *
+         * @return std::array<double, 3>
+         */
+        virtual std::array<double, 3> north() const = 0;
+
+        /**
+         * @brief Fastest either wheel motor can turn [rad/s]
+         *
+         * @return double
+         */
+        virtual double maxMotorVelocity() const = 0;
+
+        /**
+         * @brief Puts a wheel motor into velocity control. Each call is a request to the simulator,
+         * so BaseRobot only makes it through Actuators.
+         *
+         */
+        virtual void velocityControl(Wheel) = 0;
+
+        /**
+         * @brief Sets the velocity of a wheel motor [rad/s]
+         *
+         * @param wheel, velocity
+         */
+        virtual void setMotorVelocity(Wheel, double) = 0;
+
+        virtual ~RobotDevices() = default;
+
+        // Arrow key codes, the same as webots::Keyboard
+        static constexpr int KEY_LEFT {314};
+        static constexpr int KEY_UP {315};
+        static constexpr int KEY_RIGHT {316};
+        static constexpr int KEY_DOWN {317};
+};
+
+/**
+ * @brief Creates the devices of the Webots robot this controller is attached to. Only the
+ * controllers link z5363966WebotsDevices.cpp, so the robot core does not depend on Webots.
+ *
+ * @return std::unique_ptr<RobotDevices>
+ */
+std::unique_ptr<RobotDevices> makeWebotsDevices();
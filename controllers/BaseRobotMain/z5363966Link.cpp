@@ -0,0 +1,342 @@
+#include "z5363966Link.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+#include "z5363966Logger.hpp"
+
+namespace {
+    // FNV-1a, so each robot draws its own faults from the same seed
+    std::uint64_t hashName(const std::string &name)
+    {
+        std::uint64_t hash{14695981039346656037ull};
+        for (char c : name)
+        {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+Link::Link(RobotDevices &devices, const Settings &settings, Metrics &metrics)
+    : mDevices(devices),
+      mMetrics(metrics),
+      mChannel(-1),
+      mSession(1),
+      mAdoptSequences(false),
+      mTimeout(settings.getDouble("message_timeout", 0.5)),
+      mMaxTimeout(settings.getDouble("message_max_timeout", 4)),
+      mMaxAttempts(std::max(1, settings.getInt("message_max_attempts", 10))),
+      mDropFraction(settings.getDouble("message_drop_percent", 0) / 100),
+      mReorderFraction(settings.getDouble("message_reorder_percent", 0) / 100),
+      mRandom(static_cast<std::uint64_t>(settings.getInt("message_fault_seed", 1)) ^ hashName(devices.name())),
+      mUniform(0, 1)
+{
+    mMetrics.describe("cafe_messages_sent_total", "counter", "Messages sent reliably, not counting resends");
+    mMetrics.describe("cafe_messages_resent_total", "counter", "Frames sent again after their acknowledgement was overdue");
+    mMetrics.describe("cafe_messages_duplicates_total", "counter", "Frames received again and suppressed");
+    mMetrics.describe("cafe_messages_abandoned_total", "counter", "Frames given up on after message_max_attempts sends");
+    mMetrics.describe("cafe_messages_skipped_total", "counter", "Frames never received that their sender gave up on");
+    if (mDropFraction > 0 || mReorderFraction > 0)
+    {
+        mMetrics.describe("cafe_messages_dropped_total", "counter", "Frames dropped by fault injection");
+        mMetrics.describe("cafe_messages_reordered_total", "counter", "Frames held back by fault injection");
+    }
+}
+
+void Link::listen(int channel)
+{
+    mChannel = channel;
+    mDevices.listen(channel);
+}
+
+void Link::send(int channel, const std::string &message)
+{
+    if (channel < 0)
+    {
+        sendDatagram(channel, message);
+        return;
+    }
+    mOutgoing.push_back({channel, ++mNextSequence[channel], message, 0, 0});
+    transmit(mOutgoing.back());
+    mMetrics.increment("cafe_messages_sent_total", "");
+}
+
+void Link::sendDatagram(int channel, const std::string &message)
+{
+    mDevices.send(channel, message);
+}
+
+bool Link::receive(std::string &data)
+{
+    std::string received;
+    while (mReady.empty())
+    {
+        if (!mDevices.receive(received))
+        {
+            return false;
+        }
+        if (received.empty() || received[0] != MARK)
+        {
+            data = std::move(received);
+            return true;
+        }
+        if (!injectFault(received))
+        {
+            accept(received);
+        }
+    }
+    data = std::move(mReady.front());
+    mReady.pop_front();
+    return true;
+}
+
+void Link::update()
+{
+    double now{mDevices.time()};
+    for (auto late = mLate.begin(); late != mLate.end();)
+    {
+        if (late->due <= now)
+        {
+            accept(late->data);
+            late = mLate.erase(late);
+        }
+        else
+        {
+            ++late;
+        }
+    }
+
+    for (auto frame = mOutgoing.begin(); frame != mOutgoing.end();)
+    {
+        if (frame->due > now)
+        {
+            ++frame;
+            continue;
+        }
+        if (frame->attempts >= mMaxAttempts)
+        {
+            LOG_WARN(mDevices.name(), ": gave up on \"", frame->message, "\" to channel ", frame->channel, " after ",
+                     frame->attempts, " sends");
+            mMetrics.increment("cafe_messages_abandoned_total", "");
+            frame = mOutgoing.erase(frame);
+            continue;
+        }
+        if (frame->attempts > 0)
+        {
+            mMetrics.increment("cafe_messages_resent_total", "");
+        }
+        transmit(*frame);
+        ++frame;
+    }
+}
+
+std::size_t Link::unacknowledged() const
+{
+    return mOutgoing.size();
+}
+
+void Link::save(SnapshotWriter &state) const
+{
+    state.put(mSession);
+    state.put(static_cast<std::uint32_t>(mOutgoing.size()));
+    for (const Outgoing &frame : mOutgoing)
+    {
+        state.put(frame.channel);
+        state.putString(frame.message);
+    }
+}
+
+SnapshotCommit Link::restore(SnapshotReader &state)
+{
+    std::uint32_t session{state.get<std::uint32_t>() + 1};
+    std::vector<std::pair<int, std::string>> frames;
+    std::uint32_t count{state.get<std::uint32_t>()};
+    for (std::uint32_t i = 0; i < count && state.ok(); i++)
+    {
+        int channel{state.get<int>()};
+        frames.emplace_back(channel, state.getString());
+    }
+
+    return [this, session, frames = std::move(frames)]() {
+        mSession = session;
+        mNextSequence.clear();
+        mOutgoing.clear();
+        for (const auto &[channel, message] : frames)
+        {
+            mOutgoing.push_back({channel, ++mNextSequence[channel], message, 0, 0});
+        }
+
+        // Senders carried on while the link was down, so their next frame is where it starts
+        mIncoming.clear();
+        mReady.clear();
+        mAdoptSequences = true;
+    };
+}
+
+bool Link::parse(const std::string &data, Frame &frame)
+{
+    // "&<channel>:<session>:<sequence>" is an acknowledgement, followed by ":<message>" a frame
+    if (data.empty() || data[0] != MARK)
+    {
+        return false;
+    }
+    char *end{nullptr};
+    frame.channel = static_cast<int>(std::strtol(data.c_str() + 1, &end, 10));
+    if (*end != ':')
+    {
+        return false;
+    }
+    frame.session = static_cast<std::uint32_t>(std::strtoul(end + 1, &end, 10));
+    if (*end != ':')
+    {
+        return false;
+    }
+    frame.sequence = static_cast<std::uint32_t>(std::strtoul(end + 1, &end, 10));
+    frame.floor = frame.sequence;
+    if (*end == '/')
+    {
+        frame.floor = static_cast<std::uint32_t>(std::strtoul(end + 1, &end, 10));
+        if (*end != ':' || frame.floor > frame.sequence)
+        {
+            return false;
+        }
+    }
+    frame.acknowledgement = *end == '\0';
+    if (!frame.acknowledgement && *end != ':')
+    {
+        return false;
+    }
+    frame.message = frame.acknowledgement ? "" : std::string{end + 1};
+    return frame.session > 0 && frame.sequence > 0;
+}
+
+void Link::transmit(Outgoing &frame)
+{
+    std::uint32_t floor{frame.sequence};
+    for (const Outgoing &waiting : mOutgoing)
+    {
+        if (waiting.channel == frame.channel)
+        {
+            floor = std::min(floor, waiting.sequence);
+        }
+    }
+    mDevices.send(frame.channel, MARK + std::to_string(mChannel) + ":" + std::to_string(mSession) + ":" +
+                                     std::to_string(frame.sequence) +
+                                     ((floor < frame.sequence) ? "/" + std::to_string(floor) : "") + ":" + frame.message);
+    frame.attempts++;
+    double backoff{mTimeout};
+    for (int i = 1; i < frame.attempts && backoff < mMaxTimeout; i++)
+    {
+        backoff *= 2;
+    }
+    frame.due = mDevices.time() + std::min(backoff, mMaxTimeout);
+}
+
+void Link::accept(const std::string &data)
+{
+    Frame frame;
+    if (!parse(data, frame))
+    {
+        LOG_WARN(mDevices.name(), ": malformed frame \"", data, "\"");
+        return;
+    }
+    if (frame.acknowledgement)
+    {
+        if (frame.session == mSession)
+        {
+            auto acknowledged{std::find_if(mOutgoing.begin(), mOutgoing.end(), [&frame](const Outgoing &sent) {
+                return sent.channel == frame.channel && sent.sequence == frame.sequence;
+            })};
+            if (acknowledged != mOutgoing.end())
+            {
+                mOutgoing.erase(acknowledged);
+            }
+        }
+        return;
+    }
+
+    auto known{mIncoming.find(frame.channel)};
+    if (known == mIncoming.end() || frame.session > known->second.session)
+    {
+        std::uint32_t first{(mAdoptSequences && known == mIncoming.end()) ? frame.sequence : 1};
+        known = mIncoming.insert_or_assign(frame.channel, Incoming{frame.session, first, {}}).first;
+    }
+    Incoming &sender{known->second};
+    if (frame.session < sender.session)
+    {
+        // From before the sender was restored, and superseded by its new session
+        return;
+    }
+    if (frame.floor > sender.expected)
+    {
+        // The sender gave up on the frames still missing below its floor, so they will never come
+        for (auto held = sender.held.begin(); held != sender.held.end() && held->first < frame.floor;
+             held = sender.held.erase(held))
+        {
+            if (held->first > sender.expected)
+            {
+                mMetrics.increment("cafe_messages_skipped_total", "", static_cast<double>(held->first - sender.expected));
+                sender.expected = held->first;
+            }
+            mReady.push_back(std::move(held->second));
+            acknowledge(frame.channel, frame.session, sender.expected++);
+        }
+        if (frame.floor > sender.expected)
+        {
+            mMetrics.increment("cafe_messages_skipped_total", "", static_cast<double>(frame.floor - sender.expected));
+            LOG_WARN(mDevices.name(), ": skipped to frame ", frame.floor, " from channel ", frame.channel,
+                     " as the sender gave up on the ones before");
+            sender.expected = frame.floor;
+        }
+    }
+    if (frame.sequence < sender.expected)
+    {
+        mMetrics.increment("cafe_messages_duplicates_total", "");
+        acknowledge(frame.channel, frame.session, frame.sequence);
+        return;
+    }
+    if (!sender.held.emplace(frame.sequence, std::move(frame.message)).second)
+    {
+        mMetrics.increment("cafe_messages_duplicates_total", "");
+    }
+    handOn(sender, frame.channel, frame.session);
+}
+
+void Link::handOn(Incoming &sender, int channel, std::uint32_t session)
+{
+    for (auto held = sender.held.begin(); held != sender.held.end() && held->first == sender.expected;
+         held = sender.held.erase(held))
+    {
+        mReady.push_back(std::move(held->second));
+        acknowledge(channel, session, sender.expected++);
+    }
+}
+
+void Link::acknowledge(int channel, std::uint32_t session, std::uint32_t sequence)
+{
+    mDevices.send(channel, MARK + std::to_string(mChannel) + ":" + std::to_string(session) + ":" + std::to_string(sequence));
+}
+
+bool Link::injectFault(const std::string &data)
+{
+    if (mDropFraction <= 0 && mReorderFraction <= 0)
+    {
+        return false;
+    }
+    double draw{mUniform(mRandom)};
+    if (draw < mDropFraction)
+    {
+        mMetrics.increment("cafe_messages_dropped_total", "");
+        return true;
+    }
+    if (draw < mDropFraction + mReorderFraction)
+    {
+        mMetrics.increment("cafe_messages_reordered_total", "");
+        mLate.push_back({mDevices.time() + mUniform(mRandom) * REORDER_DELAY, data});
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include "z5363966Devices.hpp"
+#include "z5363966Settings.hpp"
+#include "z5363966Metrics.hpp"
+#include "z5363966Snapshot.hpp"
+
+// Reliable delivery of the dialogue between the director, customers and staff. Each step of the
+// dialogue waits for the answer to the one before, so a single lost message would stall it for good.
+//
+// A message to a channel goes out as a frame, "&<sender channel>:<session>:<sequence>:<message>",
+// numbered per destination, and is sent again until the receiver answers with an acknowledgement,
+// "&<receiver channel>:<session>:<sequence>". The first resend is message_timeout seconds of simulated
+// time after the first send and each one after waits twice as long, up to message_max_timeout, until
+// the frame is given up on after message_max_attempts sends. A receiver hands frames on in the order
+// they were sent, holding back any that overtake one still missing, and only acknowledges a frame
+// once it has handed it on. A frame received again after that is acknowledged again and suppressed.
+//
+// A frame sent while earlier frames to the same channel are still unacknowledged carries the lowest
+// of them, its floor, as "&<sender channel>:<session>:<sequence>/<floor>:<message>". Without one the
+// floor is the frame's own sequence. Everything below the floor has been acknowledged or given up
+// on, so a receiver still waiting for a frame below it skips ahead, handing on whatever it held back
+// from there. Otherwise one frame given up on would hold back every later frame from its sender.
+//
+// Broadcasts, and datagrams such as registration and status that are repeated anyway, go out once as
+// written, and anything received that is not a frame is passed on as it is.
+//
+// A link's session is bumped when it is restored from a snapshot, so receivers start counting its
+// frames again rather than suppress the sequence numbers it hands out a second time. A restored link
+// in turn starts counting each sender's frames from the first it receives.
+//
+// For testing, message_drop_percent and message_reorder_percent drop received frames, or hold them
+// back up to REORDER_DELAY seconds so later ones overtake them, seeded by message_fault_seed. Only
+// frames are affected, as the director's mode changes are broadcast and not protected.
+
+class Link {
+    public:
+        struct Frame {
+            int channel;                // sender's channel for a message, receiver's for an acknowledgement
+            std::uint32_t session;
+            std::uint32_t sequence;
+            std::uint32_t floor;        // lowest sequence the sender has not acknowledged or given up on
+            bool acknowledgement;
+            std::string message;
+        };
+
+        /**
+         * @brief Constructs the link of one controller, listening on no channel until told to
+         *
+         * @param devices radio of the controller
+         * @param settings timeouts and fault injection
+         * @param metrics registry the link counts its sends into
+         */
+        Link(RobotDevices&, const Settings&, Metrics&);
+
+        /**
+         * @brief Sets the channel the link receives on and stamps on its frames
+         *
+         */
+        void listen(int);
+
+        /**
+         * @brief Sends a message reliably to a channel, or once to every robot on -1
+         *
+         * @param channel
+         * @param message
+         */
+        void send(int, const std::string&);
+
+        /**
+         * @brief Sends a message once, as written
+         *
+         * @param channel -1 to broadcast
+         * @param message
+         */
+        void sendDatagram(int, const std::string&);
+
+        /**
+         * @brief Takes the next message received, acknowledging frames and handling acknowledgements
+         *
+         * @return boolean, false if no message is waiting
+         */
+        bool receive(std::string&);
+
+        /**
+         * @brief Resends frames whose acknowledgement is overdue and releases frames held back by
+         * fault injection. Call once a time step, before receiving.
+         *
+         */
+        void update();
+
+        /**
+         * @brief Frames sent and not yet acknowledged
+         *
+         * @return std::size_t
+         */
+        std::size_t unacknowledged() const;
+
+        /**
+         * @brief Writes the session and the unacknowledged frames
+         *
+         */
+        void save(SnapshotWriter&) const;
+
+        /**
+         * @brief Reads back the state written by save in a new session, numbering the unacknowledged
+         * frames again and sending them on the next update
+         *
+         * @return SnapshotCommit
+         */
+        SnapshotCommit restore(SnapshotReader&);
+
+        /**
+         * @brief Reads a frame or acknowledgement
+         *
+         * @param data as received
+         * @param frame set if data is a frame
+         * @return boolean, false if data is not a frame
+         */
+        static bool parse(const std::string&, Frame&);
+
+        // Marks a frame or acknowledgement
+        static constexpr char MARK {'&'};
+
+        // Longest a frame is held back by fault injection [s]
+        static constexpr double REORDER_DELAY {0.25};
+
+    private:
+        struct Outgoing {
+            int channel;
+            std::uint32_t sequence;
+            std::string message;
+            int attempts;
+            double due;         // [s] when it is next sent
+        };
+
+        struct Incoming {
+            std::uint32_t session;
+            std::uint32_t expected;
+            std::map<std::uint32_t, std::string> held;   // overtook a frame still missing, by sequence
+        };
+
+        struct Late {
+            double due;
+            std::string data;
+        };
+
+        void transmit(Outgoing&);
+        void accept(const std::string&);
+        void acknowledge(int, std::uint32_t, std::uint32_t);
+        void handOn(Incoming&, int, std::uint32_t);
+        bool injectFault(const std::string&);
+
+        RobotDevices &mDevices;
+        Metrics &mMetrics;
+        int mChannel;
+        std::uint32_t mSession;
+        bool mAdoptSequences;
+
+        std::unordered_map<int, std::uint32_t> mNextSequence;
+        std::deque<Outgoing> mOutgoing;
+        std::unordered_map<int, Incoming> mIncoming;
+        std::deque<std::string> mReady;
+
+        double mTimeout;
+        double mMaxTimeout;
+        int mMaxAttempts;
+
+        // Fault injection
+        double mDropFraction;
+        double mReorderFraction;
+        std::mt19937_64 mRandom;
+        std::uniform_real_distribution<double> mUniform;
+        std::deque<Late> mLate;
+};
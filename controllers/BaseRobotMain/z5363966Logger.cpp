@@ -0,0 +1,111 @@
+#include "z5363966Logger.hpp"
+
+#include <chrono>
+#include <iostream>
+
+constexpr std::size_t Logger::SLOT_SIZE;
+constexpr std::size_t Logger::SLOT_COUNT;
+
+std::ostream &operator<<(std::ostream &out, const LogFixed &number)
+{
+    std::ios_base::fmtflags flags{out.flags()};
+    std::streamsize precision{out.precision()};
+    out << std::setprecision(number.precision) << std::fixed << number.value;
+    out.flags(flags);
+    out.precision(precision);
+    return out;
+}
+
+Logger &Logger::instance()
+{
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : mHead(0),
+      mTail(0),
+      mRunning(true),
+      mCallCount(0),
+      mStalls(0),
+      mWriter(&Logger::writerLoop, this) {}
+
+Logger::Slot &Logger::acquireSlot()
+{
+    std::size_t head{mHead.load(std::memory_order_relaxed)};
+    if (head - mTail.load(std::memory_order_acquire) >= SLOT_COUNT)
+    {
+        // Never drops dialogue: waits for the writer to free a slot
+        mStalls++;
+        while (head - mTail.load(std::memory_order_acquire) >= SLOT_COUNT)
+        {
+            std::this_thread::yield();
+        }
+    }
+    return mSlots[head % SLOT_COUNT];
+}
+
+std::size_t Logger::drain(std::ostream &out)
+{
+    std::size_t tail{mTail.load(std::memory_order_relaxed)};
+    std::size_t head{mHead.load(std::memory_order_acquire)};
+    std::size_t written{head - tail};
+    for (; tail != head; tail++)
+    {
+        Slot &slot{mSlots[tail % SLOT_COUNT]};
+        switch (slot.level)
+        {
+        case LogLevel::DEBUG:
+            out << "[DEBUG] ";
+            break;
+        case LogLevel::WARN:
+            out << "[WARN] ";
+            break;
+        case LogLevel::ERROR:
+            out << "[ERROR] ";
+            break;
+        case LogLevel::INFO:
+            break;
+        }
+        slot.format(out, &slot.storage);
+        out << '\n';
+        mTail.store(tail + 1, std::memory_order_release);
+    }
+    if (written > 0)
+    {
+        // One flush per batch instead of one per line
+        out.flush();
+    }
+    return written;
+}
+
+void Logger::writerLoop()
+{
+    while (mRunning.load(std::memory_order_acquire))
+    {
+        if (drain(std::cout) == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    drain(std::cout);
+}
+
+void Logger::flush()
+{
+    while (mTail.load(std::memory_order_acquire) != mHead.load(std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+}
+
+Logger::~Logger()
+{
+    mRunning.store(false, std::memory_order_release);
+    mWriter.join();
+
+    if (mCallCount > 0)
+    {
+        std::cout << "Logger: " << mCallCount << " lines, " << mStalls << " full buffer stalls" << std::endl;
+    }
+}
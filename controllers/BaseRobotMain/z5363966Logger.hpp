@@ -0,0 +1,229 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <iomanip>
+#include <new>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Levels below CAFE_LOG_LEVEL are removed at compile time, including the evaluation of their arguments
+#define CAFE_LOG_LEVEL_DEBUG 0
+#define CAFE_LOG_LEVEL_INFO 1
+#define CAFE_LOG_LEVEL_WARN 2
+#define CAFE_LOG_LEVEL_ERROR 3
+
+#ifndef CAFE_LOG_LEVEL
+#define CAFE_LOG_LEVEL CAFE_LOG_LEVEL_INFO
+#endif
+
+#if CAFE_LOG_LEVEL <= CAFE_LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) Logger::instance().log(LogLevel::DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if CAFE_LOG_LEVEL <= CAFE_LOG_LEVEL_INFO
+#define LOG_INFO(...) Logger::instance().log(LogLevel::INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if CAFE_LOG_LEVEL <= CAFE_LOG_LEVEL_WARN
+#define LOG_WARN(...) Logger::instance().log(LogLevel::WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#if CAFE_LOG_LEVEL <= CAFE_LOG_LEVEL_ERROR
+#define LOG_ERROR(...) Logger::instance().log(LogLevel::ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
+
+enum class LogLevel : unsigned char { DEBUG, INFO, WARN, ERROR };
+
+/**
+ * @brief Fixed point number for log lines, formatted by the writer thread
+ * 
+ */
+struct LogFixed {
+    double value;
+    int precision;
+};
+
+std::ostream& operator<<(std::ostream&, const LogFixed&);
+
+/**
+ * @brief Text of a std::string argument, copied into the spare bytes of the line's ring buffer slot
+ * instead of into an owning std::string. Only text too long for the slot goes to the heap.
+ * 
+ */
+class LogText {
+    public:
+        /**
+         * @brief Copies the text to free, moving free past it, or to the heap if it does not fit
+         * before end
+         * 
+         * @param data, size text to copy
+         * @param free, end spare bytes of the slot
+         */
+        LogText(const char *data, std::size_t size, char *&free, char *end)
+            : mSize(size),
+              mOwned(size > static_cast<std::size_t>(end - free))
+        {
+            char *copy{mOwned ? new char[size] : free};
+            std::memcpy(copy, data, size);
+            free += mOwned ? 0 : size;
+            mData = copy;
+        }
+
+        LogText(LogText &&other) noexcept
+            : mData(other.mData),
+              mSize(other.mSize),
+              mOwned(other.mOwned)
+        {
+            other.mOwned = false;
+        }
+
+        LogText(const LogText&) = delete;
+        LogText& operator=(const LogText&) = delete;
+
+        ~LogText()
+        {
+            if (mOwned)
+            {
+                delete[] mData;
+            }
+        }
+
+        friend std::ostream& operator<<(std::ostream &out, const LogText &text)
+        {
+            return out.write(text.mData, static_cast<std::streamsize>(text.mSize));
+        }
+
+    private:
+        const char *mData;
+        std::size_t mSize;
+        bool mOwned;
+};
+
+/**
+ * @brief How a log argument is captured: by value, except std::string, whose text is copied into the
+ * slot
+ * 
+ */
+template <typename T>
+struct LogCapture {
+    using type = T;
+
+    template <typename Arg>
+    static T capture(Arg &&arg, char*&, char*)
+    {
+        return std::forward<Arg>(arg);
+    }
+};
+
+template <>
+struct LogCapture<std::string> {
+    using type = LogText;
+
+    static LogText capture(const std::string &text, char *&free, char *end)
+    {
+        return LogText{text.data(), text.size(), free, end};
+    }
+};
+
+class Logger {
+    public:
+        /**
+         * @brief Returns the process wide logger, starting its writer thread on first use
+         * 
+         * @return Logger&
+         */
+        static Logger& instance();
+
+        /**
+         * @brief Queues a log line. The arguments are captured by value, strings into the slot itself,
+         * and only formatted by the writer thread. Only the controller thread may log, and char
+         * pointers must be string literals.
+         * 
+         * @param level, args... streamed one after another to form the line
+         */
+        template <typename... Args>
+        void log(LogLevel level, Args&&... args)
+        {
+            using Record = std::tuple<typename LogCapture<typename std::decay<Args>::type>::type...>;
+            static_assert(sizeof(Record) <= SLOT_SIZE, "Log line captures too many arguments for a ring buffer slot");
+
+            mCallCount++;
+            Slot &slot{acquireSlot()};
+            char *free{reinterpret_cast<char *>(&slot.storage) + sizeof(Record)};
+            char *end{reinterpret_cast<char *>(&slot.storage) + SLOT_SIZE};
+            new (&slot.storage) Record{LogCapture<typename std::decay<Args>::type>::capture(std::forward<Args>(args), free, end)...};
+            slot.level = level;
+            slot.format = &formatRecord<Record>;
+            mHead.store(mHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        /**
+         * @brief Writes every queued line and waits until the writer thread has flushed them
+         * 
+         */
+        void flush();
+
+        /**
+         * @brief Stops the writer thread after draining the queue and reports the lines logged and the
+         * times the control loop waited for a full buffer
+         * 
+         */
+        ~Logger();
+
+    private:
+        Logger();
+
+        static constexpr std::size_t SLOT_SIZE {224};
+        static constexpr std::size_t SLOT_COUNT {1024};
+
+        struct Slot {
+            typename std::aligned_storage<SLOT_SIZE, alignof(std::max_align_t)>::type storage;
+            void (*format)(std::ostream&, void*);
+            LogLevel level;
+        };
+
+        template <typename Record, std::size_t... I>
+        static void streamRecord(std::ostream &out, Record &record, std::index_sequence<I...>)
+        {
+            using expand = int[];
+            (void)expand{0, ((void)(out << std::get<I>(record)), 0)...};
+        }
+
+        template <typename Record>
+        static void formatRecord(std::ostream &out, void *storage)
+        {
+            Record &record{*static_cast<Record *>(storage)};
+            streamRecord(out, record, std::make_index_sequence<std::tuple_size<Record>::value>());
+            record.~Record();
+        }
+
+        Slot& acquireSlot();
+        void writerLoop();
+        std::size_t drain(std::ostream&);
+
+        Slot mSlots[SLOT_COUNT];
+        alignas(64) std::atomic<std::size_t> mHead;
+        alignas(64) std::atomic<std::size_t> mTail;
+        std::atomic<bool> mRunning;
+
+        // Producer side statistics, only touched by the controller thread. The latency of a call is
+        // timed by benchmarks/LoggerBenchmark rather than on the control loop.
+        unsigned long mCallCount;
+        unsigned long mStalls;
+
+        std::thread mWriter;
+};
@@ -0,0 +1,92 @@
+#include "z5363966Menu.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+Menu::Menu(const std::string &path)
+{
+    std::ifstream menuFile{path, std::ifstream::in};
+    std::string lineInput;
+
+    // Skips the header line
+    std::getline(menuFile, lineInput);
+    while (std::getline(menuFile, lineInput) && mNames.size() < NO_ITEM)
+    {
+        // menuLine will be in the form of {menuItem, prepTime, itemPrice, ingredients}
+        std::stringstream lineStream{lineInput};
+        std::string stringSegment;
+        std::vector<std::string> menuLine;
+        while (std::getline(lineStream, stringSegment, ','))
+        {
+            menuLine.push_back(stringSegment);
+        }
+        if (menuLine.size() < 3 || mIds.count(menuLine[0]) != 0)
+        {
+            continue;
+        }
+        mIds[menuLine[0]] = static_cast<ItemId>(mNames.size());
+        mNames.push_back(menuLine[0]);
+        mPrepSeconds.push_back(std::stoi(menuLine[1]));
+        mPrices.push_back(std::stod(menuLine[2]));
+        mPriceTexts.push_back(menuLine[2]);
+        mRecipes.push_back((menuLine.size() > 3) ? menuLine[3] : "");
+    }
+}
+
+ItemId Menu::find(const std::string &name) const
+{
+    auto id{mIds.find(name)};
+    return (id != mIds.end()) ? id->second : NO_ITEM;
+}
+
+ItemId Menu::decode(const std::string &item) const
+{
+    if (!item.empty() && item[0] == ITEM_MARK)
+    {
+        long id{std::strtol(item.c_str() + 1, nullptr, 10)};
+        return (id >= 0 && static_cast<std::size_t>(id) < mNames.size()) ? static_cast<ItemId>(id) : NO_ITEM;
+    }
+    return find(item);
+}
+
+std::string Menu::label(const std::string &item) const
+{
+    ItemId id{decode(item)};
+    return (id != NO_ITEM) ? mNames[id] : item;
+}
+
+std::string Menu::encode(ItemId id)
+{
+    return ITEM_MARK + std::to_string(id);
+}
+
+const std::string& Menu::name(ItemId id) const
+{
+    return mNames[id];
+}
+
+int Menu::prepSeconds(ItemId id) const
+{
+    return mPrepSeconds[id];
+}
+
+double Menu::price(ItemId id) const
+{
+    return mPrices[id];
+}
+
+const std::string& Menu::priceText(ItemId id) const
+{
+    return mPriceTexts[id];
+}
+
+const std::string& Menu::recipe(ItemId id) const
+{
+    return mRecipes[id];
+}
+
+std::size_t Menu::size() const
+{
+    return mNames.size();
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Dense ID of a menu item, its row in Menu.csv
+using ItemId = std::uint16_t;
+
+/**
+ * @brief Menu items interned to dense IDs when Menu.csv is loaded.
+ *
+ * Each item name is looked up once, when it enters the system, and from then on its ID travels in
+ * messages ("%<id>"), kitchen orders and the ledger. Prep times and prices sit in flat arrays
+ * indexed by ID. Names are only looked up again to be logged or written to a file. Every
+ * controller loads the same Menu.csv, so IDs agree between robots.
+ *
+ */
+class Menu {
+    public:
+        /**
+         * @brief Loads the menu
+         *
+         * @param path Menu.csv, rows of item, prep time [s], price [$] and optionally ingredients
+         */
+        explicit Menu(const std::string&);
+
+        /**
+         * @brief ID of an item name, exactly as written in Menu.csv
+         *
+         * @return ItemId, NO_ITEM if it is not on the menu
+         */
+        ItemId find(const std::string&) const;
+
+        /**
+         * @brief ID of an item as it arrives in a message: "%<id>" or a name
+         *
+         * @return ItemId, NO_ITEM if it is not on the menu
+         */
+        ItemId decode(const std::string&) const;
+
+        /**
+         * @brief Name to log for an item as it arrives in a message, the text itself if it is not on
+         * the menu
+         *
+         * @return std::string
+         */
+        std::string label(const std::string&) const;
+
+        /**
+         * @brief Message form of an item, "%<id>"
+         *
+         * @return std::string
+         */
+        static std::string encode(ItemId);
+
+        const std::string& name(ItemId) const;
+        int prepSeconds(ItemId) const;
+        double price(ItemId) const;
+
+        /**
+         * @brief Price as written in Menu.csv, e.g. 4.5
+         *
+         * @return const std::string&
+         */
+        const std::string& priceText(ItemId) const;
+
+        /**
+         * @brief Ingredients of one serve as written in Menu.csv, e.g. "espresso:1;milk:220", empty
+         * if none are listed
+         *
+         * @return const std::string&
+         */
+        const std::string& recipe(ItemId) const;
+
+        /**
+         * @brief Number of items
+         *
+         * @return std::size_t
+         */
+        std::size_t size() const;
+
+        static constexpr ItemId NO_ITEM {0xFFFF};
+
+        // Marks an item ID in a message
+        static constexpr char ITEM_MARK {'%'};
+
+    private:
+        std::vector<std::string> mNames;
+        std::vector<int> mPrepSeconds;
+        std::vector<double> mPrices;
+        std::vector<std::string> mPriceTexts;
+        std::vector<std::string> mRecipes;
+        std::unordered_map<std::string, ItemId> mIds;
+};
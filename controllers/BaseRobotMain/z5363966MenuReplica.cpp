@@ -0,0 +1,190 @@
+#include "z5363966MenuReplica.hpp"
+
+#include <cstdlib>
+
+MenuReplica::MenuReplica()
+    : mVersion(0),
+      mFilled(0)
+{
+}
+
+void MenuReplica::load(const Menu &menu)
+{
+    mVersion = 1;
+    mItems.clear();
+    for (ItemId id = 0; id < menu.size(); id++)
+    {
+        mItems.push_back({menu.priceText(id), menu.price(id), true, true});
+    }
+    mFilled = mItems.size();
+}
+
+std::string MenuReplica::setAvailable(ItemId item, bool available)
+{
+    if (item >= mItems.size() || mItems[item].available == available)
+    {
+        return "";
+    }
+    mItems[item].available = available;
+    mVersion++;
+    return MARK + std::to_string(mVersion) + "+" + std::to_string(item) + ":" + encode(item);
+}
+
+std::vector<std::string> MenuReplica::snapshot() const
+{
+    std::vector<std::string> messages;
+    for (std::size_t first = 0; first < mItems.size(); first += ITEMS_PER_MESSAGE)
+    {
+        std::string message{MARK + std::to_string(mVersion) + "=" + std::to_string(first) + "/" +
+                            std::to_string(mItems.size()) + ":"};
+        for (std::size_t id = first; id < mItems.size() && id < first + ITEMS_PER_MESSAGE; id++)
+        {
+            message += ((id > first) ? "," : "") + encode(static_cast<ItemId>(id));
+        }
+        messages.push_back(message);
+    }
+    return messages;
+}
+
+bool MenuReplica::apply(const std::string &message)
+{
+    // "^<version>=<first>/<items>:<entries>" or "^<version>+<item>:<entry>"
+    char *end{nullptr};
+    unsigned long version{std::strtoul(message.c_str() + 1, &end, 10)};
+    std::size_t colon{message.find(':')};
+    char kind{*end};
+    if (version == 0 || (kind != '=' && kind != '+') || colon == std::string::npos)
+    {
+        return true;
+    }
+    std::size_t first{std::strtoul(end + 1, &end, 10)};
+
+    if (kind == '=')
+    {
+        if (version < mVersion || (version == mVersion && synced()))
+        {
+            return true;
+        }
+        if (version > mVersion)
+        {
+            mVersion = static_cast<std::uint32_t>(version);
+            mItems.assign((*end == '/') ? std::strtoul(end + 1, nullptr, 10) : 0, Entry{"", 0, false, false});
+            mFilled = 0;
+        }
+        std::size_t start{colon + 1};
+        for (std::size_t id = first; id < mItems.size() && start <= message.size(); id++)
+        {
+            std::size_t comma{message.find(',', start)};
+            std::string entry{message.substr(start, (comma != std::string::npos) ? comma - start : std::string::npos)};
+            mFilled += fill(static_cast<ItemId>(id), entry) ? 1 : 0;
+            if (comma == std::string::npos)
+            {
+                break;
+            }
+            start = comma + 1;
+        }
+        return true;
+    }
+
+    // A delta only follows on from the version before it
+    if (!synced() || version <= mVersion)
+    {
+        return synced();
+    }
+    if (version != mVersion + 1 || first >= mItems.size())
+    {
+        mFilled = 0;
+        for (Entry &item : mItems)
+        {
+            item.filled = false;
+        }
+        return false;
+    }
+    mVersion = static_cast<std::uint32_t>(version);
+    fill(static_cast<ItemId>(first), message.substr(colon + 1));
+    return true;
+}
+
+bool MenuReplica::synced() const
+{
+    return mVersion > 0 && mFilled == mItems.size();
+}
+
+MenuVerdict MenuReplica::check(ItemId item, double balance) const
+{
+    if (!synced())
+    {
+        return MenuVerdict::UNSYNCED;
+    }
+    if (item >= mItems.size())
+    {
+        return MenuVerdict::UNKNOWN_ITEM;
+    }
+    if (!mItems[item].available)
+    {
+        return MenuVerdict::UNAVAILABLE;
+    }
+    return (mItems[item].price <= balance) ? MenuVerdict::ORDERABLE : MenuVerdict::UNAFFORDABLE;
+}
+
+bool MenuReplica::available(ItemId item) const
+{
+    return item < mItems.size() && mItems[item].available;
+}
+
+std::uint32_t MenuReplica::version() const
+{
+    return mVersion;
+}
+
+void MenuReplica::save(SnapshotWriter &state) const
+{
+    state.put(mVersion);
+    state.put(static_cast<std::uint32_t>(mItems.size()));
+    for (const Entry &item : mItems)
+    {
+        state.put(item.available);
+    }
+}
+
+SnapshotCommit MenuReplica::restore(SnapshotReader &state)
+{
+    // Prices come from Menu.csv, so only the version and availability are kept
+    std::uint32_t version{state.get<std::uint32_t>()};
+    std::vector<bool> available;
+    std::uint32_t items{state.get<std::uint32_t>()};
+    for (std::uint32_t id = 0; id < items && state.ok(); id++)
+    {
+        available.push_back(state.get<bool>());
+    }
+
+    return [this, version, available = std::move(available)]() {
+        mVersion = version;
+        for (std::size_t id = 0; id < available.size() && id < mItems.size(); id++)
+        {
+            mItems[id].available = available[id];
+        }
+    };
+}
+
+std::string MenuReplica::request(int robotId)
+{
+    return std::string{MARK, REQUEST} + std::to_string(robotId);
+}
+
+std::string MenuReplica::encode(ItemId item) const
+{
+    return (mItems[item].available ? "" : std::string{UNAVAILABLE_MARK}) + mItems[item].priceText;
+}
+
+bool MenuReplica::fill(ItemId item, const std::string &entry)
+{
+    Entry &target{mItems[item]};
+    bool unavailable{!entry.empty() && entry[0] == UNAVAILABLE_MARK};
+    target.priceText = entry.substr(unavailable ? 1 : 0);
+    target.price = std::atof(target.priceText.c_str());
+    target.available = !unavailable;
+    bool newlyFilled{!target.filled};
+    target.filled = true;
+    return newlyFilled;
+}
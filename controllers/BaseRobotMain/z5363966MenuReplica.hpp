@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "z5363966Menu.hpp"
+#include "z5363966Snapshot.hpp"
+
+// The price and availability of every menu item, held by the staff and replicated to the customers.
+//
+// The staff's copy is authoritative. Each change to it bumps the version and is broadcast as a
+// delta, "^<version>+<item ID>:<entry>". A full snapshot is sent as one or more chunks,
+// "^<version>=<first item ID>/<items>:<entry>,<entry>,...", broadcast when the staff starts and
+// sent to any customer that asks with "^?<robot ID>". An entry is the price as written in Menu.csv,
+// marked with a leading 'x' if the item is unavailable, e.g. "4.5" or "x4.5".
+//
+// A customer applies deltas in version order. Stale deltas are ignored, and a gap means one was
+// lost, so the replica waits for a snapshot. Until it holds a whole snapshot it has no say, and the
+// staff decides at the counter as always.
+
+// What a customer's replica makes of an order before the customer walks to the counter
+enum class MenuVerdict : unsigned char {
+    UNSYNCED,       // no complete replica, so the staff decides
+    ORDERABLE,
+    UNKNOWN_ITEM,
+    UNAVAILABLE,
+    UNAFFORDABLE
+};
+
+class MenuReplica {
+    public:
+        MenuReplica();
+
+        /**
+         * @brief Makes this the authoritative copy: version 1, every item available at its price
+         *
+         */
+        void load(const Menu&);
+
+        /**
+         * @brief Changes whether an item can be ordered, on the authoritative copy
+         *
+         * @param item
+         * @param available
+         * @return std::string, the delta to broadcast, empty if nothing changed
+         */
+        std::string setAvailable(ItemId, bool);
+
+        /**
+         * @brief The whole menu as snapshot messages, ITEMS_PER_MESSAGE items to each
+         *
+         * @return std::vector<std::string>
+         */
+        std::vector<std::string> snapshot() const;
+
+        /**
+         * @brief Applies a snapshot chunk or delta from the staff
+         *
+         * @param message "^..." as received
+         * @return boolean, false if a delta was lost and a snapshot is needed
+         */
+        bool apply(const std::string&);
+
+        /**
+         * @brief Whether the replica holds a whole snapshot and every delta since
+         *
+         * @return boolean
+         */
+        bool synced() const;
+
+        /**
+         * @brief Whether an order can be made and afforded, as far as the replica knows
+         *
+         * @param item Menu::NO_ITEM for an item not on the menu
+         * @param balance [$]
+         * @return MenuVerdict
+         */
+        MenuVerdict check(ItemId, double) const;
+
+        bool available(ItemId) const;
+        std::uint32_t version() const;
+
+        void save(SnapshotWriter&) const;
+        SnapshotCommit restore(SnapshotReader&);
+
+        /**
+         * @brief Request for a snapshot, sent to the staff
+         *
+         * @return std::string
+         */
+        static std::string request(int);
+
+        // Marks a menu replication message
+        static constexpr char MARK {'^'};
+        static constexpr char REQUEST {'?'};
+        static constexpr std::size_t ITEMS_PER_MESSAGE {32};
+
+    private:
+        struct Entry {
+            std::string priceText;
+            double price;
+            bool available;
+            bool filled;
+        };
+
+        std::string encode(ItemId) const;
+        bool fill(ItemId, const std::string&);
+
+        std::uint32_t mVersion;
+        std::vector<Entry> mItems;
+        std::size_t mFilled;
+
+        static constexpr char UNAVAILABLE_MARK {'x'};
+};
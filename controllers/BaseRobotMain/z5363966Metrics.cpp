@@ -0,0 +1,217 @@
+#include "z5363966Metrics.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+constexpr std::array<double, Metrics::BUCKET_COUNT> Metrics::BUCKET_BOUNDS;
+
+Metrics::Metrics(const std::string &source, const Settings &settings)
+    : mSource(source),
+      mOutputPath(settings.getString("metrics_path", "../../Metrics") + "_" + source),
+      mSocketPath(settings.getString("metrics_socket", "")),
+      mInterval(settings.getDouble("metrics_interval", 10)),
+      mLastExport(0) {}
+
+void Metrics::describe(const std::string &name, const std::string &type, const std::string &help)
+{
+    Family &family{mFamilies[name]};
+    family.type = type;
+    family.help = help;
+}
+
+Metrics::Series &Metrics::getSeries(const std::string &name, const std::string &labels, const std::string &type)
+{
+    Family &family{mFamilies[name]};
+    if (family.help.empty())
+    {
+        family.type = type;
+    }
+    return family.series[labels];
+}
+
+void Metrics::increment(const std::string &name, const std::string &labels, double amount)
+{
+    getSeries(name, labels, "counter").value += amount;
+}
+
+void Metrics::set(const std::string &name, const std::string &labels, double newValue)
+{
+    getSeries(name, labels, "gauge").value = newValue;
+}
+
+void Metrics::observe(const std::string &name, const std::string &labels, double seconds)
+{
+    Series &series{getSeries(name, labels, "histogram")};
+    series.sum += seconds;
+    series.count++;
+    for (std::size_t i = 0; i < BUCKET_COUNT; i++)
+    {
+        if (seconds <= BUCKET_BOUNDS[i])
+        {
+            series.buckets[i]++;
+        }
+    }
+}
+
+double Metrics::value(const std::string &name, const std::string &labels) const
+{
+    auto family{mFamilies.find(name)};
+    if (family == mFamilies.end())
+    {
+        return 0;
+    }
+    auto series{family->second.series.find(labels)};
+    return (series != family->second.series.end()) ? series->second.value : 0;
+}
+
+void Metrics::update(double simTime)
+{
+    if (mInterval > 0 && simTime - mLastExport >= mInterval)
+    {
+        exportPrometheus(simTime);
+    }
+}
+
+std::string Metrics::labelsWithSource(const std::string &labels) const
+{
+    std::string source{"robot=\"" + mSource + "\""};
+    return labels.empty() ? source : source + "," + labels;
+}
+
+std::string Metrics::renderPrometheus() const
+{
+    std::ostringstream out;
+    out << std::setprecision(6);
+    for (const auto &entry : mFamilies)
+    {
+        const std::string &name{entry.first};
+        const Family &family{entry.second};
+        if (!family.help.empty())
+        {
+            out << "# HELP " << name << " " << family.help << "\n";
+        }
+        out << "# TYPE " << name << " " << family.type << "\n";
+        for (const auto &seriesEntry : family.series)
+        {
+            std::string labels{labelsWithSource(seriesEntry.first)};
+            const Series &series{seriesEntry.second};
+            if (family.type != "histogram")
+            {
+                out << name << "{" << labels << "} " << series.value << "\n";
+                continue;
+            }
+            for (std::size_t i = 0; i < BUCKET_COUNT; i++)
+            {
+                out << name << "_bucket{" << labels << ",le=\"" << BUCKET_BOUNDS[i] << "\"} " << series.buckets[i] << "\n";
+            }
+            out << name << "_bucket{" << labels << ",le=\"+Inf\"} " << series.count << "\n";
+            out << name << "_sum{" << labels << "} " << series.sum << "\n";
+            out << name << "_count{" << labels << "} " << series.count << "\n";
+        }
+    }
+    return out.str();
+}
+
+void Metrics::exportPrometheus(double simTime)
+{
+    mLastExport = simTime;
+    std::string text{renderPrometheus()};
+
+    // Writes to a temporary file first so scrapers never read a half written export
+    std::string tmpPath{mOutputPath + ".prom.tmp"};
+    {
+        std::ofstream promFile{tmpPath, std::ios::out | std::ios::trunc};
+        promFile << text;
+    }
+    std::remove((mOutputPath + ".prom").c_str());
+    std::rename(tmpPath.c_str(), (mOutputPath + ".prom").c_str());
+
+    if (!mSocketPath.empty())
+    {
+        sendToSocket(text);
+    }
+}
+
+void Metrics::sendToSocket(const std::string &text) const
+{
+#ifndef _WIN32
+    // Unix domain sockets cannot be reached from outside the machine
+    int fd{socket(AF_UNIX, SOCK_STREAM, 0)};
+    if (fd < 0)
+    {
+        return;
+    }
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    mSocketPath.copy(address.sun_path, sizeof(address.sun_path) - 1);
+    if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0)
+    {
+        std::size_t sent{0};
+        while (sent < text.size())
+        {
+            ssize_t written{write(fd, text.data() + sent, text.size() - sent)};
+            if (written <= 0)
+            {
+                break;
+            }
+            sent += static_cast<std::size_t>(written);
+        }
+    }
+    close(fd);
+#else
+    (void)text;
+#endif
+}
+
+void Metrics::writeSummary(double simTime)
+{
+    exportPrometheus(simTime);
+
+    std::ofstream summaryFile{mOutputPath + ".json", std::ios::out | std::ios::trunc};
+    summaryFile << std::setprecision(6);
+    summaryFile << "{\n  \"robot\": \"" << mSource << "\",\n  \"sim_time_s\": " << simTime << ",\n  \"metrics\": {";
+    bool first{true};
+    for (const auto &entry : mFamilies)
+    {
+        for (const auto &seriesEntry : entry.second.series)
+        {
+            std::string key{entry.first};
+            if (!seriesEntry.first.empty())
+            {
+                key += "{" + seriesEntry.first + "}";
+            }
+            // Escapes the quotes of the label values
+            std::string escaped;
+            for (char c : key)
+            {
+                if (c == '"')
+                {
+                    escaped += '\\';
+                }
+                escaped += c;
+            }
+
+            const Series &series{seriesEntry.second};
+            summaryFile << (first ? "\n" : ",\n") << "    \"" << escaped << "\": ";
+            if (entry.second.type == "histogram")
+            {
+                double mean{series.count ? series.sum / series.count : 0};
+                summaryFile << "{\"count\": " << series.count << ", \"sum\": " << series.sum << ", \"mean\": " << mean << "}";
+            }
+            else
+            {
+                summaryFile << series.value;
+            }
+            first = false;
+        }
+    }
+    summaryFile << "\n  }\n}\n";
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <string>
+
+#include "z5363966Settings.hpp"
+
+class Metrics {
+    public:
+        /**
+         * @brief Constructs the metrics registry for one controller. The export interval (simulated
+         * seconds), output path prefix and optional local socket are read from the settings.
+         * 
+         */
+        Metrics(const std::string&, const Settings&);
+
+        /**
+         * @brief Registers the Prometheus type ("counter", "gauge" or "histogram") and help text of a
+         * metric family
+         * 
+         */
+        void describe(const std::string&, const std::string&, const std::string&);
+
+        /**
+         * @brief Adds to a counter series. Labels are given in Prometheus form, e.g. reason="unknown_item"
+         * 
+         * @param name, labels, value
+         */
+        void increment(const std::string&, const std::string&, double = 1);
+
+        /**
+         * @brief Sets a gauge series
+         * 
+         * @param name, labels, value
+         */
+        void set(const std::string&, const std::string&, double);
+
+        /**
+         * @brief Records a duration in seconds into a histogram series
+         * 
+         * @param name, labels, seconds
+         */
+        void observe(const std::string&, const std::string&, double);
+
+        /**
+         * @brief Returns the current value of a counter or gauge series, 0 if never written
+         * 
+         * @return double
+         */
+        double value(const std::string&, const std::string&) const;
+
+        /**
+         * @brief Exports the metrics if the export interval has elapsed since the last export
+         * 
+         * @param simTime [s]
+         */
+        void update(double);
+
+        /**
+         * @brief Writes all series in Prometheus text format to the output file and socket
+         * 
+         * @param simTime [s]
+         */
+        void exportPrometheus(double);
+
+        /**
+         * @brief Writes the final export and a summary json of every series
+         * 
+         * @param simTime [s]
+         */
+        void writeSummary(double);
+
+    private:
+        static constexpr std::size_t BUCKET_COUNT {12};
+        static constexpr std::array<double, BUCKET_COUNT> BUCKET_BOUNDS {
+            {1, 2, 5, 10, 20, 30, 60, 120, 180, 300, 600, 1200}};
+
+        struct Series {
+            double value {0};
+            double sum {0};
+            unsigned long count {0};
+            std::array<unsigned long, BUCKET_COUNT> buckets {};
+        };
+
+        struct Family {
+            std::string type {"gauge"};
+            std::string help;
+            std::map<std::string, Series> series;
+        };
+
+        Series& getSeries(const std::string&, const std::string&, const std::string&);
+        std::string labelsWithSource(const std::string&) const;
+        std::string renderPrometheus() const;
+        void sendToSocket(const std::string&) const;
+
+        std::string mSource;
+        std::string mOutputPath;
+        std::string mSocketPath;
+        double mInterval;
+        double mLastExport;
+        std::map<std::string, Family> mFamilies;
+};
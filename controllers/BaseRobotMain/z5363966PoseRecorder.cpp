@@ -0,0 +1,449 @@
+#include "z5363966PoseRecorder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "z5363966Logger.hpp"
+
+constexpr char PoseRecorder::MAGIC[4];
+constexpr char PoseRecorder::INDEX_MAGIC[4];
+
+namespace {
+    enum Value : std::size_t { TIME, X, Z, HEADING, VALUES };
+
+    // A full turn in recorded heading units
+    constexpr std::int64_t TURN {360000};
+
+    // First and last times [ms], then the sample count, event count and payload size
+    constexpr std::size_t CHUNK_HEADER_BYTES {2 * sizeof(std::int64_t) + 3 * sizeof(std::uint32_t)};
+    constexpr std::size_t INDEX_ENTRY_BYTES {sizeof(std::uint64_t) + 2 * sizeof(std::int64_t)};
+
+    template <typename T>
+    void put(std::ostream &out, const T &value)
+    {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    T get(const std::string &bytes, std::size_t at)
+    {
+        T value{};
+        std::memcpy(&value, bytes.data() + at, sizeof(T));
+        return value;
+    }
+
+    void putVarint(std::string &out, std::uint64_t value)
+    {
+        while (value > 0x7f)
+        {
+            out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    bool getVarint(const std::string &in, std::size_t &at, std::uint64_t &value)
+    {
+        value = 0;
+        for (int shift = 0; at < in.size() && shift < 64; shift += 7)
+        {
+            unsigned char byte{static_cast<unsigned char>(in[at++])};
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Small differences of either sign take few bytes
+    std::uint64_t zigzag(std::int64_t value)
+    {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+    std::int64_t unzigzag(std::uint64_t value)
+    {
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    std::int64_t wrapHeading(std::int64_t heading)
+    {
+        return ((heading % TURN) + TURN) % TURN;
+    }
+
+    // Headings change the short way round, so crossing north is a small change
+    std::int64_t headingChange(std::int64_t change)
+    {
+        change = wrapHeading(change);
+        return (change >= TURN / 2) ? change - TURN : change;
+    }
+}
+
+PoseRecorder::PoseRecorder(const std::string &robotName, const Settings &settings)
+    : mChunkSamples(static_cast<std::uint32_t>(std::max(1, settings.getInt("pose_chunk_samples", DEFAULT_CHUNK_SAMPLES)))),
+      mSamples(0),
+      mBytes(0)
+{
+    std::string prefix{settings.getString("pose_record", "")};
+    if (!prefix.empty())
+    {
+        open(prefix + "_" + robotName + ".pose");
+    }
+}
+
+PoseRecorder::PoseRecorder(const std::string &path, std::uint32_t chunkSamples)
+    : mChunkSamples(std::max<std::uint32_t>(1, chunkSamples)),
+      mSamples(0),
+      mBytes(0)
+{
+    open(path);
+}
+
+PoseRecorder::~PoseRecorder()
+{
+    close();
+}
+
+bool PoseRecorder::enabled() const
+{
+    return mFile.is_open();
+}
+
+void PoseRecorder::record(double time, double x, double z, double heading)
+{
+    if (!mFile.is_open())
+    {
+        return;
+    }
+    std::int64_t values[VALUES]{std::llround(time * TIME_SCALE), std::llround(x * POSITION_SCALE),
+                                std::llround(z * POSITION_SCALE), wrapHeading(std::llround(heading * HEADING_SCALE))};
+    if (mChunkCount == 0 && mEventCount == 0)
+    {
+        mFirst = values[TIME];
+    }
+    mLastTime = std::max(mLastTime, values[TIME]);
+
+    std::int64_t changes[VALUES];
+    bool steady{mChunkCount > 0};
+    for (std::size_t value = 0; value < VALUES; value++)
+    {
+        changes[value] = values[value] - mLast[value];
+        if (value == HEADING)
+        {
+            changes[value] = headingChange(changes[value]);
+        }
+        steady = steady && changes[value] == mLastChange[value];
+    }
+    if (steady)
+    {
+        mZeroRun++;
+    }
+    else
+    {
+        putVarint(mPayload, mZeroRun);
+        mZeroRun = 0;
+        for (std::size_t value = 0; value < VALUES; value++)
+        {
+            putVarint(mPayload, zigzag(changes[value] - mLastChange[value]));
+        }
+    }
+    for (std::size_t value = 0; value < VALUES; value++)
+    {
+        mLast[value] = values[value];
+        // The first sample of a chunk is absolute, so the next one's change stands on its own
+        mLastChange[value] = (mChunkCount == 0) ? 0 : changes[value];
+    }
+    mChunkCount++;
+    mSamples++;
+    if (mChunkCount >= mChunkSamples)
+    {
+        writeChunk();
+    }
+}
+
+void PoseRecorder::event(double time, std::uint8_t code)
+{
+    if (!mFile.is_open())
+    {
+        return;
+    }
+    std::int64_t ms{std::llround(time * TIME_SCALE)};
+    if (mChunkCount == 0 && mEventCount == 0)
+    {
+        mFirst = ms;
+    }
+    mLastTime = std::max(mLastTime, ms);
+    putVarint(mEvents, zigzag(ms - mLastEvent));
+    mEvents.push_back(static_cast<char>(code));
+    mLastEvent = ms;
+    mEventCount++;
+}
+
+void PoseRecorder::close()
+{
+    if (!mFile.is_open())
+    {
+        return;
+    }
+    writeChunk();
+    for (const PoseChunk &chunk : mIndex)
+    {
+        put(mFile, chunk.offset);
+        put(mFile, chunk.first);
+        put(mFile, chunk.last);
+    }
+    put(mFile, static_cast<std::uint32_t>(mIndex.size()));
+    mFile.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    mBytes += mIndex.size() * INDEX_ENTRY_BYTES + sizeof(std::uint32_t) + sizeof(INDEX_MAGIC);
+    mFile.close();
+}
+
+std::uint64_t PoseRecorder::samples() const
+{
+    return mSamples;
+}
+
+std::uint64_t PoseRecorder::bytes() const
+{
+    return mBytes;
+}
+
+void PoseRecorder::open(const std::string &path)
+{
+    mChunkCount = 0;
+    mEventCount = 0;
+    mZeroRun = 0;
+    mFirst = 0;
+    mLastTime = 0;
+    mLastEvent = 0;
+    std::fill(std::begin(mLast), std::end(mLast), 0);
+    std::fill(std::begin(mLastChange), std::end(mLastChange), 0);
+    mFile.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!mFile.is_open())
+    {
+        LOG_ERROR("Poses: cannot record to ", path);
+        return;
+    }
+    mFile.write(MAGIC, sizeof(MAGIC));
+    mBytes = sizeof(MAGIC);
+}
+
+void PoseRecorder::writeChunk()
+{
+    if (mChunkCount == 0 && mEventCount == 0)
+    {
+        return;
+    }
+    if (mZeroRun > 0)
+    {
+        putVarint(mPayload, mZeroRun);
+    }
+    mIndex.push_back({mBytes, mFirst, mLastTime});
+    put(mFile, mFirst);
+    put(mFile, mLastTime);
+    put(mFile, mChunkCount);
+    put(mFile, mEventCount);
+    put(mFile, static_cast<std::uint32_t>(mPayload.size() + mEvents.size()));
+    mFile << mPayload << mEvents;
+    // Written out whole, so a crash loses at most the chunk being filled
+    mFile.flush();
+    mBytes += CHUNK_HEADER_BYTES + mPayload.size() + mEvents.size();
+
+    mPayload.clear();
+    mEvents.clear();
+    mChunkCount = 0;
+    mEventCount = 0;
+    mZeroRun = 0;
+    mLastEvent = 0;
+    std::fill(std::begin(mLast), std::end(mLast), 0);
+    std::fill(std::begin(mLastChange), std::end(mLastChange), 0);
+}
+
+PoseReader::PoseReader(const std::string &path)
+    : mFile(path, std::ios::in | std::ios::binary),
+      mOk(false),
+      mDecoded(0)
+{
+    char magic[sizeof(PoseRecorder::MAGIC)]{};
+    if (!mFile.read(magic, sizeof(magic)) || std::memcmp(magic, PoseRecorder::MAGIC, sizeof(magic)) != 0)
+    {
+        return;
+    }
+    mFile.seekg(0, std::ios::end);
+    std::uint64_t size{static_cast<std::uint64_t>(mFile.tellg())};
+    std::string bytes;
+
+    // The index, if the recording was closed
+    std::size_t footerBytes{sizeof(std::uint32_t) + sizeof(PoseRecorder::INDEX_MAGIC)};
+    if (size >= sizeof(magic) + footerBytes)
+    {
+        bytes.resize(footerBytes);
+        mFile.seekg(static_cast<std::streamoff>(size - footerBytes));
+        mFile.read(bytes.data(), static_cast<std::streamsize>(footerBytes));
+        std::uint64_t count{get<std::uint32_t>(bytes, 0)};
+        if (mFile && std::memcmp(bytes.data() + sizeof(std::uint32_t), PoseRecorder::INDEX_MAGIC, sizeof(magic)) == 0 &&
+            size >= sizeof(magic) + footerBytes + count * INDEX_ENTRY_BYTES)
+        {
+            bytes.resize(count * INDEX_ENTRY_BYTES);
+            mFile.seekg(static_cast<std::streamoff>(size - footerBytes - bytes.size()));
+            mFile.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            for (std::size_t at = 0; mFile && at < bytes.size(); at += INDEX_ENTRY_BYTES)
+            {
+                mChunks.push_back({get<std::uint64_t>(bytes, at), get<std::int64_t>(bytes, at + 8),
+                                   get<std::int64_t>(bytes, at + 16)});
+            }
+            mOk = static_cast<bool>(mFile);
+            return;
+        }
+    }
+
+    // Otherwise every whole chunk, found by skipping from header to header
+    mFile.clear();
+    bytes.resize(CHUNK_HEADER_BYTES);
+    for (std::uint64_t offset = sizeof(magic); offset + CHUNK_HEADER_BYTES <= size;)
+    {
+        mFile.seekg(static_cast<std::streamoff>(offset));
+        mFile.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        std::uint64_t next{offset + CHUNK_HEADER_BYTES + get<std::uint32_t>(bytes, 24)};
+        if (!mFile || next > size)
+        {
+            break;
+        }
+        mChunks.push_back({offset, get<std::int64_t>(bytes, 0), get<std::int64_t>(bytes, 8)});
+        offset = next;
+    }
+    mFile.clear();
+    mOk = true;
+}
+
+bool PoseReader::ok() const
+{
+    return mOk;
+}
+
+std::size_t PoseReader::chunks() const
+{
+    return mChunks.size();
+}
+
+bool PoseReader::read(double from, double to, std::vector<PoseSample> &samples, std::vector<PoseEvent> &events)
+{
+    samples.clear();
+    events.clear();
+    if (!mOk)
+    {
+        return false;
+    }
+    std::int64_t first{static_cast<std::int64_t>(std::ceil(from * PoseRecorder::TIME_SCALE - 1e-6))};
+    std::int64_t last{static_cast<std::int64_t>(std::floor(to * PoseRecorder::TIME_SCALE + 1e-6))};
+
+    // Chunks are in time order, so the first that ends inside the window is found by bisection
+    auto chunk{std::lower_bound(mChunks.begin(), mChunks.end(), first,
+                                [](const PoseChunk &chunk, std::int64_t time) { return chunk.last < time; })};
+    for (; chunk != mChunks.end() && chunk->first <= last; ++chunk)
+    {
+        if (!decode(*chunk, first, last, samples, events))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t PoseReader::decoded() const
+{
+    return mDecoded;
+}
+
+double PoseReader::start() const
+{
+    return mChunks.empty() ? 0 : mChunks.front().first / PoseRecorder::TIME_SCALE;
+}
+
+double PoseReader::end() const
+{
+    return mChunks.empty() ? 0 : mChunks.back().last / PoseRecorder::TIME_SCALE;
+}
+
+bool PoseReader::decode(const PoseChunk &chunk, std::int64_t first, std::int64_t last, std::vector<PoseSample> &samples,
+                        std::vector<PoseEvent> &events)
+{
+    std::string header(CHUNK_HEADER_BYTES, '\0');
+    mFile.seekg(static_cast<std::streamoff>(chunk.offset));
+    mFile.read(header.data(), static_cast<std::streamsize>(header.size()));
+    std::uint32_t sampleCount{get<std::uint32_t>(header, 16)};
+    std::uint32_t eventCount{get<std::uint32_t>(header, 20)};
+    std::string payload(get<std::uint32_t>(header, 24), '\0');
+    mFile.read(payload.data(), static_cast<std::streamsize>(payload.size()));
+    if (!mFile)
+    {
+        mFile.clear();
+        return false;
+    }
+    mDecoded++;
+
+    std::int64_t values[VALUES]{};
+    std::int64_t changes[VALUES]{};
+    auto emit{[&] {
+        if (values[TIME] >= first && values[TIME] <= last)
+        {
+            samples.push_back({values[TIME] / PoseRecorder::TIME_SCALE, values[X] / PoseRecorder::POSITION_SCALE,
+                               values[Z] / PoseRecorder::POSITION_SCALE, values[HEADING] / PoseRecorder::HEADING_SCALE});
+        }
+    }};
+    std::size_t at{0};
+    std::uint64_t read{0};
+    for (std::uint32_t sample = 0; sample < sampleCount;)
+    {
+        if (!getVarint(payload, at, read))
+        {
+            return false;
+        }
+        // A run of samples changing as the one before did
+        for (std::uint64_t steady = 0; steady < read && sample < sampleCount; steady++, sample++)
+        {
+            for (std::size_t value = 0; value < VALUES; value++)
+            {
+                values[value] += changes[value];
+            }
+            values[HEADING] = wrapHeading(values[HEADING]);
+            emit();
+        }
+        if (sample == sampleCount)
+        {
+            break;
+        }
+        for (std::size_t value = 0; value < VALUES; value++)
+        {
+            if (!getVarint(payload, at, read))
+            {
+                return false;
+            }
+            std::int64_t change{changes[value] + unzigzag(read)};
+            values[value] += change;
+            changes[value] = (sample == 0) ? 0 : change;
+        }
+        values[HEADING] = wrapHeading(values[HEADING]);
+        emit();
+        sample++;
+    }
+
+    std::int64_t time{0};
+    for (std::uint32_t event = 0; event < eventCount; event++)
+    {
+        if (!getVarint(payload, at, read) || at >= payload.size())
+        {
+            return false;
+        }
+        time += unzigzag(read);
+        std::uint8_t code{static_cast<std::uint8_t>(payload[at++])};
+        if (time >= first && time <= last)
+        {
+            events.push_back({time / PoseRecorder::TIME_SCALE, code});
+        }
+    }
+    return true;
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "z5363966Settings.hpp"
+
+// Recording of a robot's pose every step, for analysing trajectories after a run: where robots wait,
+// how long a turn dithers near the bearing tolerance.
+//
+// Setting pose_record records to <pose_record>_<robot name>.pose. Times are quantised to ms,
+// positions to 0.1 mm and headings to 0.001 deg. The samples are cut into chunks of
+// pose_chunk_samples, each starting from scratch so it can be decoded on its own. Within a chunk,
+// each sample stores how much each value's change differs from the previous sample's change. A
+// robot standing still or driving straight at a steady speed gives all zeros, so runs of such
+// samples are stored as one count. The other differences are zigzag varints, mostly a byte each.
+// Events, such as the robot's move state changing, are kept with the chunk they fall in.
+//
+// The file is the magic, then the chunks, each a fixed header giving its time span, sample and event
+// counts and payload size, then an index of every chunk's offset and time span. PoseReader reads the
+// index and decodes only the chunks that overlap the window asked for. A file cut short by a crash
+// has no index, so the reader walks the chunk headers instead, still without decoding the chunks.
+
+/**
+ * @brief A recorded pose, in the quantised units read back
+ *
+ */
+struct PoseSample {
+    double time;        // [s]
+    double x;           // [m]
+    double z;           // [m]
+    double heading;     // [0, 360) [deg]
+};
+
+/**
+ * @brief Something that happened to the robot, e.g. a change of move state
+ *
+ */
+struct PoseEvent {
+    double time;        // [s]
+    std::uint8_t code;
+};
+
+/**
+ * @brief Where a chunk starts in the file and the times it spans, as the index lists it
+ *
+ */
+struct PoseChunk {
+    std::uint64_t offset;
+    std::int64_t first;     // [ms]
+    std::int64_t last;      // [ms]
+};
+
+class PoseRecorder {
+    public:
+        /**
+         * @brief Reads pose_record and pose_chunk_samples from the settings and opens the file if
+         * recording
+         *
+         * @param robotName
+         * @param settings
+         */
+        PoseRecorder(const std::string&, const Settings&);
+
+        /**
+         * @brief Records to a file, with chunks of the given number of samples
+         *
+         * @param path
+         * @param chunkSamples
+         */
+        PoseRecorder(const std::string&, std::uint32_t);
+
+        /**
+         * @brief Closes the recording, writing out the last chunk and the index
+         *
+         */
+        ~PoseRecorder();
+
+        PoseRecorder(const PoseRecorder&) = delete;
+        PoseRecorder& operator=(const PoseRecorder&) = delete;
+
+        /**
+         * @brief Whether a file is being recorded to
+         *
+         * @return boolean
+         */
+        bool enabled() const;
+
+        /**
+         * @brief Records a pose, at a time no earlier than the last one recorded
+         *
+         * @param time [s]
+         * @param x, z [m]
+         * @param heading [deg]
+         */
+        void record(double, double, double, double);
+
+        /**
+         * @brief Records an event, kept with the chunk being filled
+         *
+         * @param time [s]
+         * @param code
+         */
+        void event(double, std::uint8_t);
+
+        /**
+         * @brief Writes out the last chunk and the index and closes the file, nothing is recorded after
+         *
+         */
+        void close();
+
+        std::uint64_t samples() const;
+
+        /**
+         * @brief Bytes written so far, the current chunk not included until it is written out
+         *
+         * @return std::uint64_t
+         */
+        std::uint64_t bytes() const;
+
+        // Quantisation of recorded values, per ms, m and deg
+        static constexpr double TIME_SCALE {1000};
+        static constexpr double POSITION_SCALE {10000};
+        static constexpr double HEADING_SCALE {1000};
+
+        static constexpr std::uint32_t DEFAULT_CHUNK_SAMPLES {1024};
+
+        static constexpr char MAGIC[4] {'P', 'O', 'S', '1'};
+        static constexpr char INDEX_MAGIC[4] {'P', 'I', 'D', 'X'};
+
+    private:
+        void open(const std::string&);
+        void writeChunk();
+
+        std::ofstream mFile;
+        std::uint32_t mChunkSamples;
+        std::uint64_t mSamples;
+        std::uint64_t mBytes;
+        std::vector<PoseChunk> mIndex;
+
+        // Chunk being filled: its encoded samples and events, its time span [ms] and the state its
+        // encoding continues from, time, x, z and heading
+        std::string mPayload;
+        std::string mEvents;
+        std::uint32_t mChunkCount;
+        std::uint32_t mEventCount;
+        std::uint32_t mZeroRun;
+        std::int64_t mFirst;
+        std::int64_t mLastTime;
+        std::int64_t mLastEvent;
+        std::int64_t mLast[4];
+        std::int64_t mLastChange[4];
+};
+
+class PoseReader {
+    public:
+        /**
+         * @brief Opens a recording and reads its index, or walks its chunk headers if it has none
+         *
+         * @param path
+         */
+        explicit PoseReader(const std::string&);
+
+        /**
+         * @brief Whether the file is a recording
+         *
+         * @return boolean
+         */
+        bool ok() const;
+
+        std::size_t chunks() const;
+
+        /**
+         * @brief Decodes the samples and events from one time to another, inclusive, decoding only the
+         * chunks that overlap them
+         *
+         * @param from, to [s]
+         * @param samples set to the samples in the window
+         * @param events set to the events in the window
+         * @return boolean, false if a chunk could not be read
+         */
+        bool read(double, double, std::vector<PoseSample>&, std::vector<PoseEvent>&);
+
+        /**
+         * @brief Chunks decoded by all reads so far
+         *
+         * @return std::size_t
+         */
+        std::size_t decoded() const;
+
+        /**
+         * @brief Time of the first and last recorded samples [s]
+         *
+         */
+        double start() const;
+        double end() const;
+
+    private:
+        bool decode(const PoseChunk&, std::int64_t, std::int64_t, std::vector<PoseSample>&, std::vector<PoseEvent>&);
+
+        std::ifstream mFile;
+        bool mOk;
+        std::vector<PoseChunk> mChunks;
+        std::size_t mDecoded;
+};
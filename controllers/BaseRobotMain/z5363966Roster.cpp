@@ -0,0 +1,123 @@
+#include "z5363966Roster.hpp"
+
+#include <cctype>
+#include <cstdlib>
+
+Roster::Roster(int staffId)
+    : mStaffId(staffId),
+      mNextFree(MAX_ROBOTS) {}
+
+int Roster::enrol(const std::string &name)
+{
+    auto known{mIds.find(name)};
+    if (known != mIds.end())
+    {
+        // Asked again because the answer was missed, so it is sent again
+        mAssignments.push_back(name + "=" + std::to_string(known->second) + ":" + std::to_string(channel(known->second)));
+        return known->second;
+    }
+
+    int id{requestedId(name, mStaffId)};
+    bool staffName{id == mStaffId && (name.empty() || !std::isdigit(static_cast<unsigned char>(name.back())))};
+    if (id < 1 || id > MAX_ROBOTS || registered(id) || (id == mStaffId && !staffName))
+    {
+        id = nextFreeId();
+        if (id == 0)
+        {
+            return 0;
+        }
+    }
+    if (static_cast<std::size_t>(id) >= mRobots.size())
+    {
+        mRobots.resize(id + 1, {"", 0, false});
+    }
+    mRobots[id] = {name, channelOf(id), true};
+    mIds[name] = id;
+    mAssignments.push_back(name + "=" + std::to_string(id) + ":" + std::to_string(mRobots[id].channel));
+    return id;
+}
+
+std::vector<std::string> Roster::takeAssignments()
+{
+    std::vector<std::string> messages;
+    std::string message;
+    for (const std::string &assignment : mAssignments)
+    {
+        if (!message.empty() && message.size() + assignment.size() + 1 > MAX_ASSIGNMENT_BYTES)
+        {
+            messages.push_back(message);
+            message.clear();
+        }
+        message += message.empty() ? "@" : ";";
+        message += assignment;
+    }
+    if (!message.empty())
+    {
+        messages.push_back(message);
+    }
+    mAssignments.clear();
+    return messages;
+}
+
+bool Roster::registered(int id) const
+{
+    return id > 0 && static_cast<std::size_t>(id) < mRobots.size() && mRobots[id].registered;
+}
+
+int Roster::channel(int id) const
+{
+    return registered(id) ? mRobots[id].channel : channelOf(id);
+}
+
+std::size_t Roster::size() const
+{
+    return mIds.size();
+}
+
+int Roster::requestedId(const std::string &name, int staffId)
+{
+    std::size_t digits{name.find_last_not_of("0123456789") + 1};
+    if (digits == name.size() || name.size() - digits > 9)
+    {
+        return staffId;
+    }
+    return std::atoi(name.c_str() + digits);
+}
+
+int Roster::channelOf(int id)
+{
+    return id;
+}
+
+bool Roster::findAssignment(const std::string &assignments, const std::string &name, int &id, int &channel)
+{
+    // Entries are "<name>=<id>:<channel>" separated by ';' after the leading '@'
+    std::size_t entry{1};
+    while (entry < assignments.size())
+    {
+        std::size_t end{assignments.find(';', entry)};
+        if (end == std::string::npos)
+        {
+            end = assignments.size();
+        }
+        std::size_t equals{assignments.find('=', entry)};
+        if (equals < end && assignments.compare(entry, equals - entry, name) == 0 && equals - entry == name.size())
+        {
+            id = std::atoi(assignments.c_str() + equals + 1);
+            std::size_t colon{assignments.find(':', equals)};
+            channel = (colon < end) ? std::atoi(assignments.c_str() + colon + 1) : channelOf(id);
+            return true;
+        }
+        entry = end + 1;
+    }
+    return false;
+}
+
+int Roster::nextFreeId()
+{
+    while (mNextFree > 0 && (registered(mNextFree) || mNextFree == mStaffId))
+    {
+        mNextFree--;
+    }
+    return mNextFree;
+}
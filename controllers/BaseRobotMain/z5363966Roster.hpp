@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Robot IDs and radio channels, handed out by the director at startup.
+ *
+ * A robot starts on the ID its name asks for (the number it ends with, the staff ID if it has none)
+ * and sends "@<name>" to the director's channel until it is answered. The director enrols it,
+ * keeping the requested ID unless another robot already holds it, in which case it gets the highest
+ * free ID, and answers every request of a time step with one broadcast "@<name>=<id>:<channel>;..."
+ * that robots still waiting pick their own entry from. A robot's channel is its ID, so any robot can
+ * address another from its ID alone.
+ * The director holds the roster in a dense array indexed by ID.
+ *
+ */
+class Roster {
+    public:
+        struct Robot {
+            std::string name;
+            int channel;
+            bool registered;
+        };
+
+        /**
+         * @brief Creates an empty roster
+         *
+         * @param staffId ID kept for the staff, the robot whose name has no number
+         */
+        explicit Roster(int);
+
+        /**
+         * @brief Enrols a robot, or returns the ID it was given if it is already enrolled
+         *
+         * @return int, 0 if the roster is full
+         */
+        int enrol(const std::string&);
+
+        /**
+         * @brief Broadcast messages answering the robots enrolled since the last call
+         *
+         * @return std::vector<std::string>, empty if nobody enrolled
+         */
+        std::vector<std::string> takeAssignments();
+
+        bool registered(int) const;
+
+        /**
+         * @brief Channel of a robot, its default channel if it has not registered
+         *
+         * @return int
+         */
+        int channel(int) const;
+
+        /**
+         * @brief Number of robots enrolled
+         *
+         * @return std::size_t
+         */
+        std::size_t size() const;
+
+        /**
+         * @brief ID a robot asks for: the number its name ends with, e.g. 12 for Customer12, or the
+         * staff ID if its name has none
+         *
+         * @return int
+         */
+        static int requestedId(const std::string&, int);
+
+        /**
+         * @brief Channel a robot listens on
+         *
+         * @return int
+         */
+        static int channelOf(int);
+
+        /**
+         * @brief Finds a robot's entry in an assignment broadcast
+         *
+         * @param assignments, name, id and channel set if found
+         * @return boolean
+         */
+        static bool findAssignment(const std::string&, const std::string&, int&, int&);
+
+        // Channel the director listens on, for registrations, staff status and completed orders
+        static constexpr int DIRECTOR_CHANNEL {0};
+
+        // IDs run from 1 to MAX_ROBOTS
+        static constexpr int MAX_ROBOTS {4095};
+
+    private:
+        // Highest free ID, for robots whose ID is taken, so they do not take the ID a robot yet to
+        // register will ask for
+        int nextFreeId();
+
+        std::vector<Robot> mRobots;
+        std::unordered_map<std::string, int> mIds;
+        std::vector<std::string> mAssignments;
+        int mStaffId;
+        int mNextFree;
+
+        // Longest assignment broadcast, so one message stays small whatever the fleet size
+        static constexpr std::size_t MAX_ASSIGNMENT_BYTES {1024};
+};
@@ -0,0 +1,127 @@
+#include "z5363966Route.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+std::vector<std::size_t> Route::plan(const RoutePoint &from, const std::vector<RoutePoint> &stops, const RoutePoint &to)
+{
+    std::size_t count{stops.size()};
+    std::vector<std::size_t> order;
+    if (count == 0)
+    {
+        return order;
+    }
+
+    if (count > MAX_EXACT_STOPS)
+    {
+        std::vector<bool> visited(count, false);
+        RoutePoint at{from};
+        for (std::size_t leg = 0; leg < count; leg++)
+        {
+            std::size_t next{count};
+            for (std::size_t stop = 0; stop < count; stop++)
+            {
+                if (!visited[stop] && (next == count || distance(at, stops[stop]) < distance(at, stops[next])))
+                {
+                    next = stop;
+                }
+            }
+            visited[next] = true;
+            order.push_back(next);
+            at = stops[next];
+        }
+        return order;
+    }
+
+    // best[visited * count + last] is the shortest path from the start through the visited stops,
+    // ending at last, and previous[] the stop before last on it
+    constexpr double NONE {std::numeric_limits<double>::infinity()};
+    std::size_t subsets{std::size_t{1} << count};
+    std::vector<double> best(subsets * count, NONE);
+    std::vector<std::size_t> previous(subsets * count, count);
+    for (std::size_t stop = 0; stop < count; stop++)
+    {
+        best[(std::size_t{1} << stop) * count + stop] = distance(from, stops[stop]);
+    }
+    for (std::size_t visited = 1; visited < subsets; visited++)
+    {
+        for (std::size_t last = 0; last < count; last++)
+        {
+            double length{best[visited * count + last]};
+            if (length == NONE)
+            {
+                continue;
+            }
+            for (std::size_t next = 0; next < count; next++)
+            {
+                std::size_t bit{std::size_t{1} << next};
+                if ((visited & bit) != 0)
+                {
+                    continue;
+                }
+                double extended{length + distance(stops[last], stops[next])};
+                std::size_t entry{(visited | bit) * count + next};
+                if (extended < best[entry])
+                {
+                    best[entry] = extended;
+                    previous[entry] = last;
+                }
+            }
+        }
+    }
+
+    std::size_t all{subsets - 1};
+    std::size_t last{0};
+    for (std::size_t stop = 1; stop < count; stop++)
+    {
+        if (best[all * count + stop] + distance(stops[stop], to) < best[all * count + last] + distance(stops[last], to))
+        {
+            last = stop;
+        }
+    }
+    for (std::size_t visited = all; last < count;)
+    {
+        order.push_back(last);
+        std::size_t before{previous[visited * count + last]};
+        visited &= ~(std::size_t{1} << last);
+        last = before;
+    }
+    return {order.rbegin(), order.rend()};
+}
+
+double Route::length(const RoutePoint &from, const std::vector<RoutePoint> &stops, const std::vector<std::size_t> &order,
+                     const RoutePoint &to)
+{
+    double total{0};
+    RoutePoint at{from};
+    for (std::size_t stop : order)
+    {
+        total += distance(at, stops[stop]);
+        at = stops[stop];
+    }
+    return total + distance(at, to);
+}
+
+double Route::roundTrips(const RoutePoint &base, const std::vector<RoutePoint> &stops, const RoutePoint &to)
+{
+    if (stops.empty())
+    {
+        return distance(base, to);
+    }
+    // The last trip goes on from its stop rather than back to the base, so ends at the stop that
+    // saves most by doing so
+    double total{0};
+    double lastSaving{-std::numeric_limits<double>::infinity()};
+    for (const RoutePoint &stop : stops)
+    {
+        total += 2 * distance(base, stop);
+        lastSaving = std::max(lastSaving, distance(base, stop) - distance(stop, to));
+    }
+    return total - lastSaving;
+}
+
+double Route::distance(const RoutePoint &from, const RoutePoint &to)
+{
+    return std::hypot(to.x - from.x, to.z - from.z);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Shortest order to visit a handful of stops on the cafeteria floor, e.g. the pickup slots a staff
+// delivers a batch of orders to on its way from the kitchen to its next station.
+//
+// A route starts at one point, visits every stop once and ends at another, and its length is the
+// sum of the straight line legs. Up to MAX_EXACT_STOPS stops are ordered exactly by dynamic
+// programming over the subsets of stops visited (Held-Karp), which is 2^n * n^2 steps but only a few
+// thousand for the batches a staff carries. Longer routes fall back to visiting the nearest stop
+// next.
+
+struct RoutePoint {
+    double x;   // [m]
+    double z;
+};
+
+class Route {
+    public:
+        /**
+         * @brief Orders the stops so the route is as short as possible
+         *
+         * @param from start of the route
+         * @param stops
+         * @param to end of the route, e.g. back at from for a round trip
+         * @return std::vector<std::size_t>, indices into stops in the order they are visited
+         */
+        static std::vector<std::size_t> plan(const RoutePoint&, const std::vector<RoutePoint>&, const RoutePoint&);
+
+        /**
+         * @brief Length of a route visiting the stops in the given order [m]
+         *
+         * @param from
+         * @param stops
+         * @param order indices into stops
+         * @param to
+         * @return double
+         */
+        static double length(const RoutePoint&, const std::vector<RoutePoint>&, const std::vector<std::size_t>&,
+                             const RoutePoint&);
+
+        /**
+         * @brief Length of serving every stop with its own round trip from a base, the last going on
+         * from its stop to the end of the route [m], what a route saves against. For a single stop
+         * it is the route itself.
+         *
+         * @param base e.g. the kitchen
+         * @param stops
+         * @param to
+         * @return double
+         */
+        static double roundTrips(const RoutePoint&, const std::vector<RoutePoint>&, const RoutePoint&);
+
+        static double distance(const RoutePoint&, const RoutePoint&);
+
+        static constexpr std::size_t MAX_EXACT_STOPS {10};
+};
@@ -0,0 +1,68 @@
+#include "z5363966Settings.hpp"
+
+Settings::Settings(const std::string &path)
+{
+    std::ifstream settingsFile{path, std::ifstream::in};
+    std::string lineInput;
+
+    // Skips the header line
+    std::getline(settingsFile, lineInput);
+    while (std::getline(settingsFile, lineInput))
+    {
+        if (!lineInput.empty() && lineInput.back() == '\r')
+        {
+            lineInput.pop_back();
+        }
+        std::size_t comma{lineInput.find(',')};
+        if (lineInput.empty() || lineInput[0] == '#' || comma == std::string::npos)
+        {
+            continue;
+        }
+        mValues[lineInput.substr(0, comma)] = lineInput.substr(comma + 1);
+    }
+}
+
+bool Settings::has(const std::string &key) const
+{
+    return mValues.count(key) != 0;
+}
+
+std::string Settings::getString(const std::string &key, const std::string &fallback) const
+{
+    auto it{mValues.find(key)};
+    return (it != mValues.end()) ? it->second : fallback;
+}
+
+double Settings::getDouble(const std::string &key, double fallback) const
+{
+    auto it{mValues.find(key)};
+    if (it == mValues.end())
+    {
+        return fallback;
+    }
+    try
+    {
+        return std::stod(it->second);
+    }
+    catch (const std::exception &)
+    {
+        return fallback;
+    }
+}
+
+int Settings::getInt(const std::string &key, int fallback) const
+{
+    auto it{mValues.find(key)};
+    if (it == mValues.end())
+    {
+        return fallback;
+    }
+    try
+    {
+        return std::stoi(it->second);
+    }
+    catch (const std::exception &)
+    {
+        return fallback;
+    }
+}
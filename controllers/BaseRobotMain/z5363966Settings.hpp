@@ -0,0 +1,47 @@
+#pragma once
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+class Settings {
+    public:
+        /**
+         * @brief Loads the simulation settings from a "Setting,Value" csv file. A missing file leaves
+         * every setting at the default supplied by the caller.
+         * 
+         */
+        explicit Settings(const std::string&);
+
+        /**
+         * @brief Checks whether a setting was provided in the settings file
+         * 
+         * @return boolean
+         */
+        bool has(const std::string&) const;
+
+        /**
+         * @brief Returns the setting as a string, or the fallback if not provided
+         * 
+         * @return std::string
+         */
+        std::string getString(const std::string&, const std::string&) const;
+
+        /**
+         * @brief Returns the setting as a double, or the fallback if not provided or malformed
+         * 
+         * @return double
+         */
+        double getDouble(const std::string&, double) const;
+
+        /**
+         * @brief Returns the setting as an int, or the fallback if not provided or malformed
+         * 
+         * @return int
+         */
+        int getInt(const std::string&, int) const;
+
+    private:
+        std::unordered_map<std::string, std::string> mValues;
+};
@@ -0,0 +1,139 @@
+#include "z5363966Snapshot.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <utility>
+
+void SnapshotWriter::putString(const std::string &value)
+{
+    put(static_cast<std::uint32_t>(value.size()));
+    mBytes.append(value);
+}
+
+const std::string& SnapshotWriter::bytes() const
+{
+    return mBytes;
+}
+
+SnapshotReader::SnapshotReader(std::string bytes)
+    : mBytes(std::move(bytes)),
+      mOffset(0),
+      mOk(true) {}
+
+std::string SnapshotReader::getString()
+{
+    std::uint32_t size{get<std::uint32_t>()};
+    if (!mOk || mOffset + size > mBytes.size())
+    {
+        mOk = false;
+        return "";
+    }
+    std::string value{mBytes.substr(mOffset, size)};
+    mOffset += size;
+    return value;
+}
+
+bool SnapshotReader::ok() const
+{
+    return mOk;
+}
+
+SnapshotStore::SnapshotStore(const std::string &source, const Settings &settings)
+    : mPathPrefix(settings.getString("snapshot_path", "../../Snapshot") + "_" + source),
+      mInterval(settings.getDouble("snapshot_interval", 0)),
+      mRestore(settings.getInt("snapshot_restore", 0) != 0),
+      mLastSnapshot(0),
+      mSequence(0)
+{
+    // Carries on the sequence of an earlier run, so new snapshots are always the newest
+    Header header;
+    std::string state;
+    for (std::uint64_t slot = 0; slot < 2; slot++)
+    {
+        if (read(path(slot), header, state) && header.sequence >= mSequence)
+        {
+            mSequence = header.sequence + 1;
+        }
+    }
+}
+
+bool SnapshotStore::due(double simTime)
+{
+    if (mInterval <= 0 || simTime - mLastSnapshot < mInterval)
+    {
+        return false;
+    }
+    mLastSnapshot = simTime;
+    return true;
+}
+
+void SnapshotStore::save(const SnapshotWriter &state, double simTime)
+{
+    Header header{{'C', 'A', 'F', 'E'}, VERSION, mSequence, simTime, state.bytes().size(), checksum(state.bytes())};
+    std::string finalPath{path(mSequence)};
+    std::string tmpPath{finalPath + ".tmp"};
+    {
+        std::ofstream snapshotFile{tmpPath, std::ios::out | std::ios::binary | std::ios::trunc};
+        snapshotFile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        snapshotFile.write(state.bytes().data(), static_cast<std::streamsize>(state.bytes().size()));
+    }
+    std::remove(finalPath.c_str());
+    std::rename(tmpPath.c_str(), finalPath.c_str());
+    mSequence++;
+}
+
+bool SnapshotStore::load(std::string &state, double &simTime)
+{
+    if (!mRestore)
+    {
+        return false;
+    }
+    bool found{false};
+    std::uint64_t newest{0};
+    for (std::uint64_t slot = 0; slot < 2; slot++)
+    {
+        Header header;
+        std::string slotState;
+        if (read(path(slot), header, slotState) && (!found || header.sequence > newest))
+        {
+            found = true;
+            newest = header.sequence;
+            simTime = header.simTime;
+            state = std::move(slotState);
+        }
+    }
+    return found;
+}
+
+bool SnapshotStore::read(const std::string &snapshotPath, Header &header, std::string &state) const
+{
+    std::ifstream snapshotFile{snapshotPath, std::ios::in | std::ios::binary};
+    if (!snapshotFile.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, "CAFE", 4) != 0 || header.version != VERSION || header.size > MAX_SIZE)
+    {
+        return false;
+    }
+    state.resize(header.size);
+    if (!snapshotFile.read(&state[0], static_cast<std::streamsize>(header.size)))
+    {
+        return false;
+    }
+    return checksum(state) == header.checksum;
+}
+
+std::string SnapshotStore::path(std::uint64_t sequence) const
+{
+    return mPathPrefix + "." + std::to_string(sequence % 2) + ".snap";
+}
+
+std::uint64_t SnapshotStore::checksum(const std::string &bytes)
+{
+    // 64 bit FNV-1a
+    std::uint64_t hash{14695981039346656037ULL};
+    for (unsigned char byte : bytes)
+    {
+        hash ^= byte;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+
+#include "z5363966Settings.hpp"
+
+// Binary snapshots of a controller's behavioural state.
+//
+// A controller writes its state field by field into a SnapshotWriter and reads it back in the same
+// order from a SnapshotReader. SnapshotStore keeps the two most recent snapshots in alternating
+// files, each with a sequence number and checksum, so a crash while writing one leaves the other
+// to restore from.
+//
+// Reading a snapshot back changes nothing by itself. It returns a SnapshotCommit holding what was
+// read, which the controller runs only once the whole snapshot was read, so one cut short leaves
+// the controller as it was.
+
+using SnapshotCommit = std::function<void()>;
+
+class SnapshotWriter {
+    public:
+        /**
+         * @brief Appends a trivially copyable value in native byte order
+         *
+         */
+        template <typename T>
+        void put(const T &value)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be written directly");
+            mBytes.append(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        /**
+         * @brief Appends a length prefixed string
+         *
+         */
+        void putString(const std::string&);
+
+        const std::string& bytes() const;
+
+    private:
+        std::string mBytes;
+};
+
+class SnapshotReader {
+    public:
+        explicit SnapshotReader(std::string);
+
+        /**
+         * @brief Reads the next value. Reading past the end returns a zero value and clears ok().
+         *
+         * @return T
+         */
+        template <typename T>
+        T get()
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable values can be read directly");
+            T value{};
+            if (mOffset + sizeof(T) > mBytes.size())
+            {
+                mOk = false;
+                return value;
+            }
+            std::memcpy(&value, mBytes.data() + mOffset, sizeof(T));
+            mOffset += sizeof(T);
+            return value;
+        }
+
+        /**
+         * @brief Reads the next length prefixed string
+         *
+         * @return std::string
+         */
+        std::string getString();
+
+        /**
+         * @brief Checks that every read so far was within the snapshot
+         *
+         * @return boolean
+         */
+        bool ok() const;
+
+    private:
+        std::string mBytes;
+        std::size_t mOffset;
+        bool mOk;
+};
+
+class SnapshotStore {
+    public:
+        /**
+         * @brief Reads snapshot_interval (simulated seconds, 0 disables snapshots), snapshot_path and
+         * snapshot_restore from the settings. Snapshots are written to <snapshot_path>_<source>.{0,1}.snap
+         *
+         */
+        SnapshotStore(const std::string&, const Settings&);
+
+        /**
+         * @brief Checks whether the snapshot interval has elapsed since the last snapshot
+         *
+         * @param simTime [s]
+         * @return boolean
+         */
+        bool due(double);
+
+        /**
+         * @brief Writes a snapshot into the older of the two files
+         *
+         * @param state, simTime [s]
+         */
+        void save(const SnapshotWriter&, double);
+
+        /**
+         * @brief Loads the newest snapshot whose checksum is valid, if restoring is enabled
+         *
+         * @param state bytes of the snapshot
+         * @param simTime time the snapshot was taken [s]
+         * @return boolean, false if restoring is disabled or there is no valid snapshot
+         */
+        bool load(std::string&, double&);
+
+    private:
+        struct Header {
+            char magic[4];
+            std::uint32_t version;
+            std::uint64_t sequence;
+            double simTime;
+            std::uint64_t size;
+            std::uint64_t checksum;
+        };
+
+        /**
+         * @brief Reads one snapshot file, returning false if it is missing, truncated or corrupt
+         *
+         * @return boolean
+         */
+        bool read(const std::string&, Header&, std::string&) const;
+
+        std::string path(std::uint64_t) const;
+
+        static std::uint64_t checksum(const std::string&);
+
+        std::string mPathPrefix;
+        double mInterval;
+        bool mRestore;
+        double mLastSnapshot;
+        std::uint64_t mSequence;
+
+        static constexpr std::uint32_t VERSION {8};
+        static constexpr std::uint64_t MAX_SIZE {std::uint64_t{1} << 26};
+};
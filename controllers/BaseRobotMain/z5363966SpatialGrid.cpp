@@ -0,0 +1,220 @@
+#include "z5363966SpatialGrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+SpatialGrid::SpatialGrid(double minX, double minZ, double width, double depth, double cellSize)
+    : mMinX(minX),
+      mMinZ(minZ),
+      mCellSize(cellSize),
+      mColumns(std::max(1, static_cast<int>(std::ceil(width / cellSize)))),
+      mRows(std::max(1, static_cast<int>(std::ceil(depth / cellSize)))),
+      mSize(0),
+      mHeads(static_cast<std::size_t>(mColumns) * mRows, NONE) {}
+
+SpatialGrid SpatialGrid::forArena(const std::string &worldPath, double cellSize)
+{
+    double width{3};
+    double depth{2};
+    std::ifstream worldFile(worldPath, std::ifstream::in);
+    std::string lineInput;
+    bool inArena{false};
+    while (std::getline(worldFile, lineInput))
+    {
+        if (lineInput.find("RectangleArena") != std::string::npos)
+        {
+            inArena = true;
+        }
+        else if (inArena && lineInput.find('}') != std::string::npos)
+        {
+            break;
+        }
+        else if (inArena && lineInput.find("floorSize") != std::string::npos)
+        {
+            std::istringstream floorSize(lineInput.substr(lineInput.find("floorSize") + 9));
+            floorSize >> width >> depth;
+        }
+    }
+    return SpatialGrid{-width / 2, -depth / 2, width, depth, cellSize};
+}
+
+void SpatialGrid::update(int id, double x, double z)
+{
+    if (static_cast<std::size_t>(id) >= mEntries.size())
+    {
+        mEntries.resize(id + 1, {0, 0, NO_CELL, NONE, NONE});
+    }
+    Entry &entry{mEntries[id]};
+    entry.x = x;
+    entry.z = z;
+    int cell{cellRow(z) * mColumns + cellColumn(x)};
+    if (entry.cell == cell)
+    {
+        return;
+    }
+    if (entry.cell == NO_CELL)
+    {
+        mSize++;
+    }
+    else
+    {
+        unlink(id);
+    }
+    link(id, cell);
+}
+
+void SpatialGrid::remove(int id)
+{
+    if (contains(id))
+    {
+        unlink(id);
+        mEntries[id].cell = NO_CELL;
+        mSize--;
+    }
+}
+
+bool SpatialGrid::contains(int id) const
+{
+    return id >= 0 && static_cast<std::size_t>(id) < mEntries.size() && mEntries[id].cell != NO_CELL;
+}
+
+void SpatialGrid::withinRadius(double x, double z, double radius, std::vector<int> &result, int exclude) const
+{
+    result.clear();
+    double radiusSquared{radius * radius};
+    int lastRow{cellRow(z + radius)};
+    int lastColumn{cellColumn(x + radius)};
+    for (int row = cellRow(z - radius); row <= lastRow; row++)
+    {
+        for (int column = cellColumn(x - radius); column <= lastColumn; column++)
+        {
+            for (int id = mHeads[row * mColumns + column]; id != NONE; id = mEntries[id].next)
+            {
+                double dx{mEntries[id].x - x};
+                double dz{mEntries[id].z - z};
+                if (id != exclude && dx * dx + dz * dz <= radiusSquared)
+                {
+                    result.push_back(id);
+                }
+            }
+        }
+    }
+}
+
+void SpatialGrid::nearest(double x, double z, std::size_t k, std::vector<int> &result, int exclude) const
+{
+    result.clear();
+    if (k == 0)
+    {
+        return;
+    }
+
+    // Max heap of the k nearest so far as {distance squared, id}, farthest on top
+    std::vector<std::pair<double, int>> best;
+    best.reserve(k + 1);
+    int centreRow{cellRow(z)};
+    int centreColumn{cellColumn(x)};
+    int maxRing{std::max({centreRow, mRows - 1 - centreRow, centreColumn, mColumns - 1 - centreColumn})};
+    for (int ring = 0; ring <= maxRing; ring++)
+    {
+        for (int row = std::max(0, centreRow - ring); row <= std::min(mRows - 1, centreRow + ring); row++)
+        {
+            // Inner rows of the ring only have its two edge cells
+            bool edgeRow{row == centreRow - ring || row == centreRow + ring};
+            int step{edgeRow ? 1 : 2 * ring};
+            for (int column = centreColumn - ring; column <= centreColumn + ring; column += step)
+            {
+                if (column < 0 || column >= mColumns)
+                {
+                    continue;
+                }
+                for (int id = mHeads[row * mColumns + column]; id != NONE; id = mEntries[id].next)
+                {
+                    if (id == exclude)
+                    {
+                        continue;
+                    }
+                    double dx{mEntries[id].x - x};
+                    double dz{mEntries[id].z - z};
+                    double distanceSquared{dx * dx + dz * dz};
+                    if (best.size() < k || distanceSquared < best.front().first)
+                    {
+                        best.push_back({distanceSquared, id});
+                        std::push_heap(best.begin(), best.end());
+                        if (best.size() > k)
+                        {
+                            std::pop_heap(best.begin(), best.end());
+                            best.pop_back();
+                        }
+                    }
+                }
+            }
+        }
+
+        // Robots beyond this ring are at least ring cells away from the query's cell
+        double reach{ring * mCellSize};
+        if (best.size() == k && best.front().first <= reach * reach)
+        {
+            break;
+        }
+    }
+
+    std::sort_heap(best.begin(), best.end());
+    for (const auto &neighbour : best)
+    {
+        result.push_back(neighbour.second);
+    }
+}
+
+std::size_t SpatialGrid::size() const
+{
+    return mSize;
+}
+
+double SpatialGrid::cellSize() const
+{
+    return mCellSize;
+}
+
+int SpatialGrid::cellColumn(double x) const
+{
+    return std::clamp(static_cast<int>(std::floor((x - mMinX) / mCellSize)), 0, mColumns - 1);
+}
+
+int SpatialGrid::cellRow(double z) const
+{
+    return std::clamp(static_cast<int>(std::floor((z - mMinZ) / mCellSize)), 0, mRows - 1);
+}
+
+void SpatialGrid::link(int id, int cell)
+{
+    Entry &entry{mEntries[id]};
+    entry.cell = cell;
+    entry.prev = NONE;
+    entry.next = mHeads[cell];
+    if (entry.next != NONE)
+    {
+        mEntries[entry.next].prev = id;
+    }
+    mHeads[cell] = id;
+}
+
+void SpatialGrid::unlink(int id)
+{
+    Entry &entry{mEntries[id]};
+    if (entry.prev != NONE)
+    {
+        mEntries[entry.prev].next = entry.next;
+    }
+    else
+    {
+        mHeads[entry.cell] = entry.next;
+    }
+    if (entry.next != NONE)
+    {
+        mEntries[entry.next].prev = entry.prev;
+    }
+}
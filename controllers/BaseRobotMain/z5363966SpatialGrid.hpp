@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Uniform grid spatial hash of robot positions on the cafeteria floor.
+//
+// The floor is split into square cells, and each cell keeps the robots inside it in an intrusive
+// linked list threaded through a dense array indexed by robot ID, so moving a robot within its cell
+// only stores its new position and moving it to another cell relinks it without allocating. Radius
+// queries scan the cells overlapping the circle and k-nearest queries scan rings of cells outwards
+// until no unscanned cell can hold a closer robot, so both cost the robots nearby rather than the
+// whole fleet. Positions off the floor count as being in the nearest edge cell.
+
+class SpatialGrid {
+    public:
+        /**
+         * @brief Creates an empty grid over a floor
+         *
+         * @param minX, minZ corner of the floor [m]
+         * @param width, depth along x and z [m]
+         * @param cellSize [m], e.g. the spacing robots keep between them
+         */
+        SpatialGrid(double, double, double, double, double);
+
+        /**
+         * @brief Creates a grid over the RectangleArena of a Webots world, centred on the origin as
+         * the arena is. Falls back to the 3 m by 2 m cafeteria floor if the world has no arena.
+         *
+         * @param worldPath e.g. ../../worlds/MTRN2500.wbt
+         * @param cellSize [m]
+         * @return SpatialGrid
+         */
+        static SpatialGrid forArena(const std::string&, double);
+
+        /**
+         * @brief Inserts a robot, or moves it if it is already in the grid
+         *
+         * @param id robot ID, >= 0
+         * @param x, z position [m]
+         */
+        void update(int, double, double);
+
+        void remove(int);
+
+        bool contains(int) const;
+
+        /**
+         * @brief Robots within radius of a point, in no particular order
+         *
+         * @param x, z, radius [m]
+         * @param result cleared first
+         * @param exclude robot ID to leave out, e.g. the robot asking, -1 for none
+         */
+        void withinRadius(double, double, double, std::vector<int>&, int exclude = -1) const;
+
+        /**
+         * @brief The k robots nearest a point, nearest first
+         *
+         * @param x, z position [m]
+         * @param k at most this many robots
+         * @param result cleared first
+         * @param exclude robot ID to leave out, -1 for none
+         */
+        void nearest(double, double, std::size_t, std::vector<int>&, int exclude = -1) const;
+
+        /**
+         * @brief Number of robots in the grid
+         *
+         * @return std::size_t
+         */
+        std::size_t size() const;
+
+        double cellSize() const;
+
+    private:
+        struct Entry {
+            double x;
+            double z;
+            int cell;   // NO_CELL if the robot is not in the grid
+            int prev;
+            int next;
+        };
+
+        int cellColumn(double) const;
+        int cellRow(double) const;
+        void link(int, int);
+        void unlink(int);
+
+        double mMinX;
+        double mMinZ;
+        double mCellSize;
+        int mColumns;
+        int mRows;
+        std::size_t mSize;
+
+        // Robots by ID, and the first robot of each cell's list
+        std::vector<Entry> mEntries;
+        std::vector<int> mHeads;
+
+        static constexpr int NO_CELL {-1};
+        static constexpr int NONE {-1};
+};
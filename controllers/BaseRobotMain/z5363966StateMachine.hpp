@@ -0,0 +1,313 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Header-only state machine used by every robot behaviour.
+//
+// States are an enum class whose last enumerator is COUNT. The allowed transitions and the
+// behaviour of every state are given as types, so the tables are validated by the compiler and
+// dispatch is a lookup into a constant jump table (no switch, no virtual call).
+
+/**
+ * @brief Index of a state in the jump table
+ *
+ * @return std::size_t
+ */
+template <typename State>
+constexpr std::size_t stateIndex(State state)
+{
+    return static_cast<std::size_t>(state);
+}
+
+/**
+ * @brief Number of states, given by the COUNT enumerator
+ *
+ * @return std::size_t
+ */
+template <typename State>
+constexpr std::size_t stateCount()
+{
+    return stateIndex(State::COUNT);
+}
+
+/**
+ * @brief An allowed transition From -> To
+ *
+ */
+template <typename State, State From, State To>
+struct StateEdge {};
+
+/**
+ * @brief The step action run every time step while in state S, with optional entry and exit actions
+ *
+ */
+template <typename Owner, typename State, State S, void (Owner::*Step)(), void (Owner::*Entry)() = nullptr,
+          void (Owner::*Exit)() = nullptr>
+struct StateBehaviour {};
+
+template <typename State, typename... Edges>
+struct TransitionTable;
+
+template <typename State, State... From, State... To>
+struct TransitionTable<State, StateEdge<State, From, To>...> {
+    static_assert(std::is_enum<State>::value, "States must be an enum class");
+    static_assert(sizeof...(From) > 0, "A transition table needs at least one transition");
+    static_assert(stateCount<State>() <= 64, "Transition rows are stored as 64 bit masks");
+
+    // One bit per target state for every source state
+    struct Rows {
+        std::uint64_t bits[stateCount<State>()];
+    };
+
+    /**
+     * @brief Checks whether From -> To is in the table
+     *
+     * @return boolean
+     */
+    static constexpr bool allows(State from, State to)
+    {
+        const State froms[] = {From...};
+        const State tos[] = {To...};
+        for (std::size_t i = 0; i < sizeof...(From); i++)
+        {
+            if (froms[i] == from && tos[i] == to)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Checks that every transition names a real state and appears only once
+     *
+     * @return boolean
+     */
+    static constexpr bool valid()
+    {
+        const State froms[] = {From...};
+        const State tos[] = {To...};
+        for (std::size_t i = 0; i < sizeof...(From); i++)
+        {
+            if (stateIndex(froms[i]) >= stateCount<State>() || stateIndex(tos[i]) >= stateCount<State>())
+            {
+                return false;
+            }
+            for (std::size_t j = i + 1; j < sizeof...(From); j++)
+            {
+                if (froms[i] == froms[j] && tos[i] == tos[j])
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    static constexpr Rows buildRows()
+    {
+        Rows rows{};
+        const State froms[] = {From...};
+        const State tos[] = {To...};
+        for (std::size_t i = 0; i < sizeof...(From); i++)
+        {
+            rows.bits[stateIndex(froms[i])] |= std::uint64_t{1} << stateIndex(tos[i]);
+        }
+        return rows;
+    }
+};
+
+template <typename Owner, typename State, typename... Behaviours>
+struct BehaviourTable;
+
+template <typename Owner, typename State, State... S, void (Owner::*... Step)(), void (Owner::*... Entry)(),
+          void (Owner::*... Exit)()>
+struct BehaviourTable<Owner, State, StateBehaviour<Owner, State, S, Step, Entry, Exit>...> {
+    using Action = void (Owner::*)();
+
+    // Every action is wrapped in a function that calls it directly, so dispatch is a single
+    // indirect call instead of a call through a member function pointer
+    using Thunk = void (*)(Owner&);
+
+    struct Jump {
+        Thunk step[stateCount<State>()];
+        Thunk entry[stateCount<State>()];
+        Thunk exit[stateCount<State>()];
+    };
+
+    template <Action A>
+    static void call(Owner &owner)
+    {
+        (owner.*A)();
+    }
+
+    template <Action A>
+    static constexpr Thunk thunk()
+    {
+        return (A == nullptr) ? nullptr : &call<A>;
+    }
+
+    /**
+     * @brief Checks that every state has exactly one behaviour
+     *
+     * @return boolean
+     */
+    static constexpr bool complete()
+    {
+        const State states[] = {S...};
+        for (std::size_t state = 0; state < stateCount<State>(); state++)
+        {
+            std::size_t found{0};
+            for (std::size_t i = 0; i < sizeof...(S); i++)
+            {
+                if (stateIndex(states[i]) == state)
+                {
+                    found++;
+                }
+            }
+            if (found != 1)
+            {
+                return false;
+            }
+        }
+        return sizeof...(S) == stateCount<State>();
+    }
+
+    static constexpr Jump buildJump()
+    {
+        Jump jump{};
+        const State states[] = {S...};
+        const Thunk steps[] = {thunk<Step>()...};
+        const Thunk entries[] = {thunk<Entry>()...};
+        const Thunk exits[] = {thunk<Exit>()...};
+        for (std::size_t i = 0; i < sizeof...(S); i++)
+        {
+            jump.step[stateIndex(states[i])] = steps[i];
+            jump.entry[stateIndex(states[i])] = entries[i];
+            jump.exit[stateIndex(states[i])] = exits[i];
+        }
+        return jump;
+    }
+};
+
+template <typename Owner, typename State, typename Transitions, typename Behaviours>
+class StateMachine {
+    public:
+        static_assert(Transitions::valid(), "Transition table names an unknown state or repeats a transition");
+        static_assert(Behaviours::complete(), "Every state needs exactly one behaviour");
+
+        /**
+         * @brief Constructs the machine in its initial state. The initial entry action is not run.
+         *
+         */
+        StateMachine(Owner &owner, State initial)
+            : mOwner(owner),
+              mState(initial) {}
+
+        /**
+         * @brief Returns the current state
+         *
+         * @return State
+         */
+        State current() const
+        {
+            return mState;
+        }
+
+        /**
+         * @brief Checks whether the machine is in the given state
+         *
+         * @return boolean
+         */
+        bool is(State state) const
+        {
+            return mState == state;
+        }
+
+        /**
+         * @brief Runs the step action of the current state
+         *
+         */
+        void step()
+        {
+            JUMP.step[stateIndex(mState)](mOwner);
+        }
+
+        /**
+         * @brief Transition whose source is known where it is written. Rejected at compile time
+         * if From -> To is not in the table.
+         *
+         */
+        template <State From, State To>
+        void transition()
+        {
+            static_assert(Transitions::allows(From, To), "Transition is not in the transition table");
+            assert(mState == From);
+            change(To);
+        }
+
+        /**
+         * @brief Transition from whichever state the machine is in, e.g. when a message arrives.
+         * Checked against the table at runtime.
+         *
+         * @return boolean, false if the transition is not allowed and the state was kept
+         */
+        bool transitionTo(State to)
+        {
+            if (!allowed(mState, to))
+            {
+                return false;
+            }
+            change(to);
+            return true;
+        }
+
+        /**
+         * @brief Puts the machine back into a state saved in a snapshot. No entry or exit action is run.
+         *
+         */
+        void restore(State state)
+        {
+            assert(stateIndex(state) < stateCount<State>());
+            mState = state;
+        }
+
+        /**
+         * @brief Checks a transition against the table
+         *
+         * @return boolean
+         */
+        static bool allowed(State from, State to)
+        {
+            return (ROWS.bits[stateIndex(from)] >> stateIndex(to)) & 1;
+        }
+
+    private:
+        void change(State to)
+        {
+            if (JUMP.exit[stateIndex(mState)] != nullptr)
+            {
+                JUMP.exit[stateIndex(mState)](mOwner);
+            }
+            mState = to;
+            if (JUMP.entry[stateIndex(mState)] != nullptr)
+            {
+                JUMP.entry[stateIndex(mState)](mOwner);
+            }
+        }
+
+        static constexpr typename Transitions::Rows ROWS {Transitions::buildRows()};
+        static constexpr typename Behaviours::Jump JUMP {Behaviours::buildJump()};
+
+        Owner &mOwner;
+        State mState;
+};
+
+template <typename Owner, typename State, typename Transitions, typename Behaviours>
+constexpr typename Transitions::Rows StateMachine<Owner, State, Transitions, Behaviours>::ROWS;
+
+template <typename Owner, typename State, typename Transitions, typename Behaviours>
+constexpr typename Behaviours::Jump StateMachine<Owner, State, Transitions, Behaviours>::JUMP;
@@ -0,0 +1,245 @@
+#include "z5363966Teleop.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "z5363966Logger.hpp"
+
+constexpr char Teleop::MAGIC[4];
+
+namespace {
+    // Recorded velocities are whole mrad/s in 16 bits, well beyond the e-puck's 6.28 rad/s
+    constexpr float MILLI {1000};
+    constexpr float MAX_VELOCITY {32.767f};
+}
+
+Teleop::Teleop(const std::string &robotName, const Settings &settings)
+    : mAddress(settings.getString("teleop_address", "")),
+      mSocket(-1),
+      mOpened(false),
+      mReplayPending(false),
+      mPendingStep(0),
+      mPending{},
+      mStep(0),
+      mLastRecordedStep(0),
+      mLastReplayedStep(0),
+      mLastLatency(0),
+      mSuperseded(0)
+{
+    if (mAddress.rfind("unix:", 0) == 0)
+    {
+        mSocketPath = mAddress.substr(5) + "_" + robotName;
+    }
+    std::string recordPrefix{settings.getString("teleop_record", "")};
+    if (!recordPrefix.empty())
+    {
+        mRecordPath = recordPrefix + "_" + robotName + ".tlp";
+    }
+    std::string replayPrefix{settings.getString("teleop_replay", "")};
+    if (!replayPrefix.empty())
+    {
+        mReplayPath = replayPrefix + "_" + robotName + ".tlp";
+    }
+}
+
+Teleop::~Teleop()
+{
+#ifndef _WIN32
+    if (mSocket >= 0)
+    {
+        close(mSocket);
+        if (!mSocketPath.empty())
+        {
+            unlink(mSocketPath.c_str());
+        }
+    }
+#endif
+}
+
+bool Teleop::enabled() const
+{
+    return !mAddress.empty() || !mReplayPath.empty();
+}
+
+bool Teleop::poll(int robotId, TeleopCommand &command)
+{
+    if (!enabled())
+    {
+        return false;
+    }
+    if (!mOpened)
+    {
+        mOpened = true;
+        if (!mReplayPath.empty())
+        {
+            mReplaying.open(mReplayPath, std::ios::in | std::ios::binary);
+            char magic[sizeof(MAGIC)]{};
+            mReplaying.read(magic, sizeof(magic));
+            if (!mReplaying || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0)
+            {
+                LOG_ERROR("Teleop: cannot replay ", mReplayPath);
+                mReplaying.close();
+            }
+        }
+        else if (!openSocket(robotId))
+        {
+            LOG_ERROR("Teleop: cannot listen on ", mAddress);
+        }
+        if (!mRecordPath.empty())
+        {
+            mRecording.open(mRecordPath, std::ios::out | std::ios::binary | std::ios::trunc);
+            mRecording.write(MAGIC, sizeof(MAGIC));
+        }
+    }
+
+    bool received{false};
+    mSuperseded = 0;
+    if (mReplaying.is_open())
+    {
+        received = replay(command);
+    }
+#ifndef _WIN32
+    else if (mSocket >= 0)
+    {
+        // Only the latest command counts, so a burst between steps costs one step of latency
+        TeleopCommand datagram;
+        while (recv(mSocket, &datagram, sizeof(datagram), MSG_DONTWAIT) == static_cast<ssize_t>(COMMAND_BYTES))
+        {
+            mSuperseded += received ? 1 : 0;
+            command = datagram;
+            received = true;
+        }
+        if (received)
+        {
+            command.left = quantise(command.left);
+            command.right = quantise(command.right);
+            auto now{std::chrono::system_clock::now().time_since_epoch()};
+            mLastLatency = (std::chrono::duration_cast<std::chrono::nanoseconds>(now).count() - command.sentNs) / 1e9;
+        }
+    }
+#endif
+
+    if (received && mRecording.is_open())
+    {
+        record(command);
+    }
+    mStep++;
+    return received;
+}
+
+double Teleop::lastLatency() const
+{
+    return mLastLatency;
+}
+
+std::uint64_t Teleop::superseded() const
+{
+    return mSuperseded;
+}
+
+float Teleop::quantise(float velocity)
+{
+    return std::round(std::clamp(velocity, -MAX_VELOCITY, MAX_VELOCITY) * MILLI) / MILLI;
+}
+
+bool Teleop::openSocket(int robotId)
+{
+#ifndef _WIN32
+    if (!mSocketPath.empty())
+    {
+        // Unix domain sockets cannot be reached from outside the machine
+        mSocket = socket(AF_UNIX, SOCK_DGRAM, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        mSocketPath.copy(address.sun_path, sizeof(address.sun_path) - 1);
+        unlink(mSocketPath.c_str());
+        if (mSocket >= 0 && bind(mSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0)
+        {
+            return true;
+        }
+    }
+    else if (mAddress.rfind("udp:", 0) == 0)
+    {
+        // Bound to the loopback interface only
+        mSocket = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<std::uint16_t>(std::atoi(mAddress.c_str() + 4) + robotId));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (mSocket >= 0 && bind(mSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0)
+        {
+            return true;
+        }
+    }
+    if (mSocket >= 0)
+    {
+        close(mSocket);
+        mSocket = -1;
+    }
+#else
+    (void)robotId;
+#endif
+    return false;
+}
+
+void Teleop::record(const TeleopCommand &command)
+{
+    // Each record is the steps since the last one as a varint, then both velocities in mrad/s
+    std::uint64_t delta{mStep - mLastRecordedStep};
+    mLastRecordedStep = mStep;
+    do
+    {
+        char byte{static_cast<char>((delta & 0x7f) | ((delta > 0x7f) ? 0x80 : 0))};
+        mRecording.put(byte);
+        delta >>= 7;
+    } while (delta > 0);
+    std::int16_t velocities[2]{static_cast<std::int16_t>(std::lround(command.left * MILLI)),
+                               static_cast<std::int16_t>(std::lround(command.right * MILLI))};
+    mRecording.write(reinterpret_cast<const char *>(velocities), sizeof(velocities));
+    mRecording.flush();
+}
+
+bool Teleop::replay(TeleopCommand &command)
+{
+    if (!mReplayPending)
+    {
+        std::uint64_t delta{0};
+        int shift{0};
+        int byte{0};
+        do
+        {
+            byte = mReplaying.get();
+            delta |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            shift += 7;
+        } while (mReplaying && (byte & 0x80) != 0);
+        std::int16_t velocities[2]{};
+        mReplaying.read(reinterpret_cast<char *>(velocities), sizeof(velocities));
+        if (!mReplaying)
+        {
+            return false;
+        }
+        mPendingStep = mLastReplayedStep + delta;
+        mLastReplayedStep = mPendingStep;
+        mPending = {mPending.sequence + 1, 0, velocities[0] / MILLI, velocities[1] / MILLI};
+        mReplayPending = true;
+    }
+    if (mPendingStep != mStep)
+    {
+        return false;
+    }
+    command = mPending;
+    mReplayPending = false;
+    return true;
+}
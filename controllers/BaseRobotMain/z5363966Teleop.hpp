@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "z5363966Settings.hpp"
+
+// Teleoperation of a robot in remote mode over a local socket, instead of the Webots keyboard.
+//
+// A client sends each velocity command as one datagram to the robot's endpoint: the Unix domain
+// socket <path>_<robot name> for a teleop_address of "unix:<path>", or 127.0.0.1 port <port> + robot
+// ID for "udp:<port>". The robot applies the latest command on its next step and measures the
+// latency from the time the client stamped on it.
+//
+// Applied commands can be recorded to <teleop_record>_<robot name>.tlp and replayed from
+// <teleop_replay>_<robot name>.tlp instead of the socket. A recording holds the step each command
+// was applied on and its wheel velocities quantised to mrad/s, which live commands are quantised to
+// as well, so a replay drives the robot exactly as the session did.
+
+// A velocity command as sent by a client, in native byte order
+struct TeleopCommand {
+    std::uint32_t sequence;
+    std::int64_t sentNs;    // client's system clock when it sent the command [ns since epoch]
+    float left;             // wheel velocities [rad/s], negative for backward
+    float right;
+};
+
+class Teleop {
+    public:
+        /**
+         * @brief Reads teleop_address, teleop_record and teleop_replay from the settings. Nothing is
+         * opened until the first poll.
+         *
+         * @param robotName
+         * @param settings
+         */
+        Teleop(const std::string&, const Settings&);
+        ~Teleop();
+
+        Teleop(const Teleop&) = delete;
+        Teleop& operator=(const Teleop&) = delete;
+
+        /**
+         * @brief Whether a socket or a replay is configured
+         *
+         * @return boolean
+         */
+        bool enabled() const;
+
+        /**
+         * @brief Takes the command to apply on this step, once per step in remote mode. Commands that
+         * arrived since the last step are drained and all but the latest are superseded.
+         *
+         * @param robotId for the UDP port, the socket is opened on the first poll
+         * @param command filled in with the command to apply
+         * @return boolean, false if there is no new command this step
+         */
+        bool poll(int, TeleopCommand&);
+
+        /**
+         * @brief Latency of the last live command, from the client sending it to it being applied [s]
+         *
+         * @return double, 0 before the first live command or when replaying
+         */
+        double lastLatency() const;
+
+        /**
+         * @brief Commands the last poll drained that were superseded by a later one
+         *
+         * @return std::uint64_t
+         */
+        std::uint64_t superseded() const;
+
+        /**
+         * @brief Wheel velocity [rad/s] as it is recorded, quantised to mrad/s
+         *
+         * @return float
+         */
+        static float quantise(float);
+
+        static constexpr std::size_t COMMAND_BYTES {sizeof(TeleopCommand)};
+
+    private:
+        bool openSocket(int);
+        void record(const TeleopCommand&);
+        bool replay(TeleopCommand&);
+
+        std::string mAddress;
+        std::string mSocketPath;
+        std::string mRecordPath;
+        std::string mReplayPath;
+        int mSocket;
+        bool mOpened;
+        std::ofstream mRecording;
+        std::ifstream mReplaying;
+        bool mReplayPending;
+        std::uint64_t mPendingStep;
+        TeleopCommand mPending;
+
+        // Steps polled so far, and the steps of the last recorded and replayed commands
+        std::uint64_t mStep;
+        std::uint64_t mLastRecordedStep;
+        std::uint64_t mLastReplayedStep;
+
+        double mLastLatency;
+        std::uint64_t mSuperseded;
+
+        static constexpr char MAGIC[4] {'T', 'L', 'P', '1'};
+};
@@ -0,0 +1,113 @@
+#include "z5363966WebotsDevices.hpp"
+
+#include <cmath>
+
+WebotsDevices::WebotsDevices()
+    : mRobot(),
+      mEmitter(mRobot.getEmitter("emitter")),
+      mReceiver(mRobot.getReceiver("receiver")),
+      mGPS(mRobot.getGPS("gps")),
+      mCompass(mRobot.getCompass("compass")),
+      mMotors{mRobot.getMotor("left wheel motor"), mRobot.getMotor("right wheel motor")} {}
+
+void WebotsDevices::enable(int timeStep)
+{
+    mKeyboard.enable(timeStep);
+    mReceiver->enable(timeStep);
+    if (mGPS != nullptr && mCompass != nullptr)
+    {
+        mGPS->enable(timeStep);
+        mCompass->enable(timeStep);
+    }
+}
+
+int WebotsDevices::step(int timeStep)
+{
+    return mRobot.step(timeStep);
+}
+
+double WebotsDevices::time() const
+{
+    return mRobot.getTime();
+}
+
+std::string WebotsDevices::name() const
+{
+    return mRobot.getName();
+}
+
+int WebotsDevices::key()
+{
+    return mKeyboard.getKey();
+}
+
+void WebotsDevices::send(int channel, const std::string &data)
+{
+    mEmitter->setChannel(channel);
+    mEmitter->send(data.data(), static_cast<int>(data.size() + 1));
+}
+
+bool WebotsDevices::receive(std::string &data)
+{
+    if (mReceiver->getQueueLength() == 0)
+    {
+        return false;
+    }
+    data = static_cast<const char *>(mReceiver->getData());
+    mReceiver->nextPacket();
+    return true;
+}
+
+void WebotsDevices::listen(int channel)
+{
+    mReceiver->setChannel(channel);
+}
+
+std::array<double, 3> WebotsDevices::position() const
+{
+    if (mGPS == nullptr)
+    {
+        return {0, 0, 0};
+    }
+    const double *gpsValues{mGPS->getValues()};
+    return {gpsValues[0], gpsValues[1], gpsValues[2]};
+}
+
+std::array<double, 3> WebotsDevices::north() const
+{
+    if (mCompass == nullptr)
+    {
+        return {0, 0, 0};
+    }
+    const double *compassValues{mCompass->getValues()};
+    return {compassValues[0], compassValues[1], compassValues[2]};
+}
+
+double WebotsDevices::maxMotorVelocity() const
+{
+    webots::Motor *motor{mMotors[static_cast<std::size_t>(Wheel::LEFT)]};
+    return (motor != nullptr) ? motor->getMaxVelocity() : 0;
+}
+
+void WebotsDevices::velocityControl(Wheel wheel)
+{
+    webots::Motor *motor{mMotors[static_cast<std::size_t>(wheel)]};
+    if (motor != nullptr)
+    {
+        motor->setPosition(INFINITY);
+    }
+}
+
+void WebotsDevices::setMotorVelocity(Wheel wheel, double velocity)
+{
+    webots::Motor *motor{mMotors[static_cast<std::size_t>(wheel)]};
+    if (motor != nullptr)
+    {
+        motor->setVelocity(velocity);
+    }
+}
+
+std::unique_ptr<RobotDevices> makeWebotsDevices()
+{
+    return std::make_unique<WebotsDevices>();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+
+#include <webots/Robot.hpp>
+#include <webots/Keyboard.hpp>
+#include <webots/Emitter.hpp>
+#include <webots/Receiver.hpp>
+#include <webots/Motor.hpp>
+#include <webots/GPS.hpp>
+#include <webots/Compass.hpp>
+
+#include "z5363966Devices.hpp"
+
+/**
+ * @brief RobotDevices of a robot in Webots. The director has only a keyboard and radio, so on it
+ * the GPS, compass and motors read zero and ignore commands.
+ *
+ */
+class WebotsDevices : public RobotDevices {
+    public:
+        WebotsDevices();
+
+        void enable(int) override;
+        int step(int) override;
+        double time() const override;
+        std::string name() const override;
+        int key() override;
+        void send(int, const std::string&) override;
+        bool receive(std::string&) override;
+        void listen(int) override;
+        std::array<double, 3> position() const override;
+        std::array<double, 3> north() const override;
+        double maxMotorVelocity() const override;
+        void velocityControl(Wheel) override;
+        void setMotorVelocity(Wheel, double) override;
+
+    private:
+        webots::Robot mRobot;
+        webots::Keyboard mKeyboard;
+        webots::Emitter *mEmitter;
+        webots::Receiver *mReceiver;
+        webots::GPS *mGPS;
+        webots::Compass *mCompass;
+        std::array<webots::Motor *, static_cast<std::size_t>(Wheel::COUNT)> mMotors;
+
+        static_assert(KEY_LEFT == webots::Keyboard::LEFT && KEY_UP == webots::Keyboard::UP &&
+                      KEY_RIGHT == webots::Keyboard::RIGHT && KEY_DOWN == webots::Keyboard::DOWN,
+                      "Arrow key codes must match webots::Keyboard");
+};
@@ -1,36 +1,61 @@
 #include "z5363966CustomerRobot.hpp"
 
-CustomerRobot::CustomerRobot()
-    : BaseRobot(),
-      currentOrderItemExists(false),
-      orderReady(false) {}
+CustomerRobot::CustomerRobot(std::unique_ptr<RobotDevices> devices)
+    : BaseRobot(std::move(devices)),
+      mOrder(""),
+      mStage(OrderStage::NONE),
+      mNextMenuRequest(0),
+      mCounters(mSettings),
+      mCounter(0),
+      mPreorderEnabled(mSettings.getInt("preorder", 0) != 0),
+      mPreorder(PreorderState::NONE),
+      mPaidTime(0),
+      mPaymentCounter(0),
+      mClosingDeadline(-1),
+      dispatchTime(0),
+      phaseStartTime(0)
+{
+    mMetrics.describe("cafe_customer_phase_seconds", "histogram", "Customer time spent in each phase of an order");
+    mMetrics.describe("cafe_customer_order_seconds", "histogram", "Customer time from dispatch to pickup");
+    mMetrics.describe("cafe_customer_orders_total", "counter", "Orders handled by the customer by outcome");
+    mMetrics.describe("cafe_customer_trips_saved_total", "counter", "Orders turned away before reaching the counter, by the menu replica or a pre-order that fell through");
+    mMetrics.describe("cafe_customer_preorder_head_start_seconds", "histogram", "Time a pre-order was paid for before the customer reached the counter");
+    mMetrics.describe("cafe_customer_wasted_trips_total", "counter", "Walks to the counter for an order the staff rejected");
+    mMetrics.describe("cafe_customer_counter_choices_total", "counter", "Orders taken to each counter, with more than one counter");
+}
 
 void CustomerRobot::run()
 {
-    // Initial mode: waits for what mode to enter into
+    start();
 
-    while (step(TIME_STEP) != -1)
-    {
-        this->currentKey = mKeyboard.getKey();
+    while (step(TIME_STEP) != -1 && update()) {}
+}
 
-        // Find when a message is received to go into auto or remote mode
-        currentData = receiveMessage();
-        currentHeading = updateHeading();
-        updatePosition();
-        processData();
+void CustomerRobot::start()
+{
+    // Initial mode: waits for what mode to enter into, unless carrying on from a snapshot
+    restoreSnapshot();
+}
 
-        switch (state)
-        {
-        case REMOTE:
-            remoteControl();
-            break;
-        case AUTO:
-            autoMode();
-            break;
-        case END:
-            return;
-        }
-    }
+bool CustomerRobot::update()
+{
+    this->currentKey = mDevices->key();
+    updateRegistration();
+    requestMenu();
+
+    // Find when a message is received to go into auto or remote mode
+    currentData = receiveMessage();
+    currentHeading = updateHeading();
+    updatePosition();
+    recordPose();
+    processData();
+    mActuators.report(mMetrics);
+    mMetrics.update(getTime());
+    updateSnapshot();
+    updateClosing();
+
+    mControl.step();
+    return !mControl.is(ControlState::END);
 }
 
 void CustomerRobot::remoteControl()
@@ -63,8 +88,8 @@ void CustomerRobot::remoteControl()
             break;
         case 'e':
             halt();
-            state = END;
-            std::cout << "Director: Remote mode was exited!" << std::endl;
+            mControl.transition<ControlState::REMOTE, ControlState::END>();
+            LOG_INFO("Director: Remote mode was exited!");
         }
         setMotorSpeed();
     }
@@ -72,59 +97,119 @@ void CustomerRobot::remoteControl()
 
 void CustomerRobot::autoMode()
 {
-    switch (autoState)
+    mExecutor.step(getTime());
+}
+
+Task CustomerRobot::orderWorkflow(std::string order, OrderStage from)
+{
+    mOrder = order;
+    bool arrived{true};
+    if (from <= OrderStage::TO_ORDER_COUNTER)
     {
-    case AUTO_IDLE:
-        if (purchaseConfirmation && orderReady)
+        dispatchTime = phaseStartTime = getTime();
+        if (turnAway(order))
         {
-            autoState = AUTO_MOVE_PICKUP_COUNTER;
-            std::cout << "Customer " + std::to_string(robotID) + ": I am heading to pickup counter" << std::endl;
+            completeOrder();
+            co_return;
         }
-        break;
-    case AUTO_MOVE_ORDER_COUNTER:
-        if (moveState == INTERMEDIATE_MOVE_FINISH)
+        mStage = OrderStage::TO_ORDER_COUNTER;
+        chooseCounter();
+        if (mPreorderEnabled && mPreorder == PreorderState::NONE)
         {
-            moveState = INTERMEDIATE_MOVE_IDLE;
-            autoState = AUTO_CUSTOMER_ORDER;
+            makeOrder(order);
+            mExecutor.spawn(preorderPayment(PreorderState::AWAIT_PRICE));
+        }
+        LOG_INFO("Customer ", robotID, ": I am heading to order counter");
+        RoutePoint orderPad{mCounters.orderPad(mCounter)};
+        ArriveAt atCounter{arriveAt(orderPad.x, orderPad.z, - M_PI / 2)};
+        auto rejected{until([this] { return mPreorder == PreorderState::FAILED; })};
+        arrived = co_await anyOf(atCounter, rejected) == 0;
+        if (arrived)
+        {
+            recordPhase("travel");
+            if (mPreorder == PreorderState::NONE)
+            {
+                makeOrder(order);
+            }
         }
         else
         {
-            move(CUSTOMER_ORDER_COUNTER_X, CUSTOMER_ORDER_COUNTER_Z, - M_PI / 2);
+            // The pre-order fell through on the way, so the customer turns straight back
+            LOG_INFO("Customer ", robotID, ": My order fell through, so I will go back");
+            abandonMove();
         }
-        break;
-    case AUTO_MOVE_PICKUP_COUNTER:
-        if (moveState == INTERMEDIATE_MOVE_FINISH)
+    }
+
+    bool paid{true};
+    if (mPreorder != PreorderState::NONE)
+    {
+        // The payment went ahead on the way, so the kitchen has had a head start
+        co_await until([this] { return mPreorder == PreorderState::PAID || mPreorder == PreorderState::FAILED; });
+        paid = mPreorder == PreorderState::PAID;
+        if (paid)
         {
-            moveState = INTERMEDIATE_MOVE_IDLE;
-            autoState = AUTO_CUSTOMER_PICKUP;
+            mMetrics.observe("cafe_customer_preorder_head_start_seconds", "", std::max(0.0, getTime() - mPaidTime));
         }
-        else
+        mPreorder = PreorderState::NONE;
+    }
+    else
+    {
+        if (from <= OrderStage::AWAIT_PRICE)
         {
-            move(CUSTOMER_PICKUP_COUNTER_X, CUSTOMER_PICKUP_COUNTER_Z, M_PI);
+            mStage = OrderStage::AWAIT_PRICE;
+            Message reply{co_await receive("$-")};
+            recordPhase("queue");
+            paid = payOrder(reply);
+            recordPhase("payment");
         }
-        break;
-    case AUTO_MOVE_STARTING_POSITION:
-        if (moveState == INTERMEDIATE_MOVE_FINISH)
+        if (paid && from <= OrderStage::AWAIT_RECEIPT)
         {
-            moveState = INTERMEDIATE_MOVE_IDLE;
-            autoState = AUTO_IDLE;
-            resetOrdering();
+            mStage = OrderStage::AWAIT_RECEIPT;
+            paid = settlePayment(co_await receive("=!"));
         }
-        else
+    }
+    if (!paid)
+    {
+        mMetrics.increment(arrived ? "cafe_customer_wasted_trips_total" : "cafe_customer_trips_saved_total",
+                           "reason=\"" + mRejection + "\"");
+    }
+    if (paid && from <= OrderStage::AWAIT_READY)
+    {
+        mStage = OrderStage::AWAIT_READY;
+        co_await receive("*");
+        recordPhase("prep");
+    }
+    if (paid && from <= OrderStage::TO_PICKUP_COUNTER)
+    {
+        mStage = OrderStage::TO_PICKUP_COUNTER;
+        LOG_INFO("Customer ", robotID, ": I am heading to pickup counter");
+        RoutePoint pickupPad{mCounters.pickupPad(mCounter)};
+        co_await arriveAt(pickupPad.x, pickupPad.z, M_PI);
+        pickupOrder(order);
+    }
+
+    mStage = OrderStage::TO_START;
+    co_await arriveAt(startXPos, startZPos, startHeading * (M_PI / 180));
+    recordPhase("return");
+    mStage = OrderStage::NONE;
+    completeOrder();
+}
+
+Task CustomerRobot::preorderPayment(PreorderState from)
+{
+    mPreorder = from;
+    if (from <= PreorderState::AWAIT_PRICE)
+    {
+        if (!payOrder(co_await receive("$-")))
         {
-            move(startXPos, startZPos, startHeading * (M_PI / 180));
+            mPreorder = PreorderState::FAILED;
+            co_return;
         }
-        break;
-    case AUTO_CUSTOMER_ORDER:
-        makeOrder();
-        break;
-    case AUTO_CUSTOMER_PAY:
-        payOrder();
-        break;
-    case AUTO_CUSTOMER_PICKUP:
-        pickupOrder();
-        break;
+        mPreorder = PreorderState::AWAIT_RECEIPT;
     }
+    bool paid{settlePayment(co_await receive("=!"))};
+    mPaidTime = getTime();
+    mPreorder = paid ? PreorderState::PAID : PreorderState::FAILED;
 }
 
 void CustomerRobot::processData()
@@ -133,7 +218,15 @@ void CustomerRobot::processData()
     {
         if (std::isdigit(currentData[0]))
         { // State changes start with a digit
-            state = std::stoi(currentData);
+            long code{0};
+            if (readNumber(currentData.c_str(), '\0', code))
+            {
+                setControlMode(static_cast<int>(code));
+            }
+            else
+            {
+                LOG_WARN(robotName, ": malformed mode change: ", currentData);
+            }
             currentData = "";
             return;
         }
@@ -142,82 +235,234 @@ void CustomerRobot::processData()
         case '?': // Print balance
             printBalance();
             break;
-        case '~': // End controller
-            state = END;
-            printBalance();
+        case '~': // End controller, once the staff has the final balance
+            if (mClosingDeadline < 0)
+            {
+                // Final balance is ".<robot ID>:<balance>"
+                std::ostringstream report;
+                report << '.' << robotID << ':' << std::setprecision(2) << std::fixed << mBalance;
+                sendMessage(report.str(), mStaffChannel);
+                mClosingDeadline = getTime() + CLOSING_TIMEOUT;
+            }
             break;
-        case '-': // Does not exist on menu
-            currentOrderItemExists = false;
-            autoState = AUTO_CUSTOMER_PAY;
+        case '+': // Exists on menu, the price follows
             break;
-        case '+': // Exists on menu
-            currentOrderItemExists = true;
+        case MenuReplica::MARK: // Menu snapshot or delta, a lost delta needs a new snapshot
+            if (!mMenuReplica.apply(currentData))
+            {
+                mNextMenuRequest = 0;
+            }
             break;
-        case '$': // Price return
-            currentOrderPrice = std::stod(currentData.substr(1, currentData.size() - 1));
-            autoState = AUTO_CUSTOMER_PAY;
+        case Counters::MARK: // Queue at every counter
+            Counters::decodeQueues(currentData, mCounterQueues);
             break;
+        case '-': // Does not exist on menu
+        case '$': // Price return
+        case '=': // Payment receipt
+        case '!': // Payment declined
         case '*': // Order ready be picked up
-            orderReady = true;
+            postMessage({currentData[0], mStaffId, currentData.substr(1)});
             break;
         default:
-            currentOrder = currentData;
-            std::cout << "Customer " + std::to_string(robotID) + ": I am heading to order counter" << std::endl;
-            autoState = AUTO_MOVE_ORDER_COUNTER;
+            mExecutor.spawn(orderWorkflow(currentData, OrderStage::TO_ORDER_COUNTER));
             break;
         }
     }
 }
 
-void CustomerRobot::makeOrder()
+void CustomerRobot::requestMenu()
 {
-    std::cout << "Customer " + std::to_string(robotID) + ": Hi Staff, I would like to order " + currentOrder << std::endl;
-    std::string message{currentOrder + std::to_string(robotID)};
-    sendMessage(message, 5);
-    std::cout << "Customer " + std::to_string(robotID) + ": *waiting to pay*" << std::endl;
-    autoState = AUTO_IDLE;
+    if (registered() && !mMenuReplica.synced() && getTime() >= mNextMenuRequest)
+    {
+        sendDatagram(MenuReplica::request(robotID), mStaffChannel);
+        mNextMenuRequest = getTime() + REGISTRATION_RETRY;
+    }
 }
 
-void CustomerRobot::payOrder()
+void CustomerRobot::updateClosing()
 {
-    std::string message;
-    if (currentOrderItemExists && currentOrderPrice <= mBalance)
+    if (mClosingDeadline < 0 || (mLink.unacknowledged() > 0 && getTime() < mClosingDeadline))
     {
-        std::cout << "Customer " + std::to_string(robotID) + ": *has enough money*" << std::endl;
-        std::cout << "Customer " + std::to_string(robotID) + ": Hi Staff, I will buy it" << std::endl;
-        std::cout << "Customer " + std::to_string(robotID) + ": *pays by card/cash*" << std::endl;
-        message = ">";
-        purchaseConfirmation = true;
-        mBalance -= currentOrderPrice;
-        autoState = AUTO_IDLE;
+        return;
     }
-    else
+    mClosingDeadline = -1;
+    mControl.transitionTo(ControlState::END);
+    printBalance();
+}
+
+void CustomerRobot::chooseCounter()
+{
+    mCounter = mCounters.choose({startXPos, startZPos}, mCounterQueues);
+    if (mCounters.size() > 1)
+    {
+        // Claim is "|<counter>:<robot ID>", ahead of the order
+        sendMessage(Counters::MARK + std::to_string(mCounter) + ":" + std::to_string(robotID), mStaffChannel);
+        mMetrics.increment("cafe_customer_counter_choices_total", "counter=\"" + std::to_string(mCounter) + "\"");
+    }
+}
+
+bool CustomerRobot::turnAway(const std::string &order)
+{
+    std::string reason;
+    switch (mMenuReplica.check(mMenu.decode(order), mBalance))
+    {
+    case MenuVerdict::UNKNOWN_ITEM:
+        reason = "unknown_item";
+        break;
+    case MenuVerdict::UNAVAILABLE:
+        reason = "unavailable";
+        break;
+    case MenuVerdict::UNAFFORDABLE:
+        reason = "insufficient_balance";
+        break;
+    default:
+        return false;
+    }
+    LOG_INFO("Customer ", robotID, ": The menu says I cannot order ", mMenu.label(order), ", so I will stay here");
+    mMetrics.increment("cafe_customer_orders_total", "result=\"" + reason + "\"");
+    mMetrics.increment("cafe_customer_trips_saved_total", "reason=\"" + reason + "\"");
+    return true;
+}
+
+void CustomerRobot::makeOrder(const std::string &order)
+{
+    LOG_INFO("Customer ", robotID, ": Hi Staff, I would like to order ", mMenu.label(order));
+    // Menu items are ordered by ID as "%<item>:<robot ID>", anything else by name as "<name><robot ID>"
+    ItemId item{mMenu.decode(order)};
+    sendMessage((item != Menu::NO_ITEM) ? Menu::encode(item) + ":" + std::to_string(robotID) : order + std::to_string(robotID),
+                mStaffChannel);
+    LOG_INFO("Customer ", robotID, ": *waiting to pay*");
+}
+
+bool CustomerRobot::payOrder(const Message &reply)
+{
+    bool itemExists{reply.type == '$'};
+    double price{0};
+    if (itemExists && !readAmount(reply.body.c_str(), price))
     {
-        std::cout << "Customer " + std::to_string(robotID) + ": *doesn't have enough money or made a boo boo*" << std::endl;
-        std::cout << "Customer " + std::to_string(robotID) + ": Oops, I will cancel the order" << std::endl;
-        message = "<";
-        autoState = AUTO_MOVE_STARTING_POSITION;
+        LOG_WARN(robotName, ": malformed price, cancelling the order: ", reply.body);
+        cancelOrder("malformed_price");
+        return false;
     }
-    sendMessage(message, 5);
+    if (itemExists && price <= mBalance)
+    {
+        LOG_INFO("Customer ", robotID, ": *has enough money*");
+        LOG_INFO("Customer ", robotID, ": Hi Staff, I will buy it");
+        LOG_INFO("Customer ", robotID, ": *pays by card/cash*");
+        // Payment is "><robot ID>:<payment ID>:<balance before paying>", the ledger sends the new balance back
+        std::ostringstream payment;
+        payment << '>' << robotID << ':' << ++mPaymentCounter << ':' << std::setprecision(2) << std::fixed << mBalance;
+        sendMessage(payment.str(), mStaffChannel);
+        return true;
+    }
+    LOG_INFO("Customer ", robotID, ": *doesn't have enough money or made a boo boo*");
+    LOG_INFO("Customer ", robotID, ": Oops, I will cancel the order");
+    cancelOrder(itemExists ? "insufficient_balance" : "unknown_item");
+    return false;
 }
 
-void CustomerRobot::pickupOrder()
+void CustomerRobot::cancelOrder(const std::string &reason)
 {
-    std::cout << "Customer " + std::to_string(robotID) + ": I got my " + currentOrder << std::endl;
+    mRejection = reason;
+    mMetrics.increment("cafe_customer_orders_total", "result=\"" + mRejection + "\"");
+    sendMessage("<" + std::to_string(robotID), mStaffChannel);
+}
+
+bool CustomerRobot::settlePayment(const Message &receipt)
+{
+    double balance{0};
+    bool readable{readAmount(receipt.body.c_str(), balance)};
+    if (!readable)
+    {
+        LOG_WARN(robotName, ": malformed receipt: ", receipt.body);
+    }
+    if (receipt.type == '!')
+    {
+        // The staff has already dropped the order, so there is nothing to cancel, and a declined
+        // payment moved no money
+        LOG_INFO("Customer ", robotID, ": Oh no, my payment was declined");
+        if (readable)
+        {
+            mBalance = balance;
+        }
+        mRejection = "declined";
+        mMetrics.increment("cafe_customer_orders_total", "result=\"declined\"");
+        return false;
+    }
+    // The receipt still says the payment went through, and the staff is already preparing the
+    // order, so the price charged comes off the balance. The ledger reconciles it at the end.
+    mBalance = readable ? balance : mBalance - mMenu.price(mMenu.decode(mOrder));
+    return true;
+}
+
+void CustomerRobot::pickupOrder(const std::string &order)
+{
+    LOG_INFO("Customer ", robotID, ": I got my ", mMenu.label(order));
+    recordPhase("pickup");
+    mMetrics.observe("cafe_customer_order_seconds", "", getTime() - dispatchTime);
+    mMetrics.increment("cafe_customer_orders_total", "result=\"served\"");
     // Send message to staff that order is picked up
-    sendMessage("*", 5);
-    autoState = AUTO_MOVE_STARTING_POSITION;
-    std::cout << "Customer " + std::to_string(robotID) + ": I am returning to starting point" << std::endl;
+    sendMessage("*" + std::to_string(robotID), mStaffChannel);
+    LOG_INFO("Customer ", robotID, ": I am returning to starting point");
+}
+
+void CustomerRobot::completeOrder()
+{
+    sendMessage("Order Complete" + std::to_string(robotID), Roster::DIRECTOR_CHANNEL);
+}
+
+void CustomerRobot::saveState(SnapshotWriter &state)
+{
+    BaseRobot::saveState(state);
+    state.putString(mOrder);
+    state.put(mStage);
+    state.put(mPaymentCounter);
+    state.put(mPreorder);
+    // Times are saved as time elapsed, as the simulation clock restarts
+    state.put(getTime() - dispatchTime);
+    state.put(getTime() - phaseStartTime);
+    state.put(getTime() - mPaidTime);
+    state.put(static_cast<std::uint32_t>(mCounter));
+}
+
+SnapshotCommit CustomerRobot::restoreState(SnapshotReader &state)
+{
+    SnapshotCommit base{BaseRobot::restoreState(state)};
+    std::string order{state.getString()};
+    OrderStage stage{state.get<OrderStage>()};
+    std::uint32_t paymentCounter{state.get<std::uint32_t>()};
+    PreorderState preorder{state.get<PreorderState>()};
+    double dispatched{getTime() - state.get<double>()};
+    double phaseStarted{getTime() - state.get<double>()};
+    double paid{getTime() - state.get<double>()};
+    std::size_t counter{std::min<std::size_t>(state.get<std::uint32_t>(), mCounters.size() - 1)};
+
+    return [=, this, base = std::move(base)]() {
+        base();
+        mOrder = order;
+        mStage = stage;
+        mPaymentCounter = paymentCounter;
+        mPreorder = preorder;
+        dispatchTime = dispatched;
+        phaseStartTime = phaseStarted;
+        mPaidTime = paid;
+        mCounter = counter;
+        if (mPreorder == PreorderState::AWAIT_PRICE || mPreorder == PreorderState::AWAIT_RECEIPT)
+        {
+            mExecutor.spawn(preorderPayment(mPreorder));
+        }
+        if (mStage != OrderStage::NONE)
+        {
+            mExecutor.spawn(orderWorkflow(mOrder, mStage));
+        }
+    };
 }
 
-void CustomerRobot::resetOrdering()
+void CustomerRobot::recordPhase(const std::string &phase)
 {
-    currentOrderItemExists = false;
-    orderReady = false;
-    currentOrder = "";
-    currentOrderPrice = 0;
-    purchaseConfirmation = false;
-    sendMessage("Order Complete", 6);
+    double now{getTime()};
+    mMetrics.observe("cafe_customer_phase_seconds", "phase=\"" + phase + "\"", now - phaseStartTime);
+    phaseStartTime = now;
 }
 
 CustomerRobot::~CustomerRobot() {}
\ No newline at end of file
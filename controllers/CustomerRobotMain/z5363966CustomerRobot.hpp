@@ -1,38 +1,152 @@
+#pragma once
+
 #include "z5363966BaseRobot.hpp"
 
+// Where the order workflow is, so a restored customer can carry on from the same point
+enum class OrderStage : unsigned char {
+    NONE,
+    TO_ORDER_COUNTER,
+    AWAIT_PRICE,
+    AWAIT_RECEIPT,
+    AWAIT_READY,
+    TO_PICKUP_COUNTER,
+    TO_START
+};
+
+// How far a pre-order's payment has got while the customer walks to the order counter
+enum class PreorderState : unsigned char {
+    NONE,
+    AWAIT_PRICE,
+    AWAIT_RECEIPT,
+    PAID,
+    FAILED
+};
+
 class CustomerRobot : public BaseRobot {
     public:
         /**
-         * @brief Construct a new Customer Robot object
+         * @brief Construct a new Customer Robot object, on the Webots robot unless other devices are given
          * 
          */
-        CustomerRobot();
+        explicit CustomerRobot(std::unique_ptr<RobotDevices> devices = makeWebotsDevices());
 
         virtual void run() override;
+
+        /**
+         * @brief Carries on from a snapshot if there is one, before the first time step
+         * 
+         */
+        void start();
+
+        /**
+         * @brief Runs one time step of the controller, after the simulation has stepped
+         * 
+         * @return boolean, false once the controller has ended
+         */
+        bool update();
+
         virtual void remoteControl() override;
         virtual void autoMode() override;
 
         void processData() override;    
 
+        /**
+         * @brief Walks to the order counter, orders, pays or cancels, picks the order up and returns
+         * to the starting position. With preorder set, it orders and pays on the way to the counter.
+         * 
+         * @param order item sent by the director, "%<item ID>" or a name not on the menu
+         * @param from stage to start at, later than TO_ORDER_COUNTER when restoring a snapshot
+         */
+        Task orderWorkflow(std::string, OrderStage);
+
+        /**
+         * @brief Pays for a pre-order as soon as the staff quotes the price, while the order
+         * workflow walks to the counter, or cancels it if it cannot be bought
+         * 
+         * @param from state to start at, AWAIT_RECEIPT when restoring a snapshot taken after paying
+         */
+        Task preorderPayment(PreorderState);
+
+        /**
+         * @brief Asks the staff for a menu snapshot while the replica is incomplete, again every
+         * REGISTRATION_RETRY
+         * 
+         */
+        void requestMenu();
+
+        /**
+         * @brief Reports the final balance to the staff once told to quit, then quits when the
+         * staff has it or CLOSING_TIMEOUT later
+         * 
+         */
+        void updateClosing();
+
+        /**
+         * @brief Turns an order away before the walk to the counter if the menu replica shows the
+         * staff would reject it: not on the menu, unavailable or more than the balance
+         * 
+         * @param order item sent by the director
+         * @return boolean, true if the order was turned away
+         */
+        bool turnAway(const std::string&);
+
+        /**
+         * @brief Picks the counter with the lowest expected wait and, if there is more than one,
+         * claims it from the staff
+         * 
+         */
+        void chooseCounter();
+
         /**
          * @brief Sends order to the Staff
          * 
          */
-        void makeOrder();
+        void makeOrder(const std::string&);
+
+        /**
+         * @brief Pays for order if able to buy the item ordered, else cancels it
+         * 
+         * @param reply price or '-' reply from the staff
+         * @return boolean, true if the order was paid for
+         */
+        bool payOrder(const Message&);
+
+        /**
+         * @brief Tells the staff the order is cancelled and records why
+         * 
+         * @param reason label of the cancellation in cafe_customer_orders_total
+         */
+        void cancelOrder(const std::string&);
 
         /**
-         * @brief Pays for order if able to buy the item ordered, else returns to starting position
+         * @brief Takes the balance from the staff's receipt, which comes from the ledger
          * 
+         * @param receipt '=' receipt or '!' decline, followed by the balance
+         * @return boolean, true if the payment was accepted
          */
-        void payOrder();
+        bool settlePayment(const Message&);
 
         /**
          * @brief Pick up order from pickup counter
          * 
          */
-        void pickupOrder();
+        void pickupOrder(const std::string&);
 
-        virtual void resetOrdering() override;
+        /**
+         * @brief Tells the director the order is complete
+         * 
+         */
+        void completeOrder();
+
+        void saveState(SnapshotWriter&) override;
+        SnapshotCommit restoreState(SnapshotReader&) override;
+
+        /**
+         * @brief Records the time spent in the phase that just ended and starts timing the next one
+         * 
+         * @param phase travel, queue, payment, prep, pickup or return
+         */
+        void recordPhase(const std::string&);
 
         /**
          * @brief Destroy the Customer Robot object
@@ -40,19 +154,39 @@ class CustomerRobot : public BaseRobot {
          */
         ~CustomerRobot();
     private:
-        bool currentOrderItemExists;
-        bool orderReady;
-        
-        // Customer Auto States
-        static constexpr int AUTO_CUSTOMER_ORDER {11};
-        static constexpr int AUTO_CUSTOMER_PAY {12};
-        static constexpr int AUTO_CUSTOMER_PICKUP {13};
+        // Order being worked on and how far the workflow has got
+        std::string mOrder;
+        OrderStage mStage;
+
+        // Menu as last heard from the staff, and when to ask again for a snapshot [s]
+        MenuReplica mMenuReplica;
+        double mNextMenuRequest;
+
+        // Counters to order from, the queues last broadcast by the staff and the counter chosen
+        Counters mCounters;
+        std::vector<int> mCounterQueues;
+        std::size_t mCounter;
+
+        // With preorder set, the order and payment go ahead as soon as the order is dispatched
+        bool mPreorderEnabled;
+        PreorderState mPreorder;
+        double mPaidTime;
+
+        // ID of the last payment sent, so the ledger applies a repeated payment once
+        std::uint32_t mPaymentCounter;
+
+        // Why the last order the staff rejected was rejected, for the trip metrics
+        std::string mRejection;
+
+        // When to stop waiting for the staff to acknowledge the final balance, negative until told
+        // to quit
+        double mClosingDeadline;
+
+        // Order timeline [s]
+        double dispatchTime;
+        double phaseStartTime;
         
         // Positions
         static constexpr double CUSTOMER_ORDER_QUEUE_X {0};
         static constexpr double CUSTOMER_ORDER_QUEUE_Z {0.125};
-        static constexpr double CUSTOMER_ORDER_COUNTER_X {0.375};
-        static constexpr double CUSTOMER_ORDER_COUNTER_Z {0.375};
-        static constexpr double CUSTOMER_PICKUP_COUNTER_X {0.375};
-        static constexpr double CUSTOMER_PICKUP_COUNTER_Z {-0.375};
 };
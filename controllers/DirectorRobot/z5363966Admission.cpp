@@ -0,0 +1,200 @@
+#include "z5363966Admission.hpp"
+
+AdmissionControl::AdmissionControl(const Settings &settings)
+	: mTarget(settings.getDouble("target_p99_latency", 0)),
+	  mShedAfter(settings.getDouble("shed_after_seconds", 0)),
+	  mQueueDepth(0),
+	  mDrainSeconds(0),
+	  mStatusTime(0),
+	  mNextLatency(0),
+	  mNextOverhead(0),
+	  mEngaged(false),
+	  mEngagements(0)
+{
+	mLatencies.reserve(WINDOW);
+	mOverheads.reserve(WINDOW);
+}
+
+void AdmissionControl::updateStatus(int queueDepth, double drainSeconds, double now)
+{
+	mQueueDepth = queueDepth;
+	mDrainSeconds = drainSeconds;
+	mStatusTime = now;
+}
+
+bool AdmissionControl::admit(double now, double kitchenSeconds)
+{
+	if (!enabled())
+	{
+		return true;
+	}
+	bool admitted{workAhead(now) <= 0 || predictedLatency(now, kitchenSeconds) <= mTarget};
+	if (!admitted && !mEngaged)
+	{
+		mEngagements++;
+	}
+	mEngaged = !admitted;
+	return admitted;
+}
+
+bool AdmissionControl::shed(double waited) const
+{
+	return enabled() && mShedAfter > 0 && waited > mShedAfter;
+}
+
+void AdmissionControl::dispatched(int customer, double now, double kitchenSeconds)
+{
+	mDispatches[customer] = {workAhead(now), kitchenSeconds};
+}
+
+void AdmissionControl::completed(int customer, double latency)
+{
+	record(mLatencies, mNextLatency, latency);
+	auto dispatch{mDispatches.find(customer)};
+	if (dispatch != mDispatches.end())
+	{
+		const Dispatch &order{dispatch->second};
+		record(mOverheads, mNextOverhead, std::max(0.0, latency - order.workAhead - order.kitchenSeconds));
+		mDispatches.erase(dispatch);
+	}
+}
+
+double AdmissionControl::predictedLatency(double now, double kitchenSeconds) const
+{
+	return workAhead(now) + kitchenSeconds + p99(mOverheads);
+}
+
+double AdmissionControl::latencyP99() const
+{
+	return p99(mLatencies);
+}
+
+void AdmissionControl::save(SnapshotWriter &state, double now) const
+{
+	state.put(mQueueDepth);
+	state.put(drainSeconds(now));
+	state.put(static_cast<std::uint32_t>(mDispatches.size()));
+	for (const auto &entry : mDispatches)
+	{
+		state.put(entry.first);
+		state.put(entry.second);
+	}
+	saveWindow(state, mLatencies, mNextLatency);
+	saveWindow(state, mOverheads, mNextOverhead);
+	state.put(mEngaged);
+	state.put(static_cast<std::uint64_t>(mEngagements));
+}
+
+SnapshotCommit AdmissionControl::restore(SnapshotReader &state, double now)
+{
+	int queueDepth{state.get<int>()};
+	double drainSeconds{state.get<double>()};
+	std::unordered_map<int, Dispatch> dispatches;
+	std::uint32_t outstanding{state.get<std::uint32_t>()};
+	for (std::uint32_t i = 0; i < outstanding && state.ok(); i++)
+	{
+		int customer{state.get<int>()};
+		dispatches[customer] = state.get<Dispatch>();
+	}
+	std::vector<double> latencies;
+	std::vector<double> overheads;
+	std::size_t nextLatency{0};
+	std::size_t nextOverhead{0};
+	restoreWindow(state, latencies, nextLatency);
+	restoreWindow(state, overheads, nextOverhead);
+	bool engaged{state.get<bool>()};
+	std::size_t engagements{static_cast<std::size_t>(state.get<std::uint64_t>())};
+
+	return [=, this, dispatches = std::move(dispatches), latencies = std::move(latencies),
+			overheads = std::move(overheads)]() {
+		mQueueDepth = queueDepth;
+		mDrainSeconds = drainSeconds;
+		mStatusTime = now;
+		mDispatches = dispatches;
+		mLatencies = latencies;
+		mNextLatency = nextLatency;
+		mOverheads = overheads;
+		mNextOverhead = nextOverhead;
+		mEngaged = engaged;
+		mEngagements = engagements;
+	};
+}
+
+int AdmissionControl::queueDepth() const
+{
+	return mQueueDepth;
+}
+
+bool AdmissionControl::enabled() const
+{
+	return mTarget > 0;
+}
+
+bool AdmissionControl::engaged() const
+{
+	return mEngaged;
+}
+
+std::size_t AdmissionControl::engagements() const
+{
+	return mEngagements;
+}
+
+double AdmissionControl::drainSeconds(double now) const
+{
+	return std::max(0.0, mDrainSeconds - (now - mStatusTime));
+}
+
+double AdmissionControl::workAhead(double now) const
+{
+	double outstanding{0};
+	for (const auto &entry : mDispatches)
+	{
+		outstanding += entry.second.kitchenSeconds;
+	}
+	return std::max(drainSeconds(now), outstanding);
+}
+
+double AdmissionControl::p99(const std::vector<double> &samples)
+{
+	if (samples.empty())
+	{
+		return 0;
+	}
+	std::vector<double> sorted{samples};
+	std::size_t rank{(sorted.size() * 99 + 99) / 100 - 1};
+	std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+	return sorted[rank];
+}
+
+void AdmissionControl::record(std::vector<double> &window, std::size_t &next, double sample)
+{
+	if (window.size() < WINDOW)
+	{
+		window.push_back(sample);
+		return;
+	}
+	window[next] = sample;
+	next = (next + 1) % WINDOW;
+}
+
+void AdmissionControl::saveWindow(SnapshotWriter &state, const std::vector<double> &window, std::size_t next)
+{
+	state.put(static_cast<std::uint32_t>(window.size()));
+	for (double sample : window)
+	{
+		state.put(sample);
+	}
+	state.put(static_cast<std::uint32_t>(next));
+}
+
+void AdmissionControl::restoreWindow(SnapshotReader &state, std::vector<double> &window, std::size_t &next)
+{
+	window.clear();
+	std::uint32_t samples{state.get<std::uint32_t>()};
+	for (std::uint32_t i = 0; i < samples && i < WINDOW && state.ok(); i++)
+	{
+		window.push_back(state.get<double>());
+	}
+	next = state.get<std::uint32_t>() % WINDOW;
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include "z5363966Settings.hpp"
+#include "z5363966Snapshot.hpp"
+
+/**
+ * @brief Decides whether the director may dispatch an order, from the staff's status messages and
+ * the latency of recent orders.
+ *
+ * An order is expected to wait for the kitchen work ahead of it, take its own prep time, and then
+ * the rest of its service (walking, ordering, paying, pickup), which is estimated as the p99 of
+ * latency less kitchen time over recent orders. The work ahead is the kitchen's drain time, but at
+ * least the prep time of every order still outstanding, as an order only reaches the drain time
+ * once its customer has walked to the counter and placed it. While the estimate is over
+ * target_p99_latency dispatches are held (backpressure), and orders that have waited longer than
+ * shed_after_seconds are dropped.
+ *
+ */
+class AdmissionControl {
+public:
+    explicit AdmissionControl(const Settings&);
+
+    /**
+     * @brief Records a status message from the staff
+     *
+     * @param queueDepth customers being served
+     * @param drainSeconds time for the kitchen to finish every placed order [s]
+     * @param now [s]
+     */
+    void updateStatus(int, double, double);
+
+    /**
+     * @brief Checks whether an order may be dispatched now, counting each time backpressure engages.
+     * An order with no kitchen work ahead of it is always admitted, as holding it gains nothing.
+     *
+     * @param now [s]
+     * @param kitchenSeconds prep time of the order [s]
+     * @return boolean
+     */
+    bool admit(double, double);
+
+    /**
+     * @brief Checks whether an order that has waited the given seconds since it arrived should be dropped
+     *
+     * @return boolean
+     */
+    bool shed(double) const;
+
+    /**
+     * @brief Records an order dispatched to a customer
+     *
+     * @param customer
+     * @param now [s]
+     * @param kitchenSeconds prep time of the order [s]
+     */
+    void dispatched(int, double, double);
+
+    /**
+     * @brief Records the latency of a customer's completed order
+     *
+     */
+    void completed(int, double);
+
+    /**
+     * @brief Estimated latency of an order dispatched now [s]
+     *
+     * @param now [s]
+     * @param kitchenSeconds prep time of the order [s]
+     * @return double
+     */
+    double predictedLatency(double, double) const;
+
+    /**
+     * @brief p99 latency of recent orders [s]
+     *
+     * @return double
+     */
+    double latencyP99() const;
+
+    /**
+     * @brief Writes the last status, outstanding orders and latency windows to a snapshot
+     *
+     * @param state, now [s]
+     */
+    void save(SnapshotWriter&, double) const;
+
+    /**
+     * @brief Reads back the state written by save
+     *
+     * @param state, now [s]
+     * @return SnapshotCommit
+     */
+    SnapshotCommit restore(SnapshotReader&, double);
+
+    int queueDepth() const;
+    bool enabled() const;
+    bool engaged() const;
+    std::size_t engagements() const;
+
+private:
+    /**
+     * @brief Drain time reported by the staff, less the time since it was reported
+     *
+     * @return double
+     */
+    double drainSeconds(double) const;
+
+    /**
+     * @brief Kitchen work an order dispatched now would wait for [s]
+     *
+     * @return double
+     */
+    double workAhead(double) const;
+
+    /**
+     * @brief p99 of a window of samples
+     *
+     * @return double
+     */
+    static double p99(const std::vector<double>&);
+
+    /**
+     * @brief Adds a sample to a window, replacing the oldest once the window is full
+     *
+     */
+    static void record(std::vector<double>&, std::size_t&, double);
+
+    static void saveWindow(SnapshotWriter&, const std::vector<double>&, std::size_t);
+    static void restoreWindow(SnapshotReader&, std::vector<double>&, std::size_t&);
+
+    double mTarget;
+    double mShedAfter;
+
+    int mQueueDepth;
+    double mDrainSeconds;
+    double mStatusTime;
+
+    struct Dispatch {
+        double workAhead;       // [s] kitchen work ahead of the order when it was dispatched
+        double kitchenSeconds;  // [s] its own prep time
+    };
+
+    // Each outstanding order
+    std::unordered_map<int, Dispatch> mDispatches;
+
+    // Recent latencies, and latencies less the kitchen time of the order
+    std::vector<double> mLatencies;
+    std::vector<double> mOverheads;
+    std::size_t mNextLatency;
+    std::size_t mNextOverhead;
+
+    bool mEngaged;
+    std::size_t mEngagements;
+
+    static constexpr std::size_t WINDOW {100};
+};
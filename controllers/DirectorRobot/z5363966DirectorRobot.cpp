@@ -1,28 +1,54 @@
 #include "z5363966DirectorRobot.hpp"
 
-DirectorRobot::DirectorRobot()
-	: robot(new webots::Robot()),
-	  emitter(robot->getEmitter("emitter")),
-	  receiver(robot->getReceiver("receiver")),
-	  state(INITIAL),
+DirectorRobot::DirectorRobot(std::unique_ptr<RobotDevices> devices)
+	: mDevices(std::move(devices)),
+	  currentKey(EOF),
 	  allowedRemoteCommands({'1', '2', '3', '4', '5'}),
-	  orderFile("../../Order.csv", std::ifstream::in),
-	  currentOrder(""),
-	  currentCustomer(0),
-	  orderCounter(0)
+	  orderCounter(0),
+	  mSettings("../../Settings.csv"),
+	  mMetrics("Director", mSettings),
+	  mLink(*mDevices, mSettings, mMetrics),
+	  mRoster(mSettings.getInt("staff_id", 5)),
+	  mMenu("../../Menu.csv"),
+	  mPending{0, 0, ""},
+	  mHasPending(false),
+	  mOutstanding(0),
+	  mMaxOutstanding(static_cast<std::size_t>(std::max(1, mSettings.getInt("max_outstanding_orders", 1)))),
+	  mAutoStartTime(0),
+	  mAdmission(mSettings),
+	  mSnapshots("Director", mSettings),
+	  mMachine(*this, DirectorState::INITIAL)
 {
-	mKeyboard.enable(TIME_STEP);
-	receiver->enable(TIME_STEP);
-	receiver->setChannel(6);
+	mDevices->enable(TIME_STEP);
+	mLink.listen(Roster::DIRECTOR_CHANNEL);
+
+	mMetrics.describe("cafe_orders_dispatched_total", "counter", "Orders dispatched to customers");
+	mMetrics.describe("cafe_orders_completed_total", "counter", "Orders reported complete by customers");
+	mMetrics.describe("cafe_order_latency_seconds", "histogram", "Time from dispatch until the customer reports the order complete");
+	mMetrics.describe("cafe_orders_per_hour", "gauge", "Completed orders per simulated hour of auto mode");
+	mMetrics.describe("cafe_order_latency_p99_seconds", "gauge", "p99 latency of the last 100 orders");
+	mMetrics.describe("cafe_order_predicted_latency_seconds", "gauge", "Estimated latency of an order dispatched now");
+	mMetrics.describe("cafe_backpressure_engaged_total", "counter", "Times dispatching was held to keep the p99 latency target");
+	mMetrics.describe("cafe_backpressure_seconds_total", "counter", "Simulated time dispatching was held");
+	mMetrics.describe("cafe_orders_shed_total", "counter", "Orders dropped after waiting longer than shed_after_seconds");
+
+	if (mSettings.getString("order_source", "file") == "generator")
+	{
+		mOrders = std::make_unique<WorkloadGenerator>(mSettings, "../../Menu.csv", "../../Starting.csv");
+	}
+	else
+	{
+		mOrders = std::make_unique<OrderFile>(mSettings.getString("order_file", "../../Order.csv"));
+	}
 }
 
 void DirectorRobot::printCommandMenu()
 {
-	std::cout << "Director: This is a simulation for MTRN2500 Cafe." << std::endl;
-	std::cout << "Director: Press [I] to reprint the commands." << std::endl;
-	std::cout << "Director: Press [R] to remote control a robot." << std::endl;
-	std::cout << "Director: Press [A] to enter the auto mode." << std::endl;
-	std::cout << "Director: Press [Q] to quit all controllers." << std::endl;
+	LOG_INFO("Director: This is a simulation for MTRN2500 Cafe.");
+	LOG_INFO("Director: Press [I] to reprint the commands.");
+	LOG_INFO("Director: Press [R] to remote control a robot.");
+	LOG_INFO("Director: Press [A] to enter the auto mode.");
+	LOG_INFO("Director: Press [Q] to quit all controllers.");
 }
 
 void DirectorRobot::menuSelect(int key)
@@ -33,26 +59,24 @@ void DirectorRobot::menuSelect(int key)
 		printCommandMenu();
 		break;
 	case 'r':
-		std::cout << "Director: Please select the robot to control remotely:" << std::endl;
-		std::cout << "Director: Press [1] to control the Purple Robot (Customer1)." << std::endl;
-		std::cout << "Director: Press [2] to control the White Robot (Customer2)." << std::endl;
-		std::cout << "Director: Press [3] to control the Gold Robot (Customer3)." << std::endl;
-		std::cout << "Director: Press [4] to control the Green Robot (Customer4)." << std::endl;
-		std::cout << "Director: Press [5] to control the Black Robot (Staff)." << std::endl;
-		state = REMOTE_CONTROL_INITIALISE;
+		LOG_INFO("Director: Please select the robot to control remotely:");
+		LOG_INFO("Director: Press [1] to control the Purple Robot (Customer1).");
+		LOG_INFO("Director: Press [2] to control the White Robot (Customer2).");
+		LOG_INFO("Director: Press [3] to control the Gold Robot (Customer3).");
+		LOG_INFO("Director: Press [4] to control the Green Robot (Customer4).");
+		LOG_INFO("Director: Press [5] to control the Black Robot (Staff).");
+		mMachine.transition<DirectorState::INITIAL, DirectorState::REMOTE_CONTROL_INITIALISE>();
 		break;
 	case 'a':
-		std::cout << "Director: Auto Mode starts" << std::endl;
-		state = AUTO_INITIALISE;
+		LOG_INFO("Director: Auto Mode starts");
+		mMachine.transition<DirectorState::INITIAL, DirectorState::AUTO_INITIALISE>();
 		break;
 	case 'q':
-		state = END;
-        emitter->setChannel(-1);
-        emitter->send("~", 2);
+		mDevices->send(-1, "~");
+		mMachine.transition<DirectorState::INITIAL, DirectorState::END>();
 		break;
 	default:
-		std::cout << "Director: Command not found." << std::endl;
-		state = INITIAL;
+		LOG_INFO("Director: Command not found.");
 		printCommandMenu();
 	}
 }
@@ -63,123 +87,408 @@ void DirectorRobot::startRemoteControl(int key)
 	char keyInput = static_cast<char>(key);
 	if (std::count(allowedRemoteCommands.begin(), allowedRemoteCommands.end(), keyInput))
 	{
-		emitter->setChannel(std::stoi(std::string(1, keyInput)));
+		mLink.send(mRoster.channel(keyInput - '0'), std::to_string(REMOTE_MODE_CODE));
 	}
 	else
 	{
-		std::cout << "Director: Command not found." << std::endl;
-		state = INITIAL;
+		LOG_INFO("Director: Command not found.");
+		mMachine.transition<DirectorState::REMOTE_CONTROL_INITIALISE, DirectorState::INITIAL>();
 		printCommandMenu();
 		return;
 	}
-	state = REMOTE;
-	std::cout << "Director: Robot " + std::string(1, keyInput) + " has now been told to be remotely controlled." << std::endl;
-	emitter->send(std::to_string(state).data(), std::to_string(state).size() + 1);
+	mMachine.transition<DirectorState::REMOTE_CONTROL_INITIALISE, DirectorState::REMOTE>();
+	LOG_INFO("Director: Robot ", keyInput, " has now been told to be remotely controlled.");
 }
 
 void DirectorRobot::startAutoMode()
 {
-	state = AUTO;
-	emitter->setChannel(-1);
-	emitter->send("?", 2);
-	emitter->send(std::to_string(state).data(), std::to_string(state).size() + 1);
+	mMachine.transition<DirectorState::AUTO_INITIALISE, DirectorState::AUTO>();
+	mDevices->send(-1, "?");
+	mDevices->send(-1, std::to_string(AUTO_MODE_CODE));
 
-	// Gets the first useless so next getline will be the actual data
-	std::getline(orderFile, currentOrder);
+	mAutoStartTime = mDevices->time();
 }
 
 void DirectorRobot::autoMode()
 {
-	if (state == AUTO)
+	if (!mHasPending)
 	{
-		if (std::getline(orderFile, lineInput))
+		mHasPending = mOrders->next(mPending);
+	}
+	if (!mHasPending)
+	{
+		if (mOutstanding == 0)
 		{
-			std::stringstream lineStream{lineInput};
-			std::string stringSegment;
-			std::vector<std::string> orderLine;
-			// menuLine will be in the form of {menuItem, prepTime, itemPrice}
-			while (std::getline(lineStream, stringSegment, ','))
+			LOG_INFO("Director: All orders are completed");
+			if (mAdmission.enabled())
 			{
-				orderLine.push_back(stringSegment);
+				LOG_INFO("Director: Backpressure engaged ", mAdmission.engagements(), " times, ",
+						 mMetrics.value("cafe_orders_shed_total", ""), " orders shed");
 			}
+			mDevices->send(-1, "~");
+			mMachine.transition<DirectorState::AUTO, DirectorState::END>();
+		}
+		return;
+	}
 
-			// Extract the information
-			currentCustomer = std::stoi(orderLine[0]);
-			currentOrder = orderLine[1];
+	// Orders wait for their arrival time, and for the customer to finish its previous order
+	double now{mDevices->time()};
+	double waited{now - mAutoStartTime - mPending.arrival};
+	if (waited < 0 || outstanding(mPending.customer))
+	{
+		return;
+	}
+	if (mPending.customer < 1 || mPending.customer > Roster::MAX_ROBOTS)
+	{
+		LOG_WARN("Director: no robot can have ID ", mPending.customer, ", dropping ", mPending.item);
+		mHasPending = false;
+		return;
+	}
+	if (mAdmission.shed(waited))
+	{
+		LOG_INFO("Director: Shedding ", mPending.item, " for Customer ", mPending.customer, " after ", LogFixed{waited, 1}, " seconds");
+		mMetrics.increment("cafe_orders_shed_total", "");
+		mHasPending = false;
+		return;
+	}
+	double prepSeconds{kitchenSeconds(mPending.item)};
+	if (!mAdmission.admit(now, prepSeconds))
+	{
+		mMetrics.increment("cafe_backpressure_seconds_total", "", TIME_STEP / 1000.0);
+		return;
+	}
 
-			// Talk to Customer/Staff Robot
-			emitter->setChannel(currentCustomer);
-			emitter->send(currentOrder.data(), currentOrder.size() + 1);
-			// std::cout << "Robot " + std::to_string(currentCustomer) + " ordered " + currentOrder << std::endl;
-			state = AUTO_IDLE;
-		}
-        else
-        {
-            std::cout << "Director: All orders are completed" << std::endl;
-            emitter->setChannel(-1);
-            emitter->send("~", 2);
-            state = END;
-        }
-	}
-	else if (state == AUTO_IDLE)
-	{
-		if (receiver->getQueueLength() != 0) {
-		    std::string data{(const char *)receiver->getData()};
-		    receiver->nextPacket();
-		    if (data.compare("Order Complete") == 0)
-		    {
-		        orderCounter++;
-		        std::cout << "Director: Order " + std::to_string(orderCounter) + " complete" << std::endl;
-		        state = AUTO;
-		    }
-		}
+	// Talk to Customer/Staff Robot
+	// Menu items are sent as "%<item ID>", names not on the menu as written
+	ItemId item{mMenu.find(mPending.item)};
+	std::string order{(item != Menu::NO_ITEM) ? Menu::encode(item) : mPending.item};
+	mLink.send(mRoster.channel(mPending.customer), order);
+	setOutstanding(mPending.customer, now);
+	mAdmission.dispatched(mPending.customer, now, prepSeconds);
+	mHasPending = false;
+	mMetrics.increment("cafe_orders_dispatched_total", "");
+	if (mOutstanding >= mMaxOutstanding)
+	{
+		mMachine.transition<DirectorState::AUTO, DirectorState::AUTO_IDLE>();
 	}
 }
 
-void DirectorRobot::run()
+void DirectorRobot::waitForOrder()
 {
-	printCommandMenu();
+	if (mOutstanding < mMaxOutstanding)
+	{
+		mMachine.transition<DirectorState::AUTO_IDLE, DirectorState::AUTO>();
+	}
+}
 
-	// Main Loop
-	int key;
-	while (robot->step(TIME_STEP) != -1)
+void DirectorRobot::receiveMessages()
+{
+	mLink.update();
+	std::string data;
+	while (mLink.receive(data))
 	{
-		key = mKeyboard.getKey();
-		if (key != EOF)
+		if (!data.empty() && data[0] == '#')
 		{
-			switch (state)
-			{
-			case INITIAL:
-				menuSelect(key);
-				break;
-			case REMOTE_CONTROL_INITIALISE:
-				startRemoteControl(key);
-				break;
-			}
+			receiveStatus(data);
+		}
+		else if (!data.empty() && data[0] == '@')
+		{
+			receiveRegistration(data);
 		}
-		else if (state == REMOTE && receiver->getQueueLength() != 0)
+		else if (data == "end")
 		{
-			std::string ret{(const char *)receiver->getData()};
-			if (ret == "end")
+			if (mMachine.is(DirectorState::REMOTE))
 			{
-				state = END;
+				mMachine.transition<DirectorState::REMOTE, DirectorState::END>();
 			}
-			receiver->nextPacket();
 		}
+		else
+		{
+			receiveCompletion(data);
+		}
+	}
+	sendAssignments();
+}
+
+void DirectorRobot::receiveRegistration(const std::string &data)
+{
+	// Registration is "@<robot name>"
+	std::string name{data.substr(1)};
+	int id{mRoster.enrol(name)};
+	if (id == 0)
+	{
+		LOG_ERROR("Director: no ID left for ", name);
+		return;
+	}
+	LOG_DEBUG("Director: ", name, " registered as ", id);
+}
+
+void DirectorRobot::sendAssignments()
+{
+	for (const std::string &assignments : mRoster.takeAssignments())
+	{
+		mDevices->send(-1, assignments);
+	}
+}
+
+void DirectorRobot::receiveStatus(const std::string &data)
+{
+	// Status is "#<queue depth>,<drain seconds>"
+	std::size_t comma{data.find(',')};
+	if (comma == std::string::npos)
+	{
+		LOG_WARN("Director: malformed status \"", data, "\"");
+		return;
+	}
+	mAdmission.updateStatus(std::atoi(data.c_str() + 1), std::atof(data.c_str() + comma + 1), mDevices->time());
+}
 
-		switch (state)
+void DirectorRobot::receiveCompletion(const std::string &data)
+{
+	// "Order Complete" is followed by the customer's robot ID
+	const std::string complete{"Order Complete"};
+	if (data.compare(0, complete.size(), complete) != 0)
+	{
+		return;
+	}
+	int customer{std::atoi(data.c_str() + complete.size())};
+	if (!outstanding(customer))
+	{
+		LOG_WARN("Director: unexpected \"", data, "\"");
+		return;
+	}
+	double latency{mDevices->time() - mDispatchTimes[customer]};
+	orderCounter++;
+	LOG_INFO("Director: Order ", orderCounter, " complete");
+	mMetrics.increment("cafe_orders_completed_total", "");
+	mMetrics.observe("cafe_order_latency_seconds", "", latency);
+	mAdmission.completed(customer, latency);
+	clearOutstanding(customer);
+}
+
+double DirectorRobot::kitchenSeconds(const std::string &name) const
+{
+	ItemId item{mMenu.find(name)};
+	return (item != Menu::NO_ITEM) ? mMenu.prepSeconds(item) : 0;
+}
+
+bool DirectorRobot::outstanding(int customer) const
+{
+	return customer > 0 && static_cast<std::size_t>(customer) < mDispatchTimes.size() &&
+		   mDispatchTimes[customer] != NOT_DISPATCHED;
+}
+
+void DirectorRobot::setOutstanding(int customer, double dispatchTime)
+{
+	if (static_cast<std::size_t>(customer) >= mDispatchTimes.size())
+	{
+		mDispatchTimes.resize(customer + 1, NOT_DISPATCHED);
+	}
+	if (mDispatchTimes[customer] == NOT_DISPATCHED)
+	{
+		mOutstanding++;
+	}
+	mDispatchTimes[customer] = dispatchTime;
+}
+
+void DirectorRobot::clearOutstanding(int customer)
+{
+	if (outstanding(customer))
+	{
+		mDispatchTimes[customer] = NOT_DISPATCHED;
+		mOutstanding--;
+	}
+}
+
+void DirectorRobot::saveState(SnapshotWriter &state)
+{
+	double now{mDevices->time()};
+	state.put(mMachine.current());
+	state.put(orderCounter);
+	mOrders->save(state);
+	state.put(mHasPending);
+	state.put(mPending.arrival);
+	state.put(mPending.customer);
+	state.putString(mPending.item);
+	state.put(static_cast<std::uint32_t>(mOutstanding));
+	for (int customer = 1; customer < static_cast<int>(mDispatchTimes.size()); customer++)
+	{
+		if (outstanding(customer))
+		{
+			state.put(customer);
+			state.put(now - mDispatchTimes[customer]);
+		}
+	}
+	state.put(now - mAutoStartTime);
+	mAdmission.save(state, now);
+	mLink.save(state);
+}
+
+SnapshotCommit DirectorRobot::restoreState(SnapshotReader &state)
+{
+	double now{mDevices->time()};
+	DirectorState directorState{state.get<DirectorState>()};
+	int counter{state.get<int>()};
+	SnapshotCommit orders{mOrders->restore(state)};
+	bool hasPending{state.get<bool>()};
+	Order pending{};
+	pending.arrival = state.get<double>();
+	pending.customer = state.get<int>();
+	pending.item = state.getString();
+	std::vector<std::pair<int, double>> dispatches;
+	std::uint32_t dispatched{state.get<std::uint32_t>()};
+	for (std::uint32_t i = 0; i < dispatched && state.ok(); i++)
+	{
+		int customer{state.get<int>()};
+		double elapsed{state.get<double>()};
+		if (customer > 0 && customer <= Roster::MAX_ROBOTS)
+		{
+			dispatches.emplace_back(customer, now - elapsed);
+		}
+	}
+	double autoStartTime{now - state.get<double>()};
+	SnapshotCommit admission{mAdmission.restore(state, now)};
+	SnapshotCommit link{mLink.restore(state)};
+
+	return [=, this, orders = std::move(orders), dispatches = std::move(dispatches), admission = std::move(admission),
+			link = std::move(link)]() {
+		orderCounter = counter;
+		orders();
+		mHasPending = hasPending;
+		mPending = pending;
+		mDispatchTimes.clear();
+		mOutstanding = 0;
+		for (const auto &[customer, dispatchTime] : dispatches)
 		{
-		case AUTO_INITIALISE:
-			startAutoMode();
-			break;
-		case AUTO:
-		case AUTO_IDLE:
-			autoMode();
-			break;
-		case END:
-			return;
+			setOutstanding(customer, dispatchTime);
 		}
+		mAutoStartTime = autoStartTime;
+		admission();
+		link();
+
+		// Only auto mode carries on, remote control waits for a key press again
+		if (directorState == DirectorState::AUTO || directorState == DirectorState::AUTO_IDLE)
+		{
+			mMachine.restore(directorState);
+		}
+	};
+}
+
+void DirectorRobot::updateSnapshot()
+{
+	if (mSnapshots.due(mDevices->time()))
+	{
+		SnapshotWriter state;
+		saveState(state);
+		mSnapshots.save(state, mDevices->time());
+	}
+}
+
+bool DirectorRobot::restoreSnapshot()
+{
+	std::string bytes;
+	double snapshotTime{0};
+	if (!mSnapshots.load(bytes, snapshotTime))
+	{
+		return false;
+	}
+	auto start{std::chrono::steady_clock::now()};
+	SnapshotReader state{std::move(bytes)};
+	SnapshotCommit commit{restoreState(state)};
+	if (!state.ok())
+	{
+		LOG_ERROR("Director: snapshot from ", LogFixed{snapshotTime, 3}, " s is incomplete");
+		return false;
+	}
+	commit();
+	[[maybe_unused]] double restoreMs{std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()};
+	LOG_INFO("Director: restored snapshot from ", LogFixed{snapshotTime, 3}, " s in ", LogFixed{restoreMs, 3}, " ms");
+	return true;
+}
+
+void DirectorRobot::run()
+{
+	start();
+
+	// Main Loop
+	while (mDevices->step(TIME_STEP) != -1 && update()) {}
+}
+
+void DirectorRobot::start()
+{
+	printCommandMenu();
+	restoreSnapshot();
+}
+
+bool DirectorRobot::update()
+{
+	currentKey = mDevices->key();
+	// Registrations arrive in every state, so messages are handled before the state's behaviour
+	receiveMessages();
+	mMachine.step();
+	if (mMachine.is(DirectorState::END))
+	{
+		return false;
+	}
+	updateSnapshot();
+	return true;
+}
+
+void DirectorRobot::stateInitial()
+{
+	if (currentKey != EOF)
+	{
+		menuSelect(currentKey);
+	}
+}
+
+void DirectorRobot::stateRemoteControlInitialise()
+{
+	if (currentKey != EOF)
+	{
+		startRemoteControl(currentKey);
+	}
+}
+
+void DirectorRobot::stateRemote() {}
+
+void DirectorRobot::stateAutoInitialise()
+{
+	startAutoMode();
+}
+
+void DirectorRobot::stateAuto()
+{
+	autoMode();
+	updateMetrics();
+}
+
+void DirectorRobot::stateAutoIdle()
+{
+	waitForOrder();
+	updateMetrics();
+}
+
+void DirectorRobot::stateEnd() {}
+
+void DirectorRobot::onEnd()
+{
+	updateMetrics();
+	mMetrics.writeSummary(mDevices->time());
+}
+
+void DirectorRobot::updateMetrics()
+{
+	double autoHours{(mDevices->time() - mAutoStartTime) / 3600};
+	if (autoHours > 0)
+	{
+		mMetrics.set("cafe_orders_per_hour", "", mMetrics.value("cafe_orders_completed_total", "") / autoHours);
 	}
+	mMetrics.set("cafe_order_latency_p99_seconds", "", mAdmission.latencyP99());
+	double prepSeconds{mHasPending ? kitchenSeconds(mPending.item) : 0};
+	mMetrics.set("cafe_order_predicted_latency_seconds", "", mAdmission.predictedLatency(mDevices->time(), prepSeconds));
+	mMetrics.set("cafe_backpressure_engaged_total", "", static_cast<double>(mAdmission.engagements()));
+	mMetrics.update(mDevices->time());
 }
 
 DirectorRobot::~DirectorRobot() {}
\ No newline at end of file
@@ -1,50 +1,187 @@
+#pragma once
+
 #include <iostream>
 #include <algorithm>
 #include <fstream>
 #include <sstream>
+#include <cstdlib>
+#include <memory>
+#include <chrono>
+#include <vector>
+
+#include "z5363966Devices.hpp"
+#include "z5363966Settings.hpp"
+#include "z5363966Metrics.hpp"
+#include "z5363966Logger.hpp"
+#include "z5363966StateMachine.hpp"
+#include "z5363966Snapshot.hpp"
+#include "z5363966Roster.hpp"
+#include "z5363966Menu.hpp"
+#include "z5363966Workload.hpp"
+#include "z5363966Admission.hpp"
+#include "z5363966Link.hpp"
 
-#include <webots/Robot.hpp>
-#include <webots/Keyboard.hpp>
-#include <webots/Emitter.hpp>
-#include <webots/Receiver.hpp>
+// States of the director
+enum class DirectorState : unsigned char {
+    INITIAL,
+    REMOTE_CONTROL_INITIALISE,
+    REMOTE,
+    AUTO_INITIALISE,
+    AUTO,
+    AUTO_IDLE,
+    END,
+    COUNT
+};
 
 class DirectorRobot
 {
 public:
-    DirectorRobot();
+    /**
+     * @brief Construct the director, on the Webots robot unless other devices are given
+     *
+     */
+    explicit DirectorRobot(std::unique_ptr<RobotDevices> devices = makeWebotsDevices());
     void printCommandMenu();
     void menuSelect(int key);
     void startRemoteControl(int key);
     void startAutoMode();
     void autoMode();
+    void waitForOrder();
+    void receiveMessages();
+    void receiveStatus(const std::string&);
+
+    /**
+     * @brief Enrols a robot asking for its ID and channel, answered by sendAssignments
+     *
+     */
+    void receiveRegistration(const std::string&);
+
+    /**
+     * @brief Broadcasts the IDs and channels of every robot enrolled this time step
+     *
+     */
+    void sendAssignments();
+    void receiveCompletion(const std::string&);
+    void updateMetrics();
+
+    /**
+     * @brief Writes the auto mode state: the order stream, pending and outstanding orders and admission control
+     *
+     */
+    void saveState(SnapshotWriter&);
+
+    /**
+     * @brief Reads back the state written by saveState, to be applied once the whole snapshot was
+     * read. Times are saved relative to the snapshot and rebased onto the current simulation time.
+     *
+     * @return SnapshotCommit
+     */
+    SnapshotCommit restoreState(SnapshotReader&);
+
+    void updateSnapshot();
+    bool restoreSnapshot();
 
     void run();
+
+    /**
+     * @brief Prints the commands and carries on from a snapshot, before the first time step
+     *
+     */
+    void start();
+
+    /**
+     * @brief Runs one time step of the director, after the simulation has stepped
+     *
+     * @return boolean, false once the director has ended
+     */
+    bool update();
     
     ~DirectorRobot();
 private:
-    webots::Robot *robot;
-    webots::Keyboard mKeyboard;
-    webots::Emitter *emitter;
-    webots::Receiver *receiver;
+    /**
+     * @brief Prep time of an item by name, 0 for one not on the menu, which the staff turns away
+     *
+     * @return double [s]
+     */
+    double kitchenSeconds(const std::string&) const;
 
-    int state;
+    std::unique_ptr<RobotDevices> mDevices;
+
+    int currentKey;
     std::vector<char> allowedRemoteCommands;
 
-    std::ifstream orderFile;
-    std::string lineInput;
-    std::string currentOrder;
-    int currentCustomer;
     int orderCounter;
 
+    Settings mSettings;
+    Metrics mMetrics;
+
+    // Sends orders and mode codes until the robot acknowledges them, see z5363966Link.hpp
+    Link mLink;
+
+    // IDs and channels of the robots, indexed by ID
+    Roster mRoster;
+
+    // Orders name their items, which are sent to customers by item ID
+    Menu mMenu;
+
+    // Orders come from Order.csv or the workload generator, see the order_source setting
+    std::unique_ptr<OrderSource> mOrders;
+    Order mPending;
+    bool mHasPending;
+
+    // Dispatch time of the order each customer is working on, indexed by robot ID, NOT_DISPATCHED if none
+    std::vector<double> mDispatchTimes;
+    std::size_t mOutstanding;
+    std::size_t mMaxOutstanding;
+    double mAutoStartTime;
+
+    // Holds or sheds dispatches from the staff's status messages
+    AdmissionControl mAdmission;
+
+    SnapshotStore mSnapshots;
+
+    // State behaviours
+    void stateInitial();
+    void stateRemoteControlInitialise();
+    void stateRemote();
+    void stateAutoInitialise();
+    void stateAuto();
+    void stateAutoIdle();
+    void stateEnd();
+    void onEnd();
+
+    using DirectorMachine = StateMachine<DirectorRobot, DirectorState,
+        TransitionTable<DirectorState,
+            StateEdge<DirectorState, DirectorState::INITIAL, DirectorState::REMOTE_CONTROL_INITIALISE>,
+            StateEdge<DirectorState, DirectorState::INITIAL, DirectorState::AUTO_INITIALISE>,
+            StateEdge<DirectorState, DirectorState::INITIAL, DirectorState::END>,
+            StateEdge<DirectorState, DirectorState::REMOTE_CONTROL_INITIALISE, DirectorState::INITIAL>,
+            StateEdge<DirectorState, DirectorState::REMOTE_CONTROL_INITIALISE, DirectorState::REMOTE>,
+            StateEdge<DirectorState, DirectorState::REMOTE, DirectorState::END>,
+            StateEdge<DirectorState, DirectorState::AUTO_INITIALISE, DirectorState::AUTO>,
+            StateEdge<DirectorState, DirectorState::AUTO, DirectorState::AUTO_IDLE>,
+            StateEdge<DirectorState, DirectorState::AUTO, DirectorState::END>,
+            StateEdge<DirectorState, DirectorState::AUTO_IDLE, DirectorState::AUTO>>,
+        BehaviourTable<DirectorRobot, DirectorState,
+            StateBehaviour<DirectorRobot, DirectorState, DirectorState::INITIAL, &DirectorRobot::stateInitial>,
+            StateBehaviour<DirectorRobot, DirectorState, DirectorState::REMOTE_CONTROL_INITIALISE, &DirectorRobot::stateRemoteControlInitialise>,
+            StateBehaviour<DirectorRobot, DirectorState, DirectorState::REMOTE, &DirectorRobot::stateRemote>,
+            StateBehaviour<DirectorRobot, DirectorState, DirectorState::AUTO_INITIALISE, &DirectorRobot::stateAutoInitialise>,
+            StateBehaviour<DirectorRobot, DirectorState, DirectorState::AUTO, &DirectorRobot::stateAuto>,
+            StateBehaviour<DirectorRobot, DirectorState, DirectorState::AUTO_IDLE, &DirectorRobot::stateAutoIdle>,
+            StateBehaviour<DirectorRobot, DirectorState, DirectorState::END, &DirectorRobot::stateEnd, &DirectorRobot::onEnd>>>;
+
+    DirectorMachine mMachine;
+
+    bool outstanding(int) const;
+    void setOutstanding(int, double);
+    void clearOutstanding(int);
+
     // Constants
     static constexpr int TIME_STEP {64};
+    static constexpr double NOT_DISPATCHED {-1};
 
-    // States
-    static constexpr int INITIAL {0};
-    static constexpr int REMOTE_CONTROL_INITIALISE {1};
-    static constexpr int REMOTE {2};
-    static constexpr int AUTO_INITIALISE {3};
-    static constexpr int AUTO {4};
-    static constexpr int AUTO_IDLE {5};
-    static constexpr int END {6};
+    // Control mode codes sent to the customer and staff robots
+    static constexpr int REMOTE_MODE_CODE {2};
+    static constexpr int AUTO_MODE_CODE {4};
 };
\ No newline at end of file
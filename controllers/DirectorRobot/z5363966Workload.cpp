@@ -0,0 +1,293 @@
+#include "z5363966Workload.hpp"
+
+namespace {
+	// Splits a csv line into its fields
+	std::vector<std::string> splitLine(const std::string &line, char separator)
+	{
+		std::stringstream lineStream{line};
+		std::string stringSegment;
+		std::vector<std::string> fields;
+		while (std::getline(lineStream, stringSegment, separator))
+		{
+			if (!stringSegment.empty() && stringSegment.back() == '\r')
+			{
+				stringSegment.pop_back();
+			}
+			fields.push_back(stringSegment);
+		}
+		return fields;
+	}
+}
+
+OrderFile::OrderFile(const std::string &path)
+	: mFile(path, std::ifstream::in)
+{
+	// Skips the header line
+	std::string header;
+	std::getline(mFile, header);
+}
+
+bool OrderFile::next(Order &order)
+{
+	std::string lineInput;
+	if (!std::getline(mFile, lineInput))
+	{
+		return false;
+	}
+	// orderLine will be in the form of {robot, order}
+	std::vector<std::string> orderLine{splitLine(lineInput, ',')};
+	order = {0, std::stoi(orderLine[0]), orderLine[1]};
+	return true;
+}
+
+void OrderFile::save(SnapshotWriter &state)
+{
+	std::int64_t offset{-1};
+	if (mFile.good())
+	{
+		offset = static_cast<std::int64_t>(mFile.tellg());
+	}
+	state.put(offset);
+}
+
+SnapshotCommit OrderFile::restore(SnapshotReader &state)
+{
+	std::int64_t offset{state.get<std::int64_t>()};
+	return [this, offset]() {
+		if (offset < 0)
+		{
+			mFile.seekg(0, std::ios::end);
+			mFile.setstate(std::ios::eofbit);
+			return;
+		}
+		mFile.clear();
+		mFile.seekg(offset);
+	};
+}
+
+WorkloadGenerator::WorkloadGenerator(const Settings &settings, const std::string &menuPath, const std::string &startingPath)
+	: mRandom(static_cast<std::uint64_t>(settings.getInt("workload_seed", 1))),
+	  mUniform(0, 1),
+	  mGenerated(0),
+	  mLimit(static_cast<std::size_t>(settings.getInt("workload_orders", 1000))),
+	  mBursty(settings.getString("workload_arrivals", "poisson") == "bursty"),
+	  mRate(settings.getDouble("workload_rate", 10) / 3600),
+	  mBurstFactor(settings.getDouble("workload_burst_factor", 5)),
+	  mBurstSeconds(settings.getDouble("workload_burst_seconds", 60)),
+	  mCalmSeconds(settings.getDouble("workload_calm_seconds", 600)),
+	  mInvalidFraction(settings.getDouble("workload_invalid_fraction", 0)),
+	  mOverBudgetFraction(settings.getDouble("workload_over_budget_fraction", 0))
+{
+	// Item weights are given as "Latte:3;Mocha:1", items not listed have weight 1
+	std::vector<std::string> weights{splitLine(settings.getString("workload_item_weights", ""), ';')};
+
+	std::ifstream menuFile{menuPath, std::ifstream::in};
+	std::string lineInput;
+	std::getline(menuFile, lineInput);
+	while (std::getline(menuFile, lineInput))
+	{
+		// menuLine will be in the form of {menuItem, prepTime, itemPrice}
+		std::vector<std::string> menuLine{splitLine(lineInput, ',')};
+		if (menuLine.size() < 3)
+		{
+			continue;
+		}
+		MenuItem item{menuLine[0], std::stod(menuLine[2]), 1};
+		for (const std::string &weight : weights)
+		{
+			std::size_t colon{weight.rfind(':')};
+			if (colon != std::string::npos && weight.substr(0, colon) == item.name)
+			{
+				item.weight = std::stod(weight.substr(colon + 1));
+			}
+		}
+		mMenu.push_back(item);
+	}
+
+	// The staff never orders
+	int staffId{settings.getInt("staff_id", 5)};
+	std::ifstream startingFile{startingPath, std::ifstream::in};
+	std::getline(startingFile, lineInput);
+	while (std::getline(startingFile, lineInput))
+	{
+		std::vector<std::string> startingLine{splitLine(lineInput, ',')};
+		if (startingLine.size() < 2 || std::stoi(startingLine[0]) == staffId)
+		{
+			continue;
+		}
+		mCustomers.push_back({std::stoi(startingLine[0]), std::stod(startingLine[1]), false, 0});
+	}
+
+	for (std::size_t i = 0; i < mCustomers.size(); i++)
+	{
+		mCustomers[i].periodEnd = exponential(1 / mCalmSeconds);
+		mArrivals.push({nextArrival(mCustomers[i], 0), i});
+	}
+}
+
+bool WorkloadGenerator::next(Order &order)
+{
+	if ((mLimit > 0 && mGenerated >= mLimit) || mArrivals.empty() || mMenu.empty())
+	{
+		return false;
+	}
+	auto [arrival, index] = mArrivals.top();
+	mArrivals.pop();
+	Customer &customer{mCustomers[index]};
+
+	double draw{mUniform(mRandom)};
+	const MenuItem *item{nullptr};
+	if (draw < mInvalidFraction)
+	{
+		// Misspells a real item, e.g. "Lattea"
+		order = {arrival, customer.id, pickItem(customer, Budget::ANY)->name + "a"};
+	}
+	else
+	{
+		Budget budget{(draw < mInvalidFraction + mOverBudgetFraction) ? Budget::OVER : Budget::WITHIN};
+		item = pickItem(customer, budget);
+		if (item == nullptr)
+		{
+			// Every item is affordable, or none is, so the fraction can not be met for this customer
+			item = pickItem(customer, Budget::ANY);
+		}
+		order = {arrival, customer.id, item->name};
+		if (item->price <= customer.balance)
+		{
+			customer.balance -= item->price;
+		}
+	}
+
+	mArrivals.push({nextArrival(customer, arrival), index});
+	mGenerated++;
+	return true;
+}
+
+void WorkloadGenerator::save(SnapshotWriter &state)
+{
+	std::ostringstream engine;
+	engine << mRandom;
+	state.putString(engine.str());
+	state.put(static_cast<std::uint64_t>(mGenerated));
+	state.put(static_cast<std::uint32_t>(mCustomers.size()));
+	for (const Customer &customer : mCustomers)
+	{
+		state.put(customer);
+	}
+	// The heap holds one arrival per customer, so a copy is cheap
+	auto arrivals{mArrivals};
+	state.put(static_cast<std::uint32_t>(arrivals.size()));
+	while (!arrivals.empty())
+	{
+		state.put(arrivals.top().first);
+		state.put(static_cast<std::uint64_t>(arrivals.top().second));
+		arrivals.pop();
+	}
+}
+
+SnapshotCommit WorkloadGenerator::restore(SnapshotReader &state)
+{
+	std::string engine{state.getString()};
+	std::size_t generated{static_cast<std::size_t>(state.get<std::uint64_t>())};
+	std::vector<Customer> customers;
+	std::uint32_t count{state.get<std::uint32_t>()};
+	for (std::uint32_t i = 0; i < count && state.ok(); i++)
+	{
+		customers.push_back(state.get<Customer>());
+	}
+	std::vector<std::pair<double, std::size_t>> arrivals;
+	std::uint32_t pending{state.get<std::uint32_t>()};
+	for (std::uint32_t i = 0; i < pending && state.ok(); i++)
+	{
+		double arrival{state.get<double>()};
+		std::size_t index{static_cast<std::size_t>(state.get<std::uint64_t>())};
+		if (index < customers.size())
+		{
+			arrivals.emplace_back(arrival, index);
+		}
+	}
+
+	return [=, this, customers = std::move(customers), arrivals = std::move(arrivals)]() {
+		std::istringstream saved{engine};
+		saved >> mRandom;
+		mGenerated = generated;
+		mCustomers = customers;
+		mArrivals = {};
+		for (const auto &arrival : arrivals)
+		{
+			mArrivals.push(arrival);
+		}
+	};
+}
+
+std::size_t WorkloadGenerator::generated() const
+{
+	return mGenerated;
+}
+
+double WorkloadGenerator::nextArrival(Customer &customer, double from)
+{
+	double time{from};
+	while (true)
+	{
+		double rate{(customer.bursting) ? mRate * mBurstFactor : mRate};
+		double arrival{time + exponential(rate)};
+		if (!mBursty || arrival < customer.periodEnd)
+		{
+			return arrival;
+		}
+		// Arrivals are memoryless, so sampling restarts at the start of the next period
+		time = customer.periodEnd;
+		customer.bursting = !customer.bursting;
+		customer.periodEnd = time + exponential(1 / ((customer.bursting) ? mBurstSeconds : mCalmSeconds));
+	}
+}
+
+const WorkloadGenerator::MenuItem* WorkloadGenerator::pickItem(const Customer &customer, Budget budget)
+{
+	double total{0};
+	for (const MenuItem &item : mMenu)
+	{
+		if (matches(item, customer, budget))
+		{
+			total += item.weight;
+		}
+	}
+	if (total <= 0)
+	{
+		return nullptr;
+	}
+	double target{mUniform(mRandom) * total};
+	const MenuItem *picked{nullptr};
+	for (const MenuItem &item : mMenu)
+	{
+		if (matches(item, customer, budget))
+		{
+			picked = &item;
+			target -= item.weight;
+			if (target < 0)
+			{
+				break;
+			}
+		}
+	}
+	return picked;
+}
+
+bool WorkloadGenerator::matches(const MenuItem &item, const Customer &customer, Budget budget) const
+{
+	switch (budget)
+	{
+	case Budget::WITHIN:
+		return item.price <= customer.balance;
+	case Budget::OVER:
+		return item.price > customer.balance;
+	default:
+		return true;
+	}
+}
+
+double WorkloadGenerator::exponential(double rate)
+{
+	return std::exponential_distribution<double>{rate}(mRandom);
+}
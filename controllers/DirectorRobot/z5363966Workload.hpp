@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "z5363966Settings.hpp"
+#include "z5363966Snapshot.hpp"
+
+// An order for the director to dispatch
+struct Order {
+    double arrival;     // seconds after auto mode started, the order is not dispatched before then
+    int customer;
+    std::string item;
+};
+
+/**
+ * @brief Stream of orders read one at a time, so a source of any length uses constant memory
+ *
+ */
+class OrderSource {
+public:
+    /**
+     * @brief Reads the next order, in order of arrival
+     *
+     * @return boolean, false once the source is exhausted
+     */
+    virtual bool next(Order&) = 0;
+
+    /**
+     * @brief Writes the position in the stream to a snapshot
+     *
+     */
+    virtual void save(SnapshotWriter&) = 0;
+
+    /**
+     * @brief Reads back a position written by save, to carry on the stream from once applied
+     *
+     * @return SnapshotCommit
+     */
+    virtual SnapshotCommit restore(SnapshotReader&) = 0;
+
+    virtual ~OrderSource() = default;
+};
+
+/**
+ * @brief Replays a "Robot,Order" csv file. Every order arrives as soon as auto mode starts.
+ *
+ */
+class OrderFile : public OrderSource {
+public:
+    explicit OrderFile(const std::string&);
+    bool next(Order&) override;
+
+    /**
+     * @brief Saves the byte offset of the next line, or -1 once the file is exhausted
+     *
+     */
+    void save(SnapshotWriter&) override;
+    SnapshotCommit restore(SnapshotReader&) override;
+
+private:
+    std::ifstream mFile;
+};
+
+/**
+ * @brief Generates orders from a load model instead of a file.
+ *
+ * Every customer in Starting.csv (other than the staff) orders independently, either as a Poisson
+ * process or alternating between calm and burst periods. Items are drawn from Menu.csv by weight,
+ * with a configurable fraction of items that are not on the menu and of items the customer cannot
+ * afford. Only the next arrival of each customer is kept, so memory does not grow with the number
+ * of orders.
+ *
+ */
+class WorkloadGenerator : public OrderSource {
+public:
+    /**
+     * @brief Reads the load model from the workload_* settings
+     *
+     * @param settings
+     * @param menuPath Menu.csv
+     * @param startingPath Starting.csv
+     */
+    WorkloadGenerator(const Settings&, const std::string&, const std::string&);
+
+    bool next(Order&) override;
+
+    /**
+     * @brief Saves the random engine, every customer and their next arrivals
+     *
+     */
+    void save(SnapshotWriter&) override;
+    SnapshotCommit restore(SnapshotReader&) override;
+
+    /**
+     * @brief Number of orders generated so far
+     *
+     * @return std::size_t
+     */
+    std::size_t generated() const;
+
+private:
+    struct MenuItem {
+        std::string name;
+        double price;
+        double weight;
+    };
+
+    // Which items pickItem chooses from, relative to the customer's balance
+    enum class Budget : unsigned char { ANY, WITHIN, OVER };
+
+    struct Customer {
+        int id;
+        double balance;     // starting cash less the orders generated for it so far
+        bool bursting;
+        double periodEnd;   // end of the current calm or burst period [s]
+    };
+
+    /**
+     * @brief Samples the arrival after the given time, moving the customer through calm and burst periods
+     *
+     * @return double
+     */
+    double nextArrival(Customer&, double);
+
+    /**
+     * @brief Picks a menu item by weight from the items matching the budget
+     *
+     * @return const MenuItem*, nullptr if no item matches
+     */
+    const MenuItem* pickItem(const Customer&, Budget);
+
+    bool matches(const MenuItem&, const Customer&, Budget) const;
+
+    double exponential(double);
+
+    std::mt19937_64 mRandom;
+    std::uniform_real_distribution<double> mUniform;
+    std::vector<MenuItem> mMenu;
+    std::vector<Customer> mCustomers;
+
+    // Next arrival of every customer, earliest first, as {arrival, index into mCustomers}
+    std::priority_queue<std::pair<double, std::size_t>, std::vector<std::pair<double, std::size_t>>,
+                        std::greater<std::pair<double, std::size_t>>> mArrivals;
+
+    std::size_t mGenerated;
+    std::size_t mLimit;
+    bool mBursty;
+    double mRate;
+    double mBurstFactor;
+    double mBurstSeconds;
+    double mCalmSeconds;
+    double mInvalidFraction;
+    double mOverBudgetFraction;
+};
@@ -0,0 +1,259 @@
+#include "z5363966Inventory.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+Inventory::Inventory(const Menu &menu, const std::string &stockPath, const Settings &settings)
+    : mRecipes(menu.size()),
+      mShortOf(menu.size(), 0),
+      mWithdrawn(menu.size(), false),
+      mCanMake((menu.size() + 63) / 64, 0),
+      mRestockInterval(settings.getDouble("restock_interval", 3600)),
+      mNextRestock(mRestockInterval),
+      mRestocks(0)
+{
+    double scale{settings.getDouble("stock_scale", 1)};
+    std::ifstream stockFile{stockPath, std::ifstream::in};
+    std::string lineInput;
+
+    // Skips the header line
+    std::getline(stockFile, lineInput);
+    while (std::getline(stockFile, lineInput))
+    {
+        // stockLine will be in the form of {ingredient, openingStock}
+        std::stringstream lineStream{lineInput};
+        std::string name;
+        std::string amount;
+        if (std::getline(lineStream, name, ',') && std::getline(lineStream, amount, ',') && !name.empty())
+        {
+            IngredientId ingredient{intern(name)};
+            mPar[ingredient] = std::llround(std::stod(amount) * scale);
+        }
+    }
+
+    // A recipe is "<ingredient>:<amount>;...", an ingredient without an amount needs one
+    for (ItemId item = 0; item < menu.size(); item++)
+    {
+        std::stringstream recipe{menu.recipe(item)};
+        std::string entry;
+        while (std::getline(recipe, entry, ';'))
+        {
+            std::size_t colon{entry.rfind(':')};
+            std::int64_t amount{(colon != std::string::npos) ? std::stoll(entry.substr(colon + 1)) : 1};
+            if (entry.empty() || amount <= 0)
+            {
+                continue;
+            }
+            IngredientId ingredient{intern(entry.substr(0, colon))};
+            auto &needs{mRecipes[item]};
+            auto same{std::find_if(needs.begin(), needs.end(), [ingredient](const auto &need) { return need.first == ingredient; })};
+            if (same != needs.end())
+            {
+                same->second += amount;
+            }
+            else
+            {
+                needs.emplace_back(ingredient, amount);
+            }
+        }
+        for (const auto &[ingredient, amount] : mRecipes[item])
+        {
+            mUses[ingredient].push_back({amount, item});
+        }
+    }
+    for (std::vector<Use> &uses : mUses)
+    {
+        std::sort(uses.begin(), uses.end(), [](const Use &a, const Use &b) { return a.amount < b.amount; });
+    }
+
+    mStock = mPar;
+    recount();
+}
+
+bool Inventory::canMake(ItemId item) const
+{
+    return item < mShortOf.size() && ((mCanMake[item / 64] >> (item % 64)) & 1) != 0;
+}
+
+void Inventory::withdraw(ItemId item)
+{
+    if (item >= mShortOf.size() || mWithdrawn[item])
+    {
+        return;
+    }
+    mWithdrawn[item] = true;
+    setShort(item, mShortOf[item] + 1);
+}
+
+bool Inventory::withdrawn(ItemId item) const
+{
+    return item < mWithdrawn.size() && mWithdrawn[item];
+}
+
+bool Inventory::consume(ItemId item)
+{
+    if (!canMake(item))
+    {
+        return false;
+    }
+    for (const auto &[ingredient, amount] : mRecipes[item])
+    {
+        adjust(ingredient, -amount);
+    }
+    return true;
+}
+
+void Inventory::release(ItemId item)
+{
+    if (item >= mRecipes.size())
+    {
+        return;
+    }
+    for (const auto &[ingredient, amount] : mRecipes[item])
+    {
+        adjust(ingredient, amount);
+    }
+}
+
+bool Inventory::update(double now)
+{
+    if (mRestockInterval <= 0 || now < mNextRestock)
+    {
+        return false;
+    }
+    mNextRestock = now + mRestockInterval;
+    for (IngredientId ingredient = 0; ingredient < mStock.size(); ingredient++)
+    {
+        if (mStock[ingredient] < mPar[ingredient])
+        {
+            adjust(ingredient, mPar[ingredient] - mStock[ingredient]);
+        }
+    }
+    mRestocks++;
+    return true;
+}
+
+std::vector<ItemId> Inventory::takeChanges()
+{
+    return std::exchange(mChanges, {});
+}
+
+std::size_t Inventory::ingredients() const
+{
+    return mNames.size();
+}
+
+const std::string& Inventory::ingredientName(IngredientId ingredient) const
+{
+    return mNames[ingredient];
+}
+
+std::int64_t Inventory::stock(IngredientId ingredient) const
+{
+    return mStock[ingredient];
+}
+
+long Inventory::restocks() const
+{
+    return mRestocks;
+}
+
+void Inventory::save(SnapshotWriter &state, double now) const
+{
+    state.put(static_cast<std::uint32_t>(mStock.size()));
+    for (std::int64_t stock : mStock)
+    {
+        state.put(stock);
+    }
+    state.put(mNextRestock - now);
+    state.put(mRestocks);
+}
+
+SnapshotCommit Inventory::restore(SnapshotReader &state, double now)
+{
+    // Ingredients are interned in the same order from the same files, so stock is saved by ID
+    std::vector<std::int64_t> stock;
+    std::uint32_t ingredients{state.get<std::uint32_t>()};
+    for (std::uint32_t ingredient = 0; ingredient < ingredients && state.ok(); ingredient++)
+    {
+        stock.push_back(state.get<std::int64_t>());
+    }
+    double nextRestock{now + state.get<double>()};
+    long restocks{state.get<long>()};
+
+    return [=, this, stock = std::move(stock)]() {
+        for (std::size_t ingredient = 0; ingredient < stock.size() && ingredient < mStock.size(); ingredient++)
+        {
+            mStock[ingredient] = stock[ingredient];
+        }
+        mNextRestock = nextRestock;
+        mRestocks = restocks;
+        recount();
+    };
+}
+
+IngredientId Inventory::intern(const std::string &name)
+{
+    auto known{mIds.find(name)};
+    if (known != mIds.end())
+    {
+        return known->second;
+    }
+    IngredientId ingredient{static_cast<IngredientId>(mNames.size())};
+    mIds[name] = ingredient;
+    mNames.push_back(name);
+    mStock.push_back(0);
+    mPar.push_back(0);
+    mUses.emplace_back();
+    return ingredient;
+}
+
+void Inventory::adjust(IngredientId ingredient, std::int64_t change)
+{
+    std::int64_t before{mStock[ingredient]};
+    std::int64_t after{before + change};
+    mStock[ingredient] = after;
+
+    // Items needing more than the lower of the two stocks but no more than the higher crossed over
+    const std::vector<Use> &uses{mUses[ingredient]};
+    auto above{[](std::int64_t stock, const Use &use) { return stock < use.amount; }};
+    auto first{std::upper_bound(uses.begin(), uses.end(), std::min(before, after), above)};
+    auto last{std::upper_bound(first, uses.end(), std::max(before, after), above)};
+    int shortfall{(after < before) ? 1 : -1};
+    for (auto use = first; use != last; ++use)
+    {
+        setShort(use->item, mShortOf[use->item] + shortfall);
+    }
+}
+
+void Inventory::setShort(ItemId item, int shortOf)
+{
+    bool could{mShortOf[item] == 0};
+    mShortOf[item] = shortOf;
+    if (could != (shortOf == 0))
+    {
+        mCanMake[item / 64] ^= std::uint64_t{1} << (item % 64);
+        mChanges.push_back(item);
+    }
+}
+
+void Inventory::recount()
+{
+    std::fill(mCanMake.begin(), mCanMake.end(), 0);
+    for (ItemId item = 0; item < mRecipes.size(); item++)
+    {
+        int shortOf{mWithdrawn[item] ? 1 : 0};
+        for (const auto &[ingredient, amount] : mRecipes[item])
+        {
+            shortOf += (mStock[ingredient] < amount) ? 1 : 0;
+        }
+        mShortOf[item] = shortOf;
+        if (shortOf == 0)
+        {
+            mCanMake[item / 64] |= std::uint64_t{1} << (item % 64);
+        }
+        mChanges.push_back(item);
+    }
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "z5363966Menu.hpp"
+#include "z5363966Settings.hpp"
+#include "z5363966Snapshot.hpp"
+
+// Stock of the ingredients the kitchen makes the menu from, hosted by the staff.
+//
+// Each item's recipe is the fourth column of Menu.csv, e.g. "espresso:1;milk:220", units of each
+// ingredient per serve. An item with no recipe never runs out. The opening stock of each ingredient
+// is read from Stock.csv, scaled by stock_scale, and is also its par level: every restock_interval
+// simulated seconds a delivery tops every ingredient back up to par in one batch.
+//
+// Whether an item can be made is a bit per item, tested in constant time when an order is checked.
+// The bits are kept up to date incrementally rather than by walking recipes. Each item counts the
+// ingredients it is short of, and each ingredient lists the items that use it sorted by the amount
+// they need. When the stock of an ingredient moves, only the items whose amount lies between the old
+// and new stock change their count, found by binary search.
+
+using IngredientId = std::uint16_t;
+
+class Inventory {
+    public:
+        /**
+         * @brief Reads the recipes from the menu and the opening stock from Stock.csv
+         *
+         * @param menu items and their recipes
+         * @param stockPath Stock.csv, rows of ingredient, opening stock
+         * @param settings stock_scale and restock_interval
+         */
+        Inventory(const Menu&, const std::string&, const Settings&);
+
+        /**
+         * @brief Whether the stock holds every ingredient of one serve of an item and it has not
+         * been withdrawn
+         *
+         * @return boolean
+         */
+        bool canMake(ItemId) const;
+
+        /**
+         * @brief Takes an item off the menu whatever the stock, e.g. one listed in menu_unavailable
+         *
+         */
+        void withdraw(ItemId);
+
+        bool withdrawn(ItemId) const;
+
+        /**
+         * @brief Takes the ingredients of one serve of an item out of stock
+         *
+         * @return boolean, false and nothing taken if it cannot be made
+         */
+        bool consume(ItemId);
+
+        /**
+         * @brief Puts the ingredients of one serve back, e.g. for an order that was not paid for
+         *
+         */
+        void release(ItemId);
+
+        /**
+         * @brief Tops every ingredient back up to par if a restock is due
+         *
+         * @param now simulated time [s]
+         * @return boolean, true if a restock was delivered
+         */
+        bool update(double);
+
+        /**
+         * @brief Items whose canMake() may have changed since the last call, to pass on to the menu
+         *
+         * @return std::vector<ItemId>
+         */
+        std::vector<ItemId> takeChanges();
+
+        /**
+         * @brief Number of ingredients in Stock.csv or any recipe
+         *
+         * @return std::size_t
+         */
+        std::size_t ingredients() const;
+
+        const std::string& ingredientName(IngredientId) const;
+        std::int64_t stock(IngredientId) const;
+
+        /**
+         * @brief Restocks delivered so far
+         *
+         * @return long
+         */
+        long restocks() const;
+
+        /**
+         * @brief Writes the stock and the time to the next restock
+         *
+         * @param state
+         * @param now simulated time [s]
+         */
+        void save(SnapshotWriter&, double) const;
+
+        /**
+         * @brief Reads back the state written by save. Applying it recounts what every item is
+         * short of.
+         *
+         * @param state
+         * @param now simulated time [s]
+         * @return SnapshotCommit
+         */
+        SnapshotCommit restore(SnapshotReader&, double);
+
+    private:
+        struct Use {
+            std::int64_t amount;    // per serve
+            ItemId item;
+        };
+
+        IngredientId intern(const std::string&);
+        void adjust(IngredientId, std::int64_t);
+        void setShort(ItemId, int);
+        void recount();
+
+        std::vector<std::string> mNames;
+        std::unordered_map<std::string, IngredientId> mIds;
+        std::vector<std::int64_t> mStock;
+        std::vector<std::int64_t> mPar;
+
+        // Recipe of each item, and items using each ingredient by ascending amount
+        std::vector<std::vector<std::pair<IngredientId, std::int64_t>>> mRecipes;
+        std::vector<std::vector<Use>> mUses;
+
+        // Ingredients each item is short of, one more if withdrawn, and whether that is none
+        std::vector<int> mShortOf;
+        std::vector<bool> mWithdrawn;
+        std::vector<std::uint64_t> mCanMake;
+        std::vector<ItemId> mChanges;
+
+        double mRestockInterval;
+        double mNextRestock;
+        long mRestocks;
+};
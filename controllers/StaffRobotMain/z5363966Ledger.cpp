@@ -0,0 +1,249 @@
+#include "z5363966Ledger.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+
+Cents toCents(double dollars)
+{
+    return static_cast<Cents>(std::llround(dollars * 100));
+}
+
+double toDollars(Cents cents)
+{
+    return static_cast<double>(cents) / 100;
+}
+
+namespace {
+    // Formats cents as dollars with two decimal places
+    std::string formatDollars(Cents cents)
+    {
+        std::ostringstream text;
+        text << std::setprecision(2) << std::fixed << toDollars(cents);
+        return text.str();
+    }
+}
+
+Ledger::Ledger(const std::string &startingPath, const std::string &accountPath, const std::string &checkpointPath,
+               int till, double interval, const Menu &menu)
+    : mOpeningTotal(0),
+      mTransfers(0),
+      mTill(till),
+      mMenu(menu),
+      mAccountPath(accountPath),
+      mCheckpointPath(checkpointPath),
+      mInterval(interval),
+      mLastCheckpoint(0),
+      mRestored(false)
+{
+    std::ifstream startingFile{startingPath, std::ifstream::in};
+    std::string lineInput;
+
+    // Skips the header line
+    std::getline(startingFile, lineInput);
+    while (std::getline(startingFile, lineInput))
+    {
+        std::size_t comma{lineInput.find(',')};
+        if (comma == std::string::npos)
+        {
+            continue;
+        }
+        Cents opening{toCents(std::stod(lineInput.substr(comma + 1)))};
+        mAccounts[std::stoi(lineInput.substr(0, comma))] = {opening, 0};
+        mOpeningTotal += opening;
+    }
+}
+
+void Ledger::start()
+{
+    if (mRestored)
+    {
+        return;
+    }
+
+    // Writes initial content to the account
+    std::ofstream accountFile{mAccountPath, std::ios::out | std::ios::trunc};
+    accountFile << "Order,Item,Customer,Account Balance ($)" << std::endl;
+    accountFile << "0,,," << formatDollars(balance(mTill)) << std::endl;
+}
+
+void Ledger::save(SnapshotWriter &state)
+{
+    checkpoint();
+    std::error_code error;
+    std::uintmax_t journalSize{std::filesystem::file_size(mAccountPath, error)};
+    state.put(static_cast<std::uint64_t>(error ? 0 : journalSize));
+    state.put(mOpeningTotal);
+    state.put(static_cast<std::uint64_t>(mTransfers));
+    state.put(static_cast<std::uint32_t>(mAccounts.size()));
+    for (const auto &entry : mAccounts)
+    {
+        state.put(entry.first);
+        state.put(entry.second.balance);
+        state.put(entry.second.lastPayment);
+    }
+}
+
+SnapshotCommit Ledger::restore(SnapshotReader &state)
+{
+    std::uint64_t journalSize{state.get<std::uint64_t>()};
+    Cents openingTotal{state.get<Cents>()};
+    std::size_t transfers{static_cast<std::size_t>(state.get<std::uint64_t>())};
+    std::unordered_map<int, Account> accounts;
+    std::uint32_t count{state.get<std::uint32_t>()};
+    for (std::uint32_t i = 0; i < count && state.ok(); i++)
+    {
+        int id{state.get<int>()};
+        Cents balance{state.get<Cents>()};
+        accounts[id] = {balance, state.get<std::uint32_t>()};
+    }
+
+    return [=, this, accounts = std::move(accounts)]() {
+        mOpeningTotal = openingTotal;
+        mTransfers = transfers;
+        mAccounts = accounts;
+        mJournal.clear();
+
+        // Lines after the snapshot belong to payments the restored ledger has not applied
+        std::error_code error;
+        std::filesystem::resize_file(mAccountPath, journalSize, error);
+        mRestored = !error;
+    };
+}
+
+Ledger::Result Ledger::transfer(int payer, std::uint32_t paymentId, int payee, Cents amount, ItemId item)
+{
+    auto from{mAccounts.find(payer)};
+    auto to{mAccounts.find(payee)};
+    if (from == mAccounts.end() || to == mAccounts.end())
+    {
+        return Result::UNKNOWN_ACCOUNT;
+    }
+    if (paymentId <= from->second.lastPayment)
+    {
+        return Result::DUPLICATE;
+    }
+    if (from->second.balance < amount)
+    {
+        return Result::INSUFFICIENT_FUNDS;
+    }
+
+    // Validated above, so both sides are applied together
+    from->second.balance -= amount;
+    to->second.balance += amount;
+    from->second.lastPayment = paymentId;
+    mTransfers++;
+
+    if (payee == mTill)
+    {
+        mJournal.push_back({mTransfers, item, payer, to->second.balance});
+    }
+    return Result::APPLIED;
+}
+
+Cents Ledger::balance(int account) const
+{
+    auto it{mAccounts.find(account)};
+    return (it != mAccounts.end()) ? it->second.balance : 0;
+}
+
+bool Ledger::has(int account) const
+{
+    return mAccounts.count(account) != 0;
+}
+
+void Ledger::update(double simTime)
+{
+    if (simTime - mLastCheckpoint >= mInterval)
+    {
+        mLastCheckpoint = simTime;
+        checkpoint();
+    }
+}
+
+void Ledger::checkpoint()
+{
+    if (!mJournal.empty())
+    {
+        std::ofstream accountFile{mAccountPath, std::ios::out | std::ios::app};
+        for (const JournalEntry &entry : mJournal)
+        {
+            accountFile << entry.transfer << ',' << ((entry.item < mMenu.size()) ? mMenu.name(entry.item) : "") << ','
+                        << entry.payer << ',' << formatDollars(entry.tillBalance) << '\n';
+        }
+        accountFile.flush();
+        mJournal.clear();
+    }
+
+    // Writes to a temporary file first so a crash never leaves a half written checkpoint
+    std::string tmpPath{mCheckpointPath + ".tmp"};
+    {
+        std::ofstream checkpointFile{tmpPath, std::ios::out | std::ios::trunc};
+        checkpointFile << "Account,Balance ($),Last Payment" << '\n';
+        for (const auto &entry : mAccounts)
+        {
+            checkpointFile << entry.first << ',' << formatDollars(entry.second.balance) << ',' << entry.second.lastPayment << '\n';
+        }
+    }
+    std::remove(mCheckpointPath.c_str());
+    std::rename(tmpPath.c_str(), mCheckpointPath.c_str());
+}
+
+Cents Ledger::total() const
+{
+    Cents sum{0};
+    for (const auto &entry : mAccounts)
+    {
+        sum += entry.second.balance;
+    }
+    return sum;
+}
+
+Cents Ledger::openingTotal() const
+{
+    return mOpeningTotal;
+}
+
+Ledger::Reconciliation Ledger::reconcile(const std::unordered_map<int, Cents> &reported) const
+{
+    Reconciliation result{{}, {}, 0, false};
+    for (const auto &entry : mAccounts)
+    {
+        auto report{reported.find(entry.first)};
+        if (report == reported.end())
+        {
+            result.unreported.push_back(entry.first);
+            result.total += entry.second.balance;
+            continue;
+        }
+        if (report->second != entry.second.balance)
+        {
+            result.mismatched.push_back(entry.first);
+        }
+        result.total += report->second;
+    }
+
+    // Money held by a robot without an account came from outside the ledger
+    for (const auto &report : reported)
+    {
+        if (!has(report.first))
+        {
+            result.mismatched.push_back(report.first);
+            result.total += report.second;
+        }
+    }
+    std::sort(result.mismatched.begin(), result.mismatched.end());
+    std::sort(result.unreported.begin(), result.unreported.end());
+    result.conserved = result.mismatched.empty() && result.unreported.empty() && result.total == mOpeningTotal;
+    return result;
+}
+
+std::size_t Ledger::accounts() const
+{
+    return mAccounts.size();
+}
+
+std::size_t Ledger::transfers() const
+{
+    return mTransfers;
+}
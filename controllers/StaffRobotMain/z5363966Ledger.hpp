@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "z5363966Snapshot.hpp"
+#include "z5363966Menu.hpp"
+
+// Money is held in whole cents so transfers are exact and totals can be compared for equality
+using Cents = std::int64_t;
+
+/**
+ * @brief Converts dollars to cents, rounding to the nearest cent
+ *
+ * @return Cents
+ */
+Cents toCents(double);
+
+/**
+ * @brief Converts cents to dollars
+ *
+ * @return double
+ */
+double toDollars(Cents);
+
+/**
+ * @brief Balances of every robot, hosted by the staff.
+ *
+ * Accounts are opened from Starting.csv and indexed by robot ID. Money only moves through
+ * transfer(), which either applies both the debit and the credit or neither. Every payment carries
+ * an ID that increases per payer, so a payment that arrives twice is applied once. Transfers are
+ * journalled in memory by item ID and written to Account.csv, with item names and a checkpoint of
+ * every balance, at checkpoint intervals rather than on every order.
+ *
+ */
+class Ledger {
+    public:
+        enum class Result : unsigned char { APPLIED, DUPLICATE, INSUFFICIENT_FUNDS, UNKNOWN_ACCOUNT };
+
+        /**
+         * @brief Outcome of comparing the balances the robots hold with the ledger at the end of a run
+         *
+         */
+        struct Reconciliation {
+            std::vector<int> mismatched;    // robots that hold a balance other than their account's, or hold no account
+            std::vector<int> unreported;    // accounts whose robot reported no balance
+            Cents total;                    // of the reported balances, and the ledger's for unreported accounts
+            bool conserved;                 // every balance matched and they total the opening balances
+        };
+
+        /**
+         * @brief Opens every account in Starting.csv
+         *
+         * @param startingPath Starting.csv
+         * @param accountPath Account.csv, journal of transfers into the till
+         * @param checkpointPath balances at the last checkpoint
+         * @param till account whose balance the journal records, the staff
+         * @param interval checkpoint interval [s]
+         * @param menu names the items in Account.csv
+         */
+        Ledger(const std::string&, const std::string&, const std::string&, int, double, const Menu&);
+
+        /**
+         * @brief Starts a new Account.csv journal, unless the ledger was restored from a snapshot
+         *
+         */
+        void start();
+
+        /**
+         * @brief Checkpoints, then writes every account and the length of Account.csv to the snapshot
+         *
+         */
+        void save(SnapshotWriter&);
+
+        /**
+         * @brief Reads back the accounts. Applying them cuts Account.csv back to its length at the
+         * snapshot.
+         *
+         * @return SnapshotCommit
+         */
+        SnapshotCommit restore(SnapshotReader&);
+
+        /**
+         * @brief Moves money from payer to payee if the payer can afford it and the payment ID has
+         * not been applied yet
+         *
+         * @param payer, paymentId, payee, amount, item paid for, written to the journal
+         * @return Result
+         */
+        Result transfer(int, std::uint32_t, int, Cents, ItemId);
+
+        /**
+         * @brief Balance of an account, 0 if it does not exist
+         *
+         * @return Cents
+         */
+        Cents balance(int) const;
+
+        bool has(int) const;
+
+        /**
+         * @brief Checkpoints if the interval has elapsed since the last checkpoint
+         *
+         * @param simTime [s]
+         */
+        void update(double);
+
+        /**
+         * @brief Appends the journalled transfers to Account.csv and replaces the checkpoint file
+         *
+         */
+        void checkpoint();
+
+        /**
+         * @brief Total of every balance
+         *
+         * @return Cents
+         */
+        Cents total() const;
+
+        /**
+         * @brief Total of the opening balances
+         *
+         * @return Cents
+         */
+        Cents openingTotal() const;
+
+        /**
+         * @brief Compares the balance each robot reports it holds with its account, and checks the
+         * reported balances still total the opening balances, so no money was created or destroyed
+         *
+         * @param reported balances by robot ID, the till's included
+         * @return Reconciliation, with robot IDs in ascending order
+         */
+        Reconciliation reconcile(const std::unordered_map<int, Cents>&) const;
+
+        /**
+         * @brief Number of accounts
+         *
+         * @return std::size_t
+         */
+        std::size_t accounts() const;
+
+        /**
+         * @brief Number of transfers applied
+         *
+         * @return std::size_t
+         */
+        std::size_t transfers() const;
+
+    private:
+        struct Account {
+            Cents balance;
+            std::uint32_t lastPayment;  // ID of the last payment made from this account, 0 if none
+        };
+
+        // A transfer into the till, not yet written to Account.csv
+        struct JournalEntry {
+            std::size_t transfer;
+            ItemId item;
+            int payer;
+            Cents tillBalance;
+        };
+
+        std::unordered_map<int, Account> mAccounts;
+        Cents mOpeningTotal;
+        std::size_t mTransfers;
+        int mTill;
+
+        const Menu &mMenu;
+        std::vector<JournalEntry> mJournal;
+        std::string mAccountPath;
+        std::string mCheckpointPath;
+        double mInterval;
+        double mLastCheckpoint;
+        bool mRestored;
+};
@@ -1,43 +1,158 @@
 #include "z5363966StaffRobot.hpp"
 
-StaffRobot::StaffRobot()
-    : BaseRobot(),
-      currentOrderWaitTime(0),
-      orderTimer(0),
-      currentCustomer(0),
-      orderCounter(0)
+namespace {
+    // Counts the workflows inside a scope, also when a workflow is destroyed before it finishes
+    struct ScopedCount {
+        int &count;
+
+        explicit ScopedCount(int &counter)
+            : count(counter)
+        {
+            count++;
+        }
+
+        ~ScopedCount()
+        {
+            count--;
+        }
+    };
+
+    // Forgets a customer's order once the workflow serving it ends
+    struct ScopedService {
+        std::unordered_map<int, StaffOrder> &services;
+        int customer;
+
+        ~ScopedService()
+        {
+            services.erase(customer);
+        }
+    };
+
+    // Takes a customer out of its counter's queue once the workflow serving it ends
+    struct ScopedClaim {
+        StaffRobot &staff;
+        int customer;
+
+        ~ScopedClaim()
+        {
+            staff.releaseCounter(customer);
+        }
+    };
+}
+
+StaffRobot::StaffRobot(std::unique_ptr<RobotDevices> devices)
+    : BaseRobot(std::move(devices)),
+      mLedger("../../Starting.csv", "../../Account.csv", "../../Ledger.csv", robotID,
+              mSettings.getDouble("ledger_checkpoint_interval", 10), mMenu),
+      mInventory(mMenu, "../../Stock.csv", mSettings),
+      mMenuPublished(false),
+      mActiveServices(0),
+      mOrdersInKitchen(0),
+      mPreorder(mSettings.getInt("preorder", 0) != 0),
+      mKitchenNextTicket(0),
+      mKitchenServing(0),
+      mKitchenHeadTime(0),
+      mKitchenQueuedSeconds(0),
+      mKitchenDoneTime(0),
+      mStatusInterval(mSettings.getDouble("status_interval", 1)),
+      mNextStatusTime(0),
+      mStation(StaffStation::START),
+      mCounters(mSettings),
+      mCounter(0),
+      mCounterWaiting(mCounters.size(), 0),
+      mCounterQueues(mCounters.size(), 0),
+      mQueuesChanged(false),
+      mLastX(startXPos),
+      mLastZ(startZPos),
+      mClosingDeadline(-1)
 {
-    assignBalance();
+    mBalance = toDollars(mLedger.balance(robotID));
+    mPickupSlots.fill(EMPTY_SLOT);
+
+    // Items listed in menu_unavailable, e.g. "Mocha;Espresso", cannot be ordered
+    mMenuReplica.load(mMenu);
+    std::stringstream unavailable{mSettings.getString("menu_unavailable", "")};
+    std::string name;
+    while (std::getline(unavailable, name, ';'))
+    {
+        mInventory.withdraw(mMenu.find(name));
+    }
 
-    // Writes initial content to the account
-    accountFile.open("../../Account.csv", std::ios::out | std::ios::trunc);
-    accountFile << "Order,Item,Customer,Account Balance ($)" << std::endl;
-    accountFile << "0,,," << std::setprecision(2) << std::fixed << mBalance << std::endl;
+    mMetrics.describe("cafe_orders_received_total", "counter", "Orders received at the counter");
+    mMetrics.describe("cafe_orders_placed_total", "counter", "Orders paid for and sent to the kitchen");
+    mMetrics.describe("cafe_orders_rejected_total", "counter", "Orders rejected at the counter by reason");
+    mMetrics.describe("cafe_order_rejection_ratio", "gauge", "Fraction of received orders that were rejected");
+    mMetrics.describe("cafe_preorders_rolled_back_total", "counter", "Pre-orders taken back out of the kitchen because they were not paid for");
+    mMetrics.describe("cafe_kitchen_wasted_seconds_total", "counter", "Simulated time the kitchen spent on pre-orders that were rolled back");
+    mMetrics.describe("cafe_staff_auto_seconds_total", "counter", "Simulated time spent in auto mode");
+    mMetrics.describe("cafe_staff_busy_seconds_total", "counter", "Simulated time the staff was serving an order");
+    mMetrics.describe("cafe_kitchen_busy_seconds_total", "counter", "Simulated time the kitchen was preparing an order");
+    mMetrics.describe("cafe_staff_utilisation_ratio", "gauge", "Staff busy time over auto mode time");
+    mMetrics.describe("cafe_kitchen_utilisation_ratio", "gauge", "Kitchen busy time over auto mode time");
+    mMetrics.describe("cafe_staff_queue_depth", "gauge", "Customers being served");
+    mMetrics.describe("cafe_kitchen_drain_seconds", "gauge", "Estimated time for the kitchen to finish every placed order");
+    mMetrics.describe("cafe_staff_distance_metres_total", "counter", "Distance the staff has driven");
+    mMetrics.describe("cafe_staff_moving_seconds_total", "counter", "Simulated time the staff spent driving");
+    mMetrics.describe("cafe_deliveries_total", "counter", "Orders carried from the kitchen to a pickup slot");
+    mMetrics.describe("cafe_delivery_rounds_total", "counter", "Rounds from the kitchen that delivered one or more orders");
+    mMetrics.describe("cafe_delivery_seconds_total", "counter", "Simulated time from setting off for the kitchen to leaving the last order of a round");
+    mMetrics.describe("cafe_delivery_saved_metres_total", "counter", "Distance delivery rounds saved against one round trip from the kitchen per order");
+    mMetrics.describe("cafe_delivery_saved_seconds_total", "counter", "Driving time delivery rounds saved, at the staff's mean driving speed");
+    mMetrics.describe("cafe_menu_messages_total", "counter", "Menu snapshots and deltas sent to the customers");
+    mMetrics.describe("cafe_payments_total", "counter", "Payments received by ledger result");
+    mMetrics.describe("cafe_ledger_divergences_total", "counter", "Payments where the customer's balance differed from the ledger");
+    mMetrics.describe("cafe_ledger_total_dollars", "gauge", "Money held across all accounts in the ledger");
+    mMetrics.describe("cafe_ledger_conserved", "gauge", "1 if every robot's final balance matched the ledger and they total the opening balances");
+    mMetrics.describe("cafe_ledger_mismatches_total", "counter", "Robots whose final balance differed from the ledger or was never reported");
+    mMetrics.describe("cafe_item_stockouts_total", "counter", "Times an item became unavailable because an ingredient ran short");
+    mMetrics.describe("cafe_ingredient_stock", "gauge", "Units of each ingredient in stock, not held by an order");
+    mMetrics.describe("cafe_restocks_total", "counter", "Restocks delivered");
+    mMetrics.describe("cafe_counter_queue", "gauge", "Customers queued at each counter, with more than one counter");
+    mMetrics.describe("cafe_staff_counter_visits_total", "counter", "Times the staff drove to serve a counter");
+    updateAvailability();
 }
 
 void StaffRobot::run()
 {
-    // Initial mode: waits for what mode to enter into
+    start();
 
-    while (step(TIME_STEP) != -1)
+    while (step(TIME_STEP) != -1 && update()) {}
+}
+
+void StaffRobot::start()
+{
+    // Initial mode: waits for what mode to enter into, unless carrying on from a snapshot
+    if (!restoreSnapshot())
     {
-        this->currentKey = mKeyboard.getKey();
+        mLedger.start();
+    }
+    mExecutor.spawn(staffRounds());
+}
 
-        currentData = receiveMessage();
-        processData();
+bool StaffRobot::update()
+{
+    this->currentKey = mDevices->key();
+    updateRegistration();
+    publishMenu();
+    publishCounters();
+    updateInventory();
 
-        switch (state)
-        {
-        case REMOTE:
-            remoteControl();
-            break;
-        case AUTO:
-            autoMode();
-            break;
-        case END:
-            return;
-        }
-    }
+    currentData = receiveMessage();
+    currentHeading = updateHeading();
+    updatePosition();
+    recordPose();
+    recordTravel();
+    processData();
+    recordUtilisation();
+    publishStatus();
+    mLedger.update(getTime());
+    mActuators.report(mMetrics);
+    mMetrics.update(getTime());
+    updateSnapshot();
+    updateClosing();
+
+    mControl.step();
+    return !mControl.is(ControlState::END);
 }
 
 void StaffRobot::remoteControl()
@@ -47,16 +162,16 @@ void StaffRobot::remoteControl()
         setMotorPosition();
         switch (std::tolower(currentKey))
         {
-        case webots::Keyboard::UP:
+        case RobotDevices::KEY_UP:
             moveForward(defaultMotorSpeed);
             break;
-        case webots::Keyboard::LEFT:
+        case RobotDevices::KEY_LEFT:
             turnLeft(defaultMotorSpeed);
             break;
-        case webots::Keyboard::DOWN:
+        case RobotDevices::KEY_DOWN:
             moveBackward(defaultMotorSpeed);
             break;
-        case webots::Keyboard::RIGHT:
+        case RobotDevices::KEY_RIGHT:
             turnRight(defaultMotorSpeed);
             break;
         case 'x':
@@ -70,8 +185,8 @@ void StaffRobot::remoteControl()
             break;
         case 'e':
             halt();
-            state = END;
-            std::cout << "Director: Remote mode was exited!" << std::endl;
+            mControl.transition<ControlState::REMOTE, ControlState::END>();
+            LOG_INFO("Director: Remote mode was exited!");
         }
         setMotorSpeed();
     }
@@ -79,46 +194,316 @@ void StaffRobot::remoteControl()
 
 void StaffRobot::autoMode()
 {
-    switch (autoState)
+    mExecutor.step(getTime());
+}
+
+Task StaffRobot::serveCustomer(int customer, ItemId item, std::string unlisted)
+{
+    ScopedCount serving{mActiveServices};
+    ScopedService service{mServices, customer};
+    ScopedClaim claim{*this, customer};
+    auto [entry, received] = mServices.try_emplace(customer, StaffOrder{customer, item, std::move(unlisted), 0, 0, ServiceStage::CHECK_ORDER, NO_TICKET, 0, false, 0, NO_SLOT});
+    StaffOrder &order{entry->second};
+
+    if (received)
     {
-    case AUTO_IDLE:
-        break;
-    case AUTO_MOVE_ORDER_COUNTER:
-        std::cout << "Staff: I am heading to order counter" << std::endl;
-        // move(STAFF_ORDER_COUNTER_X, STAFF_ORDER_COUNTER_Z);
-        autoState = AUTO_STAFF_CHECK_ORDER;
-        break;
-    case AUTO_MOVE_PICKUP_COUNTER:
-        // move to pickup counter
-        // If arrived then change state to AUTO_STAFF_ORDER_READY
-        autoState = AUTO_STAFF_ORDER_READY;
-        break;
-    case AUTO_MOVE_STARTING_POSITION:
-        std::cout << "Staff: I am returning to starting point" << std::endl;
-        // move
-        if (purchaseConfirmation)
+        mMetrics.increment("cafe_orders_received_total", "");
+    }
+
+    if (order.stage == ServiceStage::CHECK_ORDER)
+    {
+        // The customer orders at the counter, so waits for the staff to get there. A pre-order is
+        // sent on the way and checked straight away.
+        if (!mPreorder)
+        {
+            std::size_t counter{counterOf(customer)};
+            ScopedCount waiting{mCounterWaiting[counter]};
+            co_await until([this, counter] { return mStation == StaffStation::ORDER_COUNTER && mCounter == counter; });
+        }
+        order.stage = checkOrder(order) ? ServiceStage::AWAIT_PAYMENT : ServiceStage::AWAIT_CANCEL;
+        order.checkedTime = getTime();
+        if (mPreorder && order.stage == ServiceStage::AWAIT_PAYMENT)
+        {
+            order.preordered = true;
+            reserveKitchen(order);
+        }
+    }
+
+    if (order.stage == ServiceStage::AWAIT_CANCEL)
+    {
+        // The customer cancels an order it cannot make
+        co_await receive("<", customer);
+        co_return;
+    }
+
+    if (order.stage == ServiceStage::AWAIT_PAYMENT)
+    {
+        Receive paid{receive(">", customer)};
+        Receive cancelled{receive("<", customer)};
+        if (co_await anyOf(paid, cancelled) == 1)
+        {
+            // Item was on the menu, so the customer could not afford it
+            recordRejection("insufficient_balance");
+            rollBack(order, "insufficient_balance");
+            co_return;
+        }
+        if (!takePayment(order, paid.await_resume()))
+        {
+            rollBack(order, "declined");
+            co_return;
+        }
+
+        placeOrder(order);
+        if (order.ticket == NO_TICKET)
+        {
+            reserveKitchen(order);
+        }
+        order.stage = ServiceStage::KITCHEN_QUEUE;
+    }
+
+    if (order.stage == ServiceStage::KITCHEN_QUEUE || order.stage == ServiceStage::COOKING)
+    {
+        ScopedCount cooking{mOrdersInKitchen};
+        if (order.stage == ServiceStage::KITCHEN_QUEUE)
+        {
+            co_await until([this, &order] { return order.ticket == mKitchenServing; });
+            mKitchenQueuedSeconds -= order.prepSeconds;
+            // A pre-order has been prepared since it reached the head of the queue, or since it was
+            // checked if that was later
+            double started{order.preordered ? std::max(mKitchenHeadTime, order.checkedTime) : getTime()};
+            order.cookedTime = mKitchenDoneTime = started + order.prepSeconds;
+            order.stage = ServiceStage::COOKING;
+        }
+        co_await mExecutor.sleepFor(order.cookedTime - getTime());
+        advanceKitchen();
+        LOG_INFO("Staff: *order for Customer ", customer, " is prepared, waiting in the kitchen*");
+        order.stage = ServiceStage::READY;
+        mReadyOrders.push_back(customer);
+    }
+
+    if (order.stage == ServiceStage::READY)
+    {
+        // The staff's rounds carry it to a pickup slot
+        co_await until([&order] { return order.stage == ServiceStage::AWAIT_PICKUP; });
+    }
+
+    co_await receive("*", customer);
+    if (order.slot != NO_SLOT)
+    {
+        mPickupSlots[order.slot] = EMPTY_SLOT;
+    }
+}
+
+Task StaffRobot::staffRounds()
+{
+    while (true)
+    {
+        co_await until([this] {
+            return busiestCounter() != NO_COUNTER || deliverable() || (mActiveServices == 0 && mStation != StaffStation::START);
+        });
+
+        std::size_t counter{busiestCounter()};
+        if (counter != NO_COUNTER)
+        {
+            if (mStation != StaffStation::ORDER_COUNTER || mCounter != counter)
+            {
+                LOG_INFO("Staff: I am heading to order counter");
+                mStation = StaffStation::MOVING;
+                mCounter = counter;
+                mMetrics.increment("cafe_staff_counter_visits_total", "");
+                RoutePoint post{mCounters.staffPost(counter)};
+                co_await arriveAt(post.x, post.z, FACE_COUNTER);
+                mStation = StaffStation::ORDER_COUNTER;
+            }
+            co_await until([this] { return mCounterWaiting[mCounter] == 0; });
+        }
+        else if (deliverable())
         {
-            autoState = AUTO_STAFF_ORDER_PREP;
+            LOG_INFO("Staff: I am heading to the kitchen");
+            double setOff{getTime()};
+            mStation = StaffStation::MOVING;
+            co_await arriveAt(KITCHEN.x, KITCHEN.z, FACE_KITCHEN);
+            std::vector<int> batch{takeBatch()};
+            std::vector<RoutePoint> stops;
+            for (int customer : batch)
+            {
+                stops.push_back(pickupSlot(mServices.at(customer).slot));
+            }
+            StaffStation next{nextStation()};
+            RoutePoint to{(next == StaffStation::ORDER_COUNTER) ? mCounters.staffPost(busiestCounter()) :
+                          (next == StaffStation::KITCHEN) ? KITCHEN : RoutePoint{startXPos, startZPos}};
+            std::vector<std::size_t> route{Route::plan(KITCHEN, stops, to)};
+            recordDelivery(stops, route, to);
+
+            LOG_INFO("Staff: *carries ", batch.size(), " orders to the pickup counter*");
+            for (std::size_t stop : route)
+            {
+                co_await arriveAt(stops[stop].x, stops[stop].z, FACE_COUNTER);
+                auto delivered{mServices.find(batch[stop])};
+                if (delivered != mServices.end())
+                {
+                    delivered->second.stage = ServiceStage::AWAIT_PICKUP;
+                    serveOrder(delivered->second);
+                }
+            }
+            mMetrics.increment("cafe_delivery_seconds_total", "", getTime() - setOff);
+            mStation = StaffStation::PICKUP_COUNTER;
         }
         else
         {
-            // if arrived back there then back to idle
-            autoState = AUTO_IDLE;
+            LOG_INFO("Staff: I am returning to starting point");
+            mStation = StaffStation::MOVING;
+            co_await arriveAt(startXPos, startZPos, 0);
+            mStation = StaffStation::START;
         }
-        break;
-    case AUTO_STAFF_CHECK_ORDER:
-        checkOrder();
-        break;
-    case AUTO_STAFF_PLACE_ORDER:
-        placeOrder();
-        break;
-    case AUTO_STAFF_ORDER_PREP:
-        prepareOrder();
-        break;
-    case AUTO_STAFF_ORDER_READY:
-        // move to pick up tile
-        serveOrder();
-        break;
+    }
+}
+
+bool StaffRobot::deliverable() const
+{
+    return !mReadyOrders.empty() &&
+           std::find(mPickupSlots.begin(), mPickupSlots.end(), EMPTY_SLOT) != mPickupSlots.end();
+}
+
+std::vector<int> StaffRobot::takeBatch()
+{
+    std::size_t freeSlots{static_cast<std::size_t>(std::count(mPickupSlots.begin(), mPickupSlots.end(), EMPTY_SLOT))};
+    std::vector<int> batch;
+    while (!mReadyOrders.empty() && batch.size() < CARRY_CAPACITY && batch.size() < freeSlots)
+    {
+        int customer{mReadyOrders.front()};
+        mReadyOrders.pop_front();
+        auto order{mServices.find(customer)};
+        if (order == mServices.end() || order->second.stage != ServiceStage::READY)
+        {
+            continue;
+        }
+        double padZ{mCounters.pickupPad(counterOf(customer)).z};
+        int nearest{NO_SLOT};
+        for (int slot = 0; slot < static_cast<int>(PICKUP_SLOTS); slot++)
+        {
+            if (mPickupSlots[slot] == EMPTY_SLOT &&
+                (nearest == NO_SLOT || std::abs(pickupSlot(slot).z - padZ) < std::abs(pickupSlot(nearest).z - padZ)))
+            {
+                nearest = slot;
+            }
+        }
+        order->second.slot = nearest;
+        mPickupSlots[nearest] = customer;
+        batch.push_back(customer);
+    }
+    return batch;
+}
+
+RoutePoint StaffRobot::pickupSlot(int slot)
+{
+    return {PICKUP_SLOT_X, FIRST_PICKUP_SLOT_Z - PICKUP_SLOT_SPACING * slot};
+}
+
+std::size_t StaffRobot::busiestCounter() const
+{
+    std::size_t busiest{NO_COUNTER};
+    for (std::size_t counter = 0; counter < mCounters.size(); counter++)
+    {
+        if (mCounterWaiting[counter] == 0)
+        {
+            continue;
+        }
+        if (busiest == NO_COUNTER || mCounterWaiting[counter] > mCounterWaiting[busiest] ||
+            (mCounterWaiting[counter] == mCounterWaiting[busiest] &&
+             Route::distance({currentX, currentZ}, mCounters.staffPost(counter)) <
+                 Route::distance({currentX, currentZ}, mCounters.staffPost(busiest))))
+        {
+            busiest = counter;
+        }
+    }
+    return busiest;
+}
+
+std::size_t StaffRobot::counterOf(int customer) const
+{
+    auto claim{mClaims.find(customer)};
+    return (claim != mClaims.end()) ? claim->second : 0;
+}
+
+void StaffRobot::claimCounter(int customer, std::size_t counter)
+{
+    if (counter >= mCounters.size())
+    {
+        LOG_WARN(robotName, ": Customer ", customer, " claimed counter ", counter, " of ", mCounters.size());
+        return;
+    }
+    releaseCounter(customer);
+    mClaims[customer] = counter;
+    mCounterQueues[counter]++;
+    mQueuesChanged = true;
+}
+
+void StaffRobot::releaseCounter(int customer)
+{
+    auto claim{mClaims.find(customer)};
+    if (claim == mClaims.end())
+    {
+        return;
+    }
+    mCounterQueues[claim->second]--;
+    mClaims.erase(claim);
+    mQueuesChanged = true;
+}
+
+void StaffRobot::publishCounters()
+{
+    if (!mQueuesChanged || !registered() || mCounters.size() < 2)
+    {
+        return;
+    }
+    mQueuesChanged = false;
+    sendMessage(Counters::encodeQueues(mCounterQueues), -1);
+    for (std::size_t counter = 0; counter < mCounters.size(); counter++)
+    {
+        mMetrics.set("cafe_counter_queue", "counter=\"" + std::to_string(counter) + "\"", mCounterQueues[counter]);
+    }
+}
+
+StaffStation StaffRobot::nextStation() const
+{
+    if (busiestCounter() != NO_COUNTER)
+    {
+        return StaffStation::ORDER_COUNTER;
+    }
+    if (!mReadyOrders.empty() || mOrdersInKitchen > 0)
+    {
+        return StaffStation::KITCHEN;
+    }
+    return StaffStation::START;
+}
+
+void StaffRobot::recordDelivery(const std::vector<RoutePoint> &stops, const std::vector<std::size_t> &route, const RoutePoint &to)
+{
+    if (stops.empty())
+    {
+        return;
+    }
+    double saved{Route::roundTrips(KITCHEN, stops, to) - Route::length(KITCHEN, stops, route, to)};
+    double driven{mMetrics.value("cafe_staff_distance_metres_total", "")};
+    double speed{(driven > 0) ? driven / mMetrics.value("cafe_staff_moving_seconds_total", "") : 0};
+    mMetrics.increment("cafe_delivery_rounds_total", "");
+    mMetrics.increment("cafe_delivery_saved_metres_total", "", saved);
+    if (speed > 0)
+    {
+        mMetrics.increment("cafe_delivery_saved_seconds_total", "", saved / speed);
+    }
+}
+
+void StaffRobot::recordTravel()
+{
+    double driven{std::hypot(currentX - mLastX, currentZ - mLastZ)};
+    mLastX = currentX;
+    mLastZ = currentZ;
+    if (driven > 0)
+    {
+        mMetrics.increment("cafe_staff_distance_metres_total", "", driven);
+        mMetrics.increment("cafe_staff_moving_seconds_total", "", TIME_STEP / 1000.0);
     }
 }
 
@@ -128,7 +513,15 @@ void StaffRobot::processData()
     {
         if (std::isdigit(currentData[0]))
         { // State changes start with a digit
-            state = std::stoi(currentData);
+            long code{0};
+            if (readNumber(currentData.c_str(), '\0', code))
+            {
+                setControlMode(static_cast<int>(code));
+            }
+            else
+            {
+                LOG_WARN(robotName, ": malformed mode change: ", currentData);
+            }
             currentData = "";
             return;
         }
@@ -137,118 +530,565 @@ void StaffRobot::processData()
         case '?': // Print balance
             printBalance();
             break;
-        case '~': // Controller is told to quit
-            state = END;
-            accountFile.close();
-            printBalance();
+        case '~': // Controller is told to quit, once the customers have reported their final balances
+            if (mClosingDeadline < 0)
+            {
+                mClosingDeadline = getTime() + CLOSING_TIMEOUT;
+            }
             break;
-        case '<': // Purchase fail
-            purchaseConfirmation = false;
-            resetOrdering();
-            autoState = AUTO_MOVE_STARTING_POSITION;
+        case '.': // Final balance of a customer
+            recordFinalBalance(currentData.substr(1));
             break;
+        case '<': // Purchase fail
         case '>': // Purchase success
-            purchaseConfirmation = true;
-            autoState = AUTO_STAFF_PLACE_ORDER;
-            break;
         case '*': // Item picked up from counter
-            autoState = AUTO_MOVE_STARTING_POSITION;
+        {
+            // The customer's robot ID follows the message type, then any details after a ':'
+            long customer{0};
+            if (!readNumber(currentData.c_str() + 1, ':', customer))
+            {
+                LOG_WARN(robotName, ": message without a customer ID: ", currentData);
+                break;
+            }
+            std::size_t colon{currentData.find(':')};
+            postMessage({currentData[0], static_cast<int>(customer),
+                         (colon != std::string::npos) ? currentData.substr(colon + 1) : ""});
             break;
+        }
+        case Counters::MARK:
+        {
+            // Claim is "|<counter>:<customer's robot ID>"
+            long counter{0};
+            long customer{0};
+            std::size_t colon{currentData.find(':')};
+            if (colon == std::string::npos || !readNumber(currentData.c_str() + 1, ':', counter) ||
+                !readNumber(currentData.c_str() + colon + 1, '\0', customer))
+            {
+                LOG_WARN(robotName, ": malformed counter claim: ", currentData);
+                break;
+            }
+            claimCounter(static_cast<int>(customer), static_cast<std::size_t>(counter));
+            break;
+        }
+        case MenuReplica::MARK:
+        {
+            // Only requests are for the staff, "^?<customer's robot ID>"
+            long customer{0};
+            if (currentData.size() > 2 && currentData[1] == MenuReplica::REQUEST)
+            {
+                if (!readNumber(currentData.c_str() + 2, '\0', customer))
+                {
+                    LOG_WARN(robotName, ": menu request without a customer ID: ", currentData);
+                    break;
+                }
+                for (const std::string &chunk : mMenuReplica.snapshot())
+                {
+                    sendMessage(chunk, Roster::channelOf(static_cast<int>(customer)));
+                    mMetrics.increment("cafe_menu_messages_total", "kind=\"snapshot\"");
+                }
+            }
+            break;
+        }
+        case Menu::ITEM_MARK:
+        {
+            // Order of a menu item is "%<item ID>:<customer's robot ID>"
+            long customer{0};
+            std::size_t colon{currentData.find(':')};
+            if (colon == std::string::npos || !readNumber(currentData.c_str() + colon + 1, '\0', customer))
+            {
+                LOG_WARN(robotName, ": order without a customer ID: ", currentData);
+                break;
+            }
+            takeOrder(static_cast<int>(customer), mMenu.decode(currentData.substr(0, colon)), "");
+            break;
+        }
         default:
-            currentOrder = currentData;
-            currentCustomer = currentOrder.back() - '0';
-            currentOrder = currentOrder.substr(0, currentData.size() - 1);
-            autoState = AUTO_MOVE_ORDER_COUNTER;
+        {
+            // Any other order is the item name followed by the customer's robot ID, e.g. Lattea12
+            long customer{0};
+            std::size_t digits{currentData.find_last_not_of("0123456789") + 1};
+            if (digits == currentData.size() || !readNumber(currentData.c_str() + digits, '\0', customer))
+            {
+                LOG_WARN(robotName, ": order without a customer ID: ", currentData);
+                break;
+            }
+            std::string name{currentData.substr(0, digits)};
+            ItemId item{mMenu.find(name)};
+            takeOrder(static_cast<int>(customer), item, (item == Menu::NO_ITEM) ? name : "");
             break;
         }
+        }
     }
 }
 
-void StaffRobot::checkOrder()
+void StaffRobot::takeOrder(int customer, ItemId item, std::string unlisted)
 {
-    std::string lineInput;
-    std::string menuItem, prepTime, itemPrice;
-    std::cout << "Staff: *checking if item exists on menu*" << std::endl;
+    if (mServices.contains(customer))
+    {
+        LOG_WARN(robotName, ": customer ", customer, " ordered again while being served, order dropped");
+        return;
+    }
+    mExecutor.spawn(serveCustomer(customer, item, std::move(unlisted)));
+}
+
+bool StaffRobot::checkOrder(StaffOrder &order)
+{
+    LOG_INFO("Staff: *checking if item exists on menu*");
+    if (order.item != Menu::NO_ITEM && !mInventory.canMake(order.item))
+    {
+        bool withdrawn{mInventory.withdrawn(order.item)};
+        LOG_INFO("Staff: Hi Customer ", order.customer, ", sorry, ", mMenu.name(order.item), withdrawn ? " is unavailable" : " is sold out");
+        sendMessage("-", Roster::channelOf(order.customer));
+        recordRejection(withdrawn ? "unavailable" : "out_of_stock");
+        return false;
+    }
+    if (order.item != Menu::NO_ITEM)
+    {
+        mInventory.consume(order.item);
+        updateAvailability();
+        LOG_INFO("Staff: *finds item on menu*");
+        sendMessage("+", Roster::channelOf(order.customer));
+        LOG_INFO("Staff: Hi Customer ", order.customer, ", the price for ", mMenu.name(order.item), " is ", mMenu.priceText(order.item), " dollars");
+        order.prepSeconds = mMenu.prepSeconds(order.item);
+        order.price = mMenu.price(order.item);
+        sendMessage("$" + mMenu.priceText(order.item), Roster::channelOf(order.customer));
+        return true;
+    }
+    LOG_INFO("Staff: Hi Customer ", order.customer, ", oh no, we don't have ", order.unlisted, " in our menu");
+    sendMessage("-", Roster::channelOf(order.customer));
+    recordRejection("unknown_item");
+    return false;
+}
 
-    std::ifstream menuFile{"../../Menu.csv", std::ifstream::in};
+void StaffRobot::placeOrder(const StaffOrder &order)
+{
+    mMetrics.increment("cafe_orders_placed_total", "");
+    LOG_INFO("Staff : Thanks for your order. It will be ready in ", order.prepSeconds, " seconds");
+    LOG_INFO("Staff: *places order, adds into account, prepares order*");
+}
+
+void StaffRobot::reserveKitchen(StaffOrder &order)
+{
+    order.ticket = mKitchenNextTicket++;
+    mKitchenQueuedSeconds += order.prepSeconds;
+}
 
-    // Check whether order exists in the menu
-    while (std::getline(menuFile, lineInput))
+void StaffRobot::rollBack(StaffOrder &order, const std::string &reason)
+{
+    // The kitchen has used the ingredients of the order it is serving, and nothing else
+    if (order.ticket != mKitchenServing)
+    {
+        mInventory.release(order.item);
+        updateAvailability();
+    }
+    if (order.ticket == NO_TICKET)
     {
-        std::stringstream lineStream{lineInput};
-        std::string stringSegment;
-        std::vector<std::string> menuLine;
+        return;
+    }
+    LOG_INFO("Staff: *takes the order for Customer ", order.customer, " back out of the kitchen*");
+    mKitchenQueuedSeconds -= order.prepSeconds;
+    if (order.ticket == mKitchenServing)
+    {
+        // The kitchen had started on it
+        double started{std::max(mKitchenHeadTime, order.checkedTime)};
+        mMetrics.increment("cafe_kitchen_wasted_seconds_total", "", std::min<double>(getTime() - started, order.prepSeconds));
+        advanceKitchen();
+    }
+    else
+    {
+        mRolledBackTickets.insert(order.ticket);
+    }
+    order.ticket = NO_TICKET;
+    mMetrics.increment("cafe_preorders_rolled_back_total", "reason=\"" + reason + "\"");
+}
+
+void StaffRobot::advanceKitchen()
+{
+    mKitchenServing++;
+    while (mRolledBackTickets.erase(mKitchenServing) > 0)
+    {
+        mKitchenServing++;
+    }
+    mKitchenHeadTime = getTime();
+}
 
-        // menuLine will be in the form of {menuItem, prepTime, itemPrice}
-        // Extracts information into a vector
-        while (std::getline(lineStream, stringSegment, ','))
+bool StaffRobot::takePayment(const StaffOrder &order, const Message &payment)
+{
+    // Body is "<payment ID>:<balance the customer believes it has>"
+    long paymentId{0};
+    bool readable{readNumber(payment.body.c_str(), ':', paymentId)};
+    std::size_t colon{payment.body.find(':')};
+    if (readable && colon != std::string::npos)
+    {
+        double balance{0};
+        if (readAmount(payment.body.c_str() + colon + 1, balance) && toCents(balance) != mLedger.balance(order.customer))
         {
-            menuLine.push_back(stringSegment);
+            LOG_WARN("Staff: Customer ", order.customer, " believes it has $", payment.body.substr(colon + 1),
+                     " but the ledger holds $", LogFixed{toDollars(mLedger.balance(order.customer)), 2});
+            mMetrics.increment("cafe_ledger_divergences_total", "");
         }
+    }
+
+    Ledger::Result result{Ledger::Result::UNKNOWN_ACCOUNT};
+    if (readable)
+    {
+        result = mLedger.transfer(order.customer, static_cast<std::uint32_t>(paymentId), robotID, toCents(order.price), order.item);
+    }
+    else
+    {
+        LOG_WARN(robotName, ": payment without a payment ID: ", payment.body);
+    }
+    std::ostringstream receipt;
+    receipt << std::setprecision(2) << std::fixed << toDollars(mLedger.balance(order.customer));
+    switch (result)
+    {
+    case Ledger::Result::APPLIED:
+        mMetrics.increment("cafe_payments_total", "result=\"applied\"");
+        break;
+    case Ledger::Result::DUPLICATE:
+        // Already applied, so the customer only needs the receipt again
+        mMetrics.increment("cafe_payments_total", "result=\"duplicate\"");
+        break;
+    default:
+        LOG_INFO("Staff: Sorry Customer ", order.customer, ", your payment was declined");
+        mMetrics.increment("cafe_payments_total", "result=\"declined\"");
+        recordRejection("insufficient_balance");
+        sendMessage("!" + receipt.str(), Roster::channelOf(order.customer));
+        return false;
+    }
+    mBalance = toDollars(mLedger.balance(robotID));
+    sendMessage("=" + receipt.str(), Roster::channelOf(order.customer));
+    return true;
+}
+
+void StaffRobot::recordFinalBalance(const std::string &report)
+{
+    // Report is "<robot ID>:<balance>"
+    long customer{0};
+    std::size_t colon{report.find(':')};
+    if (colon == std::string::npos || !readNumber(report.c_str(), ':', customer))
+    {
+        LOG_WARN(robotName, ": malformed final balance: ", report);
+        return;
+    }
+    double balance{0};
+    if (!readAmount(report.c_str() + colon + 1, balance))
+    {
+        LOG_WARN(robotName, ": malformed final balance: ", report);
+        return;
+    }
+    mFinalBalances[static_cast<int>(customer)] = toCents(balance);
 
-        if (currentOrder == menuLine[0])
+    // Reports are handled one a step, so a crowd of customers is waited on while they keep coming
+    if (mClosingDeadline >= 0)
+    {
+        mClosingDeadline = getTime() + CLOSING_TIMEOUT;
+    }
+}
+
+void StaffRobot::updateClosing()
+{
+    // Every account but the till is a customer's
+    if (mClosingDeadline < 0 ||
+        (mFinalBalances.size() + 1 < mLedger.accounts() && getTime() < mClosingDeadline))
+    {
+        return;
+    }
+    mClosingDeadline = -1;
+    reconcileLedger();
+    mControl.transitionTo(ControlState::END);
+    printBalance();
+}
+
+void StaffRobot::reconcileLedger()
+{
+    mLedger.checkpoint();
+    std::unordered_map<int, Cents> reported{mFinalBalances};
+    reported[robotID] = toCents(mBalance);
+    Ledger::Reconciliation result{mLedger.reconcile(reported)};
+    for (int robot : result.mismatched)
+    {
+        LOG_ERROR("Staff: Robot ", robot, " holds $", LogFixed{toDollars(reported[robot]), 2}, " but the ledger holds $",
+                  LogFixed{toDollars(mLedger.balance(robot)), 2});
+        mMetrics.increment("cafe_ledger_mismatches_total", "reason=\"balance\"");
+    }
+    for (int robot : result.unreported)
+    {
+        LOG_ERROR("Staff: Customer ", robot, " never reported its final balance");
+        mMetrics.increment("cafe_ledger_mismatches_total", "reason=\"unreported\"");
+    }
+    mMetrics.set("cafe_ledger_total_dollars", "", toDollars(result.total));
+    mMetrics.set("cafe_ledger_conserved", "", result.conserved ? 1 : 0);
+    if (result.conserved)
+    {
+        LOG_INFO("Staff: Ledger reconciled, $", LogFixed{toDollars(result.total), 2}, " across ",
+                 mLedger.accounts(), " accounts after ", mLedger.transfers(), " payments");
+    }
+    else
+    {
+        LOG_ERROR("Staff: Robots hold $", LogFixed{toDollars(result.total), 2}, " but opened with $",
+                  LogFixed{toDollars(mLedger.openingTotal()), 2});
+    }
+}
+
+void StaffRobot::serveOrder(const StaffOrder &order)
+{
+    LOG_INFO("Staff: Hi customer ", order.customer, ", your ", mMenu.name(order.item), " is ready, please proceed to pickup counter");
+    releaseCounter(order.customer);
+    mMetrics.increment("cafe_deliveries_total", "");
+    // Inform customer that order is ready to be picked up
+    sendMessage("*", Roster::channelOf(order.customer));
+}
+
+void StaffRobot::publishMenu()
+{
+    if (mMenuPublished || !registered())
+    {
+        return;
+    }
+    mMenuPublished = true;
+    for (const std::string &chunk : mMenuReplica.snapshot())
+    {
+        sendMessage(chunk, -1);
+        mMetrics.increment("cafe_menu_messages_total", "kind=\"snapshot\"");
+    }
+}
+
+void StaffRobot::setAvailable(ItemId item, bool available)
+{
+    // Until then the snapshot carries it
+    std::string delta{mMenuReplica.setAvailable(item, available)};
+    if (!delta.empty() && mMenuPublished)
+    {
+        sendMessage(delta, -1);
+        mMetrics.increment("cafe_menu_messages_total", "kind=\"delta\"");
+    }
+}
+
+void StaffRobot::updateInventory()
+{
+    if (mInventory.update(getTime()))
+    {
+        LOG_INFO("Staff: *restocks the kitchen*");
+        mMetrics.increment("cafe_restocks_total", "");
+        updateAvailability();
+    }
+}
+
+void StaffRobot::updateAvailability()
+{
+    std::vector<ItemId> changes{mInventory.takeChanges()};
+    for (ItemId item : changes)
+    {
+        bool available{mInventory.canMake(item)};
+        if (mMenuReplica.available(item) && !available && !mInventory.withdrawn(item))
         {
-            std::cout << "Staff: *finds item on menu*" << std::endl;
-            sendMessage("+", currentCustomer);
-            std::cout << "Staff: Hi Customer " + std::to_string(currentCustomer) + ", the price for " + currentOrder + " is " + menuLine[2] + " dollars" << std::endl;
-            currentOrderWaitTime = std::stoi(menuLine[1]) * 1000;
-            currentOrderPrice = std::stod(menuLine[2]);
-            std::string message{"$" + menuLine[2]};
-            sendMessage(message, currentCustomer);
-            autoState = AUTO_IDLE;
-            return;
+            LOG_INFO("Staff: *runs short of an ingredient for ", mMenu.name(item), "*");
+            mMetrics.increment("cafe_item_stockouts_total", "item=\"" + mMenu.name(item) + "\"");
         }
+        setAvailable(item, available);
+    }
+    for (IngredientId ingredient = 0; ingredient < mInventory.ingredients(); ingredient++)
+    {
+        mMetrics.set("cafe_ingredient_stock", "ingredient=\"" + mInventory.ingredientName(ingredient) + "\"",
+                     static_cast<double>(mInventory.stock(ingredient)));
     }
-    std::cout << "Staff: Hi Customer " + std::to_string(currentCustomer) + ", oh no, we don't have " + currentOrder + " in our menu" << std::endl;
-    sendMessage("-", currentCustomer);
 }
 
-void StaffRobot::placeOrder()
+void StaffRobot::saveState(SnapshotWriter &state)
 {
-    if (purchaseConfirmation)
+    BaseRobot::saveState(state);
+    mLedger.save(state);
+    mMenuReplica.save(state);
+    mInventory.save(state, getTime());
+
+    // Times are saved as time remaining, as the simulation clock restarts
+    state.put(mKitchenNextTicket);
+    state.put(mKitchenServing);
+    state.put(mKitchenQueuedSeconds);
+    state.put(mKitchenDoneTime - getTime());
+    state.put(getTime() - mKitchenHeadTime);
+    state.put(static_cast<std::uint32_t>(mRolledBackTickets.size()));
+    for (int ticket : mRolledBackTickets)
     {
-        updateAccount();
-        std::cout << "Staff : Thanks for your order. It will be ready in " + std::to_string(currentOrderWaitTime / 1000) + " seconds" << std::endl;
-        std::cout << "Staff: *places order, adds into account, prepares order*" << std::endl;
+        state.put(ticket);
+    }
+    state.put(mStation);
+    state.put(static_cast<std::uint32_t>(mCounter));
+    state.put(static_cast<std::uint32_t>(mClaims.size()));
+    for (const auto &[customer, counter] : mClaims)
+    {
+        state.put(customer);
+        state.put(static_cast<std::uint32_t>(counter));
+    }
+    state.put(static_cast<std::uint32_t>(mServices.size()));
+    for (const auto &entry : mServices)
+    {
+        const StaffOrder &order{entry.second};
+        state.put(order.customer);
+        state.put(order.item);
+        state.putString(order.unlisted);
+        state.put(order.price);
+        state.put(order.prepSeconds);
+        state.put(order.stage);
+        state.put(order.ticket);
+        state.put(order.cookedTime - getTime());
+        state.put(order.preordered);
+        state.put(getTime() - order.checkedTime);
+        state.put(order.slot);
     }
-    autoState = AUTO_MOVE_STARTING_POSITION;
 }
 
-void StaffRobot::updateAccount()
+SnapshotCommit StaffRobot::restoreState(SnapshotReader &state)
 {
-    orderCounter++;
-    mBalance += currentOrderPrice;
-    accountFile << std::to_string(orderCounter) + "," + currentOrder + "," + std::to_string(currentCustomer) + "," << std::setprecision(2) << std::fixed << mBalance << std::endl;
+    SnapshotCommit base{BaseRobot::restoreState(state)};
+    SnapshotCommit ledger{mLedger.restore(state)};
+    SnapshotCommit menu{mMenuReplica.restore(state)};
+    SnapshotCommit inventory{mInventory.restore(state, getTime())};
+
+    int nextTicket{state.get<int>()};
+    int serving{state.get<int>()};
+    double queuedSeconds{state.get<double>()};
+    double doneTime{getTime() + state.get<double>()};
+    double headTime{getTime() - state.get<double>()};
+    std::unordered_set<int> rolledBackTickets;
+    std::uint32_t rolledBack{state.get<std::uint32_t>()};
+    for (std::uint32_t i = 0; i < rolledBack && state.ok(); i++)
+    {
+        rolledBackTickets.insert(state.get<int>());
+    }
+    StaffStation station{state.get<StaffStation>()};
+    std::size_t counter{std::min<std::size_t>(state.get<std::uint32_t>(), mCounters.size() - 1)};
+    std::vector<std::pair<int, std::size_t>> claims;
+    std::uint32_t claimed{state.get<std::uint32_t>()};
+    for (std::uint32_t i = 0; i < claimed && state.ok(); i++)
+    {
+        int customer{state.get<int>()};
+        claims.emplace_back(customer, state.get<std::uint32_t>());
+    }
+    std::unordered_map<int, StaffOrder> services;
+    std::uint32_t served{state.get<std::uint32_t>()};
+    for (std::uint32_t i = 0; i < served && state.ok(); i++)
+    {
+        StaffOrder order;
+        order.customer = state.get<int>();
+        order.item = state.get<ItemId>();
+        order.unlisted = state.getString();
+        order.price = state.get<double>();
+        order.prepSeconds = state.get<int>();
+        order.stage = state.get<ServiceStage>();
+        order.ticket = state.get<int>();
+        order.cookedTime = getTime() + state.get<double>();
+        order.preordered = state.get<bool>();
+        order.checkedTime = getTime() - state.get<double>();
+        order.slot = state.get<int>();
+        services[order.customer] = order;
+    }
+
+    return [=, this, rolledBackTickets = std::move(rolledBackTickets), claims = std::move(claims),
+            services = std::move(services)]() {
+        base();
+        ledger();
+        menu();
+        inventory();
+        updateAvailability();
+        mBalance = toDollars(mLedger.balance(robotID));
+
+        mKitchenNextTicket = nextTicket;
+        mKitchenServing = serving;
+        mKitchenQueuedSeconds = queuedSeconds;
+        mKitchenDoneTime = doneTime;
+        mKitchenHeadTime = headTime;
+        mRolledBackTickets = rolledBackTickets;
+        mStation = station;
+        mCounter = counter;
+        mClaims.clear();
+        std::fill(mCounterQueues.begin(), mCounterQueues.end(), 0);
+        for (const auto &[customer, claim] : claims)
+        {
+            claimCounter(customer, claim);
+        }
+        mServices = services;
+
+        // Orders that were being carried go back to waiting in the kitchen, cooked first at the front
+        std::vector<const StaffOrder *> ready;
+        for (auto &entry : mServices)
+        {
+            StaffOrder &order{entry.second};
+            if (order.stage == ServiceStage::READY)
+            {
+                order.slot = NO_SLOT;
+                ready.push_back(&order);
+            }
+            else if (order.slot >= 0 && order.slot < static_cast<int>(PICKUP_SLOTS))
+            {
+                mPickupSlots[order.slot] = order.customer;
+            }
+        }
+        std::sort(ready.begin(), ready.end(), [](const StaffOrder *a, const StaffOrder *b) { return a->cookedTime < b->cookedTime; });
+        for (const StaffOrder *order : ready)
+        {
+            mReadyOrders.push_back(order->customer);
+        }
+
+        // A workflow that finishes straight away erases its order, so spawn from the decoded copy
+        for (const auto &entry : services)
+        {
+            const StaffOrder &order{entry.second};
+            mExecutor.spawn(serveCustomer(order.customer, order.item, order.unlisted));
+        }
+    };
 }
 
-void StaffRobot::prepareOrder()
+void StaffRobot::publishStatus()
 {
-    orderTimer += TIME_STEP;
-    if (orderTimer >= currentOrderWaitTime)
+    double now{getTime()};
+    if (!mControl.is(ControlState::AUTO) || now < mNextStatusTime)
     {
-        std::cout << "Staff: *order is prepared, moving to the pickup counter*" << std::endl;
-        autoState = AUTO_MOVE_PICKUP_COUNTER;
+        return;
     }
+    mNextStatusTime = now + mStatusInterval;
+
+    double drainSeconds{mKitchenQueuedSeconds + std::max(0.0, mKitchenDoneTime - now)};
+    mMetrics.set("cafe_staff_queue_depth", "", mActiveServices);
+    mMetrics.set("cafe_kitchen_drain_seconds", "", drainSeconds);
+
+    // Status is "#<queue depth>,<drain seconds>"
+    std::ostringstream status;
+    status << '#' << mActiveServices << ',' << std::fixed << std::setprecision(3) << drainSeconds;
+    sendDatagram(status.str(), Roster::DIRECTOR_CHANNEL);
 }
 
-void StaffRobot::serveOrder()
+void StaffRobot::recordUtilisation()
 {
-    std::cout << "Staff: Hi customer " + std::to_string(currentCustomer) + ", your " + currentOrder + " is ready, please proceed to pickup counter" << std::endl;
-    // Inform customer that order is ready to be picked up
-    sendMessage("*", currentCustomer);
-    resetOrdering();
-    autoState = AUTO_IDLE;
+    if (!mControl.is(ControlState::AUTO))
+    {
+        return;
+    }
+    double stepSeconds{TIME_STEP / 1000.0};
+    mMetrics.increment("cafe_staff_auto_seconds_total", "", stepSeconds);
+    if (mActiveServices > 0)
+    {
+        mMetrics.increment("cafe_staff_busy_seconds_total", "", stepSeconds);
+    }
+    if (mOrdersInKitchen > 0)
+    {
+        mMetrics.increment("cafe_kitchen_busy_seconds_total", "", stepSeconds);
+    }
+    double autoSeconds{mMetrics.value("cafe_staff_auto_seconds_total", "")};
+    mMetrics.set("cafe_staff_utilisation_ratio", "", mMetrics.value("cafe_staff_busy_seconds_total", "") / autoSeconds);
+    mMetrics.set("cafe_kitchen_utilisation_ratio", "", mMetrics.value("cafe_kitchen_busy_seconds_total", "") / autoSeconds);
 }
 
-void StaffRobot::resetOrdering()
+void StaffRobot::recordRejection(const std::string &reason)
 {
-    purchaseConfirmation = false;
-    currentOrderWaitTime = 0;
-    orderTimer = 0;
-    currentCustomer = 0;
-    currentOrder = "";
-    currentOrderPrice = 0;
-    autoState = AUTO_IDLE;
+    mMetrics.increment("cafe_orders_rejected_total", "reason=\"" + reason + "\"");
+    double rejected{mMetrics.value("cafe_orders_rejected_total", "reason=\"unknown_item\"") +
+                    mMetrics.value("cafe_orders_rejected_total", "reason=\"unavailable\"") +
+                    mMetrics.value("cafe_orders_rejected_total", "reason=\"out_of_stock\"") +
+                    mMetrics.value("cafe_orders_rejected_total", "reason=\"insufficient_balance\"")};
+    double received{mMetrics.value("cafe_orders_received_total", "")};
+    mMetrics.set("cafe_order_rejection_ratio", "", (received > 0) ? rejected / received : 0);
 }
 
 StaffRobot::~StaffRobot() {}
\ No newline at end of file
@@ -1,67 +1,401 @@
+#pragma once
+
+#include <array>
+#include <unordered_set>
+
 #include "z5363966BaseRobot.hpp"
+#include "z5363966Inventory.hpp"
+#include "z5363966Ledger.hpp"
+#include "z5363966Route.hpp"
+
+// Where a staff workflow is, so a restored staff can carry on serving the customer
+enum class ServiceStage : unsigned char {
+    CHECK_ORDER,
+    AWAIT_CANCEL,
+    AWAIT_PAYMENT,
+    KITCHEN_QUEUE,
+    COOKING,
+    READY,          // cooked, waiting in the kitchen to be carried to a pickup slot
+    AWAIT_PICKUP
+};
+
+// Where the staff is, MOVING while it drives between stations
+enum class StaffStation : unsigned char {
+    START,
+    ORDER_COUNTER,
+    KITCHEN,
+    PICKUP_COUNTER,
+    MOVING
+};
+
+// An order being served by one of the staff workflows
+struct StaffOrder {
+    int customer;
+    ItemId item;            // Menu::NO_ITEM if the item ordered is not on the menu
+    std::string unlisted;   // name ordered, if it is not on the menu
+    double price;
+    int prepSeconds;
+    ServiceStage stage;
+    int ticket;             // place in the kitchen queue, NO_TICKET until it has one
+    double cookedTime;      // simulated time the kitchen finishes the order [s]
+    bool preordered;        // joined the kitchen queue before it was paid for
+    double checkedTime;     // simulated time the order was checked [s]
+    int slot;               // pickup slot the order is left in, NO_SLOT until it has one
+};
 
 class StaffRobot : public BaseRobot {
     public:
+        // Ticket of an order that has no place in the kitchen queue
+        static constexpr int NO_TICKET {-1};
+
+        // Slot of an order that has not been given a pickup slot, and the customer in an empty slot
+        static constexpr int NO_SLOT {-1};
+        static constexpr int EMPTY_SLOT {-1};
+        static constexpr std::size_t PICKUP_SLOTS {8};
+
+        // Counter when no customer is waiting at any
+        static constexpr std::size_t NO_COUNTER {static_cast<std::size_t>(-1)};
+
         /**
-         * @brief Construct a new Staff Robot object
+         * @brief Construct a new Staff Robot object, on the Webots robot unless other devices are given
          * 
          */
-        StaffRobot();
+        explicit StaffRobot(std::unique_ptr<RobotDevices> devices = makeWebotsDevices());
 
         void run() override;
+
+        /**
+         * @brief Carries on from a snapshot, or opens the ledger, before the first time step
+         * 
+         */
+        void start();
+
+        /**
+         * @brief Runs one time step of the controller, after the simulation has stepped
+         * 
+         * @return boolean, false once the controller has ended
+         */
+        bool update();
+
         void remoteControl() override;
         void autoMode() override;
 
         void processData() override;
     
         /**
-         * @brief Checks the received order if can be made or not
+         * @brief Serves one customer: checks the order once the staff is at the order counter, waits
+         * for payment or cancellation, has the kitchen prepare it, waits for the staff to carry it to
+         * a pickup slot and waits for the customer to pick it up. One workflow runs per customer, so
+         * several customers can be served at once. A customer with an order restored from a snapshot
+         * carries on from the order's stage.
+         * 
+         * @param customer robot ID of the customer
+         * @param item menu item ordered, Menu::NO_ITEM if it is not on the menu
+         * @param unlisted name ordered, if it is not on the menu
+         */
+        Task serveCustomer(int, ItemId, std::string);
+
+        /**
+         * @brief Starts serving a customer's order, unless the customer is already being served. Two
+         * workflows for one customer would share its order, and the first to end would erase it.
+         * 
+         * @param customer robot ID of the customer
+         * @param item menu item ordered, Menu::NO_ITEM if it is not on the menu
+         * @param unlisted name ordered, if it is not on the menu
+         */
+        void takeOrder(int, ItemId, std::string);
+
+        /**
+         * @brief Drives the staff between its stations, the only workflow that moves it. Goes to the
+         * order counter with the most customers waiting while any wait, otherwise carries cooked orders from the kitchen
+         * to the pickup counter, and returns to its start once nobody is being served. A delivery
+         * round takes as many cooked orders as it can carry and there are free slots for, and visits
+         * their slots in the order given by Route::plan, ending towards wherever the staff goes next.
+         * 
+         */
+        Task staffRounds();
+
+        /**
+         * @brief Whether a cooked order is waiting in the kitchen and there is a free slot for it
+         * 
+         * @return boolean
+         */
+        bool deliverable() const;
+
+        /**
+         * @brief Takes the cooked orders for a delivery round out of the kitchen, oldest first, and
+         * gives each the free pickup slot nearest the pickup pad of its customer's counter
+         * 
+         * @return std::vector<int>, customers whose orders are carried
+         */
+        std::vector<int> takeBatch();
+
+        /**
+         * @brief Counter with the most customers waiting for the staff, the nearest of equals
+         * 
+         * @return std::size_t, NO_COUNTER if nobody is waiting
+         */
+        std::size_t busiestCounter() const;
+
+        /**
+         * @brief Counter a customer has claimed, the first if it has not claimed one
+         * 
+         * @return std::size_t
+         */
+        std::size_t counterOf(int) const;
+
+        /**
+         * @brief Queues a customer at the counter it claimed, moving it from any it claimed before
+         * 
+         * @param customer
+         * @param counter
+         */
+        void claimCounter(int, std::size_t);
+
+        /**
+         * @brief Takes a customer out of its counter's queue, once its order is ready or its
+         * workflow ends
+         * 
+         */
+        void releaseCounter(int);
+
+        /**
+         * @brief Broadcasts the queue at every counter once it has changed, with more than one counter
          * 
          */
-        void checkOrder();
+        void publishCounters();
 
         /**
-         * @brief Places the order if confirmed paid.
+         * @brief Where the staff should head after the current round
          * 
+         * @return StaffStation
          */
-        void placeOrder();
+        StaffStation nextStation() const;
 
         /**
-         * @brief Prepares the order, implements a timer that increments with each time step, changes state when timer is done
+         * @brief Where the staff leaves an order in a pickup slot
          * 
+         * @param slot
+         * @return RoutePoint
          */
-        void prepareOrder();
+        static RoutePoint pickupSlot(int);
 
         /**
-         * @brief Updates account
+         * @brief Counts a delivery round, and the distance and driving time it saves against carrying
+         * each order on its own round trip from the kitchen
          * 
+         * @param stops pickup slots visited
+         * @param route order they are visited in
+         * @param to where the round ends
          */
-        void updateAccount();
+        void recordDelivery(const std::vector<RoutePoint>&, const std::vector<std::size_t>&, const RoutePoint&);
 
         /**
-         * @brief Serves the order and resets for new order
+         * @brief Accumulates the distance and time the staff has driven, once per time step
          * 
          */
-        void serveOrder();
+        void recordTravel();
 
-        virtual void resetOrdering() override;
+        /**
+         * @brief Checks the received order if can be made or not, and replies with the price. An
+         * order that can be made holds its ingredients from then on.
+         * 
+         * @return boolean, true if the item is on the menu and in stock
+         */
+        bool checkOrder(StaffOrder&);
+
+        /**
+         * @brief Places the order once paid for
+         * 
+         */
+        void placeOrder(const StaffOrder&);
+
+        /**
+         * @brief Gives the order its place in the kitchen queue. With preorder set this happens as
+         * soon as the order is checked, so the kitchen can start on it while the customer is still
+         * walking to the counter and the payment clears.
+         * 
+         */
+        void reserveKitchen(StaffOrder&);
+
+        /**
+         * @brief Returns the ingredients of an order that was not paid for to stock, and takes a
+         * pre-order back out of the kitchen, counting any time and ingredients the kitchen had
+         * already spent on it as wasted
+         * 
+         * @param order
+         * @param reason insufficient_balance or declined
+         */
+        void rollBack(StaffOrder&, const std::string&);
 
         /**
-         * @brief Destroy the Customer Robot object
+         * @brief Moves the kitchen on to the next ticket that has not been rolled back
+         * 
+         */
+        void advanceKitchen();
+
+        /**
+         * @brief Transfers the price from the customer to the till in the ledger and sends the
+         * customer a receipt with its new balance, or a decline
+         * 
+         * @param order
+         * @param payment '>' message, with body "<payment ID>:<balance the customer believes it has>"
+         * @return boolean, true if the payment was applied
+         */
+        bool takePayment(const StaffOrder&, const Message&);
+
+        /**
+         * @brief Records the final balance a customer reports once told to quit
+         * 
+         * @param report '.' message, "<robot ID>:<balance>"
+         */
+        void recordFinalBalance(const std::string&);
+
+        /**
+         * @brief Quits once every customer has reported its final balance, or once none has reported
+         * for CLOSING_TIMEOUT after being told to quit
+         * 
+         */
+        void updateClosing();
+
+        /**
+         * @brief Checkpoints the ledger and checks the balance every robot holds against it, and that
+         * money was conserved across all robots
+         * 
+         */
+        void reconcileLedger();
+
+        /**
+         * @brief Tells the customer the order has been left at the pickup counter
+         * 
+         */
+        void serveOrder(const StaffOrder&);
+
+        /**
+         * @brief Broadcasts a snapshot of the menu once the staff has registered, so the customers'
+         * replicas can turn away orders before walking to the counter
+         * 
+         */
+        void publishMenu();
+
+        /**
+         * @brief Changes whether an item can be ordered and broadcasts the change to the customers,
+         * once the menu has been published
+         * 
+         * @param item
+         * @param available
+         */
+        void setAvailable(ItemId, bool);
+
+        /**
+         * @brief Delivers a restock if one is due, once per time step
+         * 
+         */
+        void updateInventory();
+
+        /**
+         * @brief Makes the items the stock can no longer make, or can make again, unavailable or
+         * available, counts stock-outs and refreshes the stock gauges
+         * 
+         */
+        void updateAvailability();
+
+        /**
+         * @brief Sends the director the number of customers being served and the estimated time for
+         * the kitchen to finish every placed order, every status_interval simulated seconds
+         * 
+         */
+        void publishStatus();
+
+        /**
+         * @brief Accumulates staff and kitchen busy time for the utilisation metrics
+         * 
+         */
+        void recordUtilisation();
+
+        /**
+         * @brief Counts a rejected order and refreshes the rejection ratio
+         * 
+         * @param reason unknown_item, unavailable, out_of_stock or insufficient_balance
+         */
+        void recordRejection(const std::string&);
+
+        void saveState(SnapshotWriter&) override;
+        SnapshotCommit restoreState(SnapshotReader&) override;
+
+        /**
+         * @brief Destroy the Staff Robot object
          * 
          */
         ~StaffRobot();
     private:
-        std::ofstream accountFile;
-
-        int currentOrderWaitTime;
-        int orderTimer;
-        int currentCustomer;
-        int orderCounter;
-        
-        // Staff Auto States
-        static constexpr int AUTO_STAFF_CHECK_ORDER {11};
-        static constexpr int AUTO_STAFF_PLACE_ORDER {12};
-        static constexpr int AUTO_STAFF_ORDER_PREP {13};
-        static constexpr int AUTO_STAFF_ORDER_READY {14};
+        // Balances of every robot, the staff's own balance is the till
+        Ledger mLedger;
+
+        // Ingredients in stock, which decide the items that can be made
+        Inventory mInventory;
+
+        // Authoritative price and availability of every item, replicated to the customers
+        MenuReplica mMenuReplica;
+        bool mMenuPublished;
+
+        // Order of every customer being served, by robot ID
+        std::unordered_map<int, StaffOrder> mServices;
+
+        // Workflows currently serving a customer, and orders currently in the kitchen
+        int mActiveServices;
+        int mOrdersInKitchen;
+
+        // The kitchen prepares one order at a time, in the order they were placed. Tickets of
+        // pre-orders that were rolled back are skipped.
+        bool mPreorder;
+        int mKitchenNextTicket;
+        int mKitchenServing;
+        double mKitchenHeadTime;
+        std::unordered_set<int> mRolledBackTickets;
+        double mKitchenQueuedSeconds;
+        double mKitchenDoneTime;
+
+        double mStatusInterval;
+        double mNextStatusTime;
+
+        // Where the staff is, the counter it is at or last served, and customers waiting at each
+        // counter for it to get there
+        StaffStation mStation;
+        Counters mCounters;
+        std::size_t mCounter;
+        std::vector<int> mCounterWaiting;
+
+        // Counter claimed by every customer not yet served, and customers queued at each
+        std::unordered_map<int, std::size_t> mClaims;
+        std::vector<int> mCounterQueues;
+        bool mQueuesChanged;
+
+        // Customers whose orders are cooked and waiting in the kitchen, oldest first, and the
+        // customer whose order is in each pickup slot
+        std::deque<int> mReadyOrders;
+        std::array<int, PICKUP_SLOTS> mPickupSlots;
+
+        // Position on the last step, for the distance driven
+        double mLastX;
+        double mLastZ;
+
+        // Balance each customer holds by its own account once told to quit, by robot ID, and when to
+        // stop waiting for the rest, negative until told to quit
+        std::unordered_map<int, Cents> mFinalBalances;
+        double mClosingDeadline;
+
+        // Stations on the staff's side of the counters, and the angle to face at each [rad]
+        static constexpr RoutePoint KITCHEN {1.375, -0.375};
+        static constexpr double FACE_COUNTER {M_PI / 2};
+        static constexpr double FACE_KITCHEN {- M_PI / 2};
+
+        // Pickup slots run along the staff's side of the pickup counter. Customers collect from
+        // their counter's pickup pad, so the slots nearest it are used first.
+        static constexpr double PICKUP_SLOT_X {0.875};
+        static constexpr double FIRST_PICKUP_SLOT_Z {-0.0625};
+        static constexpr double PICKUP_SLOT_SPACING {0.125};
+
+        // Orders the staff can carry on one round
+        static constexpr std::size_t CARRY_CAPACITY {4};
 };
\ No newline at end of file
@@ -0,0 +1,328 @@
+#include "z5363966CapacityModel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace {
+    // Range and resolution of the overhead calibrate searches [s]
+    constexpr double MAX_OVERHEAD {60};
+    constexpr double OVERHEAD_STEP {0.01};
+
+    // The order and payment dialogue is a fixed number of messages, so it hardly varies
+    constexpr double COUNTER_SCV {0};
+
+    // Probability that all k servers are busy in an M/M/k queue offered a erlangs (Erlang C)
+    double erlangC(int servers, double offered)
+    {
+        double blocking{1};
+        for (int server = 1; server <= servers; server++)
+        {
+            blocking = offered * blocking / (server + offered * blocking);
+        }
+        double utilisation{offered / servers};
+        return blocking / (1 - utilisation * (1 - blocking));
+    }
+
+    // Mean wait in an M/G/k queue, by the Allen-Cunneen approximation
+    double queueWait(double arrivalRate, double service, double scv, int servers)
+    {
+        if (service <= 0)
+        {
+            return 0;
+        }
+        double offered{arrivalRate * service};
+        if (offered >= servers)
+        {
+            return std::numeric_limits<double>::infinity();
+        }
+        return erlangC(servers, offered) * service / (servers - offered) * (1 + scv) / 2;
+    }
+
+    // Metrics of a Metrics_<robot>.json summary, as {name: text after the colon}
+    std::unordered_map<std::string, std::string> readMetrics(const fs::path &path)
+    {
+        std::unordered_map<std::string, std::string> metrics;
+        std::ifstream metricsFile{path, std::ifstream::in};
+        std::string lineInput;
+        while (std::getline(metricsFile, lineInput))
+        {
+            std::size_t start{lineInput.find('"')};
+            std::size_t end{lineInput.find("\": ", start)};
+            if (start != std::string::npos && end != std::string::npos)
+            {
+                metrics[lineInput.substr(start + 1, end - start - 1)] = lineInput.substr(end + 3);
+            }
+        }
+        return metrics;
+    }
+
+    // A plain metric, or a field of a histogram such as "count" or "sum"
+    double metric(const std::unordered_map<std::string, std::string> &metrics, const std::string &name,
+                  const std::string &field = "")
+    {
+        auto found{metrics.find(name)};
+        if (found == metrics.end())
+        {
+            return 0;
+        }
+        std::size_t at{0};
+        if (!field.empty())
+        {
+            at = found->second.find("\"" + field + "\": ");
+            if (at == std::string::npos)
+            {
+                return 0;
+            }
+            at += field.size() + 4;
+        }
+        return std::atof(found->second.c_str() + at);
+    }
+
+    // Phase time summed over every customer, as {sum, count}
+    void addPhase(const std::unordered_map<std::string, std::string> &metrics, const std::string &phase,
+                  std::pair<double, double> &total)
+    {
+        std::string name{"cafe_customer_phase_seconds{phase=\\\"" + phase + "\\\"}"};
+        total.first += metric(metrics, name, "sum");
+        total.second += metric(metrics, name, "count");
+    }
+
+    double mean(const std::pair<double, double> &total)
+    {
+        return (total.second > 0) ? total.first / total.second : 0;
+    }
+}
+
+CapacityModel::CapacityModel(const Demands &demands)
+    : mDemands(demands)
+{
+}
+
+Prediction CapacityModel::evaluate(const Configuration &configuration) const
+{
+    const Demands &d{mDemands};
+    double kitchenDemand{d.paidFraction * d.prep};
+    auto [capacity, closedLatency] = closed(configuration, concurrency(configuration.customers, configuration.maxOutstanding));
+
+    Prediction prediction{};
+    double arrivalRate{configuration.ordersPerHour / 3600};
+    if (configuration.ordersPerHour <= 0 || arrivalRate >= capacity)
+    {
+        prediction.saturated = configuration.ordersPerHour > 0;
+        prediction.ordersPerHour = capacity * 3600;
+        prediction.latency = closedLatency;
+    }
+    else
+    {
+        // Only paid orders are walked to the counter, the rest are turned away by the menu replica
+        double paidRate{arrivalRate * d.paidFraction};
+        double service{d.counter + queueWait(paidRate, d.counter, COUNTER_SCV, configuration.staff) +
+                       d.prep + queueWait(paidRate, d.prep, d.prepScv, configuration.kitchenSlots)};
+        double openLatency{d.paidFraction * ((configuration.preorder ? std::max(d.travel, service) : d.travel + service) +
+                                             d.delivery + d.pickup + d.ret) +
+                           d.overhead};
+        prediction.ordersPerHour = configuration.ordersPerHour;
+        prediction.latency = std::min(openLatency, closedLatency);
+    }
+    double throughput{prediction.ordersPerHour / 3600};
+    prediction.kitchenUtilisation = throughput * kitchenDemand / configuration.kitchenSlots;
+    prediction.staffUtilisation = throughput * d.paidFraction * (d.counter + d.delivery) / configuration.staff;
+    prediction.concurrency = throughput * prediction.latency;
+    return prediction;
+}
+
+const Demands& CapacityModel::demands() const
+{
+    return mDemands;
+}
+
+double CapacityModel::concurrency(int customers, int maxOutstanding)
+{
+    // Sum over k of the probability that the next k orders are all for different customers
+    double expected{0};
+    double distinct{1};
+    for (int k = 1; k <= std::min(customers, maxOutstanding); k++)
+    {
+        distinct *= static_cast<double>(customers - k + 1) / customers;
+        expected += distinct;
+    }
+    return std::max(1.0, expected);
+}
+
+std::pair<double, double> CapacityModel::closed(const Configuration &configuration, double population) const
+{
+    const Demands &d{mDemands};
+
+    // Seidmann: a k server queue is a single server queue of demand D / k plus a delay of D (k - 1) / k
+    struct Queue {
+        double demand;
+        double length;
+    };
+    double counterDemand{d.paidFraction * d.counter};
+    double kitchenDemand{d.paidFraction * d.prep};
+    Queue queues[2]{{counterDemand / configuration.staff, 0}, {kitchenDemand / configuration.kitchenSlots, 0}};
+    double serviceDelay{counterDemand * (configuration.staff - 1) / configuration.staff +
+                        kitchenDemand * (configuration.kitchenSlots - 1) / configuration.kitchenSlots};
+    double travel{d.paidFraction * d.travel};
+    double delay{d.paidFraction * (d.delivery + d.pickup + d.ret) + d.overhead};
+
+    // Exact mean value analysis up to the next whole population, interpolating between the last two
+    int whole{static_cast<int>(std::ceil(population))};
+    double throughput{0};
+    double latency{delay + travel + serviceDelay};
+    double previousThroughput{0};
+    double previousLatency{latency};
+    for (int orders = 1; orders <= whole; orders++)
+    {
+        previousThroughput = throughput;
+        previousLatency = latency;
+        double service{serviceDelay};
+        for (Queue &queue : queues)
+        {
+            service += queue.demand * (1 + queue.length);
+        }
+        latency = delay + (configuration.preorder ? std::max(travel, service) : travel + service);
+        throughput = orders / latency;
+        for (Queue &queue : queues)
+        {
+            queue.length = throughput * queue.demand * (1 + queue.length);
+        }
+    }
+    double fraction{population - (whole - 1)};
+    if (whole > 1)
+    {
+        throughput = previousThroughput + fraction * (throughput - previousThroughput);
+        latency = previousLatency + fraction * (latency - previousLatency);
+    }
+    return {throughput, latency};
+}
+
+Demands menuDemands(const Settings &settings, const Menu &menu, const Demands &walks)
+{
+    // Item weights are given as "Latte:3;Mocha:1", items not listed have weight 1
+    std::vector<double> weights(menu.size(), 1);
+    std::stringstream weightStream{settings.getString("workload_item_weights", "")};
+    std::string weight;
+    while (std::getline(weightStream, weight, ';'))
+    {
+        std::size_t colon{weight.rfind(':')};
+        ItemId id{(colon != std::string::npos) ? menu.find(weight.substr(0, colon)) : Menu::NO_ITEM};
+        if (id != Menu::NO_ITEM)
+        {
+            weights[id] = std::stod(weight.substr(colon + 1));
+        }
+    }
+
+    double total{0};
+    double sum{0};
+    double squares{0};
+    for (ItemId id = 0; id < menu.size(); id++)
+    {
+        total += weights[id];
+        sum += weights[id] * menu.prepSeconds(id);
+        squares += weights[id] * menu.prepSeconds(id) * menu.prepSeconds(id);
+    }
+
+    Demands demands{walks};
+    demands.prep = (total > 0) ? sum / total : 0;
+    demands.prepScv = (demands.prep > 0) ? (squares / total) / (demands.prep * demands.prep) - 1 : 0;
+    demands.paidFraction = std::clamp(1 - settings.getDouble("workload_invalid_fraction", 0.05) -
+                                      settings.getDouble("workload_over_budget_fraction", 0.05), 0.0, 1.0);
+    return demands;
+}
+
+bool loadRun(const std::string &directory, RecordedRun &run)
+{
+    fs::path root{directory};
+    auto director{readMetrics(root / "Metrics_Director.json")};
+    auto staff{readMetrics(root / "Metrics_Staff.json")};
+    double completed{metric(director, "cafe_orders_completed_total")};
+    if (completed <= 0 || staff.empty())
+    {
+        return false;
+    }
+
+    std::pair<double, double> travel{0, 0};
+    std::pair<double, double> counter{0, 0};
+    std::pair<double, double> pickup{0, 0};
+    std::pair<double, double> ret{0, 0};
+    int customers{0};
+    for (const fs::directory_entry &entry : fs::directory_iterator(root))
+    {
+        std::string file{entry.path().filename().string()};
+        if (file.rfind("Metrics_Customer", 0) == 0 && entry.path().extension() == ".json")
+        {
+            auto metrics{readMetrics(entry.path())};
+            addPhase(metrics, "travel", travel);
+            addPhase(metrics, "pickup", pickup);
+            addPhase(metrics, "return", ret);
+
+            // The queue and payment phases together are the dialogue at the counter
+            std::pair<double, double> payment{0, 0};
+            addPhase(metrics, "queue", counter);
+            addPhase(metrics, "payment", payment);
+            counter.first += payment.first;
+            customers++;
+        }
+    }
+
+    Settings settings{(root / "Settings.csv").string()};
+    Menu menu{(root / "Menu.csv").string()};
+    bool generated{settings.getString("order_source", "file") == "generator"};
+
+    run.name = root.filename().string();
+    run.configuration = {generated ? settings.getDouble("workload_rate", 10) * customers : 0, customers, 1, 1,
+                         std::max(1, settings.getInt("max_outstanding_orders", 1)), settings.getInt("preorder", 0) != 0};
+    run.demands = menuDemands(settings, menu, {mean(travel), mean(counter), 0, 0, 0, mean(pickup),
+                                               (ret.second > 0) ? mean(ret) : mean(travel), 0, 1});
+
+    // The staff measures what the kitchen actually prepared and how many orders were paid for
+    double placed{metric(staff, "cafe_orders_placed_total")};
+    if (placed > 0)
+    {
+        run.demands.prep = metric(staff, "cafe_kitchen_busy_seconds_total") / placed;
+    }
+    double delivered{metric(staff, "cafe_deliveries_total")};
+    if (delivered > 0)
+    {
+        run.demands.delivery = metric(staff, "cafe_delivery_seconds_total") / delivered;
+    }
+    run.demands.paidFraction = std::min(1.0, placed / completed);
+
+    run.orders = completed;
+    run.measuredOrdersPerHour = metric(director, "cafe_orders_per_hour");
+    run.measuredLatency = metric(director, "cafe_order_latency_seconds", "mean");
+    return true;
+}
+
+double calibrate(const std::vector<RecordedRun> &runs)
+{
+    double best{0};
+    double bestError{std::numeric_limits<double>::infinity()};
+    for (double overhead = 0; overhead <= MAX_OVERHEAD; overhead += OVERHEAD_STEP)
+    {
+        double error{0};
+        for (const RecordedRun &run : runs)
+        {
+            Demands demands{run.demands};
+            demands.overhead = overhead;
+            Prediction prediction{CapacityModel(demands).evaluate(run.configuration)};
+            double throughputError{(prediction.ordersPerHour - run.measuredOrdersPerHour) / run.measuredOrdersPerHour};
+            double latencyError{(prediction.latency - run.measuredLatency) / run.measuredLatency};
+            error += throughputError * throughputError + latencyError * latencyError;
+        }
+        if (error < bestError)
+        {
+            best = overhead;
+            bestError = error;
+        }
+    }
+    return best;
+}
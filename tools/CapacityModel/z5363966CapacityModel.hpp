@@ -0,0 +1,131 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "z5363966Menu.hpp"
+#include "z5363966Settings.hpp"
+
+// A cafeteria configuration to evaluate
+struct Configuration {
+    double ordersPerHour;       // offered load, 0 if every order is there when auto mode starts
+    int customers;
+    int staff;                  // servers at the order counter
+    int kitchenSlots;           // orders the kitchen prepares at once
+    int maxOutstanding;         // max_outstanding_orders
+    bool preorder;              // orders are placed and paid for while the customer walks to the counter
+};
+
+// Per order demands of the stages [s], and the fraction of orders that are paid for
+struct Demands {
+    double travel;              // start to order counter
+    double counter;             // order and payment dialogue
+    double prep;                // mean prep time of a paid order
+    double prepScv;             // squared coefficient of variation of the prep time
+    double delivery;            // staff carrying the cooked order from the kitchen to a pickup slot
+    double pickup;              // order counter to pickup counter
+    double ret;                 // back to the start position
+    double overhead;            // messaging between the stages, fitted by calibration
+    double paidFraction;
+};
+
+// What the model predicts for a configuration
+struct Prediction {
+    double ordersPerHour;       // completed
+    double latency;             // mean, dispatch to "Order Complete" [s]
+    double kitchenUtilisation;
+    double staffUtilisation;
+    double concurrency;         // mean orders outstanding
+    bool saturated;             // the offered load exceeds what the configuration completes
+};
+
+// A recorded simulation run with what was measured in it
+struct RecordedRun {
+    std::string name;
+    Configuration configuration;
+    Demands demands;
+    double orders;
+    double measuredOrdersPerHour;
+    double measuredLatency;
+};
+
+/**
+ * @brief Queueing network model of the cafeteria, for sweeping configurations without simulating
+ * them.
+ *
+ * A paid order visits six stages: the customer's walk to the order counter, the order and payment
+ * dialogue at the counter (staff servers), the kitchen (kitchenSlots servers), the staff's delivery
+ * round to a pickup slot, the walk to the pickup counter and the walk back. Any other order is turned away by the customer's menu replica and only
+ * costs the messaging overhead. The walks and delivery are delay stages and the counter and kitchen
+ * are queues.
+ * A pre-order goes through the counter and kitchen while the customer walks to the counter, so it
+ * takes the longer of the two. When the offered load is below capacity each queue is an M/G/k queue
+ * (Erlang C with the Allen-Cunneen correction for the prep time's variation). Otherwise the network
+ * is closed with as many orders as the director keeps outstanding, solved by mean value analysis
+ * with Seidmann's approximation for the multi-server queues.
+ *
+ * The director dispatches in arrival order and holds an order while its customer is still busy, so
+ * with random customers it keeps fewer orders outstanding than max_outstanding_orders: on average as
+ * many as a random sequence of customers runs before one repeats.
+ *
+ */
+class CapacityModel {
+    public:
+        explicit CapacityModel(const Demands&);
+
+        /**
+         * @brief Predicts throughput, latency and utilisations of a configuration, in microseconds
+         *
+         * @return Prediction
+         */
+        Prediction evaluate(const Configuration&) const;
+
+        const Demands& demands() const;
+
+        /**
+         * @brief Mean orders the director keeps outstanding when orders are always waiting
+         *
+         * @param customers
+         * @param maxOutstanding
+         * @return double
+         */
+        static double concurrency(int, int);
+
+    private:
+        /**
+         * @brief Completed orders per second of the closed network with the given (fractional) population
+         *
+         * @return {throughput, latency [s]}
+         */
+        std::pair<double, double> closed(const Configuration&, double) const;
+
+        Demands mDemands;
+};
+
+/**
+ * @brief Demands of orders drawn from the menu as the workload generator draws them
+ *
+ * @param settings workload_item_weights, workload_invalid_fraction, workload_over_budget_fraction
+ * @param menu
+ * @param walks travel, counter, delivery, pickup, ret and overhead to keep
+ * @return Demands
+ */
+Demands menuDemands(const Settings&, const Menu&, const Demands&);
+
+/**
+ * @brief Reads a run the makespan suite left in benchmarks/build/scenarios: its Settings.csv and
+ * Menu.csv, and the Metrics_*.json summaries of the director, staff and customers
+ *
+ * @param directory
+ * @param run filled in if the run could be read
+ * @return boolean
+ */
+bool loadRun(const std::string&, RecordedRun&);
+
+/**
+ * @brief Fits the per order messaging overhead to the recorded runs, by least squares on the
+ * relative errors of throughput and latency
+ *
+ * @return double, the overhead [s]
+ */
+double calibrate(const std::vector<RecordedRun>&);
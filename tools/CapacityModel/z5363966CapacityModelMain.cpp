@@ -0,0 +1,243 @@
+// File:          CapacityModelMain.cpp
+// Description:   Capacity planning with a queueing network model of the cafeteria, see
+//                z5363966CapacityModel.hpp. Run from tools/CapacityModel so ../../ is the project root:
+//                  build/CapacityModel calibrate [run directory...]
+//                    fits the model to runs the makespan suite recorded (by default every scenario in
+//                    benchmarks/build/scenarios), reports its error on each and saves the calibration
+//                  build/CapacityModel sweep --rate orders/hour [--customers n] [--max-staff n]
+//                                            [--max-kitchen n] [--target-latency seconds] [--top n]
+//                    evaluates every configuration up to the limits with the saved calibration and
+//                    lists the smallest that keep up with the rate, as finalists to simulate
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "z5363966CapacityModel.hpp"
+
+namespace fs = std::filesystem;
+
+static const std::string SCENARIOS_DIR {"../../benchmarks/build/scenarios"};
+static const std::string CALIBRATION_PATH {"build/Calibration.csv"};
+
+// Used until a calibration is saved: the walks, dialogue and delivery of the makespan suite's scenarios [s]
+static constexpr Demands DEFAULT_WALKS {13.3, 5.8, 0, 0, 8.9, 6.8, 13.3, 0, 1};
+
+static void usage()
+{
+    std::fprintf(stderr, "usage: CapacityModel calibrate [run directory...]\n"
+                         "       CapacityModel sweep --rate orders/hour [--customers n] [--max-staff n] "
+                         "[--max-kitchen n] [--target-latency seconds] [--top n]\n");
+}
+
+static double relativeError(double predicted, double measured)
+{
+    return (measured != 0) ? (predicted - measured) / measured : 0;
+}
+
+static int runCalibrate(const std::vector<std::string> &directories)
+{
+    std::vector<std::string> paths{directories};
+    if (paths.empty() && fs::is_directory(SCENARIOS_DIR))
+    {
+        for (const fs::directory_entry &entry : fs::directory_iterator(SCENARIOS_DIR))
+        {
+            paths.push_back(entry.path().string());
+        }
+        std::sort(paths.begin(), paths.end());
+    }
+
+    std::vector<RecordedRun> runs;
+    for (const std::string &path : paths)
+    {
+        RecordedRun run;
+        if (loadRun(path, run))
+        {
+            runs.push_back(run);
+        }
+        else
+        {
+            std::fprintf(stderr, "skipping %s: no metrics summaries\n", path.c_str());
+        }
+    }
+    if (runs.empty())
+    {
+        std::fprintf(stderr, "no recorded runs, run make -C ../../benchmarks run first\n");
+        return 1;
+    }
+
+    double overhead{calibrate(runs)};
+    std::printf("calibrated overhead: %.2f s per order\n", overhead);
+    std::printf("%-14s %6s %8s %8s %7s %9s %9s %7s\n", "run", "orders", "meas/h", "model/h", "error",
+                "meas lat", "model lat", "error");
+    double squares{0};
+    Demands average{0, 0, 0, 0, 0, 0, 0, overhead, 0};
+    double weight{0};
+    for (const RecordedRun &run : runs)
+    {
+        Demands demands{run.demands};
+        demands.overhead = overhead;
+        Prediction prediction{CapacityModel(demands).evaluate(run.configuration)};
+        double throughputError{relativeError(prediction.ordersPerHour, run.measuredOrdersPerHour)};
+        double latencyError{relativeError(prediction.latency, run.measuredLatency)};
+        squares += throughputError * throughputError + latencyError * latencyError;
+        std::printf("%-14s %6.0f %8.2f %8.2f %+6.1f%% %9.1f %9.1f %+6.1f%%\n", run.name.c_str(), run.orders,
+                    run.measuredOrdersPerHour, prediction.ordersPerHour, 100 * throughputError, run.measuredLatency,
+                    prediction.latency, 100 * latencyError);
+
+        // Walks are averaged over the runs by the orders in each
+        average.travel += run.orders * run.demands.travel;
+        average.counter += run.orders * run.demands.counter;
+        average.delivery += run.orders * run.demands.delivery;
+        average.pickup += run.orders * run.demands.pickup;
+        average.ret += run.orders * run.demands.ret;
+        weight += run.orders;
+    }
+    std::printf("rms error: %.1f%%\n", 100 * std::sqrt(squares / (2 * runs.size())));
+
+    fs::create_directories(fs::path(CALIBRATION_PATH).parent_path());
+    std::FILE *calibration{std::fopen(CALIBRATION_PATH.c_str(), "w")};
+    if (calibration == nullptr)
+    {
+        std::fprintf(stderr, "could not write %s\n", CALIBRATION_PATH.c_str());
+        return 1;
+    }
+    std::fprintf(calibration, "Setting,Value\ntravel,%.4f\ncounter,%.4f\ndelivery,%.4f\npickup,%.4f\nreturn,%.4f\noverhead,%.4f\n",
+                 average.travel / weight, average.counter / weight, average.delivery / weight, average.pickup / weight,
+                 average.ret / weight, overhead);
+    std::fclose(calibration);
+    std::printf("saved %s\n", CALIBRATION_PATH.c_str());
+    return 0;
+}
+
+static int runSweep(double rate, int customers, int maxStaff, int maxKitchen, double targetLatency, int top)
+{
+    Settings settings{"../../Settings.csv"};
+    Menu menu{"../../Menu.csv"};
+    Settings calibration{CALIBRATION_PATH};
+    if (!calibration.has("overhead"))
+    {
+        std::fprintf(stderr, "no calibration yet, using the default walk times\n");
+    }
+    Demands walks{calibration.getDouble("travel", DEFAULT_WALKS.travel), calibration.getDouble("counter", DEFAULT_WALKS.counter),
+                  0, 0, calibration.getDouble("delivery", DEFAULT_WALKS.delivery),
+                  calibration.getDouble("pickup", DEFAULT_WALKS.pickup), calibration.getDouble("return", DEFAULT_WALKS.ret),
+                  calibration.getDouble("overhead", DEFAULT_WALKS.overhead), 1};
+    CapacityModel model{menuDemands(settings, menu, walks)};
+    bool preorder{settings.getInt("preorder", 0) != 0};
+
+    struct Candidate {
+        Configuration configuration;
+        Prediction prediction;
+    };
+    std::vector<Candidate> candidates;
+    std::size_t evaluated{0};
+    auto start{std::chrono::steady_clock::now()};
+    for (int staff = 1; staff <= maxStaff; staff++)
+    {
+        for (int kitchen = 1; kitchen <= maxKitchen; kitchen++)
+        {
+            for (int outstanding = 1; outstanding <= customers; outstanding++)
+            {
+                Configuration configuration{rate, customers, staff, kitchen, outstanding, preorder};
+                Prediction prediction{model.evaluate(configuration)};
+                evaluated++;
+                if (!prediction.saturated && (targetLatency <= 0 || prediction.latency <= targetLatency))
+                {
+                    candidates.push_back({configuration, prediction});
+                }
+            }
+        }
+    }
+    double seconds{std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+    std::printf("%zu configurations in %.3f ms, %.2f us each\n", evaluated, 1000 * seconds, 1e6 * seconds / evaluated);
+
+    // Fewest staff and kitchen slots first, then the lowest latency
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b) {
+        int aSize{a.configuration.staff + a.configuration.kitchenSlots};
+        int bSize{b.configuration.staff + b.configuration.kitchenSlots};
+        return (aSize != bSize) ? aSize < bSize : a.prediction.latency < b.prediction.latency;
+    });
+    std::printf("%zu keep up with %.0f orders/hour from %d customers%s\n", candidates.size(), rate, customers,
+                candidates.empty() ? "" : ", finalists to simulate:");
+    if (candidates.empty())
+    {
+        return 1;
+    }
+    std::printf("%6s %8s %12s %10s %9s %9s\n", "staff", "kitchen", "outstanding", "latency", "kitchen", "staff");
+    for (int rank = 0; rank < top && rank < static_cast<int>(candidates.size()); rank++)
+    {
+        const Candidate &candidate{candidates[rank]};
+        std::printf("%6d %8d %12d %9.1fs %8.0f%% %8.0f%%\n", candidate.configuration.staff,
+                    candidate.configuration.kitchenSlots, candidate.configuration.maxOutstanding,
+                    candidate.prediction.latency, 100 * candidate.prediction.kitchenUtilisation,
+                    100 * candidate.prediction.staffUtilisation);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    std::string mode{(argc > 1) ? argv[1] : ""};
+    if (mode == "calibrate")
+    {
+        return runCalibrate(std::vector<std::string>(argv + 2, argv + argc));
+    }
+    if (mode != "sweep")
+    {
+        usage();
+        return 2;
+    }
+
+    double rate{0};
+    int customers{4};
+    int maxStaff{4};
+    int maxKitchen{16};
+    double targetLatency{0};
+    int top{10};
+    for (int arg = 2; arg + 1 < argc; arg += 2)
+    {
+        std::string option{argv[arg]};
+        double value{std::atof(argv[arg + 1])};
+        if (option == "--rate")
+        {
+            rate = value;
+        }
+        else if (option == "--customers")
+        {
+            customers = std::max(1, static_cast<int>(value));
+        }
+        else if (option == "--max-staff")
+        {
+            maxStaff = std::max(1, static_cast<int>(value));
+        }
+        else if (option == "--max-kitchen")
+        {
+            maxKitchen = std::max(1, static_cast<int>(value));
+        }
+        else if (option == "--target-latency")
+        {
+            targetLatency = value;
+        }
+        else if (option == "--top")
+        {
+            top = static_cast<int>(value);
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+    if (rate <= 0 || argc % 2 != 0)
+    {
+        usage();
+        return 2;
+    }
+    return runSweep(rate, customers, maxStaff, maxKitchen, targetLatency, top);
+}
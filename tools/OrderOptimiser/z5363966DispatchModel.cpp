@@ -0,0 +1,357 @@
+#include "z5363966DispatchModel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <sstream>
+#include <tuple>
+
+#include "z5363966Workload.hpp"
+
+namespace {
+    constexpr double STEP_SECONDS {0.064};
+    constexpr double DEGREES_PER_RADIAN {180 / M_PI};
+
+    // e-puck at full wheel speed, 6.28 rad/s on 0.025 m wheels 0.045 m apart
+    constexpr double DRIVE_PER_STEP {6.28 * 0.025 * STEP_SECONDS};
+    constexpr double TURN_PER_STEP {2 * 6.28 * 0.025 / 0.045 * STEP_SECONDS * DEGREES_PER_RADIAN};
+    constexpr double BEARING_TOLERANCE {0.05};
+
+    // Steps a move spends passing through idle, face, drive, head and finish
+    constexpr double MOVE_STEPS {4};
+
+    // Steps between the messages of an order: dispatch to the customer setting off or turning the
+    // order away, the staff checking the order to payment reaching the kitchen, the staff leaving
+    // the order in its slot to the customer setting off for pickup, and arriving home to the
+    // director hearing of it
+    constexpr double DISPATCH_STEPS {1};
+    constexpr double PAY_STEPS {3};
+    constexpr double READY_STEPS {2};
+    constexpr double COMPLETE_STEPS {1};
+
+    // Counters and start pose as the customer drives to them, see CustomerRobot
+    constexpr double ORDER_COUNTER_X {0.375};
+    constexpr double ORDER_COUNTER_Z {0.375};
+    constexpr double ORDER_COUNTER_ANGLE {-90};
+    constexpr double PICKUP_COUNTER_X {0.375};
+    constexpr double PICKUP_COUNTER_Z {-0.375};
+    constexpr double PICKUP_COUNTER_ANGLE {180};
+
+    // Stations as the staff drives to them, see StaffRobot. With one order at a time the staff
+    // leaves each in the slot nearest the Pickup sign.
+    constexpr double STAFF_ORDER_COUNTER_X {0.875};
+    constexpr double STAFF_ORDER_COUNTER_Z {0.375};
+    constexpr double STAFF_COUNTER_ANGLE {90};
+    constexpr double KITCHEN_X {1.375};
+    constexpr double KITCHEN_Z {-0.375};
+    constexpr double KITCHEN_ANGLE {-90};
+    constexpr double PICKUP_SLOT_X {0.875};
+    constexpr double PICKUP_SLOT_Z {-0.3125};
+
+    // What happens to an order at an event
+    enum EventKind : int { ARRIVED, PAID, COOKED, PICKED_UP, HOME };
+
+    struct Pose {
+        double x;
+        double z;
+        double heading;     // compass bearing [deg]
+    };
+
+    // BaseRobot::move turns at full speed, then halves the rest of the turn every step down to the tolerance
+    double turnSteps(double degrees)
+    {
+        degrees = std::abs(std::remainder(degrees, 360.0));
+        if (degrees < BEARING_TOLERANCE)
+        {
+            return 0;
+        }
+        return std::max(0.0, degrees - 2 * TURN_PER_STEP) / TURN_PER_STEP +
+               std::log2(std::min(degrees, 2 * TURN_PER_STEP) / BEARING_TOLERANCE);
+    }
+
+    // BaseRobot::move faces the target, drives to it, then turns to start heading + angle
+    double moveSeconds(Pose &pose, double x, double z, double angle, double startHeading)
+    {
+        if (std::hypot(x - pose.x, z - pose.z) < 1e-9)
+        {
+            return 0;
+        }
+        double bearing{std::atan2(z - pose.z, x - pose.x) * DEGREES_PER_RADIAN + 180};
+        double distance{std::hypot(x - pose.x, z - pose.z)};
+        double heading{startHeading + angle};
+        double steps{MOVE_STEPS + turnSteps(bearing - pose.heading) + distance / DRIVE_PER_STEP + 2 +
+                     turnSteps(heading - bearing)};
+        pose = {x, z, heading};
+        return steps * STEP_SECONDS;
+    }
+
+    // Start poses of the robots named in a Webots world, from each top level node's translation
+    std::unordered_map<std::string, Pose> worldPoses(const std::string &worldPath)
+    {
+        std::unordered_map<std::string, Pose> poses;
+        std::ifstream worldFile(worldPath, std::ifstream::in);
+        std::string lineInput;
+        Pose pose{0, 0, 0};
+        while (std::getline(worldFile, lineInput))
+        {
+            if (!lineInput.empty() && lineInput[0] != ' ' && lineInput[0] != '}')
+            {
+                pose = {0, 0, 0};
+            }
+            else if (lineInput.rfind("  translation ", 0) == 0)
+            {
+                double y{0};
+                std::istringstream(lineInput.substr(14)) >> pose.x >> y >> pose.z;
+            }
+            else if (lineInput.rfind("  name \"", 0) == 0)
+            {
+                poses[lineInput.substr(8, lineInput.rfind('"') - 8)] = pose;
+            }
+        }
+        return poses;
+    }
+}
+
+DispatchModel::DispatchModel(const Settings &settings, const Menu &menu, const std::string &orderPath,
+                             const std::string &startingPath, const std::string &worldPath)
+    : mMaxOutstanding(static_cast<std::size_t>(std::max(1, settings.getInt("max_outstanding_orders", 1)))),
+      mPreorder(settings.getInt("preorder", 0) != 0)
+{
+    OrderFile orderFile{orderPath};
+    Order order;
+    while (orderFile.next(order))
+    {
+        ItemId id{menu.find(order.item)};
+        mOrders.push_back({order.customer, order.item, id, (id != Menu::NO_ITEM) ? menu.price(id) : 0,
+                           (id != Menu::NO_ITEM) ? menu.prepSeconds(id) : 0});
+    }
+
+    std::ifstream startingFile(startingPath, std::ifstream::in);
+    std::string lineInput;
+    std::getline(startingFile, lineInput);
+    while (std::getline(startingFile, lineInput))
+    {
+        std::size_t comma{lineInput.find(',')};
+        if (comma != std::string::npos)
+        {
+            mBalances[std::atoi(lineInput.c_str())] = std::stod(lineInput.substr(comma + 1));
+        }
+    }
+
+    // Customers missing from the world start where the world's customers do on average
+    std::unordered_map<std::string, Pose> poses{worldPoses(worldPath)};
+    Pose average{0, 0, 0};
+    int customers{0};
+    for (const auto &entry : poses)
+    {
+        if (entry.first.rfind("Customer", 0) == 0)
+        {
+            average.x += entry.second.x;
+            average.z += entry.second.z;
+            customers++;
+        }
+    }
+    if (customers > 0)
+    {
+        average.x /= customers;
+        average.z /= customers;
+    }
+
+    auto walksFrom = [](Pose start) {
+        Walks walks{};
+        Pose pose{start};
+        walks.toCounter = moveSeconds(pose, ORDER_COUNTER_X, ORDER_COUNTER_Z, ORDER_COUNTER_ANGLE, start.heading);
+        walks.toPickup = moveSeconds(pose, PICKUP_COUNTER_X, PICKUP_COUNTER_Z, PICKUP_COUNTER_ANGLE, start.heading);
+        walks.home = moveSeconds(pose, start.x, start.z, start.heading, start.heading);
+        return walks;
+    };
+    mDefaultWalks = walksFrom(average);
+    auto staff{poses.find("Staff")};
+    mStaffStart = (staff != poses.end()) ? Position{staff->second.x, staff->second.z} : Position{1.375, 0.875};
+    for (const ModelOrder &modelOrder : mOrders)
+    {
+        auto pose{poses.find("Customer" + std::to_string(modelOrder.customer))};
+        if (pose != poses.end() && mWalks.count(modelOrder.customer) == 0)
+        {
+            mWalks[modelOrder.customer] = walksFrom(pose->second);
+        }
+    }
+}
+
+double DispatchModel::evaluate(const std::vector<int> &sequence, Objective objective, std::vector<ModelTimes> *times) const
+{
+    // Events are {time, order, kind}
+    using Event = std::tuple<double, int, int>;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    std::unordered_map<int, double> balances{mBalances};
+    std::unordered_map<int, bool> busy;
+    std::vector<double> atCounter(mOrders.size(), 0);
+    if (times != nullptr)
+    {
+        times->assign(mOrders.size(), {0, 0});
+    }
+
+    // The staff takes on one drive at a time, in the order they come up. It goes to the order
+    // counter for a customer waiting there, to the kitchen and a pickup slot for a cooked order,
+    // and back to its start once nobody is being served.
+    Pose staff{mStaffStart.x, mStaffStart.z, 0};
+    double staffFree{0};
+    int serving{0};
+    auto drive = [&staff, &staffFree](double from, double x, double z, double angle) {
+        staffFree = std::max(from, staffFree) + moveSeconds(staff, x, z, angle, 0);
+        return staffFree;
+    };
+
+    // The director dispatches on the step after auto mode starts
+    double now{STEP_SECONDS};
+    double nextDispatch{STEP_SECONDS};
+    double kitchenFree{0};
+    double makespan{0};
+    double flowTime{0};
+    std::size_t outstanding{0};
+    std::size_t next{0};
+    while (next < sequence.size() || !events.empty())
+    {
+        while (next < sequence.size() && outstanding < mMaxOutstanding && !busy[mOrders[sequence[next]].customer])
+        {
+            int index{sequence[next++]};
+            const ModelOrder &order{mOrders[index]};
+            double dispatch{std::max(now, nextDispatch)};
+            nextDispatch = dispatch + STEP_SECONDS;
+            outstanding++;
+            busy[order.customer] = true;
+            if (times != nullptr)
+            {
+                (*times)[index].dispatch = dispatch;
+            }
+
+            // The customer's menu replica turns away what the staff would reject, without a walk
+            // A pre-order is checked and paid for as the customer sets off, without the staff at the counter
+            double &balance{balances[order.customer]};
+            if (order.id != Menu::NO_ITEM && order.price <= balance)
+            {
+                balance -= order.price;
+                atCounter[index] = dispatch + DISPATCH_STEPS * STEP_SECONDS + walks(order.customer).toCounter;
+                if (mPreorder)
+                {
+                    serving++;
+                    events.push({dispatch + (DISPATCH_STEPS + PAY_STEPS) * STEP_SECONDS, index, PAID});
+                }
+                else
+                {
+                    events.push({atCounter[index], index, ARRIVED});
+                }
+            }
+            else
+            {
+                events.push({dispatch + DISPATCH_STEPS * STEP_SECONDS, index, HOME});
+            }
+        }
+        if (events.empty())
+        {
+            break;
+        }
+
+        auto [time, index, kind] = events.top();
+        events.pop();
+        now = time;
+        const ModelOrder &order{mOrders[index]};
+        switch (kind)
+        {
+        case ARRIVED:
+        {
+            serving++;
+            double checked{drive(now, STAFF_ORDER_COUNTER_X, STAFF_ORDER_COUNTER_Z, STAFF_COUNTER_ANGLE)};
+            events.push({checked + PAY_STEPS * STEP_SECONDS, index, PAID});
+            continue;
+        }
+        case PAID:
+            kitchenFree = std::max(now, kitchenFree) + order.prepSeconds;
+            events.push({kitchenFree, index, COOKED});
+            continue;
+        case COOKED:
+        {
+            drive(now, KITCHEN_X, KITCHEN_Z, KITCHEN_ANGLE);
+            double delivered{drive(now, PICKUP_SLOT_X, PICKUP_SLOT_Z, STAFF_COUNTER_ANGLE)};
+            double setOff{std::max(delivered + READY_STEPS * STEP_SECONDS, atCounter[index])};
+            events.push({setOff + walks(order.customer).toPickup, index, PICKED_UP});
+            continue;
+        }
+        case PICKED_UP:
+            if (--serving == 0)
+            {
+                drive(now, mStaffStart.x, mStaffStart.z, 0);
+            }
+            events.push({now + walks(order.customer).home, index, HOME});
+            continue;
+        default:
+            break;
+        }
+
+        // The director hears of the completion a step later, and a director that was holding
+        // dispatches at the limit only dispatches again on the step after that
+        double complete{now + COMPLETE_STEPS * STEP_SECONDS};
+        if (outstanding == mMaxOutstanding)
+        {
+            nextDispatch = std::max(nextDispatch, complete + STEP_SECONDS);
+        }
+        now = std::max(now, complete);
+        outstanding--;
+        busy[order.customer] = false;
+        makespan = std::max(makespan, complete);
+        flowTime += complete;
+        if (times != nullptr)
+        {
+            (*times)[index].complete = complete;
+        }
+    }
+    return (objective == Objective::MAKESPAN) ? makespan : flowTime;
+}
+
+bool DispatchModel::valid(const std::vector<int> &sequence) const
+{
+    if (sequence.size() != mOrders.size())
+    {
+        return false;
+    }
+    std::vector<bool> seen(mOrders.size(), false);
+    std::unordered_map<int, int> last;
+    for (int index : sequence)
+    {
+        if (index < 0 || static_cast<std::size_t>(index) >= mOrders.size() || seen[index])
+        {
+            return false;
+        }
+        seen[index] = true;
+        auto previous{last.find(mOrders[index].customer)};
+        if (previous != last.end() && previous->second > index)
+        {
+            return false;
+        }
+        last[mOrders[index].customer] = index;
+    }
+    return true;
+}
+
+const std::vector<ModelOrder>& DispatchModel::orders() const
+{
+    return mOrders;
+}
+
+double DispatchModel::toCounter(int customer) const
+{
+    return walks(customer).toCounter;
+}
+
+double DispatchModel::pickupHome(int customer) const
+{
+    return walks(customer).toPickup + walks(customer).home;
+}
+
+const DispatchModel::Walks& DispatchModel::walks(int customer) const
+{
+    auto found{mWalks.find(customer)};
+    return (found != mWalks.end()) ? found->second : mDefaultWalks;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "z5363966Menu.hpp"
+#include "z5363966Settings.hpp"
+
+// What a dispatch sequence is scored on. Every order in Order.csv arrives when auto mode starts, so
+// an order's flow time is its completion time.
+enum class Objective : unsigned char { MAKESPAN, FLOW_TIME };
+
+// An order of Order.csv, with what the model needs to know about it
+struct ModelOrder {
+    int customer;
+    std::string item;   // as written in Order.csv
+    ItemId id;          // Menu::NO_ITEM if it is not on the menu
+    double price;
+    int prepSeconds;
+};
+
+// Times of one order under a dispatch sequence, from the start of auto mode [s]
+struct ModelTimes {
+    double dispatch;
+    double complete;
+};
+
+/**
+ * @brief Discrete event model of auto mode, for scoring dispatch sequences without running the
+ * simulation.
+ *
+ * It follows the director's rules: orders are dispatched in sequence order, the next order waits for
+ * its customer to finish the previous one and for fewer than max_outstanding_orders customers to be
+ * ordering, and one order is dispatched per time step. A customer turns an order away at once if the
+ * item is not on the menu or not affordable, as its menu replica does. Otherwise it walks to the
+ * order counter, where the staff checks the order once it gets there, and pays, or with preorder set
+ * orders and pays as it sets off. Paid orders join the kitchen, which prepares one order at a time in
+ * the order they were paid for. The staff carries each cooked order from the kitchen to a pickup
+ * slot, and the customer then walks to the pickup counter and back to its start. The staff drives
+ * one trip at a time and returns to its start once nobody is being served. Walks and drives are
+ * timed from the distances and turns between the start poses in the world file and the counters, at
+ * the speeds and tolerances BaseRobot::move drives with.
+ *
+ */
+class DispatchModel {
+    public:
+        /**
+         * @brief Loads the orders, menu, starting balances and customer start poses
+         *
+         * @param settings for max_outstanding_orders
+         * @param menu
+         * @param orderPath Order.csv
+         * @param startingPath Starting.csv
+         * @param worldPath e.g. ../../worlds/MTRN2500.wbt, for where each customer starts
+         */
+        DispatchModel(const Settings&, const Menu&, const std::string&, const std::string&, const std::string&);
+
+        /**
+         * @brief Scores a dispatch sequence
+         *
+         * @param sequence indices into orders(), each once, keeping every customer's orders in file order
+         * @param objective
+         * @param times if not null, filled with every order's times, indexed like orders()
+         * @return double, makespan or total flow time [s]
+         */
+        double evaluate(const std::vector<int>&, Objective, std::vector<ModelTimes> *times = nullptr) const;
+
+        /**
+         * @brief Checks that a sequence holds every order once and keeps each customer's orders in file order
+         *
+         * @return boolean
+         */
+        bool valid(const std::vector<int>&) const;
+
+        const std::vector<ModelOrder>& orders() const;
+
+        /**
+         * @brief Walk times of a customer [s]: start to order counter, and order counter to pickup
+         * counter and back to start
+         *
+         */
+        double toCounter(int) const;
+        double pickupHome(int) const;
+
+    private:
+        struct Walks {
+            double toCounter;
+            double toPickup;
+            double home;
+        };
+
+        struct Position {
+            double x;
+            double z;
+        };
+
+        const Walks& walks(int) const;
+
+        std::vector<ModelOrder> mOrders;
+        std::unordered_map<int, double> mBalances;
+        std::unordered_map<int, Walks> mWalks;
+        Walks mDefaultWalks;
+        Position mStaffStart;
+        std::size_t mMaxOutstanding;
+        bool mPreorder;
+};
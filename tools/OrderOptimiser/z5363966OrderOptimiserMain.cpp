@@ -0,0 +1,159 @@
+// File:          OrderOptimiserMain.cpp
+// Description:   Offline order sequence optimiser. Reads Order.csv, Menu.csv, Starting.csv and the
+//                customer start poses in worlds/MTRN2500.wbt, then searches for the order in which the
+//                director should dispatch the orders to minimise the makespan or the total flow time of
+//                auto mode, keeping each customer's orders in the order Order.csv lists them. The best
+//                sequence found within the time budget is written as an Order.csv the director replays
+//                when its order_file setting points at it. Prints how the best score improved over the
+//                search, so the budget can be traded against quality.
+//                Run from tools/OrderOptimiser so ../../ is the project root:
+//                  build/OrderOptimiser [--objective makespan|flow] [--budget seconds] [--threads n]
+//                                       [--seed n] [--orders path] [--settings path] [--out path]
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "z5363966DispatchModel.hpp"
+#include "z5363966SequenceSearch.hpp"
+
+static constexpr double DEFAULT_BUDGET_SECONDS {10};
+
+// Times the report gives the best score at, growing geometrically up to the budget
+static constexpr double FIRST_CHECKPOINT_SECONDS {0.001};
+static constexpr double CHECKPOINT_FACTOR {10};
+
+static void usage()
+{
+    std::fprintf(stderr, "usage: OrderOptimiser [--objective makespan|flow] [--budget seconds] [--threads n] "
+                         "[--seed n] [--orders path] [--settings path] [--out path]\n");
+}
+
+static std::string percent(double score, double fileScore)
+{
+    char text[32];
+    std::snprintf(text, sizeof(text), "%+.1f%%", (fileScore > 0) ? 100 * (score - fileScore) / fileScore : 0.0);
+    return text;
+}
+
+int main(int argc, char **argv)
+{
+    Objective objective{Objective::MAKESPAN};
+    double budget{DEFAULT_BUDGET_SECONDS};
+    unsigned threads{std::max(1u, std::thread::hardware_concurrency())};
+    std::uint64_t seed{1};
+    std::string orderPath{"../../Order.csv"};
+    std::string settingsPath{"../../Settings.csv"};
+    std::string outPath{"../../OrderOptimised.csv"};
+    for (int arg = 1; arg < argc; arg++)
+    {
+        std::string option{argv[arg]};
+        if (arg + 1 >= argc)
+        {
+            usage();
+            return 2;
+        }
+        std::string value{argv[++arg]};
+        if (option == "--objective" && (value == "makespan" || value == "flow"))
+        {
+            objective = (value == "makespan") ? Objective::MAKESPAN : Objective::FLOW_TIME;
+        }
+        else if (option == "--budget")
+        {
+            budget = std::atof(value.c_str());
+        }
+        else if (option == "--threads")
+        {
+            threads = static_cast<unsigned>(std::max(1, std::atoi(value.c_str())));
+        }
+        else if (option == "--seed")
+        {
+            seed = std::strtoull(value.c_str(), nullptr, 10);
+        }
+        else if (option == "--orders")
+        {
+            orderPath = value;
+        }
+        else if (option == "--settings")
+        {
+            settingsPath = value;
+        }
+        else if (option == "--out")
+        {
+            outPath = value;
+        }
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    Settings settings{settingsPath};
+    Menu menu{"../../Menu.csv"};
+    DispatchModel model{settings, menu, orderPath, "../../Starting.csv",
+                        "../../worlds/MTRN2500.wbt"};
+    const std::vector<ModelOrder> &orders{model.orders()};
+    const char *name{(objective == Objective::MAKESPAN) ? "makespan" : "flow time"};
+    std::printf("%zu orders, minimising %s for up to %.1f s on %u thread(s)\n", orders.size(), name, budget, threads);
+
+    SearchResult result{searchSequence(model, objective, budget, threads, seed)};
+
+    // Best score by each checkpoint, so a smaller budget can be judged by what it would have found
+    std::printf("%10s %14s %10s\n", "time [s]", "best [s]", "vs file");
+    for (double checkpoint = FIRST_CHECKPOINT_SECONDS; ; checkpoint *= CHECKPOINT_FACTOR)
+    {
+        bool last{checkpoint >= result.seconds};
+        checkpoint = std::min(checkpoint, result.seconds);
+        double best{result.fileScore};
+        for (const auto &[seconds, score] : result.trace)
+        {
+            if (seconds <= checkpoint)
+            {
+                best = score;
+            }
+        }
+        std::printf("%10.3f %14.1f %10s\n", checkpoint, best, percent(best, result.fileScore).c_str());
+        if (last)
+        {
+            break;
+        }
+    }
+
+    std::vector<int> fileOrder(orders.size());
+    for (std::size_t index = 0; index < orders.size(); index++)
+    {
+        fileOrder[index] = static_cast<int>(index);
+    }
+    std::printf("file order:  makespan %.1f s, flow time %.1f s\n",
+                model.evaluate(fileOrder, Objective::MAKESPAN), model.evaluate(fileOrder, Objective::FLOW_TIME));
+    std::printf("best order:  makespan %.1f s, flow time %.1f s (%s %s)\n",
+                model.evaluate(result.best, Objective::MAKESPAN), model.evaluate(result.best, Objective::FLOW_TIME),
+                percent(result.bestScore, result.fileScore).c_str(), name);
+    std::printf("%s after %llu sequences scored\n", result.proven ? "optimal under the model" : "budget spent",
+                static_cast<unsigned long long>(result.evaluations));
+
+    if (!model.valid(result.best))
+    {
+        std::fprintf(stderr, "best sequence reorders a customer's orders\n");
+        return 1;
+    }
+    std::ofstream outFile{outPath, std::ofstream::out | std::ofstream::trunc};
+    outFile << "Robot,Order\n";
+    for (int index : result.best)
+    {
+        outFile << orders[index].customer << ',' << orders[index].item << '\n';
+    }
+    if (!outFile)
+    {
+        std::fprintf(stderr, "could not write %s\n", outPath.c_str());
+        return 1;
+    }
+    std::printf("wrote %s, replay it with order_file,%s in Settings.csv\n", outPath.c_str(), outPath.c_str());
+    return 0;
+}
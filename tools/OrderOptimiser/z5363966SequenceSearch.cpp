@@ -0,0 +1,352 @@
+#include "z5363966SequenceSearch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // Most sequences to score one by one rather than search
+    constexpr double EXHAUSTIVE_LIMIT {2e6};
+
+    // Orders fixed by each prefix the exhaustive search hands to a thread
+    constexpr std::size_t PREFIX_LENGTH {3};
+
+    // Moves without improving before the local search perturbs, per order
+    constexpr std::size_t STALL_MOVES_PER_ORDER {20};
+
+    // Fraction of orders moved at random by a perturbation
+    constexpr double PERTURB_FRACTION {0.05};
+
+    // Scores within this of each other are a tie
+    constexpr double EPSILON {1e-9};
+
+    // Best sequence across the threads
+    class SharedBest {
+        public:
+            SharedBest(Clock::time_point start) : mStart(start) {}
+
+            void offer(const std::vector<int> &sequence, double score)
+            {
+                std::lock_guard<std::mutex> lock{mMutex};
+                if (mBest.empty() || score < mScore - EPSILON)
+                {
+                    mBest = sequence;
+                    mScore = score;
+                    mTrace.push_back({std::chrono::duration<double>(Clock::now() - mStart).count(), score});
+                }
+            }
+
+            void take(SearchResult &result)
+            {
+                std::lock_guard<std::mutex> lock{mMutex};
+                result.best = mBest;
+                result.bestScore = mScore;
+                result.trace = mTrace;
+            }
+
+        private:
+            std::mutex mMutex;
+            Clock::time_point mStart;
+            std::vector<int> mBest;
+            double mScore{0};
+            std::vector<std::pair<double, double>> mTrace;
+    };
+
+    // Each customer's orders in file order, with a cursor to the next one still to be sequenced
+    struct Queues {
+        std::vector<std::vector<int>> orders;
+        std::vector<std::size_t> next;
+    };
+
+    Queues customerQueues(const DispatchModel &model)
+    {
+        std::map<int, std::size_t> customers;
+        Queues queues;
+        for (std::size_t index = 0; index < model.orders().size(); index++)
+        {
+            auto found{customers.emplace(model.orders()[index].customer, queues.orders.size())};
+            if (found.second)
+            {
+                queues.orders.emplace_back();
+            }
+            queues.orders[found.first->second].push_back(static_cast<int>(index));
+        }
+        queues.next.assign(queues.orders.size(), 0);
+        return queues;
+    }
+
+    // Number of sequences keeping each customer's orders in file order, n! / (n1! n2! ...)
+    double sequenceCount(const Queues &queues, std::size_t orders)
+    {
+        double logCount{std::lgamma(orders + 1.0)};
+        for (const std::vector<int> &customer : queues.orders)
+        {
+            logCount -= std::lgamma(customer.size() + 1.0);
+        }
+        return std::exp(logCount);
+    }
+
+    // A start for the exhaustive search, with each customer's cursor just past the prefix
+    struct Prefix {
+        std::vector<int> sequence;
+        std::vector<std::size_t> next;
+    };
+
+    // Every prefix of the given length, each keeping its customers' orders in file order
+    void prefixes(Queues &queues, std::vector<int> &prefix, std::size_t length, std::vector<Prefix> &out)
+    {
+        if (prefix.size() == length)
+        {
+            out.push_back({prefix, queues.next});
+            return;
+        }
+        for (std::size_t customer = 0; customer < queues.orders.size(); customer++)
+        {
+            if (queues.next[customer] < queues.orders[customer].size())
+            {
+                prefix.push_back(queues.orders[customer][queues.next[customer]++]);
+                prefixes(queues, prefix, length, out);
+                queues.next[customer]--;
+                prefix.pop_back();
+            }
+        }
+    }
+
+    struct Enumeration {
+        const DispatchModel &model;
+        Objective objective;
+        Clock::time_point deadline;
+        std::atomic<bool> &timedOut;
+        std::vector<int> best;
+        double bestScore;
+        std::uint64_t scored;
+    };
+
+    // Scores every completion of the sequence, stopping early once the budget runs out
+    void enumerate(Enumeration &search, Queues &queues, std::vector<int> &sequence)
+    {
+        if (search.timedOut)
+        {
+            return;
+        }
+        if (sequence.size() == search.model.orders().size())
+        {
+            double score{search.model.evaluate(sequence, search.objective)};
+            if (search.best.empty() || score < search.bestScore - EPSILON)
+            {
+                search.best = sequence;
+                search.bestScore = score;
+            }
+            if (++search.scored % 1024 == 0 && Clock::now() > search.deadline)
+            {
+                search.timedOut = true;
+            }
+            return;
+        }
+        for (std::size_t customer = 0; customer < queues.orders.size(); customer++)
+        {
+            if (queues.next[customer] < queues.orders[customer].size())
+            {
+                sequence.push_back(queues.orders[customer][queues.next[customer]++]);
+                enumerate(search, queues, sequence);
+                queues.next[customer]--;
+                sequence.pop_back();
+            }
+        }
+    }
+
+    // A sequence drawn uniformly from those keeping each customer's orders in file order
+    std::vector<int> randomSequence(Queues queues, std::size_t orders, std::mt19937_64 &random)
+    {
+        std::vector<int> sequence;
+        sequence.reserve(orders);
+        std::size_t remaining{orders};
+        while (remaining > 0)
+        {
+            std::size_t pick{std::uniform_int_distribution<std::size_t>(0, remaining - 1)(random)};
+            for (std::size_t customer = 0; customer < queues.orders.size(); customer++)
+            {
+                std::size_t left{queues.orders[customer].size() - queues.next[customer]};
+                if (pick < left)
+                {
+                    sequence.push_back(queues.orders[customer][queues.next[customer]++]);
+                    break;
+                }
+                pick -= left;
+            }
+            remaining--;
+        }
+        return sequence;
+    }
+
+    // Moves the order at from to position to, shifting the orders between them along one
+    void moveOrder(std::vector<int> &sequence, std::size_t from, std::size_t to)
+    {
+        if (from < to)
+        {
+            std::rotate(sequence.begin() + from, sequence.begin() + from + 1, sequence.begin() + to + 1);
+        }
+        else
+        {
+            std::rotate(sequence.begin() + to, sequence.begin() + from, sequence.begin() + from + 1);
+        }
+    }
+
+    // Moves the order at from to a random other position between its customer's neighbouring orders
+    // and returns that position, or returns from if it has nowhere to go
+    std::size_t randomMove(std::vector<int> &sequence, const DispatchModel &model, std::size_t from,
+                           std::mt19937_64 &random)
+    {
+        int customer{model.orders()[sequence[from]].customer};
+        std::size_t low{from};
+        while (low > 0 && model.orders()[sequence[low - 1]].customer != customer)
+        {
+            low--;
+        }
+        std::size_t high{from};
+        while (high + 1 < sequence.size() && model.orders()[sequence[high + 1]].customer != customer)
+        {
+            high++;
+        }
+        if (low == high)
+        {
+            return from;
+        }
+        std::size_t to{std::uniform_int_distribution<std::size_t>(low, high - 1)(random)};
+        to += (to >= from) ? 1 : 0;
+        moveOrder(sequence, from, to);
+        return to;
+    }
+
+}
+
+SearchResult searchSequence(const DispatchModel &model, Objective objective, double budgetSeconds, unsigned threads,
+                            std::uint64_t seed)
+{
+    Clock::time_point start{Clock::now()};
+    Clock::time_point deadline{start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(budgetSeconds))};
+    threads = std::max(1u, threads);
+    std::size_t orders{model.orders().size()};
+    Queues queues{customerQueues(model)};
+
+    SearchResult result{};
+    std::vector<int> fileOrder(orders);
+    for (std::size_t index = 0; index < orders; index++)
+    {
+        fileOrder[index] = static_cast<int>(index);
+    }
+    result.fileScore = model.evaluate(fileOrder, objective);
+
+    SharedBest shared{start};
+    shared.offer(fileOrder, result.fileScore);
+    std::atomic<std::uint64_t> evaluations{1};
+    std::atomic<bool> timedOut{false};
+    std::vector<std::thread> workers;
+
+    if (sequenceCount(queues, orders) <= EXHAUSTIVE_LIMIT)
+    {
+        // Threads take prefixes in turn and score every sequence starting with them
+        std::vector<Prefix> work;
+        std::vector<int> prefix;
+        prefixes(queues, prefix, std::min(PREFIX_LENGTH, orders), work);
+        std::atomic<std::size_t> nextPrefix{0};
+        for (unsigned thread = 0; thread < threads; thread++)
+        {
+            workers.emplace_back([&, queues]() mutable {
+                Enumeration search{model, objective, deadline, timedOut, {}, 0, 0};
+                for (std::size_t index = nextPrefix++; index < work.size() && !timedOut; index = nextPrefix++)
+                {
+                    std::vector<int> sequence{work[index].sequence};
+                    queues.next = work[index].next;
+                    enumerate(search, queues, sequence);
+                }
+                if (!search.best.empty())
+                {
+                    shared.offer(search.best, search.bestScore);
+                }
+                evaluations += search.scored;
+            });
+        }
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+        result.proven = !timedOut;
+    }
+    else
+    {
+        std::size_t stallMoves{STALL_MOVES_PER_ORDER * orders};
+        std::size_t perturbMoves{std::max<std::size_t>(2, static_cast<std::size_t>(PERTURB_FRACTION * orders))};
+        for (unsigned thread = 0; thread < threads; thread++)
+        {
+            workers.emplace_back([&, thread]() {
+                std::mt19937_64 random{seed + thread};
+                std::uniform_int_distribution<std::size_t> position(0, orders - 1);
+                std::vector<int> current{(thread == 0) ? fileOrder : randomSequence(queues, orders, random)};
+                double score{model.evaluate(current, objective)};
+                std::vector<int> best{current};
+                double bestScore{score};
+                shared.offer(best, bestScore);
+                std::uint64_t scored{1};
+                std::size_t stalled{0};
+                while (Clock::now() < deadline)
+                {
+                    std::size_t from{position(random)};
+                    std::size_t to{randomMove(current, model, from, random)};
+                    if (to == from)
+                    {
+                        stalled++;
+                        continue;
+                    }
+                    double moved{model.evaluate(current, objective)};
+                    scored++;
+                    if (moved <= score + EPSILON)
+                    {
+                        score = moved;
+                    }
+                    else
+                    {
+                        moveOrder(current, to, from);
+                    }
+                    if (score < bestScore - EPSILON)
+                    {
+                        best = current;
+                        bestScore = score;
+                        shared.offer(best, bestScore);
+                        stalled = 0;
+                    }
+                    else if (++stalled > stallMoves)
+                    {
+                        // Kicks the best sequence out of its local optimum
+                        current = best;
+                        for (std::size_t move = 0; move < perturbMoves; move++)
+                        {
+                            randomMove(current, model, position(random), random);
+                        }
+                        score = model.evaluate(current, objective);
+                        scored++;
+                        stalled = 0;
+                    }
+                }
+                evaluations += scored;
+            });
+        }
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+        result.proven = false;
+    }
+
+    shared.take(result);
+    result.evaluations = evaluations;
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return result;
+}
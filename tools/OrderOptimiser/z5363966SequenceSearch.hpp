@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "z5363966DispatchModel.hpp"
+
+// Outcome of a sequence search
+struct SearchResult {
+    std::vector<int> best;
+    double bestScore;
+    double fileScore;           // of the orders in file order
+    bool proven;                // every sequence was scored, so best is optimal under the model
+    std::uint64_t evaluations;
+    double seconds;             // the search took
+
+    // {seconds since the search started, best score so far}, every time the best improved
+    std::vector<std::pair<double, double>> trace;
+};
+
+/**
+ * @brief Searches for the dispatch sequence with the lowest score under a dispatch model.
+ *
+ * Only sequences that keep each customer's orders in file order are considered. When there are few
+ * enough of them, every one is scored, split across the threads. Otherwise each thread runs an
+ * iterated local search from its own start (the first thread from the file order), moving one order
+ * at a time within the window its customer's other orders allow and perturbing the best sequence
+ * whenever it stops improving. The threads share the best sequence found.
+ *
+ * @param model
+ * @param objective
+ * @param budgetSeconds wall time the search may take
+ * @param threads at least 1
+ * @param seed of the local search
+ * @return SearchResult
+ */
+SearchResult searchSequence(const DispatchModel&, Objective, double, unsigned, std::uint64_t);
@@ -0,0 +1,58 @@
+// File:          PoseExportMain.cpp
+// Description:   Prints a robot's recorded poses as CSV, see z5363966PoseRecorder.hpp. Decodes only the
+//                chunks of the recording that overlap the window asked for, the whole recording if
+//                none is given. With --events it prints the recorded events instead: move states
+//                from BaseRobot::MOVE_EVENT, control states from BaseRobot::CONTROL_EVENT.
+//                  build/PoseExport [--events] <recording.pose> [<from> [<to>]]   (times in s)
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "z5363966PoseRecorder.hpp"
+
+int main(int argc, char **argv)
+{
+    bool events{argc > 1 && std::string(argv[1]) == "--events"};
+    int first{events ? 2 : 1};
+    if (argc <= first || argc > first + 3)
+    {
+        std::fprintf(stderr, "usage: PoseExport [--events] <recording.pose> [<from> [<to>]]\n");
+        return 2;
+    }
+    PoseReader reader{argv[first]};
+    if (!reader.ok())
+    {
+        std::fprintf(stderr, "PoseExport: %s is not a pose recording\n", argv[first]);
+        return 1;
+    }
+    double from{(argc > first + 1) ? std::atof(argv[first + 1]) : reader.start()};
+    double to{(argc > first + 2) ? std::atof(argv[first + 2]) : reader.end()};
+
+    std::vector<PoseSample> samples;
+    std::vector<PoseEvent> recorded;
+    if (!reader.read(from, to, samples, recorded))
+    {
+        std::fprintf(stderr, "PoseExport: %s is damaged\n", argv[first]);
+        return 1;
+    }
+    if (events)
+    {
+        std::printf("Time (s),Event\n");
+        for (const PoseEvent &event : recorded)
+        {
+            std::printf("%.3f,%u\n", event.time, static_cast<unsigned>(event.code));
+        }
+    }
+    else
+    {
+        std::printf("Time (s),X (m),Z (m),Heading (deg)\n");
+        for (const PoseSample &sample : samples)
+        {
+            std::printf("%.3f,%.4f,%.4f,%.3f\n", sample.time, sample.x, sample.z, sample.heading);
+        }
+    }
+    std::fprintf(stderr, "%zu of %zu chunks decoded\n", reader.decoded(), reader.chunks());
+    return 0;
+}
@@ -0,0 +1,83 @@
+// File:          TeleopClientMain.cpp
+// Description:   Streams teleop commands to a robot in remote mode, see z5363966Teleop.hpp. Reads one
+//                command per line from standard input as "<left> <right>" wheel velocities in rad/s and
+//                sends each as soon as it is read, stamped with the current time. The robot's endpoint
+//                follows teleop_address and staff_id in Settings.csv.
+//                Run from tools/TeleopClient so ../../ is the project root:
+//                  build/TeleopClient <robot name>
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "z5363966Roster.hpp"
+#include "z5363966Settings.hpp"
+#include "z5363966Teleop.hpp"
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        std::fprintf(stderr, "usage: TeleopClient <robot name>, then \"<left> <right>\" [rad/s] per line\n");
+        return 2;
+    }
+    std::string robotName{argv[1]};
+    Settings settings{"../../Settings.csv"};
+    std::string teleopAddress{settings.getString("teleop_address", "")};
+
+    int fd{-1};
+    sockaddr_storage address{};
+    socklen_t addressLength{0};
+    if (teleopAddress.rfind("unix:", 0) == 0)
+    {
+        fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+        auto *unixAddress{reinterpret_cast<sockaddr_un *>(&address)};
+        unixAddress->sun_family = AF_UNIX;
+        (teleopAddress.substr(5) + "_" + robotName).copy(unixAddress->sun_path, sizeof(unixAddress->sun_path) - 1);
+        addressLength = sizeof(sockaddr_un);
+    }
+    else if (teleopAddress.rfind("udp:", 0) == 0)
+    {
+        // IDs are as the robot asks for them, so a robot given another ID by the director is not reached
+        int robotId{Roster::requestedId(robotName, settings.getInt("staff_id", 5))};
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        auto *udpAddress{reinterpret_cast<sockaddr_in *>(&address)};
+        udpAddress->sin_family = AF_INET;
+        udpAddress->sin_port = htons(static_cast<std::uint16_t>(std::stoi(teleopAddress.substr(4)) + robotId));
+        udpAddress->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addressLength = sizeof(sockaddr_in);
+    }
+    if (fd < 0)
+    {
+        std::fprintf(stderr, "set teleop_address to unix:<path> or udp:<port> in Settings.csv\n");
+        return 1;
+    }
+
+    std::uint32_t sequence{0};
+    std::string lineInput;
+    while (std::getline(std::cin, lineInput))
+    {
+        TeleopCommand command{++sequence, 0, 0, 0};
+        if (!(std::istringstream(lineInput) >> command.left >> command.right))
+        {
+            std::fprintf(stderr, "skipping \"%s\", expected \"<left> <right>\"\n", lineInput.c_str());
+            continue;
+        }
+        auto now{std::chrono::system_clock::now().time_since_epoch()};
+        command.sentNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+        if (sendto(fd, &command, sizeof(command), 0, reinterpret_cast<sockaddr *>(&address), addressLength) < 0)
+        {
+            std::perror("TeleopClient: send");
+        }
+    }
+    close(fd);
+    return 0;
+}